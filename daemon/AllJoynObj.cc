@@ -56,6 +56,8 @@
 #include "EndpointHelper.h"
 #include "ns/IpNameService.h"
 #include "AllJoynPeerObj.h"
+#include "DaemonConfig.h"
+#include "LockOrderChecker.h"
 
 #define QCC_MODULE "ALLJOYN_OBJ"
 
@@ -67,18 +69,93 @@ namespace ajn {
 void* AllJoynObj::NameMapEntry::truthiness = reinterpret_cast<void*>(true);
 int AllJoynObj::JoinSessionThread::jstCount = 0;
 
+/*
+ * Default number of threads handling JoinSession requests, and separately AttachSession requests.
+ * Override with the "max_concurrent_joins" limit in the daemon config.
+ */
+static const uint32_t MAX_JOIN_SESSION_THREADS_DEFAULT = 8;
+
+/*
+ * Default number of JoinSession threads, and separately AttachSession threads, that may be blocked
+ * on another daemon or an application without holding a place in the pool. Override with the
+ * "max_waiting_joins" limit in the daemon config.
+ */
+static const uint32_t MAX_WAITING_JOIN_SESSION_THREADS_DEFAULT = 64;
+
+/* Timeout in milliseconds for each step of a join that waits on another daemon or an application */
+static const uint32_t JOIN_SESSION_STEP_TIMEOUT = 30000;
+
 void AllJoynObj::AcquireLocks()
 {
-    /*
-     * Locks must be acquired in the following order since tha caller of
-     * this method may already have the name table lock
-     */
+    /* Locks must be acquired in rank order: virtual endpoints, session map, name table */
+    AcquireSessionLocks();
     router.LockNameTable();
 }
 
 void AllJoynObj::ReleaseLocks()
 {
     router.UnlockNameTable();
+    ReleaseSessionLocks();
+}
+
+void AllJoynObj::AcquireSessionLocks()
+{
+    AcquireVirtualEndpointsLock();
+    AcquireSessionMapLock();
+}
+
+void AllJoynObj::ReleaseSessionLocks()
+{
+    ReleaseSessionMapLock();
+    ReleaseVirtualEndpointsLock();
+}
+
+void AllJoynObj::AcquireVirtualEndpointsLock()
+{
+    LockOrderChecker::Acquiring(LOCK_RANK_VIRTUAL_ENDPOINTS, "virtualEndpointsLock");
+    virtualEndpointsLock.Lock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::ReleaseVirtualEndpointsLock()
+{
+    virtualEndpointsLock.Unlock(MUTEX_CONTEXT);
+    LockOrderChecker::Released(LOCK_RANK_VIRTUAL_ENDPOINTS);
+}
+
+void AllJoynObj::AcquireSessionMapLock()
+{
+    LockOrderChecker::Acquiring(LOCK_RANK_SESSION_MAP, "sessionMapLock");
+    sessionMapLock.Lock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::ReleaseSessionMapLock()
+{
+    sessionMapLock.Unlock(MUTEX_CONTEXT);
+    LockOrderChecker::Released(LOCK_RANK_SESSION_MAP);
+}
+
+void AllJoynObj::AcquireStateLock()
+{
+    LockOrderChecker::Acquiring(LOCK_RANK_TRANSPORT_STATE, "stateLock");
+    stateLock.Lock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::ReleaseStateLock()
+{
+    stateLock.Unlock(MUTEX_CONTEXT);
+    LockOrderChecker::Released(LOCK_RANK_TRANSPORT_STATE);
+}
+
+void AllJoynObj::AcquireDiscoveryLock()
+{
+    LockOrderChecker::Acquiring(LOCK_RANK_DISCOVERY, "discoveryLock");
+    discoveryLock.Lock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::ReleaseDiscoveryLock()
+{
+    discoveryLock.Unlock(MUTEX_CONTEXT);
+    LockOrderChecker::Released(LOCK_RANK_DISCOVERY);
 }
 
 AllJoynObj::AllJoynObj(Bus& bus, BusController* busController) :
@@ -94,6 +171,12 @@ AllJoynObj::AllJoynObj(Bus& bus, BusController* busController) :
     exchangeNamesSignal(NULL),
     detachSessionSignal(NULL),
     timer("NameReaper"),
+    numJoinThreads(0),
+    numAttachThreads(0),
+    maxJoinThreads(MAX_JOIN_SESSION_THREADS_DEFAULT),
+    numWaitingJoinThreads(0),
+    numWaitingAttachThreads(0),
+    maxWaitingJoinThreads(MAX_WAITING_JOIN_SESSION_THREADS_DEFAULT),
     isStopping(false),
     busController(busController)
 {
@@ -112,6 +195,12 @@ QStatus AllJoynObj::Init()
 {
     QStatus status;
 
+    maxJoinThreads = DaemonConfig::Access()->Get("limit@max_concurrent_joins", MAX_JOIN_SESSION_THREADS_DEFAULT);
+    if (maxJoinThreads == 0) {
+        maxJoinThreads = 1;
+    }
+    maxWaitingJoinThreads = DaemonConfig::Access()->Get("limit@max_waiting_joins", MAX_WAITING_JOIN_SESSION_THREADS_DEFAULT);
+
     /* Make this object implement org.alljoyn.Bus */
     const InterfaceDescription* alljoynIntf = bus.GetInterface(org::alljoyn::Bus::InterfaceName);
     if (!alljoynIntf) {
@@ -247,6 +336,8 @@ QStatus AllJoynObj::Stop()
     /* Stop any outstanding JoinSessionThreads */
     joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     isStopping = true;
+    joinRequests.clear();
+    attachRequests.clear();
     vector<JoinSessionThread*>::iterator it = joinSessionThreads.begin();
     while (it != joinSessionThreads.end()) {
         (*it)->Stop();
@@ -366,7 +457,7 @@ void AllJoynObj::BindSessionPort(const InterfaceDescription::Member* member, Mes
 
     if (replyCode == ALLJOYN_BINDSESSIONPORT_REPLY_SUCCESS) {
         /* Assign or check uniqueness of sessionPort */
-        AcquireLocks();
+        AcquireSessionMapLock();
         if (sessionPort == SESSION_PORT_ANY) {
             sessionPort = 9999;
             while (++sessionPort) {
@@ -407,7 +498,7 @@ void AllJoynObj::BindSessionPort(const InterfaceDescription::Member* member, Mes
             entry.id = 0;
             SessionMapInsert(entry);
         }
-        ReleaseLocks();
+        ReleaseSessionMapLock();
     }
 
     /* Reply to request */
@@ -437,7 +528,7 @@ void AllJoynObj::UnbindSessionPort(const InterfaceDescription::Member* member, M
 
     /* Remove session map entry */
     String sender = msg->GetSender();
-    AcquireLocks();
+    AcquireSessionMapLock();
     SessionMapType::iterator it = SessionMapLowerBound(sender, 0);
     while ((it != sessionMap.end()) && (it->first.first == sender) && (it->first.second == 0)) {
         if (it->second.sessionPort == sessionPort) {
@@ -447,7 +538,7 @@ void AllJoynObj::UnbindSessionPort(const InterfaceDescription::Member* member, M
         }
         ++it;
     }
-    ReleaseLocks();
+    ReleaseSessionMapLock();
 
     /* Reply to request */
     MsgArg replyArgs[1];
@@ -463,13 +554,63 @@ void AllJoynObj::UnbindSessionPort(const InterfaceDescription::Member* member, M
 
 ThreadReturn STDCALL AllJoynObj::JoinSessionThread::Run(void* arg)
 {
-    if (isJoin) {
-        QCC_DbgTrace(("JoinSessionThread::RunJoin()"));
-        return RunJoin();
-    } else {
-        QCC_DbgTrace(("JoinSessionThread::RunAttach()"));
-        return RunAttach();
+    deque<Message>& requests = isJoin ? ajObj.joinRequests : ajObj.attachRequests;
+    uint32_t& numThreads = isJoin ? ajObj.numJoinThreads : ajObj.numAttachThreads;
+
+    /*
+     * Handle queued requests until there are none left. A thread coming back from a remote wait
+     * may find the pool was refilled in the meantime, in which case it leaves.
+     */
+    ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+    while (!requests.empty() && !IsStopping() && (numThreads <= ajObj.maxJoinThreads)) {
+        msg = requests.front();
+        requests.pop_front();
+        ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+        if (isJoin) {
+            QCC_DbgTrace(("JoinSessionThread::RunJoin()"));
+            RunJoin();
+        } else {
+            QCC_DbgTrace(("JoinSessionThread::RunAttach()"));
+            RunAttach();
+        }
+        ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+    }
+    /* Requests queued after this point start a new thread */
+    --numThreads;
+    ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    return 0;
+}
+
+void AllJoynObj::JoinSessionThread::BeginRemoteWait()
+{
+    deque<Message>& requests = isJoin ? ajObj.joinRequests : ajObj.attachRequests;
+    uint32_t& numThreads = isJoin ? ajObj.numJoinThreads : ajObj.numAttachThreads;
+    uint32_t& numWaiting = isJoin ? ajObj.numWaitingJoinThreads : ajObj.numWaitingAttachThreads;
+
+    ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+    if (!isWaiting && (numWaiting < ajObj.maxWaitingJoinThreads)) {
+        isWaiting = true;
+        ++numWaiting;
+        --numThreads;
+        if (!requests.empty() && !ajObj.isStopping) {
+            ajObj.StartJoinSessionThread(isJoin);
+        }
+    }
+    ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+}
+
+void AllJoynObj::JoinSessionThread::EndRemoteWait()
+{
+    uint32_t& numThreads = isJoin ? ajObj.numJoinThreads : ajObj.numAttachThreads;
+    uint32_t& numWaiting = isJoin ? ajObj.numWaitingJoinThreads : ajObj.numWaitingAttachThreads;
+
+    ajObj.joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
+    if (isWaiting) {
+        isWaiting = false;
+        --numWaiting;
+        ++numThreads;
     }
+    ajObj.joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
 }
 
 ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
@@ -527,7 +668,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
         }
     }
 
-    ajObj.AcquireLocks();
+    ajObj.AcquireSessionLocks();
 
     /* Do not let a session creator join itself */
     SessionMapType::iterator it = ajObj.SessionMapLowerBound(sender, 0);
@@ -624,13 +765,15 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                     }
 
                     /* Ask creator to accept session */
-                    ajObj.ReleaseLocks();
+                    ajObj.ReleaseSessionLocks();
+                    BeginRemoteWait();
                     status = ajObj.SendAcceptSession(sme.sessionPort, newSessionId, sessionHost, sender.c_str(), optsIn, isAccepted);
+                    EndRemoteWait();
                     if (status != ER_OK) {
                         QCC_LogError(status, ("SendAcceptSession failed"));
                         replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
                     }
-                    ajObj.AcquireLocks();
+                    ajObj.AcquireSessionLocks();
 
                     /* Check the session didn't go away during the join attempt */
                     if (!joinerEp->IsValid()) {
@@ -746,6 +889,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
             if (!b2bEp->IsValid()) {
                 /* Step 1a: If there is a busAddr from advertisement use it to (possibly) create a physical connection */
                 vector<String> busAddrs;
+                ajObj.AcquireDiscoveryLock();
                 multimap<String, NameMapEntry>::iterator nmit = ajObj.nameMap.lower_bound(sessionHost);
                 while (nmit != ajObj.nameMap.end() && (nmit->first == sessionHost)) {
                     if (nmit->second.transport & optsIn.transports) {
@@ -770,13 +914,16 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                         ++ait;
                     }
                 }
-                ajObj.ReleaseLocks();
+                ajObj.ReleaseDiscoveryLock();
+                ajObj.ReleaseSessionLocks();
                 /*
                  * Step 1c: If still no advertisement (busAddr) and we are connected to the sesionHost, then ask it directly
                  * for the busAddr
                  */
                 if (vSessionEp->IsValid() && busAddrs.empty()) {
+                    BeginRemoteWait();
                     status = ajObj.SendGetSessionInfo(sessionHost, sessionPort, optsIn, busAddrs);
+                    EndRemoteWait();
                     if (status != ER_OK) {
                         busAddrs.clear();
                         QCC_LogError(status, ("GetSessionInfo failed"));
@@ -795,7 +942,9 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                                 continue;
                             }
                             BusEndpoint newEp;
+                            BeginRemoteWait();
                             status = trans->Connect(busAddrs[i].c_str(), optsIn, newEp);
+                            EndRemoteWait();
                             if (status == ER_OK) {
                                 b2bEp = RemoteEndpoint::cast(newEp);
                                 if (b2bEp->IsValid()) {
@@ -819,7 +968,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                 if (busAddr.empty()) {
                     replyCode = ALLJOYN_JOINSESSION_REPLY_UNREACHABLE;
                 }
-                ajObj.AcquireLocks();
+                ajObj.AcquireSessionLocks();
             }
 
             /* Step 2: Wait for the new b2b endpoint to have a virtual ep for nextController */
@@ -838,30 +987,32 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                 }
                 /* Otherwise wait */
                 uint64_t now = GetTimestamp64();
-                if (now > (startTime + 30000LL)) {
+                if (now > (startTime + JOIN_SESSION_STEP_TIMEOUT)) {
                     replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
                     QCC_LogError(ER_FAIL, ("JoinSession timed out waiting for %s to appear on %s", sessionHost, b2bEp->GetUniqueName().c_str()));
                     break;
                 }
                 /* Give up the locks while waiting */
-                ajObj.ReleaseLocks();
+                ajObj.ReleaseSessionLocks();
                 qcc::Sleep(10);
-                ajObj.AcquireLocks();
+                ajObj.AcquireSessionLocks();
             }
 
             /* Step 3: Send a session attach */
             if (replyCode == ALLJOYN_JOINSESSION_REPLY_SUCCESS) {
                 const String nextControllerName = b2bEp->GetRemoteName();
-                ajObj.ReleaseLocks();
+                ajObj.ReleaseSessionLocks();
+                BeginRemoteWait();
                 status = ajObj.SendAttachSession(sessionPort, sender.c_str(), sessionHost, sessionHost, b2bEp,
                                                  nextControllerName.c_str(), 0, busAddr.c_str(), optsIn, replyCode,
                                                  id, optsOut, membersArg);
+                EndRemoteWait();
                 if (status != ER_OK) {
                     QCC_LogError(status, ("AttachSession to %s failed", nextControllerName.c_str()));
                     replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
                 }
                 /* Re-acquire locks */
-                ajObj.AcquireLocks();
+                ajObj.AcquireSessionLocks();
                 ajObj.router.FindEndpoint(sessionHost, vSessionEp);
                 if (!vSessionEp->IsValid()) {
                     replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
@@ -906,9 +1057,9 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
             if ((replyCode == ALLJOYN_JOINSESSION_REPLY_SUCCESS) && (optsOut.traffic != SessionOpts::TRAFFIC_MESSAGES)) {
                 SessionMapEntry* smEntry = ajObj.SessionMapFind(sender, id);
                 if (smEntry) {
-                    ajObj.ReleaseLocks();
+                    ajObj.ReleaseSessionLocks();
                     status = ajObj.ShutdownEndpoint(b2bEp, smEntry->fd);
-                    ajObj.AcquireLocks();
+                    ajObj.AcquireSessionLocks();
                     smEntry = ajObj.SessionMapFind(sender, id);
                     if (smEntry) {
                         smEntry->isRawReady = true;
@@ -964,7 +1115,8 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                     SessionOpts tOpts;
                     const String nextControllerName = memberB2BEp->GetRemoteName();
                     uint32_t tReplyCode;
-                    ajObj.ReleaseLocks();
+                    ajObj.ReleaseSessionLocks();
+                    BeginRemoteWait();
                     status = ajObj.SendAttachSession(sessionPort,
                                                      sender.c_str(),
                                                      sessionHost,
@@ -978,7 +1130,8 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                                                      tId,
                                                      tOpts,
                                                      tMembersArg);
-                    ajObj.AcquireLocks();
+                    EndRemoteWait();
+                    ajObj.AcquireSessionLocks();
                     if (status != ER_OK) {
                         QCC_LogError(status, ("Failed to attach session %u to %s", id, member.c_str()));
                     } else if (tReplyCode != ALLJOYN_JOINSESSION_REPLY_SUCCESS) {
@@ -1003,9 +1156,9 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                 }
                 /* Multipoint session member is local to this daemon. Send MPSessionChanged */
                 if (optsOut.isMultipoint) {
-                    ajObj.ReleaseLocks();
+                    ajObj.ReleaseSessionLocks();
                     ajObj.SendMPSessionChanged(id, sender.c_str(), true, member.c_str());
-                    ajObj.AcquireLocks();
+                    ajObj.AcquireSessionLocks();
                 }
             }
             /* Add session routing */
@@ -1017,7 +1170,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
             }
         }
     }
-    ajObj.ReleaseLocks();
+    ajObj.ReleaseSessionLocks();
 
     /* Reply to request */
     MsgArg replyArgs[3];
@@ -1043,12 +1196,12 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
 
     /* Send a series of MPSessionChanged to "catch up" the new joiner */
     if ((replyCode == ALLJOYN_JOINSESSION_REPLY_SUCCESS) && optsOut.isMultipoint) {
-        ajObj.AcquireLocks();
+        ajObj.AcquireSessionLocks();
         SessionMapEntry* smEntry = ajObj.SessionMapFind(sender, id);
         if (smEntry) {
             String sessionHost = smEntry->sessionHost;
             vector<String> memberVector = smEntry->memberNames;
-            ajObj.ReleaseLocks();
+            ajObj.ReleaseSessionLocks();
             ajObj.SendMPSessionChanged(id, sessionHost.c_str(), true, sender.c_str());
             vector<String>::const_iterator mit = memberVector.begin();
             while (mit != memberVector.end()) {
@@ -1058,7 +1211,7 @@ ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunJoin()
                 mit++;
             }
         } else {
-            ajObj.ReleaseLocks();
+            ajObj.ReleaseSessionLocks();
         }
     }
 
@@ -1087,36 +1240,53 @@ void AllJoynObj::JoinSessionThread::ThreadExit(Thread* thread)
     }
 }
 
-void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message& msg)
+void AllJoynObj::QueueJoinSessionRequest(const Message& msg, bool isJoin)
 {
-    /* Handle JoinSession on another thread since JoinThread can block waiting for NameOwnerChanged */
     joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
     if (!isStopping) {
-        JoinSessionThread* jst = new JoinSessionThread(*this, msg, true);
-        QStatus status = jst->Start(NULL, jst);
-        if (status == ER_OK) {
-            joinSessionThreads.push_back(jst);
-        } else {
-            QCC_LogError(status, ("Join: Failed to start JoinSessionThread"));
+        deque<Message>& requests = isJoin ? joinRequests : attachRequests;
+        uint32_t numThreads = isJoin ? numJoinThreads : numAttachThreads;
+        uint32_t numWaiting = isJoin ? numWaitingJoinThreads : numWaitingAttachThreads;
+        requests.push_back(msg);
+        /*
+         * Running threads take the request when they finish their current one, so only start a
+         * new thread while the pool is below its limit.
+         */
+        if (numThreads < maxJoinThreads) {
+            QStatus status = StartJoinSessionThread(isJoin);
+            if ((status != ER_OK) && (numThreads == 0) && (numWaiting == 0)) {
+                /* No thread will ever take the request */
+                requests.pop_back();
+            }
         }
     }
     joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
 }
 
+QStatus AllJoynObj::StartJoinSessionThread(bool isJoin)
+{
+    JoinSessionThread* jst = new JoinSessionThread(*this, isJoin);
+    QStatus status = jst->Start(NULL, jst);
+    if (status == ER_OK) {
+        joinSessionThreads.push_back(jst);
+        ++(isJoin ? numJoinThreads : numAttachThreads);
+    } else {
+        QCC_LogError(status, ("%s: Failed to start JoinSessionThread", isJoin ? "Join" : "Attach"));
+        delete jst;
+    }
+    return status;
+}
+
+void AllJoynObj::JoinSession(const InterfaceDescription::Member* member, Message& msg)
+{
+    /* Handle JoinSession on another thread since JoinThread can block waiting for NameOwnerChanged */
+    QueueJoinSessionRequest(msg, true);
+}
+
 void AllJoynObj::AttachSession(const InterfaceDescription::Member* member, Message& msg)
 {
     /* Handle AttachSession on another thread since AttachSession can block when connecting through an intermediate node */
-    joinSessionThreadsLock.Lock(MUTEX_CONTEXT);
-    if (!isStopping) {
-        JoinSessionThread* jst = new JoinSessionThread(*this, msg, false);
-        QStatus status = jst->Start(NULL, jst);
-        if (status == ER_OK) {
-            joinSessionThreads.push_back(jst);
-        } else {
-            QCC_LogError(status, ("Attach: Failed to start JoinSessionThread"));
-        }
-    }
-    joinSessionThreadsLock.Unlock(MUTEX_CONTEXT);
+    QueueJoinSessionRequest(msg, false);
 }
 
 void AllJoynObj::LeaveSession(const InterfaceDescription::Member* member, Message& msg)
@@ -1134,11 +1304,11 @@ void AllJoynObj::LeaveSession(const InterfaceDescription::Member* member, Messag
     QCC_DbgTrace(("AllJoynObj::LeaveSession(%u)", id));
 
     /* Find the session with that id */
-    AcquireLocks();
+    AcquireSessionLocks();
     SessionMapEntry* smEntry = SessionMapFind(msg->GetSender(), id);
     if (!smEntry || (id == 0)) {
         replyCode = ALLJOYN_LEAVESESSION_REPLY_NO_SESSION;
-        ReleaseLocks();
+        ReleaseSessionLocks();
     } else {
         /* Send DetachSession signal to daemons of all session participants */
         MsgArg detachSessionArgs[2];
@@ -1157,7 +1327,7 @@ void AllJoynObj::LeaveSession(const InterfaceDescription::Member* member, Messag
         }
 
         /* Locks must be released before calling RemoveSessionRefs since that method calls out to user (SessionLost) */
-        ReleaseLocks();
+        ReleaseSessionLocks();
 
         /* Remove entries from sessionMap, but dont send a SessionLost back to the caller of this method. */
         RemoveSessionRefs(msg->GetSender(), id, false);
@@ -1197,7 +1367,7 @@ void AllJoynObj::RemoveSessionMember(const InterfaceDescription::Member* member,
 
     QCC_DbgPrintf(("AllJoynObj::RemoveSessionMember(%u, %s)", id, sessionMemberName));
 
-    AcquireLocks();
+    AcquireSessionLocks();
     if (replyCode == ALLJOYN_REMOVESESSIONMEMBER_REPLY_SUCCESS) {
         /* Find the session with the sender and specified session id */
         SessionMapEntry* smEntry = SessionMapFind(msg->GetSender(), id);
@@ -1259,7 +1429,7 @@ void AllJoynObj::RemoveSessionMember(const InterfaceDescription::Member* member,
         }
 
         /* Locks must be released before calling RemoveSessionRefs since that method calls out to user (SessionLost) */
-        ReleaseLocks();
+        ReleaseSessionLocks();
 
         /* Remove entries from sessionMap, send a SessionLost to the session member being removed. */
         RemoveSessionRefs(sessionMemberName, id, true);
@@ -1268,7 +1438,7 @@ void AllJoynObj::RemoveSessionMember(const InterfaceDescription::Member* member,
         router.RemoveSessionRoutes(sessionMemberName, id);
 
     } else {
-        ReleaseLocks();
+        ReleaseSessionLocks();
     }
 
     /* Reply to request */
@@ -1298,14 +1468,14 @@ void AllJoynObj::GetHostIp(const InterfaceDescription::Member* member, Message&
 
     String ipAddrStr = "";
     /* Find the session with that id */
-    AcquireLocks();
+    AcquireSessionLocks();
     SessionMapEntry* smEntry = SessionMapFind(msg->GetSender(), id);
     if (!smEntry || (id == 0)) {
         replyCode = ALLJOYN_GETHOSTIP_REPLY_NO_SESSION;
-        ReleaseLocks();
+        ReleaseSessionLocks();
     } else if (smEntry->sessionHost == msg->GetSender()) {
         replyCode = ALLJOYN_GETHOSTIP_REPLY_IS_BINDER;
-        ReleaseLocks();
+        ReleaseSessionLocks();
     } else {
         /* get the vep to the sessionhost.
          */
@@ -1321,7 +1491,7 @@ void AllJoynObj::GetHostIp(const InterfaceDescription::Member* member, Message&
             replyCode = ALLJOYN_GETHOSTIP_REPLY_FAILED;
         }
 
-        ReleaseLocks();
+        ReleaseSessionLocks();
     }
     const char* ipAddr = ipAddrStr.c_str();
     /* Reply to request */
@@ -1379,7 +1549,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
     if (status != ER_OK) {
         QCC_DbgTrace(("AllJoynObj::AttachSession(<bad args>)"));
         replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
-        ajObj.AcquireLocks();
+        ajObj.AcquireSessionLocks();
     } else {
         srcStr = src;
         destStr = dest;
@@ -1387,7 +1557,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
         QCC_DbgTrace(("AllJoynObj::AttachSession(%d, %s, %s, %s, %s, %s, <%x, %x, %x>)", sessionPort, src, sessionHost,
                       dest, srcB2B, busAddr, optsIn.traffic, optsIn.proximity, optsIn.transports));
 
-        ajObj.AcquireLocks();
+        ajObj.AcquireSessionLocks();
         /*
          * If there is an outstanding join involving (sessionHost,port), then destEp may not be valid yet.
          * Essentially, someone else might know we are a multipoint session member before we do.
@@ -1395,9 +1565,9 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
         BusEndpoint destEp = ajObj.router.FindEndpoint(destStr);
         if ((destEp->GetEndpointType() != ENDPOINT_TYPE_REMOTE) && (destEp->GetEndpointType() != ENDPOINT_TYPE_NULL) && (destEp->GetEndpointType() != ENDPOINT_TYPE_LOCAL)) {
             /* Release locks while waiting */
-            ajObj.ReleaseLocks();
+            ajObj.ReleaseSessionLocks();
             qcc::Sleep(500);
-            ajObj.AcquireLocks();
+            ajObj.AcquireSessionLocks();
             destEp = ajObj.router.FindEndpoint(destStr);
         }
 
@@ -1467,9 +1637,9 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 optsOut.transports &= optsIn.transports;
 
                 /* Add virtual endpoint (AddVirtualEndpoint cannot be called with locks) */
-                ajObj.ReleaseLocks();
+                ajObj.ReleaseSessionLocks();
                 ajObj.AddVirtualEndpoint(srcStr, srcB2BStr);
-                ajObj.AcquireLocks();
+                ajObj.AcquireSessionLocks();
                 BusEndpoint tempEp = ajObj.router.FindEndpoint(srcStr);
                 VirtualEndpoint srcEp = VirtualEndpoint::cast(tempEp);
                 tempEp = ajObj.router.FindEndpoint(srcB2BStr);
@@ -1488,8 +1658,10 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                     BusEndpoint creatorEp = ajObj.router.FindEndpoint(sme.sessionHost);
 
                     if (creatorEp->IsValid() && (destEp == creatorEp)) {
-                        ajObj.ReleaseLocks();
+                        ajObj.ReleaseSessionLocks();
+                        BeginRemoteWait();
                         status = ajObj.SendAcceptSession(sme.sessionPort, sme.id, dest, src, optsIn, isAccepted);
+                        EndRemoteWait();
 
                         if (ER_OK != status) {
                             replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
@@ -1499,7 +1671,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                         ajObj.AddVirtualEndpoint(srcStr, srcB2BStr);
 
                         /* Re-lock and re-acquire */
-                        ajObj.AcquireLocks();
+                        ajObj.AcquireSessionLocks();
                         if (!destEp->IsValid() || !srcEp->IsValid()) {
                             QCC_LogError(ER_FAIL, ("%s (%s) disappeared during JoinSession", !destEp->IsValid() ? "destEp" : "srcB2BEp", !destEp->IsValid() ? destStr.c_str() : srcB2BStr.c_str()));
                             replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
@@ -1566,10 +1738,12 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 if (trans == NULL) {
                     replyCode = ALLJOYN_JOINSESSION_REPLY_UNREACHABLE;
                 } else {
-                    ajObj.ReleaseLocks();
+                    ajObj.ReleaseSessionLocks();
                     BusEndpoint ep;
+                    BeginRemoteWait();
                     status = trans->Connect(busAddr, optsIn, ep);
-                    ajObj.AcquireLocks();
+                    EndRemoteWait();
+                    ajObj.AcquireSessionLocks();
                     if (status == ER_OK) {
                         b2bEp = RemoteEndpoint::cast(ep);
                         if (b2bEp->IsValid()) {
@@ -1591,10 +1765,12 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 const String nextControllerName = b2bEp->GetRemoteName();
 
                 /* Send AttachSession */
-                ajObj.ReleaseLocks();
+                ajObj.ReleaseSessionLocks();
+                BeginRemoteWait();
                 status = ajObj.SendAttachSession(sessionPort, src, sessionHost, dest, b2bEp, nextControllerName.c_str(),
                                                  msg->GetSessionId(), busAddr, optsIn, replyCode, tempId, tempOpts, replyArgs[3]);
-                ajObj.AcquireLocks();
+                EndRemoteWait();
+                ajObj.AcquireSessionLocks();
 
                 /* If successful, add bi-directional session routes */
                 if ((status == ER_OK) && (replyCode == ALLJOYN_JOINSESSION_REPLY_SUCCESS)) {
@@ -1614,24 +1790,24 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                         }
                         /* Otherwise wait */
                         uint64_t now = GetTimestamp64();
-                        if (now > (startTime + 30000LL)) {
+                        if (now > (startTime + JOIN_SESSION_STEP_TIMEOUT)) {
                             replyCode = ALLJOYN_JOINSESSION_REPLY_FAILED;
                             QCC_LogError(ER_FAIL, ("AttachSession timed out waiting for destination to appear"));
                             break;
                         } else {
                             /* Give up the locks while waiting */
-                            ajObj.ReleaseLocks();
+                            ajObj.ReleaseSessionLocks();
                             qcc::Sleep(10);
-                            ajObj.AcquireLocks();
+                            ajObj.AcquireSessionLocks();
                         }
                     }
 
                     /* Add virtual endpoint */
-                    ajObj.ReleaseLocks();
+                    ajObj.ReleaseSessionLocks();
                     ajObj.AddVirtualEndpoint(srcStr, srcB2BStr);
 
                     /* Relock and reacquire */
-                    ajObj.AcquireLocks();
+                    ajObj.AcquireSessionLocks();
                     BusEndpoint tempEp = ajObj.router.FindEndpoint(srcStr);
                     VirtualEndpoint srcEp = VirtualEndpoint::cast(tempEp);
                     tempEp = ajObj.router.FindEndpoint(srcB2BStr);
@@ -1678,20 +1854,20 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
     BusEndpoint tempEp = ajObj.router.FindEndpoint(srcB2BStr);
     srcB2BEp = RemoteEndpoint::cast(tempEp);
     if (srcB2BEp->IsValid()) {
-        ajObj.ReleaseLocks();
+        ajObj.ReleaseSessionLocks();
         status = msg->ReplyMsg(msg, replyArgs, ArraySize(replyArgs));
         if (status == ER_OK) {
             status = srcB2BEp->PushMessage(msg);
         }
     } else {
-        ajObj.ReleaseLocks();
+        ajObj.ReleaseSessionLocks();
         status = ajObj.MethodReply(msg, replyArgs, ArraySize(replyArgs));
     }
     /* Send SessionJoined to creator */
     if (sendSessionJoined) {
         ajObj.SendSessionJoined(sme.sessionPort, sme.id, srcStr.c_str(), sme.endpointName.c_str());
     }
-    ajObj.AcquireLocks();
+    ajObj.AcquireSessionLocks();
 
     /* Log error if reply could not be sent */
     if (ER_OK != status) {
@@ -1706,10 +1882,10 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
                 SessionMapEntry* smEntry = ajObj.SessionMapFind(creatorName, id);
                 if (smEntry) {
                     if (smEntry->streamingEp->IsValid()) {
-                        ajObj.ReleaseLocks();
+                        ajObj.ReleaseSessionLocks();
                         status = ajObj.ShutdownEndpoint(smEntry->streamingEp, smEntry->fd);
 
-                        ajObj.AcquireLocks();
+                        ajObj.AcquireSessionLocks();
                         smEntry = ajObj.SessionMapFind(creatorName, id);
                         if (smEntry) {
                             if (status != ER_OK) {
@@ -1728,11 +1904,11 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
             /* Indirect raw route (middle-man). Create a pump to copy raw data between endpoints */
             QStatus tStatus;
             SocketFd srcB2bFd, b2bFd;
-            ajObj.ReleaseLocks();
+            ajObj.ReleaseSessionLocks();
             status = ajObj.ShutdownEndpoint(srcB2BEp, srcB2bFd);
             tStatus = ajObj.ShutdownEndpoint(b2bEp, b2bFd);
 
-            ajObj.AcquireLocks();
+            ajObj.AcquireSessionLocks();
             status = (status == ER_OK) ? tStatus : status;
             if (status == ER_OK) {
                 SocketStream* ss1 = new SocketStream(srcB2bFd);
@@ -1765,7 +1941,7 @@ qcc::ThreadReturn STDCALL AllJoynObj::JoinSessionThread::RunAttach()
         }
     }
 
-    ajObj.ReleaseLocks();
+    ajObj.ReleaseSessionLocks();
 
     /* Send SessionChanged if multipoint */
     if ((replyCode == ALLJOYN_JOINSESSION_REPLY_SUCCESS) && optsOut.isMultipoint && (id != 0) && destIsLocal) {
@@ -1781,21 +1957,21 @@ void AllJoynObj::SetAdvNameAlias(const String& guid, const TransportMask mask, c
 {
     QCC_DbgTrace(("AllJoynObj::SetAdvNameAlias(%s, 0x%x, %s)", guid.c_str(), mask, advName.c_str()));
 
-    AcquireLocks();
+    AcquireDiscoveryLock();
     advAliasMap.insert(pair<String, pair<String, TransportMask> >(guid, pair<String, TransportMask>(advName, mask)));
-    ReleaseLocks();
+    ReleaseDiscoveryLock();
 }
 
 void AllJoynObj::RemoveSessionRefs(const char* epName, SessionId id, bool sendSessionLost)
 {
     QCC_DbgTrace(("AllJoynObj::RemoveSessionRefs(%s, %u, %u)", epName, id, sendSessionLost));
 
-    AcquireLocks();
+    AcquireSessionLocks();
 
     BusEndpoint endpoint = router.FindEndpoint(epName);
 
     if (!endpoint->IsValid()) {
-        ReleaseLocks();
+        ReleaseSessionLocks();
         return;
     }
 
@@ -1870,7 +2046,7 @@ void AllJoynObj::RemoveSessionRefs(const char* epName, SessionId id, bool sendSe
             ++it;
         }
     }
-    ReleaseLocks();
+    ReleaseSessionLocks();
 
     /* Send MPSessionChanged for each changed session involving alias */
     vector<pair<String, SessionId> >::const_iterator csit = changedSessionMembers.begin();
@@ -1901,17 +2077,17 @@ void AllJoynObj::RemoveSessionRefs(const String& vepName, const String& b2bEpNam
     VirtualEndpoint vep;
     RemoteEndpoint b2bEp;
 
-    AcquireLocks();
+    AcquireSessionLocks();
     QStatus disconnectReason = b2bEp->GetDisconnectStatus();
 
     if (!router.FindEndpoint(vepName, vep)) {
         QCC_LogError(ER_FAIL, ("Virtual endpoint %s disappeared during RemoveSessionRefs", vepName.c_str()));
-        ReleaseLocks();
+        ReleaseSessionLocks();
         return;
     }
     if (!router.FindEndpoint(b2bEpName, b2bEp)) {
         QCC_LogError(ER_FAIL, ("B2B endpoint %s disappeared during RemoveSessionRefs", b2bEpName.c_str()));
-        ReleaseLocks();
+        ReleaseSessionLocks();
         return;
     }
 
@@ -1970,7 +2146,7 @@ void AllJoynObj::RemoveSessionRefs(const String& vepName, const String& b2bEpNam
             ++it;
         }
     }
-    ReleaseLocks();
+    ReleaseSessionLocks();
 
     /* Send MPSessionChanged for each changed session involving alias */
     vector<pair<String, SessionId> >::const_iterator csit = changedSessionMembers.begin();
@@ -2082,7 +2258,7 @@ QStatus AllJoynObj::SendAttachSession(SessionPort sessionPort,
                                           attachArgs,
                                           ArraySize(attachArgs),
                                           reply,
-                                          30000);
+                                          JOIN_SESSION_STEP_TIMEOUT);
     }
 
     if (status != ER_OK) {
@@ -2162,7 +2338,8 @@ QStatus AllJoynObj::SendAcceptSession(SessionPort sessionPort,
                                         "AcceptSession",
                                         acceptArgs,
                                         ArraySize(acceptArgs),
-                                        reply);
+                                        reply,
+                                        JOIN_SESSION_STEP_TIMEOUT);
     if (status == ER_OK) {
         size_t na;
         const MsgArg* replyArgs;
@@ -2179,12 +2356,12 @@ void AllJoynObj::SendSessionLost(const SessionMapEntry& sme, QStatus reason)
     /* Send SessionLost to the endpoint mentioned in sme */
     Message sigMsg(bus);
 
-    AcquireLocks();
+    AcquireSessionLocks();
     BusEndpoint ep = router.FindEndpoint(sme.endpointName);
 
 
     if (ep->GetEndpointType() == ENDPOINT_TYPE_REMOTE && RemoteEndpoint::cast(ep)->GetRemoteProtocolVersion() < 7) {
-        ReleaseLocks();
+        ReleaseSessionLocks();
         /* For older clients i.e. protocol version < 7, emit SessionLost(u) signal */
         MsgArg args[1];
         args[0].Set("u", sme.id);
@@ -2194,7 +2371,7 @@ void AllJoynObj::SendSessionLost(const SessionMapEntry& sme, QStatus reason)
             QCC_LogError(status, ("Failed to send SessionLost(%d) to %s", sme.id, sme.endpointName.c_str()));
         }
     } else {
-        ReleaseLocks();
+        ReleaseSessionLocks();
         /* For newer clients i.e. protocol version >= 7, emit SessionLostWithReason(uu) signal */
         MsgArg args[2];
         args[0].Set("u", sme.id);
@@ -2360,14 +2537,14 @@ void AllJoynObj::GetSessionFd(const InterfaceDescription::Member* member, Messag
     QCC_DbgTrace(("AllJoynObj::GetSessionFd(%u)", id));
 
     /* Wait for any join related operations to complete before returning fd */
-    AcquireLocks();
+    AcquireSessionLocks();
     SessionMapEntry* smEntry = SessionMapFind(msg->GetSender(), id);
     if (smEntry && (smEntry->opts.traffic != SessionOpts::TRAFFIC_MESSAGES)) {
         uint64_t ts = GetTimestamp64();
         while (smEntry && !smEntry->isRawReady && ((ts + 5000LL) > GetTimestamp64())) {
-            ReleaseLocks();
+            ReleaseSessionLocks();
             qcc::Sleep(5);
-            AcquireLocks();
+            AcquireSessionLocks();
             smEntry = SessionMapFind(msg->GetSender(), id);
         }
         /* sessionMap entry removal was delayed waiting for sockFd to become available. Delete it now. */
@@ -2376,7 +2553,7 @@ void AllJoynObj::GetSessionFd(const InterfaceDescription::Member* member, Messag
             SessionMapErase(*smEntry);
         }
     }
-    ReleaseLocks();
+    ReleaseSessionLocks();
 
     if (sockFd != -1) {
         /* Send the fd and transfer ownership */
@@ -2437,7 +2614,7 @@ void AllJoynObj::SetLinkTimeout(const InterfaceDescription::Member* member, Mess
     QStatus status = ER_OK;
 
     /* Set the link timeout on all endpoints that are involved in this session */
-    AcquireLocks();
+    AcquireSessionLocks();
     SessionMapType::iterator it = SessionMapLowerBound(msg->GetSender(), id);
 
     while ((it != sessionMap.end()) && (it->first.first == msg->GetSender()) && (it->first.second == id)) {
@@ -2468,7 +2645,7 @@ void AllJoynObj::SetLinkTimeout(const InterfaceDescription::Member* member, Mess
         }
         ++it;
     }
-    ReleaseLocks();
+    ReleaseSessionLocks();
 
     /* Set disposition */
     if (status == ER_ALLJOYN_SETLINKTIMEOUT_REPLY_NO_DEST_SUPPORT) {
@@ -2650,7 +2827,7 @@ void AllJoynObj::AdvertiseName(const InterfaceDescription::Member* member, Messa
                 } else {
                     it->second.first |= transports;
                 }
-                stateLock.Lock(MUTEX_CONTEXT);
+                AcquireStateLock();
                 ReleaseLocks();
 
                 /* Advertise on transports specified */
@@ -2667,7 +2844,7 @@ void AllJoynObj::AdvertiseName(const InterfaceDescription::Member* member, Messa
                         QCC_LogError(ER_BUS_TRANSPORT_NOT_AVAILABLE, ("NULL transport pointer found in transportList"));
                     }
                 }
-                stateLock.Unlock(MUTEX_CONTEXT);
+                ReleaseStateLock();
 
             } else {
                 ReleaseLocks();
@@ -2773,7 +2950,7 @@ QStatus AllJoynObj::ProcCancelAdvertise(const qcc::String& sender, const qcc::St
         cancelMask &= origMask;
     }
 
-    stateLock.Lock(MUTEX_CONTEXT);
+    AcquireStateLock();
     ReleaseLocks();
 
     /* Cancel transport advertisement if no other refs exist */
@@ -2791,7 +2968,7 @@ QStatus AllJoynObj::ProcCancelAdvertise(const qcc::String& sender, const qcc::St
     } else if (!foundAdvert) {
         status = ER_FAIL;
     }
-    stateLock.Unlock(MUTEX_CONTEXT);
+    ReleaseStateLock();
 
     /* Remove advertisement from local nameMap so local discoverers are notified of advertisement going away */
     if ((status == ER_OK) && (transports & TRANSPORT_LOCAL)) {
@@ -2859,8 +3036,16 @@ void AllJoynObj::ProcFindAdvertisedName(Message& msg, bool isAnyTrans)
         status = TransportPermission::FilterTransports(srcEp, sender, transports, "AllJoynObj::FindAdvertisedName");
     }
 
+    /*
+     * The discover map is protected by discoveryLock. stateLock is held until the transports
+     * have been called so that discovery is enabled in the same order the map is updated.
+     */
+    AcquireStateLock();
+    ReleaseLocks();
+
     if (ALLJOYN_FINDADVERTISEDNAME_REPLY_SUCCESS == replyCode) {
         /* Check to see if this endpoint is already discovering this prefix */
+        AcquireDiscoveryLock();
         bool foundEntry = false;
         multimap<qcc::String, pair<TransportMask, qcc::String> >::iterator it = discoverMap.lower_bound(namePrefix);
         while ((it != discoverMap.end()) && (it->first == namePrefix)) {
@@ -2880,12 +3065,11 @@ void AllJoynObj::ProcFindAdvertisedName(Message& msg, bool isAnyTrans)
         if (!foundEntry) {
             discoverMap.insert(std::make_pair(namePrefix, std::make_pair(transports, sender)));
         }
+        ReleaseDiscoveryLock();
     }
     /* Find out the transports on which discovery needs to be enabled for this name.
      * i.e. The ones that are set in the requested transport mask and not set in the origMask.
      */
-    stateLock.Lock(MUTEX_CONTEXT);
-    ReleaseLocks();
     enableMask = transports & ~origMask;
     if (ALLJOYN_FINDADVERTISEDNAME_REPLY_SUCCESS == replyCode) {
         /* Find name on all remote transports */
@@ -2899,7 +3083,7 @@ void AllJoynObj::ProcFindAdvertisedName(Message& msg, bool isAnyTrans)
             }
         }
     }
-    stateLock.Unlock(MUTEX_CONTEXT);
+    ReleaseStateLock();
 
     /* Reply to request */
     MsgArg replyArg("u", replyCode);
@@ -2913,7 +3097,7 @@ void AllJoynObj::ProcFindAdvertisedName(Message& msg, bool isAnyTrans)
 
     /* Send FoundAdvertisedName signals if there are existing matches for namePrefix */
     if (ALLJOYN_FINDADVERTISEDNAME_REPLY_SUCCESS == replyCode) {
-        AcquireLocks();
+        AcquireDiscoveryLock();
         multimap<String, NameMapEntry>::iterator it = nameMap.lower_bound(namePrefix);
         set<pair<String, TransportMask> > sentSet;
         while ((it != nameMap.end()) && (0 == strncmp(it->first.c_str(), namePrefix.c_str(), namePrefix.size()))) {
@@ -2925,9 +3109,9 @@ void AllJoynObj::ProcFindAdvertisedName(Message& msg, bool isAnyTrans)
             if (sentSet.find(sentSetEntry) == sentSet.end()) {
                 String foundName = it->first;
                 NameMapEntry nme = it->second;
-                ReleaseLocks();
+                ReleaseDiscoveryLock();
                 status = SendFoundAdvertisedName(sender, foundName, nme.transport, namePrefix);
-                AcquireLocks();
+                AcquireDiscoveryLock();
                 it = nameMap.lower_bound(namePrefix);
                 sentSet.insert(sentSetEntry);
                 if (ER_OK != status) {
@@ -2937,7 +3121,7 @@ void AllJoynObj::ProcFindAdvertisedName(Message& msg, bool isAnyTrans)
                 ++it;
             }
         }
-        ReleaseLocks();
+        ReleaseDiscoveryLock();
     }
 }
 
@@ -2992,7 +3176,8 @@ QStatus AllJoynObj::ProcCancelFindName(const qcc::String& sender, const qcc::Str
 {
     QCC_DbgTrace(("AllJoynObj::ProcCancelFindName(sender = %s, namePrefix = %s, transports = %d)", sender.c_str(), namePrefix.c_str(), transports));
     QStatus status = ER_OK;
-    AcquireLocks();
+    AcquireStateLock();
+    AcquireDiscoveryLock();
     bool foundFinder = false;
     TransportMask refMask = 0;
     TransportMask origMask = 0;
@@ -3016,9 +3201,7 @@ QStatus AllJoynObj::ProcCancelFindName(const qcc::String& sender, const qcc::Str
     if (foundFinder) {
         cancelMask &= origMask;
     }
-
-    stateLock.Lock(MUTEX_CONTEXT);
-    ReleaseLocks();
+    ReleaseDiscoveryLock();
 
     /* Disable discovery if certain transports are no longer referenced for the name prefix */
     if (foundFinder && cancelMask) {
@@ -3032,7 +3215,7 @@ QStatus AllJoynObj::ProcCancelFindName(const qcc::String& sender, const qcc::Str
     } else if (!foundFinder) {
         status = ER_FAIL;
     }
-    stateLock.Unlock(MUTEX_CONTEXT);
+    ReleaseStateLock();
     return status;
 }
 
@@ -3043,9 +3226,9 @@ QStatus AllJoynObj::AddBusToBusEndpoint(RemoteEndpoint& endpoint)
     const qcc::String& shortGuidStr = endpoint->GetRemoteGUID().ToShortString();
 
     /* Add b2b endpoint */
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     b2bEndpoints[endpoint->GetUniqueName()] = endpoint;
-    ReleaseLocks();
+    ReleaseVirtualEndpointsLock();
 
     /* Create a virtual endpoint for talking to the remote bus control object */
     /* This endpoint will also carry broadcast messages for the remote bus */
@@ -3062,10 +3245,10 @@ void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
 {
     QCC_DbgTrace(("AllJoynObj::RemoveBusToBusEndpoint(%s)", endpoint->GetUniqueName().c_str()));
 
-    /* Be careful to lock the name table before locking the virtual endpoints since both locks are needed
+    /* Be careful to lock virtualEndpointsLock before locking the virtual endpoints since both locks are needed
      * and doing it in the opposite order invites deadlock
      */
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     String b2bEpName = endpoint->GetUniqueName();
 
     /* Remove the B2B endpoint before removing virtual endpoints to ensure
@@ -3092,9 +3275,9 @@ void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
          * This call must be made without holding locks since it can trigger LostSession callback
          */
 
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
         RemoveSessionRefs(vepName, b2bEpName);
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         it = virtualEndpoints.find(vepName);
         if (it == virtualEndpoints.end()) {
             /* If the virtual endpoint was lost, continue to the next virtual endpoint */
@@ -3132,12 +3315,12 @@ void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
                         String key = it->first;
                         String key2 = it2->first.c_str();
                         RemoteEndpoint ep = it2->second;
-                        ReleaseLocks();
+                        ReleaseVirtualEndpointsLock();
                         status = ep->PushMessage(sigMsg);
                         if (ER_OK != status) {
                             QCC_LogError(status, ("Failed to send NameChanged to %s", ep->GetUniqueName().c_str()));
                         }
-                        AcquireLocks();
+                        AcquireVirtualEndpointsLock();
                         it2 = b2bEndpoints.lower_bound(key2);
                         if ((it2 != b2bEndpoints.end()) && (it2->first == key2)) {
                             ++it2;
@@ -3154,9 +3337,9 @@ void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
             /* Remove virtual endpoint with no more b2b eps */
             if (it != virtualEndpoints.end()) {
                 String vepName = it->first;
-                ReleaseLocks();
+                ReleaseVirtualEndpointsLock();
                 RemoveVirtualEndpoint(vepName);
-                AcquireLocks();
+                AcquireVirtualEndpointsLock();
                 it = virtualEndpoints.upper_bound(vepName);
             }
 
@@ -3165,7 +3348,7 @@ void AllJoynObj::RemoveBusToBusEndpoint(RemoteEndpoint& endpoint)
         }
     }
 
-    ReleaseLocks();
+    ReleaseVirtualEndpointsLock();
 }
 
 QStatus AllJoynObj::ExchangeNames(RemoteEndpoint& endpoint)
@@ -3176,7 +3359,7 @@ QStatus AllJoynObj::ExchangeNames(RemoteEndpoint& endpoint)
     QStatus status;
 
     /* Send local name table info to remote bus controller */
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     router.GetUniqueNamesAndAliases(names);
 
     MsgArg argArray(ALLJOYN_ARRAY);
@@ -3224,15 +3407,15 @@ QStatus AllJoynObj::ExchangeNames(RemoteEndpoint& endpoint)
                                         0,
                                         0);
         if (ER_OK == status) {
-            ReleaseLocks();
+            ReleaseVirtualEndpointsLock();
             status = endpoint->PushMessage(exchangeMsg);
-            AcquireLocks();
+            AcquireVirtualEndpointsLock();
         }
     }
     if (status != ER_OK) {
         QCC_LogError(status, ("Failed to send ExchangeName signal"));
     }
-    ReleaseLocks();
+    ReleaseVirtualEndpointsLock();
 
     /*
      * This will also free the inner MsgArgs.
@@ -3254,10 +3437,10 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
     const String& shortGuidStr = guid.ToShortString();
 
     /* Create a virtual endpoint for each unique name in args */
-    /* Be careful to lock the name table before locking the virtual endpoints since both locks are needed
+    /* Be careful to lock virtualEndpointsLock before locking the virtual endpoints since both locks are needed
      * and doing it in the opposite order invites deadlock
      */
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     map<qcc::StringMapKey, RemoteEndpoint>::iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
     const size_t numItems = args[0].v_array.GetNumElements();
     if (bit != b2bEndpoints.end()) {
@@ -3280,11 +3463,11 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
                     /* Add a virtual endpoint */
                     bool madeChange;
                     String b2bName = bit->second->GetUniqueName();
-                    ReleaseLocks();
+                    ReleaseVirtualEndpointsLock();
                     AddVirtualEndpoint(uniqueName, b2bName, &madeChange);
 
                     /* Relock and reacquire */
-                    AcquireLocks();
+                    AcquireVirtualEndpointsLock();
                     BusEndpoint tempEp = router.FindEndpoint(uniqueName);
                     VirtualEndpoint vep = VirtualEndpoint::cast(tempEp);
                     bit = b2bEndpoints.find(key);
@@ -3303,9 +3486,9 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
                     for (size_t j = 0; j < numAliases; ++j) {
                         assert(ALLJOYN_STRING == aliasItems[j].typeId);
                         if (vep->IsValid()) {
-                            ReleaseLocks();
+                            ReleaseVirtualEndpointsLock();
                             bool madeChange = router.SetVirtualAlias(aliasItems[j].v_string.str, &vep, vep);
-                            AcquireLocks();
+                            AcquireVirtualEndpointsLock();
                             bit = b2bEndpoints.find(key);
                             if (bit == b2bEndpoints.end()) {
                                 QCC_DbgPrintf(("b2bEp %s disappeared during ExchangeNamesSignalHandler", key.c_str()));
@@ -3330,13 +3513,13 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
     } else {
         QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find b2b endpoint %s", msg->GetRcvEndpointName()));
     }
-    ReleaseLocks();
+    ReleaseVirtualEndpointsLock();
 
     /* If there were changes, forward message to all directly connected controllers except the one that
      * sent us this ExchangeNames
      */
     if (madeChanges) {
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         map<qcc::StringMapKey, RemoteEndpoint>::const_iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
         map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
         while (it != b2bEndpoints.end()) {
@@ -3344,12 +3527,12 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
                 QCC_DbgPrintf(("Propagating ExchangeName signal to %s", it->second->GetUniqueName().c_str()));
                 StringMapKey key = it->first;
                 RemoteEndpoint ep = it->second;
-                ReleaseLocks();
+                ReleaseVirtualEndpointsLock();
                 QStatus status = ep->PushMessage(msg);
                 if (ER_OK != status) {
                     QCC_LogError(status, ("Failed to forward ExchangeNames to %s", ep->GetUniqueName().c_str()));
                 }
-                AcquireLocks();
+                AcquireVirtualEndpointsLock();
                 bit = b2bEndpoints.find(msg->GetRcvEndpointName());
                 it = b2bEndpoints.lower_bound(key);
                 if ((it != b2bEndpoints.end()) && (it->first == key)) {
@@ -3359,7 +3542,7 @@ void AllJoynObj::ExchangeNamesSignalHandler(const InterfaceDescription::Member*
                 ++it;
             }
         }
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
     }
 }
 
@@ -3388,7 +3571,7 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
     }
 
     if (alias[0] == ':') {
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         map<qcc::StringMapKey, RemoteEndpoint>::iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
         if (bit != b2bEndpoints.end()) {
             /* Change affects a remote unique name (i.e. a VirtualEndpoint) */
@@ -3399,50 +3582,50 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
                     if (madeChanges && vep->RemoveBusToBusEndpoint(bit->second)) {
                         /* The last b2b endpoint was removed from this vep. */
                         String vepName = vep->GetUniqueName();
-                        ReleaseLocks();
+                        ReleaseVirtualEndpointsLock();
                         RemoveVirtualEndpoint(vepName);
                     } else {
-                        ReleaseLocks();
+                        ReleaseVirtualEndpointsLock();
                     }
                 } else {
-                    ReleaseLocks();
+                    ReleaseVirtualEndpointsLock();
                 }
             } else {
                 /* Add a new virtual endpoint */
                 if (bit != b2bEndpoints.end()) {
                     String b2bEpName = bit->second->GetUniqueName();
-                    ReleaseLocks();
+                    ReleaseVirtualEndpointsLock();
                     AddVirtualEndpoint(alias, b2bEpName, &madeChanges);
                 } else {
-                    ReleaseLocks();
+                    ReleaseVirtualEndpointsLock();
                 }
             }
         } else {
-            ReleaseLocks();
+            ReleaseVirtualEndpointsLock();
             QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find bus-to-bus endpoint %s", msg->GetRcvEndpointName()));
         }
     } else {
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         /* Change affects a well-known name (name table only) */
         VirtualEndpoint remoteController = FindVirtualEndpoint(msg->GetSender());
         if (remoteController->IsValid()) {
-            ReleaseLocks();
+            ReleaseVirtualEndpointsLock();
             if (newOwner.empty()) {
                 madeChanges = router.SetVirtualAlias(alias, NULL, remoteController);
             } else {
                 VirtualEndpoint newOwnerEp = FindVirtualEndpoint(newOwner.c_str());
                 madeChanges = router.SetVirtualAlias(alias, &newOwnerEp, remoteController);
             }
-            AcquireLocks();
+            AcquireVirtualEndpointsLock();
         } else {
             QCC_LogError(ER_BUS_NO_ENDPOINT, ("Cannot find virtual endpoint %s", msg->GetSender()));
         }
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
     }
 
     if (madeChanges) {
         /* Forward message to all directly connected controllers except the one that sent us this NameChanged */
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         map<qcc::StringMapKey, RemoteEndpoint>::const_iterator bit = b2bEndpoints.find(msg->GetRcvEndpointName());
         map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
         while (it != b2bEndpoints.end()) {
@@ -3450,12 +3633,12 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
                 QCC_DbgPrintf(("Propagating NameChanged signal to %s", it->second->GetUniqueName().c_str()));
                 String key = it->first.c_str();
                 RemoteEndpoint ep = it->second;
-                ReleaseLocks();
+                ReleaseVirtualEndpointsLock();
                 QStatus status = ep->PushMessage(msg);
                 if (ER_OK != status) {
                     QCC_LogError(status, ("Failed to forward NameChanged to %s", ep->GetUniqueName().c_str()));
                 }
-                AcquireLocks();
+                AcquireVirtualEndpointsLock();
                 bit = b2bEndpoints.find(msg->GetRcvEndpointName());
                 it = b2bEndpoints.lower_bound(key);
                 if ((it != b2bEndpoints.end()) && (it->first == key)) {
@@ -3465,7 +3648,7 @@ void AllJoynObj::NameChangedSignalHandler(const InterfaceDescription::Member* me
                 ++it;
             }
         }
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
     }
 }
 
@@ -3475,7 +3658,7 @@ void AllJoynObj::AddVirtualEndpoint(const qcc::String& uniqueName, const String&
 
     bool added = false;
 
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     BusEndpoint tempEp = router.FindEndpoint(b2bEpName);
     RemoteEndpoint busToBusEndpoint = RemoteEndpoint::cast(tempEp);
 
@@ -3489,9 +3672,9 @@ void AllJoynObj::AddVirtualEndpoint(const qcc::String& uniqueName, const String&
      * Also, if the busToBusEndpoint becomes invalid, we just return.
      */
     while (busToBusEndpoint->IsValid() && it != virtualEndpoints.end() && it->second->IsStopping()) {
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
         qcc::Sleep(10);
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         it = virtualEndpoints.find(uniqueName);
     }
 
@@ -3503,7 +3686,7 @@ void AllJoynObj::AddVirtualEndpoint(const qcc::String& uniqueName, const String&
             virtualEndpoints.insert(pair<qcc::String, VirtualEndpoint>(uniqueName, vep));
             added = true;
             /* Register the endpoint with the router */
-            ReleaseLocks();
+            ReleaseVirtualEndpointsLock();
             BusEndpoint busEndpoint = BusEndpoint::cast(vep);
             router.RegisterEndpoint(busEndpoint);
 
@@ -3511,10 +3694,10 @@ void AllJoynObj::AddVirtualEndpoint(const qcc::String& uniqueName, const String&
             /* Add the busToBus endpoint to the existing virtual endpoint */
             vep = it->second;
             added = vep->AddBusToBusEndpoint(busToBusEndpoint);
-            ReleaseLocks();
+            ReleaseVirtualEndpointsLock();
         }
     } else {
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
     }
 
     if (wasAdded) {
@@ -3529,26 +3712,26 @@ void AllJoynObj::RemoveVirtualEndpoint(const String& vepName)
     /* Remove virtual endpoint along with any aliases that exist for this uniqueName */
     router.RemoveVirtualAliases(vepName);
     router.UnregisterEndpoint(vepName, ENDPOINT_TYPE_VIRTUAL);
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     map<qcc::String, VirtualEndpoint>::iterator it = virtualEndpoints.find(vepName);
     if (it != virtualEndpoints.end()) {
         VirtualEndpoint vep = it->second;
         virtualEndpoints.erase(it);
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
     } else {
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
     }
 }
 
 VirtualEndpoint AllJoynObj::FindVirtualEndpoint(const qcc::String& uniqueName)
 {
     VirtualEndpoint ret;
-    AcquireLocks();
+    AcquireVirtualEndpointsLock();
     map<qcc::String, VirtualEndpoint>::iterator it = virtualEndpoints.find(uniqueName);
     if (it != virtualEndpoints.end()) {
         ret = it->second;
     }
-    ReleaseLocks();
+    ReleaseVirtualEndpointsLock();
     return ret;
 }
 
@@ -3577,7 +3760,7 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
 
     /* Remove unique names from sessionMap entries */
     if (!newOwner && (alias[0] == ':')) {
-        AcquireLocks();
+        AcquireSessionMapLock();
         vector<pair<String, SessionId> > changedSessionMembers;
         vector<SessionMapEntry> sessionsLost;
         SessionMapType::iterator it = sessionMap.begin();
@@ -3643,7 +3826,7 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
                 ++it;
             }
         }
-        ReleaseLocks();
+        ReleaseSessionMapLock();
 
         /* Send MPSessionChanged for each changed session involving alias */
         vector<pair<String, SessionId> >::const_iterator csit = changedSessionMembers.begin();
@@ -3662,7 +3845,7 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
     if (0 == ::strncmp(shortGuidStr.c_str(), un->c_str() + 1, shortGuidStr.size())) {
 
         /* Send NameChanged to all directly connected controllers */
-        AcquireLocks();
+        AcquireVirtualEndpointsLock();
         map<qcc::StringMapKey, RemoteEndpoint>::iterator it = b2bEndpoints.begin();
         while (it != b2bEndpoints.end()) {
             Message sigMsg(bus);
@@ -3684,9 +3867,9 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
             if (ER_OK == status) {
                 StringMapKey key = it->first;
                 RemoteEndpoint ep = it->second;
-                ReleaseLocks();
+                ReleaseVirtualEndpointsLock();
                 status = ep->PushMessage(sigMsg);
-                AcquireLocks();
+                AcquireVirtualEndpointsLock();
                 it = b2bEndpoints.lower_bound(key);
                 if ((it != b2bEndpoints.end()) && (it->first == key)) {
                     ++it;
@@ -3699,7 +3882,7 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
                 QCC_LogError(status, ("Failed to send NameChanged"));
             }
         }
-        ReleaseLocks();
+        ReleaseVirtualEndpointsLock();
 
         /* If a local unique name dropped, then remove any refs it had in the connnect, advertise and discover maps */
         if ((NULL == newOwner) && (alias[0] == ':')) {
@@ -3744,19 +3927,21 @@ void AllJoynObj::NameOwnerChanged(const qcc::String& alias, const qcc::String* o
             }
 
             /* Remove endpoint refs from discover map */
+            vector<pair<String, TransportMask> > finds;
+            AcquireDiscoveryLock();
             multimap<String, pair<TransportMask, String> >::const_iterator dit = discoverMap.begin();
             while (dit != discoverMap.end()) {
                 if (dit->second.second == *oldOwner) {
-                    last = dit->first;
-                    TransportMask mask = dit->second.first;
-                    ++dit;
-                    QCC_DbgPrintf(("Calling ProcCancelFindName from NameOwnerChanged [%s]", Thread::GetThread()->GetName()));
-                    QStatus status = ProcCancelFindName(*oldOwner, last, mask);
-                    if (ER_OK != status) {
-                        QCC_LogError(status, ("Failed to cancel discover for name \"%s\"", last.c_str()));
-                    }
-                } else {
-                    ++dit;
+                    finds.push_back(pair<String, TransportMask>(dit->first, dit->second.first));
+                }
+                ++dit;
+            }
+            ReleaseDiscoveryLock();
+            for (size_t i = 0; i < finds.size(); ++i) {
+                QCC_DbgPrintf(("Calling ProcCancelFindName from NameOwnerChanged [%s]", Thread::GetThread()->GetName()));
+                QStatus status = ProcCancelFindName(*oldOwner, finds[i].first, finds[i].second);
+                if (ER_OK != status) {
+                    QCC_LogError(status, ("Failed to cancel discover for name \"%s\"", finds[i].first.c_str()));
                 }
             }
             ReleaseLocks();
@@ -3789,7 +3974,7 @@ void AllJoynObj::FoundNames(const qcc::String& busAddr,
     }
     set<FoundNameEntry> foundNameSet;
     set<String> lostNameSet;
-    AcquireLocks();
+    AcquireDiscoveryLock();
     if (names == NULL) {
         /* If name is NULL expire all names for the given bus address. */
         if (ttl == 0) {
@@ -3896,7 +4081,7 @@ void AllJoynObj::FoundNames(const qcc::String& busAddr,
             ++nit;
         }
     }
-    ReleaseLocks();
+    ReleaseDiscoveryLock();
 
     /* Send FoundAdvertisedName signals without holding locks */
     set<FoundNameEntry>::const_iterator fit = foundNameSet.begin();
@@ -3923,7 +4108,7 @@ void AllJoynObj::CleanAdvAliasMap(const String& name, const TransportMask mask)
     QCC_DbgTrace(("AllJoynObj::CleanAdvAliasMap(%s, 0x%x): size=%d", name.c_str(), mask, advAliasMap.size()));
 
     /* Clean advAliasMap */
-    AcquireLocks();
+    AcquireDiscoveryLock();
     multimap<String, pair<String, TransportMask> >::iterator ait = advAliasMap.begin();
     while (ait != advAliasMap.end()) {
         if ((ait->second.first == name) && ((ait->second.second & mask) != 0)) {
@@ -3932,7 +4117,7 @@ void AllJoynObj::CleanAdvAliasMap(const String& name, const TransportMask mask)
             ++ait;
         }
     }
-    ReleaseLocks();
+    ReleaseDiscoveryLock();
 }
 
 QStatus AllJoynObj::SendFoundAdvertisedName(const String& dest,
@@ -3956,7 +4141,7 @@ QStatus AllJoynObj::SendLostAdvertisedName(const String& name, TransportMask tra
     QStatus status = ER_OK;
 
     /* Send LostAdvertisedName to anyone who is discovering name */
-    AcquireLocks();
+    AcquireDiscoveryLock();
     vector<pair<String, String> > sigVec;
     if (0 < discoverMap.size()) {
         multimap<qcc::String, pair<TransportMask, qcc::String> >::const_iterator dit = discoverMap.lower_bound(name[0]);
@@ -3967,7 +4152,7 @@ QStatus AllJoynObj::SendLostAdvertisedName(const String& name, TransportMask tra
             ++dit;
         }
     }
-    ReleaseLocks();
+    ReleaseDiscoveryLock();
 
     /* Send the signals now that we aren't holding the lock */
     vector<pair<String, String> >::const_iterator it = sigVec.begin();
@@ -3992,18 +4177,16 @@ QStatus AllJoynObj::SendLostAdvertisedName(const String& name, TransportMask tra
 void AllJoynObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
     if (ER_OK == reason) {
-        AcquireLocks();
+        vector<pair<String, TransportMask> > expired;
+        AcquireDiscoveryLock();
         if ((bool)alarm->GetContext()) {
             multimap<String, NameMapEntry>::iterator it = nameMap.begin();
             uint64_t now = GetTimestamp64();
             while (it != nameMap.end()) {
                 NameMapEntry& nme = it->second;
                 if ((now - nme.timestamp) >= nme.ttl) {
-                    /* Send LostAdvertisedName */
                     QCC_DbgPrintf(("Expiring discovered name %s for guid %s", it->first.c_str(), nme.guid.c_str()));
-                    SendLostAdvertisedName(it->first, nme.transport);
-                    /* Clean advAliasMap */
-                    CleanAdvAliasMap(it->first, nme.transport);
+                    expired.push_back(pair<String, TransportMask>(it->first, nme.transport));
                     /* Remove alarm */
                     timer.RemoveAlarm(nme.alarm, false);
                     nme.alarm->SetContext((void*)false);
@@ -4013,7 +4196,14 @@ void AllJoynObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
                 }
             }
         }
-        ReleaseLocks();
+        ReleaseDiscoveryLock();
+
+        for (size_t i = 0; i < expired.size(); ++i) {
+            /* Send LostAdvertisedName */
+            SendLostAdvertisedName(expired[i].first, expired[i].second);
+            /* Clean advAliasMap */
+            CleanAdvAliasMap(expired[i].first, expired[i].second);
+        }
     }
 }
 
@@ -23,6 +23,7 @@
 #define _ALLJOYN_ALLJOYNOBJ_H
 
 #include <qcc/platform.h>
+#include <deque>
 #include <vector>
 #include <map>
 
@@ -486,7 +487,22 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
   private:
     Bus& bus;                             /**< The bus */
     DaemonRouter& router;                 /**< The router */
-    qcc::Mutex stateLock;                 /**< Lock that protects AlljoynObj state */
+    qcc::Mutex stateLock;                 /**< Lock that serializes advertise and discover calls into the transports */
+
+    /*
+     * Locks that protect virtualEndpoints and b2bEndpoints, and sessionMap. They are ranked below
+     * the name table lock so that the router may be called with them held, and session operations
+     * do not contend with name table changes.
+     */
+    qcc::Mutex virtualEndpointsLock;
+    qcc::Mutex sessionMapLock;
+
+    /*
+     * Lock that protects nameMap, discoverMap and advAliasMap. It is ranked below the name table
+     * lock and the other AllJoynObj locks: any of them may be held when it is acquired but none may
+     * be acquired while it is held. Signals are never sent and transports are never called while holding it.
+     */
+    qcc::Mutex discoveryLock;
 
     const InterfaceDescription* daemonIface;               /**< org.alljoyn.Daemon interface */
 
@@ -503,10 +519,10 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
     /** Map of active advertised names to requesting local endpoint's permitted transport mask(s) and name(s) */
     std::multimap<qcc::String, std::pair<TransportMask, qcc::String> > advertiseMap;
 
-    /** Map of active discovery names to requesting local endpoint's permitted transport mask(s) and name(s) */
+    /** Map of active discovery names to requesting local endpoint's permitted transport mask(s) and name(s) (protected by discoveryLock) */
     std::multimap<qcc::String, std::pair<TransportMask, qcc::String> > discoverMap;
 
-    /** Map of discovered bus names (protected by discoverMapLock) */
+    /** Map of discovered bus names (protected by discoveryLock) */
     struct NameMapEntry {
         qcc::String busAddr;
         qcc::String guid;
@@ -550,7 +566,7 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
 
     typedef std::multimap<std::pair<qcc::String, SessionId>, SessionMapEntry> SessionMapType;
 
-    SessionMapType sessionMap;  /**< Map (endpointName,sessionId) to session info */
+    SessionMapType sessionMap;  /**< Map (endpointName,sessionId) to session info (protected by sessionMapLock) */
 
     /*
      * Helper function to get session map interator
@@ -577,11 +593,11 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
     const InterfaceDescription::Member* exchangeNamesSignal;   /**< org.alljoyn.Daemon.ExchangeNames signal member */
     const InterfaceDescription::Member* detachSessionSignal;   /**< org.alljoyn.Daemon.DetachSession signal member */
 
-    std::map<qcc::String, VirtualEndpoint> virtualEndpoints;   /**< Map of endpoints that reside behind a connected AllJoyn daemon */
+    std::map<qcc::String, VirtualEndpoint> virtualEndpoints;   /**< Map of endpoints that reside behind a connected AllJoyn daemon (protected by virtualEndpointsLock) */
 
-    std::map<qcc::StringMapKey, RemoteEndpoint> b2bEndpoints;  /**< Map of bus-to-bus endpoints that are connected to external daemons */
+    std::map<qcc::StringMapKey, RemoteEndpoint> b2bEndpoints;  /**< Map of bus-to-bus endpoints that are connected to external daemons (protected by virtualEndpointsLock) */
 
-    std::multimap<qcc::String, std::pair<qcc::String, TransportMask> > advAliasMap;  /**< Map remote daemon guid/transport to advertised name alias */
+    std::multimap<qcc::String, std::pair<qcc::String, TransportMask> > advAliasMap;  /**< Map remote daemon guid/transport to advertised name alias (protected by discoveryLock) */
 
     qcc::Timer timer;           /**< Timer object for reaping expired names */
 
@@ -592,14 +608,27 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
-    /** JoinSessionThread handles a JoinSession request from a local client on a separate thread */
+    /**
+     * JoinSessionThread handles queued JoinSession requests from local clients or AttachSession
+     * requests from remote daemons off the message dispatch thread, since these can block waiting
+     * for NameOwnerChanged or for replies from other daemons. The threads form a bounded pool
+     * per kind of request: a thread is started for a queued request only if fewer than the limit
+     * are running, and each thread keeps taking requests until its queue is empty. Joins and
+     * attaches have separate pools so a burst of joins waiting on remote attaches cannot starve
+     * the attaches other daemons send here.
+     *
+     * A thread that blocks on another daemon, a transport connect or an application gives up its
+     * place in the pool for the duration of the wait, so requests that do not need that remote
+     * are not stuck behind it. The number of threads waiting like this is bounded separately.
+     */
     class JoinSessionThread : public qcc::Thread, public qcc::ThreadListener {
       public:
-        JoinSessionThread(AllJoynObj& ajObj, const Message& msg, bool isJoin) :
+        JoinSessionThread(AllJoynObj& ajObj, bool isJoin) :
             qcc::Thread(qcc::String("JoinS-") + qcc::U32ToString(qcc::IncrementAndFetch(&jstCount))),
             ajObj(ajObj),
-            msg(msg),
-            isJoin(isJoin) { }
+            msg(ajObj.bus),
+            isJoin(isJoin),
+            isWaiting(false) { }
 
         void ThreadExit(Thread* thread);
 
@@ -611,18 +640,58 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
         qcc::ThreadReturn STDCALL RunJoin();
         qcc::ThreadReturn STDCALL RunAttach();
 
+        /**
+         * Called with the AllJoynObj locks released before a blocking call to a remote daemon,
+         * transport or application. Gives this thread's place in the pool to a new thread if
+         * requests are queued and the limit on waiting threads has not been reached.
+         */
+        void BeginRemoteWait();
+
+        /**
+         * Called when the blocking call returns. The thread takes back a place in the pool and
+         * exits after the current request if that leaves the pool over its limit.
+         */
+        void EndRemoteWait();
+
         AllJoynObj& ajObj;
-        Message msg;
+        Message msg;                                     /**< Request currently being handled */
         bool isJoin;
+        bool isWaiting;                                  /**< True if BeginRemoteWait gave up this thread's place */
     };
 
-    std::vector<JoinSessionThread*> joinSessionThreads;  /**< List of outstanding join session requests */
-    qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects joinSessionThreads */
+    /**
+     * Start a JoinSessionThread for queued requests. Must be called with joinSessionThreadsLock held.
+     *
+     * @param isJoin  true for JoinSession, false for AttachSession.
+     * @return ER_OK if the thread was started.
+     */
+    QStatus StartJoinSessionThread(bool isJoin);
+
+    /**
+     * Queue a JoinSession or AttachSession request and start a JoinSessionThread for it if the
+     * pool for that kind of request is not full.
+     *
+     * @param msg     The request.
+     * @param isJoin  true for JoinSession, false for AttachSession.
+     */
+    void QueueJoinSessionRequest(const Message& msg, bool isJoin);
+
+    std::vector<JoinSessionThread*> joinSessionThreads;  /**< List of running join session threads */
+    std::deque<Message> joinRequests;                    /**< JoinSession requests waiting for a thread */
+    std::deque<Message> attachRequests;                  /**< AttachSession requests waiting for a thread */
+    uint32_t numJoinThreads;                             /**< Number of threads taking from joinRequests */
+    uint32_t numAttachThreads;                           /**< Number of threads taking from attachRequests */
+    uint32_t maxJoinThreads;                             /**< Limit on numJoinThreads and numAttachThreads each */
+    uint32_t numWaitingJoinThreads;                      /**< Number of join threads blocked in a remote wait */
+    uint32_t numWaitingAttachThreads;                    /**< Number of attach threads blocked in a remote wait */
+    uint32_t maxWaitingJoinThreads;                      /**< Limit on numWaitingJoinThreads and numWaitingAttachThreads each */
+    qcc::Mutex joinSessionThreadsLock;                   /**< Lock that protects joinSessionThreads and the request queues */
     bool isStopping;                                     /**< True while waiting for threads to exit */
     BusController* busController;                        /**< BusController that created this BusObject */
 
     /**
-     * Acquire AllJoynObj locks.
+     * Acquire AllJoynObj locks: virtualEndpointsLock, sessionMapLock and the name table lock.
+     * Needed for connectMap and advertiseMap.
      */
     void AcquireLocks();
 
@@ -631,6 +700,56 @@ class AllJoynObj : public BusObject, public NameListener, public TransportListen
      */
     void ReleaseLocks();
 
+    /**
+     * Acquire virtualEndpointsLock and sessionMapLock without the name table lock.
+     */
+    void AcquireSessionLocks();
+
+    /**
+     * Release virtualEndpointsLock and sessionMapLock.
+     */
+    void ReleaseSessionLocks();
+
+    /**
+     * Acquire virtualEndpointsLock. Must not be called with sessionMapLock or the name table lock held.
+     */
+    void AcquireVirtualEndpointsLock();
+
+    /**
+     * Release virtualEndpointsLock.
+     */
+    void ReleaseVirtualEndpointsLock();
+
+    /**
+     * Acquire sessionMapLock. Must not be called with the name table lock held.
+     */
+    void AcquireSessionMapLock();
+
+    /**
+     * Release sessionMapLock.
+     */
+    void ReleaseSessionMapLock();
+
+    /**
+     * Acquire stateLock. May be called with the AllJoynObj locks held.
+     */
+    void AcquireStateLock();
+
+    /**
+     * Release stateLock.
+     */
+    void ReleaseStateLock();
+
+    /**
+     * Acquire discoveryLock. May be called with the AllJoynObj locks or stateLock held.
+     */
+    void AcquireDiscoveryLock();
+
+    /**
+     * Release discoveryLock.
+     */
+    void ReleaseDiscoveryLock();
+
     /**
      * Utility function used to send a single FoundName signal.
      *
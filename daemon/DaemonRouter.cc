@@ -116,7 +116,6 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
 
     bool destinationEmpty = destination[0] == '\0';
     if (!destinationEmpty) {
-        nameTable.Lock();
         BusEndpoint destEndpoint = nameTable.FindEndpoint(destination);
         if (destEndpoint->IsValid()) {
             /* If this message is coming from a bus-to-bus ep, make sure the receiver is willing to receive it */
@@ -135,9 +134,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
                     BusEndpoint busEndpoint = BusEndpoint::cast(localEndpoint);
                     PushMessage(msg, busEndpoint);
                 } else {
-                    nameTable.Unlock();
                     status = SendThroughEndpoint(msg, destEndpoint, sessionId);
-                    nameTable.Lock();
                 }
             } else {
                 QCC_DbgPrintf(("Blocking message from %s to %s (serial=%d) because receiver does not allow remote messages",
@@ -157,9 +154,7 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
             if ((ER_OK != status) && (ER_BUS_ENDPOINT_CLOSING != status) && (status != ER_BUS_STOPPING)) {
                 QCC_LogError(status, ("BusEndpoint::PushMessage failed"));
             }
-            nameTable.Unlock();
         } else {
-            nameTable.Unlock();
             if ((msg->GetFlags() & ALLJOYN_FLAG_AUTO_START) &&
                 (sender->GetEndpointType() != ENDPOINT_TYPE_BUS2BUS) &&
                 (sender->GetEndpointType() != ENDPOINT_TYPE_NULL)) {
@@ -198,32 +193,20 @@ QStatus DaemonRouter::PushMessage(Message& msg, BusEndpoint& origSender)
          * The message has an empty destination field and no session is specified so this is a
          * regular broadcast message.
          */
-        nameTable.Lock();
-        ruleTable.Lock();
-        RuleIterator it = ruleTable.Begin();
-        while (it != ruleTable.End()) {
-            if (it->second.IsMatch(msg)) {
-                BusEndpoint dest = it->first;
-                QCC_DbgPrintf(("Routing %s (%d) to %s", msg->Description().c_str(), msg->GetCallSerial(), dest->GetUniqueName().c_str()));
-                /*
-                 * If the message originated locally or the destination allows remote messages
-                 * forward the message, otherwise silently ignore it.
-                 */
-                if (!((sender->GetEndpointType() == ENDPOINT_TYPE_BUS2BUS) && !dest->AllowRemoteMessages())) {
-                    ruleTable.Unlock();
-                    nameTable.Unlock();
-                    QStatus tStatus = SendThroughEndpoint(msg, dest, sessionId);
-                    status = (status == ER_OK) ? tStatus : status;
-                    nameTable.Lock();
-                    ruleTable.Lock();
-                }
-                it = ruleTable.AdvanceToNextEndpoint(dest);
-            } else {
-                ++it;
+        vector<BusEndpoint> matches;
+        ruleTable.FindMatchingEndpoints(msg, matches);
+        for (vector<BusEndpoint>::iterator it = matches.begin(); it != matches.end(); ++it) {
+            BusEndpoint dest = *it;
+            QCC_DbgPrintf(("Routing %s (%d) to %s", msg->Description().c_str(), msg->GetCallSerial(), dest->GetUniqueName().c_str()));
+            /*
+             * If the message originated locally or the destination allows remote messages
+             * forward the message, otherwise silently ignore it.
+             */
+            if (!((sender->GetEndpointType() == ENDPOINT_TYPE_BUS2BUS) && !dest->AllowRemoteMessages())) {
+                QStatus tStatus = SendThroughEndpoint(msg, dest, sessionId);
+                status = (status == ER_OK) ? tStatus : status;
             }
         }
-        ruleTable.Unlock();
-        nameTable.Unlock();
 
         if (msg->IsSessionless()) {
             /* Give "locally generated" sessionless message to SessionlessObj */
@@ -373,6 +356,26 @@ QStatus DaemonRouter::RemoveRule(BusEndpoint& endpoint, Rule& rule)
     return status;
 }
 
+void DaemonRouter::ConfigureTxQueue(RemoteEndpoint endpoint)
+{
+    DaemonConfig* config = DaemonConfig::Access();
+    uint32_t maxMsgs = config->Get("limit@max_tx_queue_messages", ALLJOYN_MAX_TX_QUEUE_MESSAGES_DEFAULT);
+    uint32_t maxBytes = config->Get("limit@max_tx_queue_bytes", ALLJOYN_MAX_TX_QUEUE_BYTES_DEFAULT);
+    qcc::String overflow = config->Get("limit@tx_queue_overflow", "block");
+
+    _RemoteEndpoint::TxQueuePolicy policy = _RemoteEndpoint::TX_QUEUE_BLOCK;
+    if (overflow == "drop_expirable") {
+        policy = _RemoteEndpoint::TX_QUEUE_DROP_EXPIRABLE;
+    } else if (overflow == "drop_new") {
+        policy = _RemoteEndpoint::TX_QUEUE_DROP_NEW;
+    } else if (overflow == "disconnect") {
+        policy = _RemoteEndpoint::TX_QUEUE_DISCONNECT;
+    } else if (overflow != "block") {
+        QCC_LogError(ER_BUS_BAD_VALUE, ("Unknown tx_queue_overflow policy \"%s\", using \"block\"", overflow.c_str()));
+    }
+    endpoint->SetTxQueueLimits(maxMsgs, maxBytes, policy);
+}
+
 QStatus DaemonRouter::RegisterEndpoint(BusEndpoint& endpoint)
 {
     QCC_DbgTrace(("DaemonRouter::RegisterEndpoint(%s, %d)", endpoint->GetUniqueName().c_str(), endpoint->GetEndpointType()));
@@ -383,6 +386,11 @@ QStatus DaemonRouter::RegisterEndpoint(BusEndpoint& endpoint)
         localEndpoint = LocalEndpoint::cast(endpoint);
     }
 
+    /* Apply the configured transmit queue limits to remote endpoints */
+    if ((endpoint->GetEndpointType() == ENDPOINT_TYPE_REMOTE) || (endpoint->GetEndpointType() == ENDPOINT_TYPE_BUS2BUS)) {
+        ConfigureTxQueue(RemoteEndpoint::cast(endpoint));
+    }
+
     if (endpoint->GetEndpointType() == ENDPOINT_TYPE_BUS2BUS) {
         /* AllJoynObj is in charge of managing bus-to-bus endpoints and their names */
         RemoteEndpoint busToBusEndpoint = RemoteEndpoint::cast(endpoint);
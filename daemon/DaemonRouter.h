@@ -352,6 +352,20 @@ class DaemonRouter : public Router {
     void RemoveSessionRoutes(const char* uniqueName, SessionId id);
 
   private:
+    /**
+     * Default transmit queue limits for remote endpoints. These can be changed with the
+     * max_tx_queue_messages, max_tx_queue_bytes and tx_queue_overflow limits in the daemon config.
+     */
+    static const uint32_t ALLJOYN_MAX_TX_QUEUE_MESSAGES_DEFAULT = 30;
+    static const uint32_t ALLJOYN_MAX_TX_QUEUE_BYTES_DEFAULT = 0;
+
+    /**
+     * Apply the configured transmit queue limits to a remote endpoint.
+     *
+     * @param endpoint   The endpoint to configure.
+     */
+    void ConfigureTxQueue(RemoteEndpoint endpoint);
+
     LocalEndpoint localEndpoint;    /**< The local endpoint */
     RuleTable ruleTable;            /**< Routing rule table */
     NameTable nameTable;            /**< BusName to transport lookupl table */
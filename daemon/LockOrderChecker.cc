@@ -0,0 +1,100 @@
+/**
+ * @file
+ * Debug check that daemon locks are acquired in a consistent order.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#ifndef NDEBUG
+
+#include <assert.h>
+#include <map>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/Thread.h>
+
+#include "LockOrderChecker.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/* Ranks of the locks held by each thread in the order they were acquired */
+typedef map<Thread*, vector<LockRank> > HeldLockMap;
+
+/*
+ * These are namespace scope rather than function local statics because initialization of function
+ * local statics is not thread-safe before C++11. They are constructed before main() runs, before
+ * any daemon thread can take a ranked lock.
+ */
+static HeldLockMap heldLocks;
+static Mutex heldLocksLock;
+
+void LockOrderChecker::Acquiring(LockRank rank, const char* name)
+{
+    Thread* thread = Thread::GetThread();
+    heldLocksLock.Lock(MUTEX_CONTEXT);
+    vector<LockRank>& held = heldLocks[thread];
+    /*
+     * Locks may be released out of order so compare against every held lock, not only the last
+     * one acquired. Taking a lock that is already held is a recursive acquisition and cannot block.
+     */
+    LockRank highest = rank;
+    bool recursive = false;
+    for (size_t i = 0; i < held.size(); ++i) {
+        recursive = recursive || (held[i] == rank);
+        highest = (held[i] > highest) ? held[i] : highest;
+    }
+    if (!recursive && (highest > rank)) {
+        QCC_LogError(ER_FAIL, ("Lock order violation: %s (rank %d) acquired by %s while holding a lock of rank %d",
+                               name, rank, thread->GetName(), highest));
+        assert(!"Lock order violation");
+    }
+    held.push_back(rank);
+    heldLocksLock.Unlock(MUTEX_CONTEXT);
+}
+
+void LockOrderChecker::Released(LockRank rank)
+{
+    Thread* thread = Thread::GetThread();
+    heldLocksLock.Lock(MUTEX_CONTEXT);
+    HeldLockMap::iterator it = heldLocks.find(thread);
+    if (it != heldLocks.end()) {
+        vector<LockRank>& held = it->second;
+        for (size_t i = held.size(); i > 0; --i) {
+            if (held[i - 1] == rank) {
+                held.erase(held.begin() + (i - 1));
+                break;
+            }
+        }
+        if (held.empty()) {
+            heldLocks.erase(it);
+        }
+    }
+    heldLocksLock.Unlock(MUTEX_CONTEXT);
+}
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * Debug check that daemon locks are acquired in a consistent order.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_LOCKORDERCHECKER_H
+#define _ALLJOYN_LOCKORDERCHECKER_H
+
+#include <qcc/platform.h>
+
+namespace ajn {
+
+/**
+ * Ranks of the daemon locks that are held together. A thread may only acquire a lock whose
+ * rank is higher than the rank of every lock it holds, or a lock it already holds (the locks
+ * are recursive).
+ */
+enum LockRank {
+    LOCK_RANK_VIRTUAL_ENDPOINTS = 1, /**< AllJoynObj lock protecting the virtual and bus-to-bus endpoint maps */
+    LOCK_RANK_SESSION_MAP,           /**< AllJoynObj lock protecting the session map */
+    LOCK_RANK_NAME_TABLE,            /**< NameTable lock, wherever it is taken */
+    LOCK_RANK_TRANSPORT_STATE,       /**< AllJoynObj lock serializing advertise/discover calls into the transports */
+    LOCK_RANK_DISCOVERY              /**< AllJoynObj lock protecting the discovered names, discoverers and aliases */
+};
+
+/**
+ * Tracks the ranked locks held by each thread and logs an error and asserts if a lock is
+ * acquired out of order. The checks are only compiled into debug builds.
+ */
+class LockOrderChecker {
+  public:
+    /**
+     * Called before acquiring a ranked lock.
+     *
+     * @param rank   Rank of the lock.
+     * @param name   Name of the lock for the error message.
+     */
+    static void Acquiring(LockRank rank, const char* name)
+#ifdef NDEBUG
+    { }
+#else
+    ;
+#endif
+
+    /**
+     * Called after releasing a ranked lock.
+     *
+     * @param rank   Rank of the lock.
+     */
+    static void Released(LockRank rank)
+#ifdef NDEBUG
+    { }
+#else
+    ;
+#endif
+};
+
+}
+
+#endif
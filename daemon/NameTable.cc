@@ -43,6 +43,31 @@ using namespace qcc;
 
 namespace ajn {
 
+NameTable::NameTable() : uniqueId(0), uniquePrefix(":1."), version(0)
+{
+    Snapshot* snapshot = new Snapshot();
+    for (size_t b = 0; b < SNAPSHOT_BUCKETS; ++b) {
+        snapshot->buckets[b] = new SnapshotBucket();
+        snapshot->buckets[b]->refs = 1;
+    }
+    snapshots[0] = snapshot;
+    snapshots[1] = NULL;
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+NameTable::~NameTable()
+{
+    for (int s = 0; s < 2; ++s) {
+        for (size_t i = 0; i < retired[s].size(); ++i) {
+            ReleaseSnapshot(retired[s][i]);
+        }
+        if (snapshots[s]) {
+            ReleaseSnapshot(snapshots[s]);
+        }
+    }
+}
+
 qcc::String NameTable::GenerateUniqueName(void)
 {
     return uniquePrefix + U32ToString(IncrementAndFetch((int32_t*)&uniqueId));
@@ -62,9 +87,11 @@ void NameTable::AddUniqueName(BusEndpoint& endpoint)
 
     const qcc::String& uniqueName = endpoint->GetUniqueName();
     QCC_DbgPrintf(("Add unique name %s", uniqueName.c_str()));
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     uniqueNames[uniqueName] = endpoint;
-    lock.Unlock(MUTEX_CONTEXT);
+    NameChanged(uniqueName);
+    PublishSnapshot();
+    Unlock();
 
     /* Notify listeners */
     CallListeners(uniqueName, NULL, &uniqueName);
@@ -75,62 +102,46 @@ void NameTable::RemoveUniqueName(const qcc::String& uniqueName)
     QCC_DbgTrace(("RemoveUniqueName %s", uniqueName.c_str()));
 
     /* Erase the unique bus name and any well-known names that use the same endpoint */
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     unordered_map<qcc::String, BusEndpoint, Hash, Equal>::iterator it = uniqueNames.find(uniqueName);
     if (it != uniqueNames.end()) {
-        BusEndpoint endpoint = it->second;
-
-        /* Remove well-known names asssociated with uniqueName */
+        /*
+         * Remove well-known names asssociated with uniqueName. All of the changes are made
+         * before the snapshot is published and listeners are called once the lock is released.
+         */
+        vector<pair<String, String> > released;
         unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::iterator ait = aliasNames.begin();
         while (ait != aliasNames.end()) {
-            deque<NameQueueEntry>::iterator lit = ait->second.begin();
-            bool startOver = false;
-            while (lit != ait->second.end()) {
-                if (lit->endpointName == endpoint->GetUniqueName()) {
-                    if (lit == ait->second.begin()) {
-                        uint32_t disposition;
-                        String alias = ait->first;
-                        String epName = endpoint->GetUniqueName();
-                        /* Must unlock before calling RemoveAlias because it can call out (and cannot be locked at the time) */
-                        lock.Unlock(MUTEX_CONTEXT);
-                        RemoveAlias(alias, epName, disposition, NULL, NULL);
-                        lock.Lock(MUTEX_CONTEXT);
-                        /* Make sure iterator is still valid */
-                        it = uniqueNames.find(uniqueName);
-                        if (it == uniqueNames.end()) {
-                            break;
-                        }
-                        if (DBUS_RELEASE_NAME_REPLY_RELEASED == disposition) {
-                            ait = aliasNames.begin();
-                            startOver = true;
-                            break;
-                        } else {
-                            QCC_LogError(ER_FAIL, ("Failed to release %s from %s", alias.c_str(), epName.c_str()));
-                            break;
-                        }
+            unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::iterator cur = ait++;
+            deque<NameQueueEntry>::iterator lit = cur->second.begin();
+            while (lit != cur->second.end()) {
+                if (lit->endpointName == uniqueName) {
+                    if (lit == cur->second.begin()) {
+                        String alias = cur->first;
+                        released.push_back(pair<String, String>(alias, RemovePrimaryOwner(cur)));
                     } else {
-                        ait->second.erase(lit);
-                        break;
+                        cur->second.erase(lit);
                     }
-                } else {
-                    ++lit;
+                    break;
                 }
-            }
-            if (!startOver) {
-                ++ait;
+                ++lit;
             }
         }
 
-        if (it != uniqueNames.end()) {
-            uniqueNames.erase(it);
-            QCC_DbgPrintf(("Removed ep=%s from name table", uniqueName.c_str()));
-        }
+        uniqueNames.erase(it);
+        NameChanged(uniqueName);
+        QCC_DbgPrintf(("Removed ep=%s from name table", uniqueName.c_str()));
+        PublishSnapshot();
 
-        lock.Unlock(MUTEX_CONTEXT);
+        Unlock();
         /* Notify listeners */
+        for (size_t i = 0; i < released.size(); ++i) {
+            const String& newOwner = released[i].second;
+            CallListeners(released[i].first, &uniqueName, newOwner.empty() ? NULL : &newOwner);
+        }
         CallListeners(uniqueName, &uniqueName, NULL);
     } else {
-        lock.Unlock(MUTEX_CONTEXT);
+        Unlock();
     }
 }
 
@@ -145,7 +156,7 @@ QStatus NameTable::AddAlias(const qcc::String& aliasName,
 
     QCC_DbgTrace(("NameTable: AddAlias(%s, %s)", aliasName.c_str(), uniqueName.c_str()));
 
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     unordered_map<qcc::String, BusEndpoint, Hash, Equal>::const_iterator it = uniqueNames.find(uniqueName);
     if (it != uniqueNames.end()) {
         unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::iterator wasIt = aliasNames.find(aliasName);
@@ -187,7 +198,11 @@ QStatus NameTable::AddAlias(const qcc::String& aliasName,
                 origOwner = &vit->second->GetUniqueName();
             }
         }
-        lock.Unlock(MUTEX_CONTEXT);
+        if (newOwner) {
+            NameChanged(aliasName);
+            PublishSnapshot();
+        }
+        Unlock();
 
         if (listener) {
             listener->AddAliasComplete(aliasName, disposition, context);
@@ -198,7 +213,7 @@ QStatus NameTable::AddAlias(const qcc::String& aliasName,
         status = ER_OK;
     } else {
         status = ER_BUS_NO_ENDPOINT;
-        lock.Unlock(MUTEX_CONTEXT);
+        Unlock();
     }
     return status;
 }
@@ -215,7 +230,7 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
 
     QCC_DbgTrace(("NameTable: RemoveAlias(%s, %s)", aliasName.c_str(), ownerName.c_str()));
 
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
 
     /* Find endpoint for aliasName */
     unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::iterator it = aliasNames.find(aliasName);
@@ -224,24 +239,10 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
 
         assert(!queue.empty());
         if (queue[0].endpointName == ownerName) {
-            /* Remove primary */
-            if (queue.size() > 1) {
-                queue.pop_front();
-                BusEndpoint ep = FindEndpoint(queue[0].endpointName);
-                if (ep->IsValid()) {
-                    newOwner = queue[0].endpointName;
-                }
-            }
-            if (newOwner.empty()) {
-                /* Check to see if there is a (now unmasked) remote owner for the alias */
-                map<qcc::StringMapKey, VirtualEndpoint>::const_iterator vit = virtualAliasNames.find(aliasName);
-                if (vit != virtualAliasNames.end()) {
-                    newOwner = vit->second->GetUniqueName();
-                }
-                aliasNames.erase(it);
-            }
+            newOwner = RemovePrimaryOwner(it);
             oldOwner = ownerName;
             disposition = DBUS_RELEASE_NAME_REPLY_RELEASED;
+            PublishSnapshot();
         } else {
             /* Alias is not owned by ownerName */
             disposition = DBUS_RELEASE_NAME_REPLY_NOT_OWNER;
@@ -250,7 +251,7 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
         disposition = DBUS_RELEASE_NAME_REPLY_NON_EXISTENT;
     }
 
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 
     if (listener) {
         listener->RemoveAliasComplete(aliasNameCopy, disposition, context);
@@ -260,11 +261,36 @@ void NameTable::RemoveAlias(const qcc::String& aliasName,
     }
 }
 
-BusEndpoint NameTable::FindEndpoint(const qcc::String& busName) const
+qcc::String NameTable::RemovePrimaryOwner(unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::iterator it)
+{
+    deque<NameQueueEntry>& queue = it->second;
+    qcc::String newOwner;
+
+    NameChanged(it->first);
+    if (queue.size() > 1) {
+        queue.pop_front();
+        /* The snapshot may not reflect changes made by the caller yet */
+        BusEndpoint ep = FindEndpointLocked(queue[0].endpointName);
+        if (ep->IsValid()) {
+            newOwner = queue[0].endpointName;
+        }
+    }
+    if (newOwner.empty()) {
+        /* Check to see if there is a (now unmasked) remote owner for the alias */
+        map<qcc::StringMapKey, VirtualEndpoint>::const_iterator vit = virtualAliasNames.find(it->first);
+        if (vit != virtualAliasNames.end()) {
+            newOwner = vit->second->GetUniqueName();
+        }
+        aliasNames.erase(it);
+    }
+    return newOwner;
+}
+
+BusEndpoint NameTable::FindEndpointLocked(const qcc::String& busName) const
 {
     BusEndpoint ep;
 
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     if (busName[0] == ':') {
         unordered_map<qcc::String, BusEndpoint, Hash, Equal>::const_iterator it = uniqueNames.find(busName);
         if (it != uniqueNames.end()) {
@@ -274,7 +300,7 @@ BusEndpoint NameTable::FindEndpoint(const qcc::String& busName) const
         unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::const_iterator it = aliasNames.find(busName);
         if (it != aliasNames.end()) {
             assert(!it->second.empty());
-            ep = FindEndpoint(it->second[0].endpointName);
+            ep = FindEndpointLocked(it->second[0].endpointName);
         }
         /* Fallback to virtual (remote) aliases if a suitable local one cannot be found */
         if (!ep->IsValid()) {
@@ -285,13 +311,112 @@ BusEndpoint NameTable::FindEndpoint(const qcc::String& busName) const
             }
         }
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
+    return ep;
+}
+
+BusEndpoint NameTable::FindEndpoint(const char* busName) const
+{
+    BusEndpoint ep;
+
+    /*
+     * Announce ourselves as a reader of the current snapshot, then check that
+     * it did not get retired before the writer could see us. Once confirmed
+     * the snapshot cannot be freed until we are done with it.
+     */
+    int32_t v;
+    while (true) {
+        v = version;
+        IncrementAndFetch(&readers[v & 1]);
+        if (v == version) {
+            break;
+        }
+        DecrementAndFetch(&readers[v & 1]);
+    }
+
+    const Snapshot* snapshot = snapshots[v & 1];
+    const SnapshotBucket* bucket = snapshot->buckets[qcc::hash_string(busName) & (SNAPSHOT_BUCKETS - 1)];
+    unordered_map<StringMapKey, BusEndpoint>::const_iterator it = bucket->names.find(StringMapKey(busName));
+    if (it != bucket->names.end()) {
+        ep = it->second;
+    }
+
+    DecrementAndFetch(&readers[v & 1]);
     return ep;
 }
 
+void NameTable::PublishSnapshot()
+{
+    if (changedNames.empty()) {
+        return;
+    }
+
+    /* Share every bucket with the current snapshot except the ones holding changed names */
+    int32_t next = version + 1;
+    const Snapshot* current = snapshots[version & 1];
+    Snapshot* snapshot = new Snapshot(*current);
+    for (size_t b = 0; b < SNAPSHOT_BUCKETS; ++b) {
+        ++snapshot->buckets[b]->refs;
+    }
+    for (set<String>::const_iterator nit = changedNames.begin(); nit != changedNames.end(); ++nit) {
+        size_t b = qcc::hash_string(nit->c_str()) & (SNAPSHOT_BUCKETS - 1);
+        SnapshotBucket* bucket = snapshot->buckets[b];
+        if (bucket == current->buckets[b]) {
+            --bucket->refs;
+            bucket = new SnapshotBucket(*bucket);
+            bucket->refs = 1;
+            snapshot->buckets[b] = bucket;
+        }
+        BusEndpoint ep = FindEndpointLocked(*nit);
+        if (ep->IsValid()) {
+            bucket->names[StringMapKey(*nit)] = ep;
+        } else {
+            bucket->names.erase(StringMapKey(*nit));
+        }
+    }
+    changedNames.clear();
+
+    /*
+     * The slot we fill holds the snapshot before the current one. Lookups that
+     * confirmed that version may still be using it so it is retired rather
+     * than freed, lookups that have not confirmed yet will see the version
+     * change and move on to the new snapshot.
+     */
+    Snapshot* replaced = snapshots[next & 1];
+    snapshots[next & 1] = snapshot;
+    IncrementAndFetch(&version);
+    if (replaced) {
+        retired[next & 1].push_back(replaced);
+    }
+    FreeRetiredSnapshots();
+}
+
+void NameTable::FreeRetiredSnapshots()
+{
+    for (int s = 0; s < 2; ++s) {
+        /* Lookups starting from now can only find the snapshot that replaced these */
+        if (!retired[s].empty() && (readers[s] == 0)) {
+            for (size_t i = 0; i < retired[s].size(); ++i) {
+                ReleaseSnapshot(retired[s][i]);
+            }
+            retired[s].clear();
+        }
+    }
+}
+
+void NameTable::ReleaseSnapshot(Snapshot* snapshot)
+{
+    for (size_t b = 0; b < SNAPSHOT_BUCKETS; ++b) {
+        if (--snapshot->buckets[b]->refs == 0) {
+            delete snapshot->buckets[b];
+        }
+    }
+    delete snapshot;
+}
+
 void NameTable::GetBusNames(vector<qcc::String>& names) const
 {
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
 
     unordered_map<qcc::String, deque<NameQueueEntry>, Hash, Equal>::const_iterator it = aliasNames.begin();
     while (it != aliasNames.end()) {
@@ -303,7 +428,7 @@ void NameTable::GetBusNames(vector<qcc::String>& names) const
         names.push_back(uit->first);
         ++uit;
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 }
 
 void NameTable::GetUniqueNamesAndAliases(vector<pair<qcc::String, vector<qcc::String> > >& names) const
@@ -311,7 +436,7 @@ void NameTable::GetUniqueNamesAndAliases(vector<pair<qcc::String, vector<qcc::St
 
     /* Create a intermediate map to avoid N^2 perf */
     multimap<BusEndpoint, qcc::String> epMap;
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     unordered_map<qcc::String, BusEndpoint, Hash, Equal>::const_iterator uit = uniqueNames.begin();
     while (uit != uniqueNames.end()) {
         epMap.insert(pair<const BusEndpoint, qcc::String>(uit->second, uit->first));
@@ -333,7 +458,7 @@ void NameTable::GetUniqueNamesAndAliases(vector<pair<qcc::String, vector<qcc::St
         epMap.insert(pair<BusEndpoint, qcc::String>(BusEndpoint::cast(vep), vit->first.c_str()));
         ++vit;
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 
     /* Fill in the caller's vector */
     qcc::String uniqueName;
@@ -379,30 +504,35 @@ void NameTable::GetQueuedNames(const qcc::String& busName, std::vector<qcc::Stri
 
 void NameTable::RemoveVirtualAliases(const qcc::String& epName)
 {
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     BusEndpoint tempEp = FindEndpoint(epName);
     VirtualEndpoint ep = VirtualEndpoint::cast(tempEp);
 
     QCC_DbgTrace(("NameTable::RemoveVirtualAliases(%s)", ep->IsValid() ? ep->GetUniqueName().c_str() : "<none>"));
 
+    /* Remove all of the aliases before publishing, then notify listeners with the lock released */
+    vector<String> removed;
     if (ep->IsValid()) {
         map<qcc::StringMapKey, VirtualEndpoint>::iterator vit = virtualAliasNames.begin();
         while (vit != virtualAliasNames.end()) {
             if (vit->second == ep) {
                 String alias = vit->first.c_str();
                 virtualAliasNames.erase(vit++);
+                NameChanged(alias);
                 if (aliasNames.find(alias) == aliasNames.end()) {
-                    lock.Unlock(MUTEX_CONTEXT);
-                    CallListeners(alias, &epName, NULL);
-                    lock.Lock(MUTEX_CONTEXT);
-                    vit = virtualAliasNames.upper_bound(alias);
+                    removed.push_back(alias);
                 }
             } else {
                 ++vit;
             }
         }
+        PublishSnapshot();
+    }
+    Unlock();
+
+    for (size_t i = 0; i < removed.size(); ++i) {
+        CallListeners(removed[i], &epName, NULL);
     }
-    lock.Unlock(MUTEX_CONTEXT);
 }
 
 bool NameTable::SetVirtualAlias(const qcc::String& alias,
@@ -411,7 +541,7 @@ bool NameTable::SetVirtualAlias(const qcc::String& alias,
 {
     QCC_DbgTrace(("NameTable::SetVirtualAlias(%s, %s, %s)", alias.c_str(), newOwner ? (*newOwner)->GetUniqueName().c_str() : "<none>", requestingEndpoint->GetUniqueName().c_str()));
 
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
 
     map<qcc::StringMapKey, VirtualEndpoint>::iterator vit = virtualAliasNames.find(alias);
     VirtualEndpoint oldOwner;
@@ -432,7 +562,7 @@ bool NameTable::SetVirtualAlias(const qcc::String& alias,
         size_t oldPeriodOff = oldOwnerName.find_first_of('.');
         size_t reqPeriodOff = reqOwnerName.find_first_of('.');
         if ((oldPeriodOff == String::npos) || (0 != oldOwnerName.compare(0, oldPeriodOff, reqOwnerName, 0, reqPeriodOff))) {
-            lock.Unlock(MUTEX_CONTEXT);
+            Unlock();
             return false;
         }
     }
@@ -447,11 +577,13 @@ bool NameTable::SetVirtualAlias(const qcc::String& alias,
         madeChange = true;
         virtualAliasNames.erase(StringMapKey(alias));
     }
+    NameChanged(alias);
+    PublishSnapshot();
 
     String oldName = oldOwner->IsValid() ? oldOwner->GetUniqueName() : "";
     String newName = newOwner ? (*newOwner)->GetUniqueName() : "";
 
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 
     /* Virtual aliases cannot override locally requested aliases */
     if (madeChange && !maskingLocalName) {
@@ -464,14 +596,14 @@ bool NameTable::SetVirtualAlias(const qcc::String& alias,
 
 void NameTable::AddListener(NameListener* listener)
 {
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     listeners.insert(ProtectedNameListener(listener));
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 }
 
 void NameTable::RemoveListener(NameListener* listener)
 {
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     ProtectedNameListener pl(listener);
     set<ProtectedNameListener>::iterator it = listeners.find(pl);
     if (it != listeners.end()) {
@@ -480,26 +612,26 @@ void NameTable::RemoveListener(NameListener* listener)
 
         /* Wait until references to pl reach q (pl is only remaining ref) */
         while (pl.GetRefCount() > 1) {
-            lock.Unlock(MUTEX_CONTEXT);
+            Unlock();
             qcc::Sleep(4);
-            lock.Lock(MUTEX_CONTEXT);
+            Lock();
         }
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 }
 
 void NameTable::CallListeners(const qcc::String& aliasName, const qcc::String* origOwner, const qcc::String* newOwner)
 {
-    lock.Lock(MUTEX_CONTEXT);
+    Lock();
     set<ProtectedNameListener>::iterator it = listeners.begin();
     while (it != listeners.end()) {
         ProtectedNameListener nl = *it;
-        lock.Unlock(MUTEX_CONTEXT);
+        Unlock();
         (*nl)->NameOwnerChanged(aliasName, origOwner, newOwner);
-        lock.Lock(MUTEX_CONTEXT);
+        Lock();
         it = listeners.upper_bound(nl);
     }
-    lock.Unlock(MUTEX_CONTEXT);
+    Unlock();
 }
 
 }
@@ -28,6 +28,7 @@
 #include <vector>
 #include <set>
 
+#include <qcc/atomic.h>
 #include <qcc/Mutex.h>
 #include <qcc/Environ.h>
 #include <qcc/String.h>
@@ -36,6 +37,7 @@
 #include <alljoyn/Status.h>
 
 #include "BusEndpoint.h"
+#include "LockOrderChecker.h"
 #include "VirtualEndpoint.h"
 
 #include <qcc/STLContainer.h>
@@ -50,6 +52,12 @@ class NameListener;
  * bus names and the BusEndpoint that these names exist on.
  * This mapping is many (names) to one (endpoint). Every endpoint has
  * exactly one unique name and zero or more well-known names.
+ *
+ * Lookups are served from a read-only snapshot that maps every name straight
+ * to its endpoint and are made without taking the name table lock. The
+ * snapshot is split into buckets by name hash, every change to the names
+ * publishes a new snapshot that shares the buckets it did not change with
+ * the previous one.
  */
 class NameTable {
   public:
@@ -67,7 +75,12 @@ class NameTable {
     /**
      * Constructor
      */
-    NameTable() : uniqueId(0), uniquePrefix(":1.") { }
+    NameTable();
+
+    /**
+     * Destructor
+     */
+    ~NameTable();
 
     /**
      * Set the GUID of the bus.
@@ -176,7 +189,26 @@ class NameTable {
      * @param busName   Name of bus.
      * @return  Returns the endpoint if it was found or an invalid endpoint if not found
      */
-    BusEndpoint FindEndpoint(const qcc::String& busName) const;
+    BusEndpoint FindEndpoint(const qcc::String& busName) const { return FindEndpoint(busName.c_str()); }
+
+    /**
+     * Find an endpoint for a given unique or alias bus name.
+     * This does not take the name table lock or allocate memory.
+     *
+     * @param busName   Name of bus.
+     * @return  Returns the endpoint if it was found or an invalid endpoint if not found
+     */
+    BusEndpoint FindEndpoint(const char* busName) const;
+
+    /**
+     * Find an endpoint for a given unique or alias bus name by searching the
+     * name tables under the lock instead of the snapshot. Unlike FindEndpoint
+     * this sees changes that have not been published yet.
+     *
+     * @param busName   Name of bus.
+     * @return  Returns the endpoint if it was found or an invalid endpoint if not found
+     */
+    BusEndpoint FindEndpointLocked(const qcc::String& busName) const;
 
     /**
      * Get all bus names from name table.
@@ -203,12 +235,20 @@ class NameTable {
     /**
      * Lock table.
      */
-    void Lock() { lock.Lock(MUTEX_CONTEXT); }
+    void Lock() const
+    {
+        LockOrderChecker::Acquiring(LOCK_RANK_NAME_TABLE, "name table");
+        lock.Lock(MUTEX_CONTEXT);
+    }
 
     /**
-     * Lock table.
+     * Unlock table.
      */
-    void Unlock() { lock.Unlock(MUTEX_CONTEXT); }
+    void Unlock() const
+    {
+        lock.Unlock(MUTEX_CONTEXT);
+        LockOrderChecker::Released(LOCK_RANK_NAME_TABLE);
+    }
 
   private:
     typedef struct {
@@ -231,6 +271,27 @@ class NameTable {
         }
     };
 
+    /** Number of buckets in a snapshot, must be a power of 2 */
+    static const size_t SNAPSHOT_BUCKETS = 256;
+
+    /**
+     * Unique and alias names whose hash selects this bucket mapped to the
+     * endpoint that messages sent to the name are delivered to. A bucket is
+     * never modified once it is part of a published snapshot.
+     */
+    struct SnapshotBucket {
+        std::unordered_map<qcc::StringMapKey, BusEndpoint> names;
+        uint32_t refs;    /**< Number of snapshots using this bucket, only accessed with the lock held */
+    };
+
+    /**
+     * Every unique and alias name mapped to the endpoint that messages sent to
+     * the name are delivered to.
+     */
+    struct Snapshot {
+        SnapshotBucket* buckets[SNAPSHOT_BUCKETS];
+    };
+
     mutable qcc::Mutex lock;                                             /**< Lock protecting name tables */
     std::unordered_map<qcc::String, BusEndpoint, Hash, Equal> uniqueNames;   /**< Unique name table */
     std::unordered_map<qcc::String, std::deque<NameQueueEntry>, Hash, Equal> aliasNames;  /**< Alias name table */
@@ -241,6 +302,55 @@ class NameTable {
     std::set<ProtectedNameListener> listeners;                         /**< Listeners regsitered with name table */
     std::map<qcc::StringMapKey, VirtualEndpoint> virtualAliasNames;    /**< map of virtual aliases to virtual endpts */
 
+    Snapshot* volatile snapshots[2];        /**< Current snapshot is snapshots[version & 1], the other is the previous one */
+    volatile int32_t version;               /**< Incremented each time a snapshot is published */
+    mutable volatile int32_t readers[2];    /**< Number of lookups using each of the snapshot slots */
+    std::vector<Snapshot*> retired[2];      /**< Replaced snapshots waiting for the readers of their slot to finish */
+    std::set<qcc::String> changedNames;     /**< Names changed since the last snapshot was published */
+
+    /**
+     * Record that the endpoint a name resolves to may have changed. Must be
+     * called with the lock held, the change is visible to lookups once the
+     * snapshot is published.
+     *
+     * @param name   Unique or alias name that changed.
+     */
+    void NameChanged(const qcc::String& name) { changedNames.insert(name); }
+
+    /**
+     * Publish a snapshot in which the buckets holding the changed names are
+     * replaced by updated copies. Must be called with the lock held once a
+     * set of changes to the name tables is complete. Never waits for
+     * lookups, the snapshot that is replaced is freed by a later call once
+     * the lookups that may be using it have finished.
+     */
+    void PublishSnapshot();
+
+    /**
+     * Free the retired snapshots of each slot that has no lookups in
+     * progress. Must be called with the lock held.
+     */
+    void FreeRetiredSnapshots();
+
+    /**
+     * Free a snapshot and the buckets no other snapshot is using. Must be
+     * called with the lock held.
+     *
+     * @param snapshot   Snapshot that no lookup can be using.
+     */
+    void ReleaseSnapshot(Snapshot* snapshot);
+
+    /**
+     * Remove the primary owner of an alias, promoting the next queued owner if
+     * it is still connected. Must be called with the lock held. The alias is
+     * marked as changed, the caller is responsible for publishing the snapshot
+     * and calling the listeners.
+     *
+     * @param it   Alias whose primary owner is removed. Erased if no new local owner remains.
+     * @return  Unique name of the new owner of the alias or empty if there is none.
+     */
+    qcc::String RemovePrimaryOwner(std::unordered_map<qcc::String, std::deque<NameQueueEntry>, Hash, Equal>::iterator it);
+
     /**
      * Helper used to call the listners
      *
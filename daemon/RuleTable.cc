@@ -21,6 +21,7 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 
+#include <algorithm>
 #include <cstring>
 
 #include "RuleTable.h"
@@ -141,11 +142,126 @@ qcc::String Rule::ToString() const
     return "s:" + sender + " i:" + iface + " m:" + member + " p:" + path + " d:" + destination;
 }
 
+RuleTable::~RuleTable()
+{
+    unordered_map<const char*, InternedString*, Hash, Equal>::iterator it = interned.begin();
+    while (it != interned.end()) {
+        delete it->second;
+        ++it;
+    }
+}
+
+const char* RuleTable::Intern(const qcc::String& str)
+{
+    if (str.empty()) {
+        return NULL;
+    }
+    InternedString* is;
+    unordered_map<const char*, InternedString*, Hash, Equal>::iterator it = interned.find(str.c_str());
+    if (it == interned.end()) {
+        is = new InternedString(str);
+        interned[is->str.c_str()] = is;
+    } else {
+        is = it->second;
+    }
+    ++is->refs;
+    return is->str.c_str();
+}
+
+void RuleTable::Release(const char* str)
+{
+    if (str) {
+        unordered_map<const char*, InternedString*, Hash, Equal>::iterator it = interned.find(str);
+        if ((it != interned.end()) && (--it->second->refs == 0)) {
+            InternedString* is = it->second;
+            interned.erase(it);
+            delete is;
+        }
+    }
+}
+
+const char* RuleTable::FindInterned(const char* str) const
+{
+    if (!str || (str[0] == '\0')) {
+        return NULL;
+    }
+    unordered_map<const char*, InternedString*, Hash, Equal>::const_iterator it = interned.find(str);
+    return (it == interned.end()) ? NULL : it->second->str.c_str();
+}
+
+void RuleTable::IndexRule(const BusEndpoint& endpoint, Rule& rule)
+{
+    BucketKey key(Intern(rule.iface), Intern(rule.member));
+    ruleIndex[key].push_back(IndexEntry(endpoint, &rule));
+}
+
+void RuleTable::UnindexRule(Rule& rule)
+{
+    BucketKey key(FindInterned(rule.iface.c_str()), FindInterned(rule.member.c_str()));
+    unordered_map<BucketKey, RuleList, BucketHash>::iterator bit = ruleIndex.find(key);
+    if (bit != ruleIndex.end()) {
+        RuleList& list = bit->second;
+        for (RuleList::iterator it = list.begin(); it != list.end(); ++it) {
+            if (it->rule == &rule) {
+                list.erase(it);
+                break;
+            }
+        }
+        if (list.empty()) {
+            ruleIndex.erase(bit);
+        }
+    }
+    Release(key.iface);
+    Release(key.member);
+}
+
+void RuleTable::MatchBucket(const BucketKey& key, const Message& msg, std::vector<BusEndpoint>& matches)
+{
+    unordered_map<BucketKey, RuleList, BucketHash>::iterator bit = ruleIndex.find(key);
+    if (bit != ruleIndex.end()) {
+        for (RuleList::iterator it = bit->second.begin(); it != bit->second.end(); ++it) {
+            if (it->rule->IsMatch(msg)) {
+                matches.push_back(it->endpoint);
+            }
+        }
+    }
+}
+
+void RuleTable::FindMatchingEndpoints(const Message& msg, std::vector<BusEndpoint>& matches)
+{
+    matches.clear();
+    Lock();
+    /*
+     * An interface or member that has never been interned cannot appear in any rule so only
+     * the wildcard buckets need to be checked for that field.
+     */
+    const char* iface = FindInterned(msg->GetInterface());
+    const char* member = FindInterned(msg->GetMemberName());
+    if (iface && member) {
+        MatchBucket(BucketKey(iface, member), msg, matches);
+    }
+    if (iface) {
+        MatchBucket(BucketKey(iface, NULL), msg, matches);
+    }
+    if (member) {
+        MatchBucket(BucketKey(NULL, member), msg, matches);
+    }
+    MatchBucket(BucketKey(NULL, NULL), msg, matches);
+    Unlock();
+
+    /* An endpoint with more than one matching rule only gets the message once */
+    if (matches.size() > 1) {
+        sort(matches.begin(), matches.end());
+        matches.erase(unique(matches.begin(), matches.end()), matches.end());
+    }
+}
+
 QStatus RuleTable::AddRule(BusEndpoint& endpoint, const Rule& rule)
 {
     QCC_DbgPrintf(("AddRule for endpoint %s\n  %s", endpoint->GetUniqueName().c_str(), rule.ToString().c_str()));
     Lock();
-    rules.insert(std::pair<BusEndpoint, Rule>(endpoint, rule));
+    RuleIterator it = rules.insert(std::pair<BusEndpoint, Rule>(endpoint, rule));
+    IndexRule(endpoint, it->second);
     Unlock();
     return ER_OK;
 }
@@ -154,10 +270,10 @@ QStatus RuleTable::RemoveRule(BusEndpoint& endpoint, Rule& rule)
 {
     Lock();
 
-    //std::pair<std::multimap<BusEndpoint, Rule>::const_iterator, RuleIterator> range = rules.equal_range(endpoint);
     std::pair<RuleIterator, RuleIterator> range = rules.equal_range(endpoint);
     while (range.first != range.second) {
         if (range.first->second == rule) {
+            UnindexRule(range.first->second);
             rules.erase(range.first);
             break;
         }
@@ -172,6 +288,9 @@ QStatus RuleTable::RemoveAllRules(BusEndpoint& endpoint)
     Lock();
     std::pair<RuleIterator, RuleIterator> range = rules.equal_range(endpoint);
     if (range.first != rules.end()) {
+        for (RuleIterator it = range.first; it != range.second; ++it) {
+            UnindexRule(it->second);
+        }
         rules.erase(range.first, range.second);
     }
     Unlock();
@@ -27,9 +27,11 @@
 #include <qcc/platform.h>
 
 #include <map>
+#include <vector>
 
 #include <qcc/String.h>
 #include <qcc/Mutex.h>
+#include <qcc/Util.h>
 
 #include <alljoyn/Message.h>
 
@@ -37,6 +39,8 @@
 
 #include <alljoyn/Status.h>
 
+#include <qcc/STLContainer.h>
+
 namespace ajn {
 
 /**
@@ -115,6 +119,16 @@ typedef std::multimap<BusEndpoint, Rule>::iterator RuleIterator;
 class RuleTable {
   public:
 
+    /**
+     * Constructor
+     */
+    RuleTable() { }
+
+    /**
+     * Destructor
+     */
+    ~RuleTable();
+
     /**
      * Add a rule for an endpoint.
      *
@@ -202,9 +216,132 @@ class RuleTable {
         return ret;
     }
 
+    /**
+     * Find all endpoints that have at least one rule matching a message.
+     *
+     * Rules are indexed by interface and member so only the rules that could possibly match
+     * the message are evaluated. The cost of this call grows with the number of candidate
+     * rules rather than with the total number of rules in the table. This method obtains the
+     * rule table lock internally.
+     *
+     * @param msg       Message to be matched.
+     * @param matches   [OUT] Endpoints with a matching rule. Each endpoint appears once.
+     */
+    void FindMatchingEndpoints(const Message& msg, std::vector<BusEndpoint>& matches);
+
   private:
+
+    /**
+     * Copy constructor and assignment are private and not implemented.
+     */
+    RuleTable(const RuleTable& other);
+    RuleTable& operator=(const RuleTable& other);
+
+    /**
+     * An entry in the rule index. The rule pointer refers to the rule stored in the rules
+     * multimap and is valid for as long as the rule is in the table.
+     */
+    struct IndexEntry {
+        BusEndpoint endpoint;
+        Rule* rule;
+
+        IndexEntry(const BusEndpoint& endpoint, Rule* rule) : endpoint(endpoint), rule(rule) { }
+    };
+
+    /**
+     * Index bucket key. Both fields are interned strings, NULL is used as the wildcard for
+     * rules that do not specify an interface or a member.
+     */
+    struct BucketKey {
+        const char* iface;
+        const char* member;
+
+        BucketKey(const char* iface, const char* member) : iface(iface), member(member) { }
+
+        bool operator==(const BucketKey& other) const { return (iface == other.iface) && (member == other.member); }
+    };
+
+    /**
+     * Hash functor for bucket keys. Since the keys are interned the pointers are hashed directly.
+     */
+    struct BucketHash {
+        inline size_t operator()(const BucketKey& k) const {
+            return (reinterpret_cast<size_t>(k.iface) * 31) ^ reinterpret_cast<size_t>(k.member);
+        }
+    };
+
+    /**
+     * Hash functor for the intern table
+     */
+    struct Hash {
+        inline size_t operator()(const char* s) const {
+            return qcc::hash_string(s);
+        }
+    };
+
+    /**
+     * Equality functor for the intern table
+     */
+    struct Equal {
+        inline bool operator()(const char* s1, const char* s2) const {
+            return (s1 == s2) || (strcmp(s1, s2) == 0);
+        }
+    };
+
+    /**
+     * A reference counted interned string. The key in the intern table points to str.
+     */
+    struct InternedString {
+        qcc::String str;
+        uint32_t refs;
+
+        InternedString(const qcc::String& str) : str(str), refs(0) { }
+    };
+
+    /**
+     * Intern a string adding a reference to it.
+     *
+     * @param str   The string to intern.
+     * @return  The interned string or NULL if str is empty.
+     */
+    const char* Intern(const qcc::String& str);
+
+    /**
+     * Release a reference to an interned string.
+     *
+     * @param str   The interned string (may be NULL).
+     */
+    void Release(const char* str);
+
+    /**
+     * Lookup an interned string without adding a reference.
+     *
+     * @param str   String to look for.
+     * @return  The interned string or NULL if str is empty or has not been interned.
+     */
+    const char* FindInterned(const char* str) const;
+
+    /**
+     * Add a rule to the index. Caller must hold the lock.
+     */
+    void IndexRule(const BusEndpoint& endpoint, Rule& rule);
+
+    /**
+     * Remove a rule from the index. Caller must hold the lock.
+     */
+    void UnindexRule(Rule& rule);
+
+    /**
+     * Add the endpoints of the rules in a bucket that match a message.
+     */
+    void MatchBucket(const BucketKey& key, const Message& msg, std::vector<BusEndpoint>& matches);
+
+    typedef std::vector<IndexEntry> RuleList;
+
     qcc::Mutex lock;                            /**< Lock protecting rule table */
     std::multimap<BusEndpoint, Rule> rules;    /**< Rule table */
+    std::unordered_map<const char*, InternedString*, Hash, Equal> interned;  /**< Interned interface and member names */
+    std::unordered_map<BucketKey, RuleList, BucketHash> ruleIndex;          /**< Rules bucketed by interface and member */
 };
 
 }
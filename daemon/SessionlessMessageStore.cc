@@ -0,0 +1,187 @@
+/**
+ * @file
+ * Implementation of the store for cached sessionless signals.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <qcc/Debug.h>
+#include <qcc/time.h>
+
+#include "SessionlessMessageStore.h"
+
+#define QCC_MODULE "SESSIONLESS"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/*
+ * Stale heap entries are left behind when signals are replaced or removed. The heap is rebuilt
+ * when they outnumber the live entries by this factor.
+ */
+static const size_t STALE_EXPIRY_FACTOR = 2;
+static const size_t MIN_EXPIRY_COMPACT = 64;
+
+SessionlessMessageStore::SessionlessMessageStore() : nextGeneration(0)
+{
+}
+
+void SessionlessMessageStore::Add(Message& msg, uint32_t changeId)
+{
+    Key key(msg->GetSender(), msg->GetInterface(), msg->GetMemberName(), msg->GetObjectPath());
+
+    MessageMap::iterator it = messages.find(key);
+    if (it != messages.end()) {
+        Erase(it);
+    }
+    uint64_t generation = nextGeneration++;
+    it = messages.insert(pair<Key, Entry>(key, Entry(changeId, msg, generation))).first;
+    it->second.key = &it->first;
+    it->second.indexPos = byChangeId.insert(pair<uint32_t, Entry*>(changeId, &it->second));
+
+    uint32_t tilExpire;
+    msg->IsExpired(&tilExpire);
+    if (tilExpire != numeric_limits<uint32_t>::max()) {
+        expiryHeap.push(Expiry(GetTimestamp64() + tilExpire, generation, key));
+        CompactExpiryHeap();
+    }
+}
+
+bool SessionlessMessageStore::Remove(const qcc::String& sender, uint32_t serialNum, bool& expired)
+{
+    Key key(sender.c_str(), "", "", "");
+    MessageMap::iterator it = messages.lower_bound(key);
+    while ((it != messages.end()) && (sender == it->second.msg->GetSender())) {
+        if (it->second.msg->GetCallSerial() == serialNum) {
+            expired = it->second.msg->IsExpired();
+            Erase(it);
+            return true;
+        }
+        ++it;
+    }
+    return false;
+}
+
+size_t SessionlessMessageStore::RemoveSender(const qcc::String& sender)
+{
+    size_t count = 0;
+    Key key(sender.c_str(), "", "", "");
+    MessageMap::iterator it = messages.lower_bound(key);
+    while ((it != messages.end()) && (sender == it->second.msg->GetSender())) {
+        Erase(it++);
+        ++count;
+    }
+    return count;
+}
+
+size_t SessionlessMessageStore::GetRange(uint32_t fromId, uint32_t len, std::vector<Message>& msgs)
+{
+    size_t numExpired = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+    /*
+     * A range that wraps around is split into [fromId, max] and [0, toId)
+     */
+    uint32_t toId = fromId + len;
+    bool wraps = (toId < fromId);
+    ChangeIdIndex::iterator it = byChangeId.lower_bound(fromId);
+    for (int pass = 0; pass < (wraps ? 2 : 1); ++pass) {
+        if (pass == 1) {
+            it = byChangeId.begin();
+        }
+        while ((it != byChangeId.end()) && ((pass == 0 && wraps) || (it->first < toId))) {
+            Entry* entry = (it++)->second;
+            if (entry->msg->IsExpired()) {
+                Erase(messages.find(*entry->key));
+                ++numExpired;
+            } else {
+                msgs.push_back(entry->msg);
+            }
+        }
+    }
+    return numExpired;
+}
+
+size_t SessionlessMessageStore::PurgeExpired(uint32_t& nextExpire)
+{
+    size_t count = 0;
+    uint64_t now = GetTimestamp64();
+
+    nextExpire = numeric_limits<uint32_t>::max();
+    while (!expiryHeap.empty()) {
+        const Expiry& top = expiryHeap.top();
+        MessageMap::iterator it = messages.find(top.key);
+        if ((it == messages.end()) || (it->second.generation != top.generation)) {
+            /* The signal was replaced or removed */
+            expiryHeap.pop();
+            continue;
+        }
+        /*
+         * The heap time is only a hint, the message decides when it has expired. A message that
+         * has not yet expired goes back on the heap with its current expiry time.
+         */
+        uint32_t tilExpire;
+        if (top.expireTime > now) {
+            nextExpire = (uint32_t)(std::min)(top.expireTime - now, (uint64_t)numeric_limits<uint32_t>::max());
+            break;
+        }
+        if (it->second.msg->IsExpired(&tilExpire)) {
+            expiryHeap.pop();
+            Erase(it);
+            ++count;
+        } else {
+            Expiry retry(now + tilExpire, top.generation, top.key);
+            expiryHeap.pop();
+            expiryHeap.push(retry);
+        }
+    }
+    return count;
+}
+
+void SessionlessMessageStore::Erase(MessageMap::iterator it)
+{
+    byChangeId.erase(it->second.indexPos);
+    messages.erase(it);
+}
+
+void SessionlessMessageStore::CompactExpiryHeap()
+{
+    if ((expiryHeap.size() < MIN_EXPIRY_COMPACT) || (expiryHeap.size() < (STALE_EXPIRY_FACTOR * messages.size()))) {
+        return;
+    }
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > live;
+    while (!expiryHeap.empty()) {
+        const Expiry& top = expiryHeap.top();
+        MessageMap::iterator it = messages.find(top.key);
+        if ((it != messages.end()) && (it->second.generation == top.generation)) {
+            live.push(top);
+        }
+        expiryHeap.pop();
+    }
+    expiryHeap = live;
+}
+
+}
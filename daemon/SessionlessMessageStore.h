@@ -0,0 +1,178 @@
+/**
+ * @file
+ * SessionlessMessageStore holds the sessionless signals cached by SessionlessObj.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_SESSIONLESSMESSAGESTORE_H
+#define _ALLJOYN_SESSIONLESSMESSAGESTORE_H
+
+#include <qcc/platform.h>
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+
+#include <qcc/String.h>
+
+#include <alljoyn/Message.h>
+
+namespace ajn {
+
+/**
+ * Store for sessionless signals waiting to be delivered to remote daemons. A stored signal
+ * replaces any earlier signal with the same sender, interface, member and object path.
+ *
+ * Besides the primary map the store keeps an index ordered by change id so a range request only
+ * visits the signals in the range, and a min-heap of expiry times so expired signals are purged
+ * without walking the whole store.
+ *
+ * The store is not thread-safe, callers must provide their own locking.
+ */
+class SessionlessMessageStore {
+  public:
+
+    /**
+     * Constructor
+     */
+    SessionlessMessageStore();
+
+    /**
+     * Add a signal to the store replacing any signal from the same sender with the same
+     * interface, member and object path.
+     *
+     * @param msg        The sessionless signal.
+     * @param changeId   The change id the signal was stored under.
+     */
+    void Add(Message& msg, uint32_t changeId);
+
+    /**
+     * Remove the signal with a given serial number.
+     *
+     * @param sender      Unique name of the sender of the signal.
+     * @param serialNum   Serial number of the signal.
+     * @param expired     [OUT] Set to true if the signal had already expired.
+     *
+     * @return true if the signal was found and removed.
+     */
+    bool Remove(const qcc::String& sender, uint32_t serialNum, bool& expired);
+
+    /**
+     * Remove all signals from a sender.
+     *
+     * @param sender   Unique name of the sender.
+     *
+     * @return  The number of signals removed.
+     */
+    size_t RemoveSender(const qcc::String& sender);
+
+    /**
+     * Get the unexpired signals with a change id in the range [fromId, fromId + len) ordered by
+     * change id. The range may wrap around. Expired signals found in the range are removed.
+     *
+     * @param fromId      Beginning of the change id range (inclusive).
+     * @param len         Length of the change id range.
+     * @param msgs        [OUT] The signals in the range are appended to this vector.
+     *
+     * @return  The number of expired signals that were removed.
+     */
+    size_t GetRange(uint32_t fromId, uint32_t len, std::vector<Message>& msgs);
+
+    /**
+     * Remove the signals whose time-to-live has expired.
+     *
+     * @param nextExpire   [OUT] Milliseconds until the next signal expires or
+     *                     numeric_limits<uint32_t>::max() if no signal has a time-to-live.
+     *
+     * @return  The number of signals removed.
+     */
+    size_t PurgeExpired(uint32_t& nextExpire);
+
+    /**
+     * Get the largest change id of the stored signals.
+     *
+     * @return  The largest change id or 0 if the store is empty.
+     */
+    uint32_t GetMaxChangeId() const { return byChangeId.empty() ? 0 : byChangeId.rbegin()->first; }
+
+    /**
+     * Check if the store is empty.
+     */
+    bool IsEmpty() const { return messages.empty(); }
+
+    /**
+     * Get the number of stored signals.
+     */
+    size_t Size() const { return messages.size(); }
+
+  private:
+
+    /* Key for the primary map, signals are grouped by sender */
+    class Key : public qcc::String {
+      public:
+        Key(const char* sender, const char* iface, const char* member, const char* objPath) :
+            qcc::String(sender, 0, ::strlen(sender) + ::strlen(iface) + ::strlen(member) + ::strlen(objPath) + 4)
+        {
+            append(':');
+            append(iface);
+            append(':');
+            append(member);
+            append(':');
+            append(objPath);
+        }
+    };
+
+    struct Entry;
+    typedef std::multimap<uint32_t, Entry*> ChangeIdIndex;
+
+    /* A stored signal */
+    struct Entry {
+        uint32_t changeId;                   /**< Change id the signal was stored under */
+        Message msg;                         /**< The signal */
+        uint64_t generation;                 /**< Distinguishes this signal from earlier signals with the same key */
+        const Key* key;                      /**< Key of this signal in the primary map */
+        ChangeIdIndex::iterator indexPos;    /**< Position of this signal in the change id index */
+        Entry(uint32_t changeId, const Message& msg, uint64_t generation) : changeId(changeId), msg(msg), generation(generation), key(NULL) { }
+    };
+
+    typedef std::map<Key, Entry> MessageMap;
+
+    /*
+     * An expiry time on the heap. Removing or replacing a signal leaves its heap entry in place,
+     * stale entries are recognized by the generation and dropped when they reach the top.
+     */
+    struct Expiry {
+        uint64_t expireTime;                 /**< Absolute expiry time in milliseconds */
+        uint64_t generation;                 /**< Generation of the signal this entry was created for */
+        Key key;                             /**< Key of the signal */
+        Expiry(uint64_t expireTime, uint64_t generation, const Key& key) : expireTime(expireTime), generation(generation), key(key) { }
+        bool operator>(const Expiry& other) const { return expireTime > other.expireTime; }
+    };
+
+    void Erase(MessageMap::iterator it);
+    void CompactExpiryHeap();
+
+    MessageMap messages;                                                                  /**< Signals by key */
+    ChangeIdIndex byChangeId;                                                             /**< Signals by change id */
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > expiryHeap;   /**< Expiry times, soonest first */
+    uint64_t nextGeneration;                                                              /**< Generation for the next stored signal */
+};
+
+}
+
+#endif
@@ -83,7 +83,7 @@ SessionlessObj::SessionlessObj(Bus& bus, BusController* busController) :
     requestSignalsSignal(NULL),
     requestRangeSignal(NULL),
     timer("sessionless"),
-    messageMap(),
+    messageStore(),
     ruleCountMap(),
     changeIdMap(),
     lock(),
@@ -92,7 +92,8 @@ SessionlessObj::SessionlessObj(Bus& bus, BusController* busController) :
     isDiscoveryStarted(false),
     sessionOpts(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY),
     sessionPort(SESSIONLESS_SESSION_PORT),
-    advanceChangeId(false)
+    advanceChangeId(false),
+    purgeTimestamp(0)
 {
     /* Initialize findPrefix */
     findPrefix = WellKnownName;
@@ -270,7 +271,7 @@ void SessionlessObj::AddRule(const qcc::String& epName, Rule& rule)
              * this client (implicitly) if this daemon has previously received
              * sessionless signals for any client.
              */
-            if (!changeIdMap.empty() || !messageMap.empty()) {
+            if (!changeIdMap.empty() || !messageStore.IsEmpty()) {
                 lock.Unlock();
                 RereceiveMessages(epName, "");
                 lock.Lock();
@@ -326,17 +327,10 @@ QStatus SessionlessObj::PushMessage(Message& msg)
         return ER_FAIL;
     }
 
-    /* Put the message in the map and kick the worker */
-    MessageMapKey key(msg->GetSender(), msg->GetInterface(), msg->GetMemberName(), msg->GetObjectPath());
+    /* Put the message in the store and kick the worker */
     lock.Lock();
     advanceChangeId = true;
-    pair<uint32_t, Message> val(curChangeId, msg);
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.find(key);
-    if (it == messageMap.end()) {
-        messageMap.insert(pair<MessageMapKey, pair<uint32_t, Message> >(key, val));
-    } else {
-        it->second = val;
-    }
+    messageStore.Add(msg, curChangeId);
     lock.Unlock();
     uint32_t zero = 0;
     SessionlessObj* slObj = this;
@@ -391,18 +385,10 @@ QStatus SessionlessObj::CancelMessage(const qcc::String& sender, uint32_t serial
     QCC_DbgTrace(("SessionlessObj::CancelMessage(%s, 0x%x)", sender.c_str(), serialNum));
 
     lock.Lock();
-    MessageMapKey key(sender.c_str(), "", "", "");
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.lower_bound(key);
-    while ((it != messageMap.end()) && (sender == it->second.second->GetSender())) {
-        if (it->second.second->GetCallSerial() == serialNum) {
-            if (!it->second.second->IsExpired()) {
-                status = ER_OK;
-            }
-            messageMap.erase(it);
-            messageErased = true;
-            break;
-        }
-        ++it;
+    bool expired = false;
+    messageErased = messageStore.Remove(sender, serialNum, expired);
+    if (messageErased && !expired) {
+        status = ER_OK;
     }
     lock.Unlock();
 
@@ -498,13 +484,10 @@ void SessionlessObj::NameOwnerChanged(const String& name,
         }
 
         /* Remove stored sessionless messages sent by toldOwner */
-        MessageMapKey key(oldOwner->c_str(), "", "", "");
-        map<MessageMapKey, pair<uint32_t, Message> >::iterator mit = messageMap.lower_bound(key);
-        while ((mit != messageMap.end()) && (::strcmp(oldOwner->c_str(), mit->second.second->GetSender()) == 0)) {
-            messageMap.erase(mit++);
-        }
-        /* Alert the advertiser worker if messageMap is empty */
-        if (messageMap.empty()) {
+        messageStore.RemoveSender(*oldOwner);
+
+        /* Alert the advertiser worker if messageStore is empty */
+        if (messageStore.IsEmpty()) {
             uint32_t zero = 0;
             SessionlessObj* slObj = this;
             QStatus status = timer.AddAlarm(Alarm(zero, slObj));
@@ -689,7 +672,6 @@ void SessionlessObj::RequestRangeSignalHandler(const InterfaceDescription::Membe
 void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sessionId, uint32_t fromChangeId, uint32_t toChangeId)
 {
     QStatus status = ER_OK;
-    bool messageErased = false;
     QCC_DbgTrace(("SessionlessObj::HandleControlSignal(%d, %d)", fromChangeId, toChangeId));
 
     /* Enable concurrency since PushMessage could block */
@@ -702,42 +684,42 @@ void SessionlessObj::HandleRangeRequest(const char* sender, SessionId sessionId,
         advanceChangeId = false;
     }
 
-    /* Send all messages in messageMap in range [fromChangeId, toChangeId) */
-    map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.begin();
-    uint32_t rangeLen = toChangeId - fromChangeId;
-    while (it != messageMap.end()) {
-        if (IN_WINDOW(uint32_t, fromChangeId, rangeLen, it->second.first)) {
-            MessageMapKey key = it->first;
-            if (it->second.second->IsExpired()) {
-                /* Remove expired message without sending */
-                messageMap.erase(it++);
-                messageErased = true;
-            } else {
-                /* Send message */
-                lock.Unlock();
-                router.LockNameTable();
-                BusEndpoint ep = router.FindEndpoint(sender);
-                if (ep->IsValid()) {
-                    router.UnlockNameTable();
-                    if (ep->GetEndpointType() == ENDPOINT_TYPE_VIRTUAL) {
-                        status = VirtualEndpoint::cast(ep)->PushMessage(it->second.second, sessionId);
-                    } else {
-                        status = ep->PushMessage(it->second.second);
-                    }
+    /* Take the unexpired messages in range [fromChangeId, toChangeId) in change id order */
+    vector<Message> msgs;
+    bool messageErased = (messageStore.GetRange(fromChangeId, toChangeId - fromChangeId, msgs) > 0);
+    lock.Unlock();
+
+    /*
+     * Send the messages as a single batch. The destination is resolved once and the messages
+     * are queued on the endpoint with one wake-up of its writer. A batch stops at the first
+     * message that cannot be sent; as when each message was pushed on its own that message is
+     * skipped and the rest of the range is still sent.
+     */
+    if (!msgs.empty()) {
+        router.LockNameTable();
+        BusEndpoint ep = router.FindEndpoint(sender);
+        router.UnlockNameTable();
+        if (ep->IsValid()) {
+            EndpointType epType = ep->GetEndpointType();
+            size_t next = 0;
+            while (next < msgs.size()) {
+                size_t numSent;
+                if (epType == ENDPOINT_TYPE_VIRTUAL) {
+                    status = VirtualEndpoint::cast(ep)->PushMessages(&msgs[next], msgs.size() - next, sessionId, numSent);
+                } else if ((epType == ENDPOINT_TYPE_REMOTE) || (epType == ENDPOINT_TYPE_BUS2BUS)) {
+                    status = RemoteEndpoint::cast(ep)->PushMessages(&msgs[next], msgs.size() - next, numSent);
                 } else {
-                    router.UnlockNameTable();
+                    status = ep->PushMessage(msgs[next]);
+                    numSent = (status == ER_OK) ? 1 : 0;
+                }
+                next += numSent;
+                if (status != ER_OK) {
+                    QCC_LogError(status, ("Failed to push sessionless signal to %s", sender));
+                    ++next;
                 }
-                lock.Lock();
-                it = messageMap.upper_bound(key);
-            }
-            if (status != ER_OK) {
-                QCC_LogError(status, ("Failed to push sessionless signal to %s", sender));
             }
-        } else {
-            ++it;
         }
     }
-    lock.Unlock();
 
     /* Alert the advertiser worker */
     if (messageErased) {
@@ -764,23 +746,24 @@ void SessionlessObj::AlarmTriggered(const Alarm& alarm, QStatus reason)
 
     if (reason == ER_OK) {
         uint32_t tilExpire = ::numeric_limits<uint32_t>::max();
-        uint32_t expire;
-        uint32_t maxChangeId = 0;
-        bool mapIsEmpty = true;
+        uint32_t nextExpire;
 
-        /* Purge the messageMap of expired messages */
+        /*
+         * Purge expired messages. Only messages that have reached their expiry time are visited,
+         * the alarm is rearmed for the next one to expire.
+         */
         lock.Lock();
-        map<MessageMapKey, pair<uint32_t, Message> >::iterator it = messageMap.begin();
-        while (it != messageMap.end()) {
-            if (it->second.second->IsExpired(&expire)) {
-                messageMap.erase(it++);
-            } else {
-                maxChangeId = max(maxChangeId, it->second.first);
-                mapIsEmpty = false;
-                ++it;
+        messageStore.PurgeExpired(nextExpire);
+        uint32_t maxChangeId = messageStore.GetMaxChangeId();
+        bool mapIsEmpty = messageStore.IsEmpty();
+        lock.Unlock();
+        if (nextExpire != ::numeric_limits<uint32_t>::max()) {
+            uint64_t now = GetTimestamp64();
+            if ((purgeTimestamp <= now) || ((now + nextExpire) < purgeTimestamp)) {
+                purgeTimestamp = now + nextExpire + 1;
+                tilExpire = nextExpire + 1;
             }
         }
-        lock.Unlock();
 
         /* Change advertisment if map is empty or if maxChangeId > lastAdvChangeId */
         if (mapIsEmpty || IS_GREATER(uint32_t, maxChangeId, lastAdvChangeId)) {
@@ -39,6 +39,7 @@
 #include "DaemonRouter.h"
 #include "NameTable.h"
 #include "RuleTable.h"
+#include "SessionlessMessageStore.h"
 #include "Transport.h"
 
 namespace ajn {
@@ -261,23 +262,8 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
 
     qcc::Timer timer;                     /**< Timer object for reaping expired names */
 
-    /* Class used as key for messageMap */
-    class MessageMapKey : public qcc::String {
-      public:
-        MessageMapKey(const char* sender, const char* iface, const char* member, const char* objPath) :
-            qcc::String(sender, 0, ::strlen(sender) + ::strlen(iface) + ::strlen(member) + ::strlen(objPath) + 4)
-        {
-            append(':');
-            append(iface);
-            append(':');
-            append(member);
-            append(':');
-            append(objPath);
-        }
-    };
-
     /** Storage for sessionless messages waiting to be delivered */
-    std::map<MessageMapKey, std::pair<uint32_t, Message> > messageMap;
+    SessionlessMessageStore messageStore;
 
     /** Count the number of rules (per endpoint) that specify sesionless=TRUE */
     std::map<qcc::String, uint32_t> ruleCountMap;
@@ -312,7 +298,7 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
     /** Map remote guid to ChangeIdEntry */
     std::map<qcc::String, ChangeIdEntry> changeIdMap;
 
-    qcc::Mutex lock;            /**< Mutex that protects messageMap this obj's data structures */
+    qcc::Mutex lock;            /**< Mutex that protects messageStore and this obj's data structures */
     uint32_t curChangeId;       /**< Change id assoc with current pushed signal(s) */
     uint32_t lastAdvChangeId;   /**< Last advertised change id */
     qcc::String lastAdvName;    /**< Last advertised name */
@@ -322,6 +308,7 @@ class SessionlessObj : public BusObject, public NameListener, public SessionList
     SessionOpts sessionOpts;    /**< SessionOpts used by internal session */
     SessionPort sessionPort;    /**< SessionPort used by internal session */
     bool advanceChangeId;       /**< Set to true when changeId should be advanced on next SLS send request */
+    uint64_t purgeTimestamp;    /**< Time of the alarm armed to purge the next expiring message */
 };
 
 }
@@ -26,6 +26,7 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/IfConfig.h>
+#include <qcc/IODispatch.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/TransportMask.h>
@@ -40,6 +41,10 @@
 #include "ns/IpNameService.h"
 #include "TCPTransport.h"
 
+#if defined(QCC_OS_GROUP_POSIX)
+#include <sys/select.h>
+#endif
+
 /*
  * How the transport fits into the system
  * ======================================
@@ -282,34 +287,33 @@
  * that an endpoint is not brought up immediately, but an authentication step
  * must be performed.  The server accept loop starts this process by placing the
  * new TCPEndpoint on an authList, or list of authenticating endpoints.
- * It then calls the endpoint Authenticate() method which spins up an
- * authentication thread and returns immediately.  This process transfers the
- * responsibility for the connection and its resources to the authentication
- * thread.  Authentication can succeed, fail, or take to long and be aborted.
- *
- * If authentication succeeds, the authentication thread calls back into the
- * TCPTransport's Authenticated() method.  Along with indicating that
- * authentication has completed successfully, this transfers ownership of the
- * TCPEndpoint back to the TCPTransport from the authentication
- * thread.  At this time, the TCPEndpoint is Start()ed which spins up
- * the transmit and receive threads and enables Message routing across the
- * transport.
- *
- * If the authentication fails, the authentication thread simply sets a the
- * TCPEndpoint state to FAILED and exits.  The server accept loop looks at
- * authenticating endpoints (those on the authList)each time through its loop.
- * If an endpoint has failed authentication, and its thread has actually gone
- * away (or more precisely is at least going away in such a way that it will
- * never touch the endpoint data structure again).  This means that the endpoint
- * can be deleted.
+ * It then calls the endpoint Authenticate() method which registers the
+ * connection's stream with the bus IODispatch and returns immediately.  No
+ * thread is created for the connection.  Each time the client sends data, one
+ * of the small, fixed set of IODispatch threads runs the next step of the SASL
+ * conversation and the Hello exchange without blocking, and then goes back to
+ * serving other connections.  This process transfers the responsibility for
+ * the connection and its resources to the authentication callbacks.
+ * Authentication can succeed, fail, or take to long and be aborted.
+ *
+ * When authentication succeeds or fails, the callback sets the TCPEndpoint
+ * auth state to SUCCEEDED or FAILED and alerts the server accept loop, which
+ * looks at authenticating endpoints (those on the authList) each time through
+ * its loop.  It joins the stream so that no callback can touch the endpoint
+ * data structure again.  A failed endpoint can then be deleted.  A successful
+ * endpoint is handed to the TCPTransport's Authenticated() method which
+ * Start()s it, enabling Message routing across the transport.
  *
  * If the authentication takes "too long" we assume that a denial of service
- * attack in in progress.  We call AuthStop() on such an endpoint which will most
- * likely induce a failure (unless we happen to call abort just as the endpoint
+ * attack in in progress.  We call AuthStop() on such an endpoint which sets
+ * the FAILED state (unless we happen to call abort just as the endpoint
  * actually finishes the authentication which is highly unlikely but okay).
  * This AuthStop() will cause the endpoint to be scavenged using the above mechanism
  * the next time through the accept loop.
  *
+ * Since pending connections only cost their socket and authentication state,
+ * the daemon can afford to have thousands of them.
+ *
  * A daemon transport can accept incoming connections, and it can make outgoing
  * connections to another daemon.  This case is simpler than the accept case
  * since it is expected that a socket connect can block, so it is possible to do
@@ -408,22 +412,21 @@ const char* const TCPTransport::ALLJOYN_DEFAULT_ROUTER_ADVERTISEMENT_PREFIX = "o
 class _TCPEndpoint : public _RemoteEndpoint {
   public:
     /**
-     * There are three threads that can be running around in this data
-     * structure.  An auth thread is run before the endpoint is started in order
-     * to handle the security stuff that must be taken care of before messages
-     * can start passing.  This enum reflects the states of the authentication
-     * process and the state can be found in m_authState.  Once authentication
-     * is complete, the auth thread must go away, but it must also be joined,
-     * which is indicated by the AUTH_DONE state.  The other threads are the
-     * endpoint RX and TX threads, which are dealt with by the EndpointState.
+     * Authentication callbacks are run from IODispatch threads before the
+     * endpoint is started in order to handle the security stuff that must be
+     * taken care of before messages can start passing.  This enum reflects the
+     * states of the authentication process and the state can be found in
+     * m_authState.  Once authentication is complete, the callbacks must be
+     * joined, which is indicated by the AUTH_DONE state.  The endpoint RX and
+     * TX processing is dealt with by the EndpointState.
      */
     enum AuthState {
         AUTH_ILLEGAL = 0,
-        AUTH_INITIALIZED,    /**< This endpoint structure has been allocated but no auth thread has been run */
-        AUTH_AUTHENTICATING, /**< We have spun up an authentication thread and it has begun running our user function */
-        AUTH_FAILED,         /**< The authentication has failed and the authentication thread is exiting immidiately */
+        AUTH_INITIALIZED,    /**< This endpoint structure has been allocated but authentication has not started */
+        AUTH_AUTHENTICATING, /**< The stream is registered for authentication callbacks */
+        AUTH_FAILED,         /**< The authentication has failed and no further steps will be run */
         AUTH_SUCCEEDED,      /**< The auth process (Establish) has succeeded and the connection is ready to be started */
-        AUTH_DONE,           /**< The auth thread has been successfully shut down and joined */
+        AUTH_DONE,           /**< The authentication callbacks have been stopped and joined */
     };
 
     /**
@@ -472,7 +475,8 @@ class _TCPEndpoint : public _RemoteEndpoint {
         m_authState(AUTH_INITIALIZED),
         m_epState(EP_INITIALIZED),
         m_tStart(qcc::Timespec(0)),
-        m_authThread(this),
+        m_authDriver(this),
+        m_gotNul(false),
         m_stream(sock),
         m_ipAddr(ipAddr),
         m_port(port),
@@ -553,6 +557,16 @@ class _TCPEndpoint : public _RemoteEndpoint {
     bool IsSuddenDisconnect() { return m_wasSuddenDisconnect; }
     void SetSuddenDisconnect(bool val) { m_wasSuddenDisconnect = val; }
 
+#if defined(QCC_OS_GROUP_POSIX) && !defined(QCC_OS_DARWIN)
+    /**
+     * Write a batch of queued messages to the socket with a single sendmsg() call.
+     */
+    QStatus PushBytesSG(const qcc::IOVec* iov, size_t numIov, size_t& pushed)
+    {
+        return SendBytesSG(m_stream.GetSocketFd(), iov, numIov, pushed);
+    }
+#endif
+
     QStatus SetLinkTimeout(uint32_t& linkTimeout)
     {
         QStatus status = ER_OK;
@@ -570,34 +584,32 @@ class _TCPEndpoint : public _RemoteEndpoint {
         return status;
     }
 
+  private:
     /*
-     * Return true if the auth thread is STARTED, RUNNING or STOPPING.  A true
-     * response means the authentication thread is in a state that indicates
-     * a possibility it might touch the endpoint data structure.  This means
-     * don't delete the endpoint if this method returns true.  This method
-     * indicates nothing about endpoint rx and tx thread state.
+     * Receives the IODispatch callbacks for the stream while the connection
+     * is authenticating.  Once the connection is authenticated the stream is
+     * handed over to the RemoteEndpoint, which receives the callbacks itself.
      */
-    bool IsAuthThreadRunning(void)
-    {
-        return m_authThread.IsRunning();
-    }
-
-  private:
-    class AuthThread : public qcc::Thread {
+    class AuthDriver : public qcc::IOReadListener, public qcc::IOWriteListener, public qcc::IOExitListener {
       public:
-        AuthThread(_TCPEndpoint* ep) : Thread("auth"), m_endpoint(ep)  { }
+        AuthDriver(_TCPEndpoint* ep) : m_endpoint(ep) { }
+        QStatus ReadCallback(qcc::Source& source, bool isTimedOut) { return m_endpoint->AuthRead(); }
+        QStatus WriteCallback(qcc::Sink& sink, bool isTimedOut) { return ER_OK; }
+        void ExitCallback() { }
       private:
-        virtual qcc::ThreadReturn STDCALL Run(void* arg);
-
         _TCPEndpoint* m_endpoint;
     };
 
+    QStatus AuthRead(void);
+
     TCPTransport* m_transport;        /**< The server holding the connection */
     volatile SideState m_sideState;   /**< Is this an active or passive connection */
     volatile AuthState m_authState;   /**< The state of the endpoint authentication process */
     volatile EndpointState m_epState; /**< The state of the endpoint authentication process */
     qcc::Timespec m_tStart;           /**< Timestamp indicating when the authentication process started */
-    AuthThread m_authThread;          /**< Thread used to do blocking calls during startup */
+    AuthDriver m_authDriver;          /**< Runs the authentication from IODispatch read callbacks */
+    qcc::Mutex m_authLock;            /**< Serializes the authentication callbacks with AuthStop() */
+    bool m_gotNul;                    /**< True once the leading nul byte has been read */
     qcc::SocketStream m_stream;       /**< Stream used by authentication code */
     qcc::IPAddress m_ipAddr;          /**< Remote IP address. */
     uint16_t m_port;                  /**< Remote port. */
@@ -607,194 +619,162 @@ class _TCPEndpoint : public _RemoteEndpoint {
 QStatus _TCPEndpoint::Authenticate(void)
 {
     QCC_DbgTrace(("TCPEndpoint::Authenticate()"));
-    /*
-     * Start the authentication thread.
-     */
-    QStatus status = m_authThread.Start(this);
-    if (status != ER_OK) {
-        m_authState = AUTH_FAILED;
-    }
-    return status;
-}
 
-void _TCPEndpoint::AuthStop(void)
-{
-    QCC_DbgTrace(("TCPEndpoint::AuthStop()"));
+    /* Initialized the features for this endpoint */
+    GetFeatures().isBusToBus = false;
+    GetFeatures().handlePassing = false;
 
-    /*
-     * Ask the auth thread to stop executing.  The only ways out of the thread
-     * run function will set the state to either AUTH_SUCCEEDED or AUTH_FAILED.
-     * There is a very small chance that we will send a stop to the thread after
-     * it has successfully authenticated, but we expect that this will result in
-     * an AUTH_FAILED state for the vast majority of cases.  In this case, we
-     * notice that the thread failed the next time through the main server run
-     * loop, join the thread via AuthJoin below and delete the endpoint.  Note
-     * that this is a lazy cleanup of the endpoint.
+    DaemonRouter& router = reinterpret_cast<DaemonRouter&>(m_transport->m_bus.GetInternal().GetRouter());
+    AuthListener* authListener = router.GetBusController()->GetAuthListener();
+    /* Since the TCPTransport allows untrusted clients, it must implement UntrustedClientStart and
+     * UntrustedClientExit.
+     * As a part of Establish, the endpoint can call the Transport's UntrustedClientStart method if
+     * it is an untrusted client, so the transport MUST call SetListener before calling EstablishStart
+     * Note: This is only required on the accepting end i.e. for incoming endpoints.
      */
-    m_authThread.Stop();
-}
-
-void _TCPEndpoint::AuthJoin(void)
-{
-    QCC_DbgTrace(("TCPEndpoint::AuthJoin()"));
+    SetListener(m_transport);
+    QStatus status;
+    if (authListener) {
+        status = EstablishStart("ALLJOYN_PIN_KEYX ANONYMOUS", authListener);
+    } else {
+        status = EstablishStart("ANONYMOUS", authListener);
+    }
 
     /*
-     * Join the auth thread to stop executing.  All threads must be joined in
-     * order to communicate their return status.  The auth thread is no exception.
-     * This is done in a lazy fashion from the main server accept loop, where we
-     * cleanup every time through the loop.
+     * Nothing is read here.  The authentication conversation is run by the
+     * IODispatch threads, a step at a time, each time the client sends
+     * something.  No thread is tied up by a connection waiting on a slow or
+     * silent client.
      */
-    m_authThread.Join();
+    if (status == ER_OK) {
+        m_authState = AUTH_AUTHENTICATING;
+        IODispatch& iodispatch = m_transport->m_bus.GetInternal().GetIODispatch();
+        status = iodispatch.StartStream(&m_stream, &m_authDriver, &m_authDriver, &m_authDriver, true, false);
+    }
+    if (status != ER_OK) {
+        EstablishCancel();
+        m_authState = AUTH_FAILED;
+    }
+    return status;
 }
 
-void* _TCPEndpoint::AuthThread::Run(void* arg)
+QStatus _TCPEndpoint::AuthRead(void)
 {
-    QCC_DbgTrace(("TCPEndpoint::AuthThread::Run()"));
-
-    m_endpoint->m_authState = AUTH_AUTHENTICATING;
+    QCC_DbgTrace(("TCPEndpoint::AuthRead()"));
+
+    /*
+     * We're running an authentication step here, on an IODispatch thread, and
+     * we are cooperating with the main server thread.  The server thread only
+     * reads the auth state, so there are no data sharing issues.  If there is
+     * an authentication failure, we set the state to AUTH_FAILED.  If the
+     * authentication succeeds we set the state to AUTH_SUCCEEDED.  Either way
+     * we alert the server accept loop which stops the stream, waits for this
+     * callback to return and then either deletes the connection or starts it.
+     * Since the server accept loop must Join() the stream before it touches
+     * the connection, we can never touch the endpoint after we return from
+     * here without re-enabling the read callback.
+     */
+    m_authLock.Lock(MUTEX_CONTEXT);
+    if (m_authState != AUTH_AUTHENTICATING) {
+        m_authLock.Unlock(MUTEX_CONTEXT);
+        return ER_OK;
+    }
 
-    /*
-     * We're running an authentication process here and we are cooperating with
-     * the main server thread.  This thread is running in an object that is
-     * allocated on the heap, and the server is managing these objects so we
-     * need to coordinate getting all of this cleaned up.
-     *
-     * There is a state variable that only we write.  The server thread only
-     * reads this variable, so there are no data sharing issues.  If there is an
-     * authentication failure, this thread sets that state variable to
-     * AUTH_FAILED and then exits.  The server holds a list of currently
-     * authenticating connections and will look for AUTH_FAILED connections when
-     * it runs its Accept loop.  If it finds one, it will AuthJoin() this
-     * thread.  Since we set AUTH_FAILED immediately before exiting, there will
-     * be no problem having the server block waiting for the Join() to complete.
-     * We fail authentication here and let the server clean up after us, lazily.
-     *
-     * If we succeed in the authentication process, we set the state variable
-     * to AUTH_SUCEEDED and then call back into the server telling it that we are
-     * up and running.  It needs to take us off of the list of authenticating
-     * connections and put us on the list of running connections.  This thread
-     * will quickly go away and will be replaced by the RX and TX threads of
-     * the running RemoteEndpoint.
-     *
-     * If we are running an authentication process, we are probably ultimately
-     * blocked on a socket.  We expect that if the server is asked to shut
-     * down, it will run through its list of authenticating connections and
-     * AuthStop() each one.  That will cause a thread Stop() which should unblock
-     * all of the reads and return an error which will eventually pop out here
-     * with an authentication failure.
-     *
-     * Finally, if the server decides we've spent too much time here and we are
-     * actually a denial of service attack, it can close us down by doing an
-     * AuthStop() on the authenticating endpoint.  This will do a thread Stop()
-     * on the auth thread of the endpoint which will pop out of here as an
-     * authentication failure as well.  The only ways out of this method must be
-     * with state = AUTH_FAILED or state = AUTH_SUCCEEDED.
-     */
-    uint8_t byte;
-    size_t nbytes;
+    QStatus status = ER_OK;
 
     /*
      * Eat the first byte of the stream.  This is required to be zero by the
      * DBus protocol.  It is used in the Unix socket implementation to carry
-     * out-of-band capabilities, but is discarded here.  We do this here since
-     * it involves a read that can block.
-     */
-    QStatus status = m_endpoint->m_stream.PullBytes(&byte, 1, nbytes);
-    if ((status != ER_OK) || (nbytes != 1) || (byte != 0)) {
-        QCC_LogError(status, ("Failed to read first byte from stream"));
-
-        /*
-         * Management of the resources used by the authentication thread is done
-         * in one place, by the server Accept loop.  The authentication thread
-         * writes its state into the connection and the server Accept loop reads
-         * this state.  As soon as we set this state to AUTH_FAILED, we are
-         * telling the Accept loop that we are done with the conn data
-         * structure.  That thread is then free to do anything it wants with the
-         * connection, including deleting it, so we are not allowed to touch
-         * conn after setting this state.
-         *
-         * In addition to releasing responsibility for the conn data structure,
-         * when we set the state to AUTH_SUCCEEDED we are telling the server
-         * accept loop that we are exiting now and so it can Join() on us (the
-         * authentication thread) without being worried about blocking since the
-         * next thing we do is exit.
-         */
-        m_endpoint->m_authState = AUTH_FAILED;
-        return (void*)ER_FAIL;
+     * out-of-band capabilities, but is discarded here.
+     */
+    if (!m_gotNul) {
+        uint8_t byte;
+        size_t nbytes;
+        status = m_stream.PullBytes(&byte, 1, nbytes, 0);
+        if ((status == ER_OK) && ((nbytes != 1) || (byte != 0))) {
+            status = ER_FAIL;
+        }
+        if (status == ER_OK) {
+            m_gotNul = true;
+        } else if ((status == ER_TIMEOUT) || (status == ER_WOULDBLOCK)) {
+            status = ER_WOULDBLOCK;
+        } else {
+            QCC_LogError(status, ("Failed to read first byte from stream"));
+        }
     }
 
-    /* Initialized the features for this endpoint */
-    m_endpoint->GetFeatures().isBusToBus = false;
-    m_endpoint->GetFeatures().isBusToBus = false;
-    m_endpoint->GetFeatures().handlePassing = false;
-
-    /* Run the actual connection authentication code. */
+    /* Run as much of the connection authentication as the data received allows. */
     qcc::String authName;
-    qcc::String redirection;
-    DaemonRouter& router = reinterpret_cast<DaemonRouter&>(m_endpoint->m_transport->m_bus.GetInternal().GetRouter());
-    AuthListener* authListener = router.GetBusController()->GetAuthListener();
-    /* Since the TCPTransport allows untrusted clients, it must implement UntrustedClientStart and
-     * UntrustedClientExit.
-     * As a part of Establish, the endpoint can call the Transport's UntrustedClientStart method if
-     * it is an untrusted client, so the transport MUST call m_endpoint->SetListener before calling Establish
-     * Note: This is only required on the accepting end i.e. for incoming endpoints.
-     */
-    m_endpoint->SetListener(m_endpoint->m_transport);
-    if (authListener) {
-        status = m_endpoint->Establish("ALLJOYN_PIN_KEYX ANONYMOUS", authName, redirection, authListener);
-    } else {
-        status = m_endpoint->Establish("ANONYMOUS", authName, redirection, authListener);
+    if (m_gotNul) {
+        status = EstablishContinue(authName);
     }
-    if (status != ER_OK) {
-        QCC_LogError(status, ("Failed to establish TCP endpoint"));
 
+    if (status == ER_WOULDBLOCK) {
         /*
-         * Management of the resources used by the authentication thread is done
-         * in one place, by the server Accept loop.  The authentication thread
-         * writes its state into the connection and the server Accept loop reads
-         * this state.  As soon as we set this state to AUTH_FAILED, we are
-         * telling the Accept loop that we are done with the conn data
-         * structure.  That thread is then free to do anything it wants with the
-         * connection, including deleting it, so we are not allowed to touch
-         * conn after setting this state.
-         *
-         * In addition to releasing responsibility for the conn data structure,
-         * when we set the state to AUTH_SUCCEEDED we are telling the server
-         * accept loop that we are exiting now and so it can Join() on us (the
-         * authentication thread) without being worried about blocking since the
-         * next thing we do is exit.
+         * Wait for the client to send more.  The server accept loop times us
+         * out if the client takes too long about it.
          */
-        m_endpoint->m_authState = AUTH_FAILED;
-        return (void*)status;
+        m_transport->m_bus.GetInternal().GetIODispatch().EnableReadCallback(&m_stream);
+        m_authLock.Unlock(MUTEX_CONTEXT);
+        return ER_OK;
     }
 
+    if (status == ER_OK) {
+        m_authState = AUTH_SUCCEEDED;
+    } else {
+        QCC_LogError(status, ("Failed to establish TCP endpoint"));
+        m_authState = AUTH_FAILED;
+    }
+    m_authLock.Unlock(MUTEX_CONTEXT);
+
     /*
-     * Tell the transport that the authentication has succeeded and that it can
-     * now bring the connection up.
+     * Wake up the server accept loop so that it deals with the result immediately.
      */
-    TCPEndpoint tcpEp = TCPEndpoint::wrap(m_endpoint);
-    m_endpoint->m_transport->Authenticated(tcpEp);
+    m_transport->Alert();
+    return ER_OK;
+}
 
-    QCC_DbgTrace(("TCPEndpoint::AuthThread::Run(): Returning"));
+void _TCPEndpoint::AuthStop(void)
+{
+    QCC_DbgTrace(("TCPEndpoint::AuthStop()"));
 
     /*
-     * We are now done with the authentication process.  We have succeeded doing
-     * the authentication and we may or may not have succeeded in starting the
-     * endpoint TX and RX threads depending on what happened down in
-     * Authenticated().  What concerns us here is that we are done with this
-     * thread (the authentication thread) and we are about to exit.  Before
-     * exiting, we must tell server accept loop that we are done with this data
-     * structure.  As soon as we set this state to AUTH_SUCCEEDED that thread is
-     * then free to do anything it wants with the connection, including deleting
-     * it, so we are not allowed to touch conn after setting this state.
-     *
-     * In addition to releasing responsibility for the conn data structure, when
-     * we set the state to AUTH_SUCCEEDED we are telling the server accept loop
-     * that we are exiting now and so it can Join() the authentication thread
-     * without being worried about blocking since the next thing we do is exit.
+     * Abandon the authentication.  If a read callback is running it will
+     * finish its step, but the state becomes AUTH_FAILED and no further steps
+     * are run.  There is a very small chance that we will stop the
+     * authentication after it has succeeded, in which case the connection is
+     * started as usual.  The server accept loop notices the failure the next
+     * time through, joins the stream via AuthJoin below and deletes the
+     * endpoint.  Note that this is a lazy cleanup of the endpoint.
      */
-    m_endpoint->m_authState = AUTH_SUCCEEDED;
-    return (void*)status;
+    m_authLock.Lock(MUTEX_CONTEXT);
+    if (m_authState == AUTH_AUTHENTICATING) {
+        m_authState = AUTH_FAILED;
+    }
+    m_authLock.Unlock(MUTEX_CONTEXT);
+    m_transport->m_bus.GetInternal().GetIODispatch().StopStream(&m_stream);
+}
+
+void _TCPEndpoint::AuthJoin(void)
+{
+    QCC_DbgTrace(("TCPEndpoint::AuthJoin()"));
+
+    /*
+     * Take the stream away from the authentication callbacks and wait for any
+     * callback in progress to return.  After this nothing but the caller
+     * touches the endpoint, which can then be deleted or started.  This is done
+     * in a lazy fashion from the main server accept loop, where we cleanup
+     * every time through the loop.
+     */
+    IODispatch& iodispatch = m_transport->m_bus.GetInternal().GetIODispatch();
+    iodispatch.StopStream(&m_stream);
+    iodispatch.JoinStream(&m_stream);
+
+    /*
+     * The authentication state holds a reference to the endpoint.  If the
+     * authentication did not complete it must be released here.
+     */
+    EstablishCancel();
 }
 
 TCPTransport::TCPTransport(BusAttachment& bus)
@@ -830,8 +810,9 @@ void TCPTransport::Authenticated(TCPEndpoint& conn)
         return;
     }
     /*
-     * If Authenticated() is being called, it is as a result of the
-     * authentication thread telling us that it has succeeded.  What we need to
+     * If Authenticated() is being called, it is as a result of the server
+     * accept loop finding that the authentication has succeeded and joining
+     * the authentication callbacks.  What we need to
      * do here is to try and Start() the endpoint which will spin up its TX and
      * RX threads and register the endpoint with the daemon router.  As soon as
      * we call Start(), we are transferring responsibility for error reporting
@@ -845,11 +826,6 @@ void TCPTransport::Authenticated(TCPEndpoint& conn)
     set<TCPEndpoint>::iterator i = find(m_authList.begin(), m_authList.end(), conn);
     assert(i != m_authList.end() && "TCPTransport::Authenticated(): Conn not on m_authList");
 
-    /*
-     * Note here that we have not yet marked the authState as AUTH_SUCCEEDED so
-     * this is a point in time where the authState can be AUTH_AUTHENTICATING
-     * and the endpoint can be on the endpointList and not the authList.
-     */
     m_authList.erase(i);
     m_endpointList.insert(conn);
 
@@ -866,12 +842,11 @@ void TCPTransport::Authenticated(TCPEndpoint& conn)
          * We were unable to start up the endpoint for some reason.  As soon as
          * we set this state to EP_FAILED, we are telling the server accept loop
          * that we tried to start the connection but it failed.  This connection
-         * is now useless and is a candidate for cleanup.  This will be
-         * prevented until authState changes from AUTH_AUTHENTICATING to
-         * AUTH_SUCCEEDED.  This may be a little confusing, but the
-         * authentication process has really succeeded but the endpoint start
-         * has failed.  The combination of status in this case will be
-         * AUTH_SUCCEEDED and EP_FAILED.  Once this state is detected by the
+         * is now useless and is a candidate for cleanup.  This may be a
+         * little confusing, but the authentication process has really
+         * succeeded but the endpoint start has failed.  The combination of
+         * status in this case will be AUTH_DONE and EP_FAILED.  Once this
+         * state is detected by the
          * server accept loop it is then free to do anything it wants with the
          * connection, including deleting it.
          */
@@ -995,11 +970,11 @@ QStatus TCPTransport::Stop(void)
     }
 
     /*
-     * Ask any authenticating endpoints to shut down and exit their threads.  By its
+     * Ask any authenticating endpoints to abandon their authentication.  By its
      * presence on the m_authList, we know that the endpoint is authenticating and
-     * the authentication thread has responsibility for dealing with the endpoint
-     * data structure.  We call Stop() to stop that thread from running.  The
-     * endpoint Rx and Tx threads will not be running yet.
+     * the authentication callbacks have responsibility for dealing with the
+     * endpoint data structure.  We call AuthStop() to stop further callbacks.
+     * The endpoint Rx and Tx threads will not be running yet.
      */
     for (set<TCPEndpoint>::iterator i = m_authList.begin(); i != m_authList.end(); ++i) {
         TCPEndpoint ep = *i;
@@ -1058,20 +1033,17 @@ QStatus TCPTransport::Join(void)
      * running in those endpoints actually stop running.
      *
      * Since Stop() is a request to stop, and this is what has ultimately been
-     * done to both authentication threads and Rx and Tx threads, it is possible
-     * that a thread is actually running after the call to Stop().  If that
-     * thead happens to be an authenticating endpoint, it is possible that an
-     * authentication actually completes after Stop() is called.  This will move
-     * a connection from the m_authList to the m_endpointList, so we need to
-     * make sure we wait for all of the connections on the m_authList to go away
-     * before we look for the connections on the m_endpointlist.
+     * done to both authentication callbacks and Rx and Tx threads, it is
+     * possible that a callback is actually running after the call to Stop().
+     * We wait for all of the connections on the m_authList to go away before
+     * we look for the connections on the m_endpointlist.
      */
     m_endpointListLock.Lock(MUTEX_CONTEXT);
 
     /*
-     * Any authenticating endpoints have been asked to shut down and exit their
-     * authentication threads in a previously required Stop().  We need to
-     * Join() all of these auth threads here.
+     * Any authenticating endpoints have been asked to abandon their
+     * authentication in a previously required Stop().  We need to Join() the
+     * authentication callbacks of all of these endpoints here.
      */
     set<TCPEndpoint>::iterator it = m_authList.begin();
     while (it != m_authList.end()) {
@@ -1088,7 +1060,7 @@ QStatus TCPTransport::Join(void)
      * Any running endpoints have been asked it their threads in a previously
      * required Stop().  We need to Join() all of thesse threads here.  This
      * Join() will wait on the endpoint rx and tx threads to exit as opposed to
-     * the joining of the auth thread we did above.
+     * the joining of the auth callbacks we did above.
      */
     it = m_endpointList.begin();
     while (it != m_endpointList.end()) {
@@ -1375,12 +1347,30 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
         TCPEndpoint ep = *i;
         _TCPEndpoint::AuthState authState = ep->GetAuthState();
 
+        if (authState == _TCPEndpoint::AUTH_SUCCEEDED) {
+            /*
+             * The endpoint has succeeded authentication and no further
+             * authentication callbacks will touch it.  Join the stream to be
+             * sure the last one has returned, after which we own the conn and
+             * can hand it over to the RemoteEndpoint by starting it.  We set
+             * the state through a method call to enable this single special
+             * case where we are allowed to set the state.
+             */
+            QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Starting authenticated endpoint"));
+            m_endpointListLock.Unlock(MUTEX_CONTEXT);
+            ep->AuthJoin();
+            ep->SetAuthDone();
+            Authenticated(ep);
+            m_endpointListLock.Lock(MUTEX_CONTEXT);
+            i = m_authList.upper_bound(ep);
+            continue;
+        }
+
         if (authState == _TCPEndpoint::AUTH_FAILED) {
             /*
-             * The endpoint has failed authentication and the auth thread is
-             * gone or is going away.  Since it has failed there is no way this
-             * endpoint is going to be started so we can get rid of it as soon
-             * as we Join() the (failed) authentication thread.
+             * The endpoint has failed authentication.  Since it has failed
+             * there is no way this endpoint is going to be started so we can
+             * get rid of it as soon as we Join() the authentication callbacks.
              */
             QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Scavenging failed authenticator"));
             m_authList.erase(i);
@@ -1397,25 +1387,19 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
         if (ep->GetStartTime() + tTimeout < tNow) {
             /*
              * This endpoint is taking too long to authenticate.  Stop the
-             * authentication process.  The auth thread is still running, so we
-             * can't just delete the connection, we need to let it stop in its
-             * own time.  What that thread will do is to set AUTH_FAILED and
-             * exit.  we will then clean it up the next time through this loop.
-             * In the hope that the thread can exit and we can catch its exit
-             * here and now, we take our thread off the OS ready list (Sleep)
-             * and let the other thread run before looping back.
+             * authentication process, which sets AUTH_FAILED.  A callback may
+             * still be running, so we can't just delete the connection here;
+             * we clean it up the next time through this loop.
              */
             QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Scavenging slow authenticator"));
             ep->AuthStop();
-            qcc::Sleep(1);
         }
         ++i;
     }
 
     /*
      * We've handled the authList, so now run through the list of connections on
-     * the endpointList and cleanup any that are no longer running or Join()
-     * authentication threads that have successfully completed.
+     * the endpointList and cleanup any that are no longer running.
      */
     i = m_endpointList.begin();
     while (i != m_endpointList.end()) {
@@ -1434,24 +1418,6 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
         _TCPEndpoint::AuthState authState = ep->GetAuthState();
         _TCPEndpoint::EndpointState endpointState = ep->GetEpState();
 
-        if (authState == _TCPEndpoint::AUTH_SUCCEEDED) {
-            /*
-             * The endpoint has succeeded authentication and the auth thread is
-             * gone or is going away.  Take this opportunity to join the auth
-             * thread.  Since the auth thread promised not to touch the state
-             * after setting AUTH_SUCCEEEDED, we can safely change the state
-             * here since we now own the conn.  We do this through a method call
-             * to enable this single special case where we are allowed to set
-             * the state.
-             */
-            QCC_DbgHLPrintf(("TCPTransport::ManageEndpoints(): Scavenging failed authenticator"));
-            m_endpointListLock.Unlock(MUTEX_CONTEXT);
-            ep->AuthJoin();
-            ep->SetAuthDone();
-            m_endpointListLock.Lock(MUTEX_CONTEXT);
-            i = m_endpointList.upper_bound(ep);
-            continue;
-        }
         /*
          * Passive endpoints need to be monitored between the time the endpoint is created via listen/accept
          * up until responsibility for  lifecycle of the endpoint can be transferred to the session management
@@ -1493,7 +1459,7 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
          * the endpoint threads, remove the endpoint from the
          * endpoint list and delete it.  Note that we are calling
          * the endpoint Join() to join the TX and RX threads and not
-         * the endpoint AuthJoin() to join the auth thread.
+         * the endpoint AuthJoin() to join the auth callbacks.
          */
         if (endpointState == _TCPEndpoint::EP_STOPPING) {
             m_endpointList.erase(i);
@@ -1508,6 +1474,25 @@ void TCPTransport::ManageEndpoints(Timespec tTimeout)
     m_endpointListLock.Unlock(MUTEX_CONTEXT);
 }
 
+/*
+ * IODispatch waits on its sockets with select() on POSIX platforms, and select()
+ * cannot wait on a descriptor at or above FD_SETSIZE.  Every connection holds a
+ * socket, and pending connections count against the connection limit, so a
+ * configured limit that would push socket numbers past FD_SETSIZE is reduced,
+ * leaving ALLJOYN_FD_RESERVE descriptors for everything else the daemon opens.
+ */
+uint32_t TCPTransport::ClampConnections(uint32_t maxConn)
+{
+#if defined(QCC_OS_GROUP_POSIX)
+    static const uint32_t selectLimit = FD_SETSIZE - ALLJOYN_FD_RESERVE;
+    if (maxConn > selectLimit) {
+        QCC_DbgPrintf(("TCPTransport::ClampConnections(): max_completed_connections of %u exceeds select() limit, using %u", maxConn, selectLimit));
+        maxConn = selectLimit;
+    }
+#endif
+    return maxConn;
+}
+
 void* TCPTransport::Run(void* arg)
 {
     QCC_DbgTrace(("TCPTransport::Run()"));
@@ -1539,7 +1524,7 @@ void* TCPTransport::Run(void* arg)
      * TCP transport.  If starting to process a new connection would mean
      * exceeding this number, we drop the new connection.
      */
-    uint32_t maxConn = config->Get("limit@max_completed_connections", ALLJOYN_MAX_COMPLETED_CONNECTIONS_TCP_DEFAULT);
+    uint32_t maxConn = ClampConnections(config->Get("limit@max_completed_connections", ALLJOYN_MAX_COMPLETED_CONNECTIONS_TCP_DEFAULT));
 
     QStatus status = ER_OK;
 
@@ -2598,7 +2583,7 @@ QStatus TCPTransport::Connect(const char* connectSpec, const SessionOpts& opts,
      * TCP transport.  If starting to process a new connection would mean
      * exceeding this number, we drop the new connection.
      */
-    uint32_t maxConn = config->Get("limit@max_completed_connections", ALLJOYN_MAX_COMPLETED_CONNECTIONS_TCP_DEFAULT);
+    uint32_t maxConn = ClampConnections(config->Get("limit@max_completed_connections", ALLJOYN_MAX_COMPLETED_CONNECTIONS_TCP_DEFAULT));
 
     QStatus status;
     bool isConnected = false;
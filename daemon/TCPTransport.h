@@ -494,11 +494,12 @@ class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener,
      * in the DBus configuration, but it applies only to the TCP transport.  To
      * override this value, change the limit, "max_incomplete_connections_tcp".
      * Typically, DBus sets this value to 10,000 which is essentially infinite
-     * from the perspective of a phone.  Since this represents a transient state
-     * in connection establishment, there should be few connections in this
-     * state, so we default to a quite low number.
+     * from the perspective of a phone.  Authenticating connections are driven
+     * by IODispatch callbacks rather than a thread each, so a pending
+     * connection costs little more than its socket and we can allow a burst
+     * of clients to connect at once.
      */
-    static const uint32_t ALLJOYN_MAX_INCOMPLETE_CONNECTIONS_TCP_DEFAULT = 10;
+    static const uint32_t ALLJOYN_MAX_INCOMPLETE_CONNECTIONS_TCP_DEFAULT = 256;
 
     /**
      * @brief The default value for the maximum number of TCP connections
@@ -508,8 +509,10 @@ class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener,
      * in the DBus configuration, but it applies only to the TCP transport.
      * To override this value, change the limit, "max_completed_connections_tcp".
      * Typically, DBus sets this value to 100,000 which is essentially infinite
-     * from the perspective of a phone.  Since we expect bus topologies to be
-     * relatively small, we default to a quite low number.
+     * from the perspective of a phone.  Routing nodes may serve many thin
+     * clients, so we default to as many as IODispatch can wait on with
+     * select() (FD_SETSIZE, typically 1024) less ALLJOYN_FD_RESERVE.  Larger
+     * configured values are reduced to that on POSIX platforms.
      *
      * @warning This maximum is enforced on incoming connections only.  An
      * AllJoyn daemon is free to form as many outbound connections as it pleases
@@ -517,7 +520,25 @@ class TCPTransport : public Transport, public _RemoteEndpoint::EndpointListener,
      * connections will be accepted.  This is because we are defending against
      * attacks from "abroad" and trust ourselves implicitly.
      */
-    static const uint32_t ALLJOYN_MAX_COMPLETED_CONNECTIONS_TCP_DEFAULT = 50;
+    static const uint32_t ALLJOYN_MAX_COMPLETED_CONNECTIONS_TCP_DEFAULT = 896;
+
+    /**
+     * @brief The number of file descriptors below FD_SETSIZE kept free for
+     * uses other than TCP connections (listen and name service sockets,
+     * thread and timer events, local transports).
+     */
+    static const uint32_t ALLJOYN_FD_RESERVE = 128;
+
+    /**
+     * @brief Reduce a maximum number of TCP connections to what IODispatch
+     * can wait on.
+     *
+     * @param maxConn  The configured maximum number of connections.
+     *
+     * @return maxConn or, on platforms where sockets are waited on with
+     *         select(), FD_SETSIZE - ALLJOYN_FD_RESERVE if that is smaller.
+     */
+    static uint32_t ClampConnections(uint32_t maxConn);
 
     /**
      * @brief The default value for the maximum number of untrusted clients
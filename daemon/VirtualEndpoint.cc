@@ -84,6 +84,33 @@ QStatus _VirtualEndpoint::PushMessage(Message& msg, SessionId id)
     return status;
 }
 
+QStatus _VirtualEndpoint::PushMessages(Message* msgs, size_t numMsgs, SessionId id, size_t& numSent)
+{
+    QCC_DbgTrace(("_VirtualEndpoint::PushMessages(this=%s [%x], SessionId=%u, count=%d)", GetUniqueName().c_str(), this, id, numMsgs));
+
+    QStatus status = (numMsgs == 0) ? ER_OK : ER_BUS_NO_ROUTE;
+    vector<RemoteEndpoint> tryEndpoints;
+
+    m_b2bEndpointsLock.Lock(MUTEX_CONTEXT);
+    multimap<SessionId, RemoteEndpoint>::iterator it = (id == 0) ? m_b2bEndpoints.begin() : m_b2bEndpoints.lower_bound(id);
+    while ((it != m_b2bEndpoints.end()) && (id == it->first)) {
+        tryEndpoints.push_back(it->second);
+        ++it;
+    }
+    m_b2bEndpointsLock.Unlock(MUTEX_CONTEXT);
+    /*
+     * As with a single message the routes are tried in turn, a route that fails part way through
+     * the batch leaves the rest of the batch for the next route.
+     */
+    numSent = 0;
+    for (vector<RemoteEndpoint>::iterator iter = tryEndpoints.begin(); (status != ER_OK) && (iter != tryEndpoints.end()); ++iter) {
+        size_t numQueued;
+        status = (*iter)->PushMessages(&msgs[numSent], numMsgs - numSent, numQueued);
+        numSent += numQueued;
+    }
+    return status;
+}
+
 RemoteEndpoint _VirtualEndpoint::GetBusToBusEndpoint(SessionId sessionId, int* b2bCount) const
 {
     RemoteEndpoint ret;
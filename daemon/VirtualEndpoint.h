@@ -23,6 +23,9 @@
 #define _ALLJOYN_VIRTUALENDPOINT_H
 
 #include <qcc/platform.h>
+
+#include <map>
+
 #include <qcc/ManagedObj.h>
 #include <qcc/String.h>
 
@@ -85,6 +88,21 @@ class _VirtualEndpoint : public _BusEndpoint {
      */
     QStatus PushMessage(Message& msg, SessionId id);
 
+    /**
+     * Send a batch of outgoing messages over a specific session. The bus-to-bus endpoint is
+     * looked up once for the whole batch.
+     *
+     * @param msgs      Messages to be sent in order.
+     * @param numMsgs   Number of messages.
+     * @param id        SessionId to use for the outgoing messages.
+     * @param numSent   [OUT] Number of messages that were sent. On failure msgs[numSent] is the
+     *                  message that could not be sent on any route.
+     * @return
+     *      - ER_OK if successful.
+     *      - An error status otherwise
+     */
+    QStatus PushMessages(Message* msgs, size_t numMsgs, SessionId id, size_t& numSent);
+
     /**
      * Get unique bus name.
      *
@@ -534,6 +534,9 @@ DaemonICETransport::DaemonICETransport(BusAttachment& bus) :
     m_stopping(false),
     m_listener(0),
     m_packetEngine("ice_packet_engine"),
+#ifndef NDEBUG
+    m_packetEngineDebug(m_packetEngine),
+#endif
     m_iceCallback(m_listener, this),
     daemonICETransportTimer("ICETransTimer", true)
 {
@@ -686,7 +689,17 @@ QStatus DaemonICETransport::Start()
     }
 
     /* Start the PacketEngine */
-    status = m_packetEngine.Start(ajn::MAX_ICE_INTERFACE_MTU);
+    DaemonConfig* config = DaemonConfig::Access();
+    uint32_t poolPrealloc = config->Get("limit@ice_packet_pool_prealloc", ALLJOYN_ICE_PACKET_POOL_PREALLOC_DEFAULT);
+    uint32_t poolHighWater = config->Get("limit@ice_packet_pool_high_water", ALLJOYN_ICE_PACKET_POOL_HIGH_WATER_DEFAULT);
+    CongestionControlType ccType;
+    qcc::String ccName = config->Get("ice_packet_engine/property@congestion_control", "reno");
+    if (CongestionControl::ParseType(ccName, ccType) == ER_OK) {
+        m_packetEngine.SetCongestionControl(ccType);
+    } else {
+        QCC_LogError(ER_BAD_ARG_1, ("DaemonICETransport::Start(): Unknown congestion_control \"%s\". Using reno", ccName.c_str()));
+    }
+    status = m_packetEngine.Start(ajn::MAX_ICE_INTERFACE_MTU, poolPrealloc, poolHighWater);
     if (status != ER_OK) {
         QCC_LogError(status, ("DaemonICETransport::Start(): PacketEngine::Start failed"));
         return status;
@@ -45,6 +45,7 @@
 #include "ICESessionListener.h"
 #include "PeerCandidateListener.h"
 #include "PacketEngine.h"
+#include "PacketEngineDebug.h"
 #include "TokenRefreshListener.h"
 #include "ICEPacketStream.h"
 
@@ -507,6 +508,11 @@ class DaemonICETransport : public Transport, public _RemoteEndpoint::EndpointLis
     /* Instance of the packet engine associated with the ICE transport*/
     PacketEngine m_packetEngine;
 
+#ifndef NDEBUG
+    /* Exports the packet engine's packet pool counters through the debug object */
+    debug::PacketEngineDebugObj m_packetEngineDebug;
+#endif
+
     Mutex m_IncomingICESessionsLock; /**< Mutex that protects IncomingICESessions */
 
     /*
@@ -676,6 +682,23 @@ class DaemonICETransport : public Transport, public _RemoteEndpoint::EndpointLis
      */
     static const uint32_t ALLJOYN_MAX_COMPLETED_CONNECTIONS_ICE_DEFAULT = 50;
 
+    /**
+     * @brief The default number of packets the PacketEngine allocates when it
+     * starts.
+     *
+     * To override this value, change the limit, "ice_packet_pool_prealloc".
+     */
+    static const uint32_t ALLJOYN_ICE_PACKET_POOL_PREALLOC_DEFAULT = 0;
+
+    /**
+     * @brief The default maximum number of free packets kept by the
+     * PacketEngine's packet pool.
+     *
+     * To override this value, change the limit, "ice_packet_pool_high_water".
+     * 0 lets the pool keep up to half as many free packets as are in use.
+     */
+    static const uint32_t ALLJOYN_ICE_PACKET_POOL_HIGH_WATER_DEFAULT = 0;
+
     /**
      * @brief The scheduling interval for the DaemonICETransport::Run thread.
      */
@@ -24,7 +24,15 @@
 #include <errno.h>
 #include <assert.h>
 
+#if defined(QCC_OS_LINUX)
+#include <algorithm>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
 #include <qcc/Event.h>
+#include <qcc/atomic.h>
 #include <qcc/Debug.h>
 #include <qcc/StringUtil.h>
 #include "UDPPacketStream.h"
@@ -37,13 +45,56 @@ using namespace qcc;
 
 namespace ajn {
 
+#if defined(QCC_OS_LINUX)
+/* Max number of datagrams read or written with one recvmmsg/sendmmsg call */
+static const size_t UDP_MAX_BATCH = 64;
+
+static socklen_t MakeSockAddr(const PacketDest& dest, struct sockaddr_storage& addr)
+{
+    IPAddress ipAddr(dest.ip, dest.addrSize);
+    ::memset(&addr, 0, sizeof(addr));
+    if (ipAddr.IsIPv4()) {
+        struct sockaddr_in* sa = reinterpret_cast<struct sockaddr_in*>(&addr);
+        sa->sin_family = AF_INET;
+        sa->sin_port = htons(dest.port);
+        ipAddr.RenderIPBinary(reinterpret_cast<uint8_t*>(&sa->sin_addr.s_addr), IPAddress::IPv4_SIZE);
+        return sizeof(struct sockaddr_in);
+    } else {
+        struct sockaddr_in6* sa = reinterpret_cast<struct sockaddr_in6*>(&addr);
+        sa->sin6_family = AF_INET6;
+        sa->sin6_port = htons(dest.port);
+        ipAddr.RenderIPBinary(sa->sin6_addr.s6_addr, IPAddress::IPv6_SIZE);
+        return sizeof(struct sockaddr_in6);
+    }
+}
+
+static void GetPacketSender(const struct sockaddr_storage& addr, PacketDest& sender)
+{
+    IPAddress ipAddr;
+    uint16_t port = 0;
+    if (addr.ss_family == AF_INET) {
+        const struct sockaddr_in* sa = reinterpret_cast<const struct sockaddr_in*>(&addr);
+        ipAddr = IPAddress(reinterpret_cast<const uint8_t*>(&sa->sin_addr.s_addr), IPAddress::IPv4_SIZE);
+        port = ntohs(sa->sin_port);
+    } else {
+        const struct sockaddr_in6* sa = reinterpret_cast<const struct sockaddr_in6*>(&addr);
+        ipAddr = IPAddress(sa->sin6_addr.s6_addr, IPAddress::IPv6_SIZE);
+        port = ntohs(sa->sin6_port);
+    }
+    ipAddr.RenderIPBinary(sender.ip, IPAddress::IPv6_SIZE);
+    sender.addrSize = ipAddr.Size();
+    sender.port = port;
+}
+#endif
+
 UDPPacketStream::UDPPacketStream(const char* ifaceName, uint16_t port) :
     ipAddr(),
     port(port),
     mtu(0),
     sock(-1),
     sourceEvent(&Event::neverSet),
-    sinkEvent(&Event::alwaysSet)
+    sinkEvent(&Event::alwaysSet),
+    truncatedPackets(0)
 {
     QCC_DbgPrintf(("UDPPacketStream::UDPPacketStream(ifaceName='ifaceName', port=%u)", ifaceName, port));
 
@@ -66,7 +117,8 @@ UDPPacketStream::UDPPacketStream(const qcc::IPAddress& addr, uint16_t port) :
     mtu(1472),
     sock(-1),
     sourceEvent(&Event::neverSet),
-    sinkEvent(&Event::alwaysSet)
+    sinkEvent(&Event::alwaysSet),
+    truncatedPackets(0)
 {
     QCC_DbgPrintf(("UDPPacketStream::UDPPacketStream(addr='%s', port=%u)", ipAddr.ToString().c_str(), port));
 
@@ -88,7 +140,8 @@ UDPPacketStream::UDPPacketStream(const qcc::IPAddress& addr, uint16_t port, size
     mtu(mtu),
     sock(-1),
     sourceEvent(&Event::neverSet),
-    sinkEvent(&Event::alwaysSet)
+    sinkEvent(&Event::alwaysSet),
+    truncatedPackets(0)
 {
     QCC_DbgPrintf(("UDPPacketStream::UDPPacketStream(addr='%s', port=%u, mtu=%lu)", ipAddr.ToString().c_str(), port, mtu));
 }
@@ -194,6 +247,101 @@ QStatus UDPPacketStream::PullPacketBytes(void* buf, size_t reqBytes, size_t& act
     return status;
 }
 
+#if defined(QCC_OS_LINUX)
+QStatus UDPPacketStream::PullPacketBatch(PacketBuffer* packets, size_t maxPackets, size_t& numPackets, uint32_t timeout)
+{
+    struct mmsghdr msgs[UDP_MAX_BATCH];
+    struct iovec iovs[UDP_MAX_BATCH];
+    struct sockaddr_storage addrs[UDP_MAX_BATCH];
+    unsigned int count = (unsigned int)(std::min)(maxPackets, UDP_MAX_BATCH);
+
+    numPackets = 0;
+    for (unsigned int i = 0; i < count; ++i) {
+        assert(packets[i].len >= mtu);
+        iovs[i].iov_base = packets[i].buf;
+        iovs[i].iov_len = packets[i].len;
+        ::memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int ret = ::recvmmsg(sock, msgs, count, MSG_DONTWAIT, NULL);
+    if ((ret < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)) && (timeout != 0)) {
+        /* Wait for the first packet, the rest of the batch is whatever has arrived by then */
+        QStatus status = Event::Wait(*sourceEvent, timeout);
+        if (status == ER_TIMEOUT) {
+            return ER_WOULDBLOCK;
+        } else if (status != ER_OK) {
+            return status;
+        }
+        ret = ::recvmmsg(sock, msgs, count, MSG_DONTWAIT, NULL);
+    }
+    if (ret < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return ER_WOULDBLOCK;
+        }
+        QCC_LogError(ER_OS_ERROR, ("recvmmsg failed: %s", ::strerror(errno)));
+        return ER_OS_ERROR;
+    }
+    for (int i = 0; i < ret; ++i) {
+        if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            /* Part of the datagram was discarded by the kernel so it cannot be unmarshaled */
+            IncrementAndFetch(&truncatedPackets);
+            QCC_DbgPrintf(("Dropped truncated datagram (buffer %u bytes)", (unsigned int) packets[i].len));
+            continue;
+        }
+        if (numPackets != static_cast<size_t>(i)) {
+            /* Move the packet down over the dropped ones, keeping buffers paired with their data */
+            std::swap(packets[numPackets].buf, packets[i].buf);
+        }
+        packets[numPackets].len = msgs[i].msg_len;
+        GetPacketSender(addrs[i], packets[numPackets].dest);
+        ++numPackets;
+    }
+    return (numPackets > 0) ? ER_OK : ER_WOULDBLOCK;
+}
+
+QStatus UDPPacketStream::PushPacketBatch(PacketBuffer* packets, size_t numPackets, size_t& numSent)
+{
+    struct mmsghdr msgs[UDP_MAX_BATCH];
+    struct iovec iovs[UDP_MAX_BATCH];
+    struct sockaddr_storage addrs[UDP_MAX_BATCH];
+    QStatus status = ER_OK;
+
+    numSent = 0;
+    while ((status == ER_OK) && (numSent < numPackets)) {
+        unsigned int count = (unsigned int)(std::min)(numPackets - numSent, UDP_MAX_BATCH);
+        for (unsigned int i = 0; i < count; ++i) {
+            PacketBuffer& pb = packets[numSent + i];
+            assert(pb.len <= mtu);
+            iovs[i].iov_base = pb.buf;
+            iovs[i].iov_len = pb.len;
+            ::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = MakeSockAddr(pb.dest, addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int ret = ::sendmmsg(sock, msgs, count, 0);
+        if (ret <= 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("sendmmsg failed: %s (%d)", ::strerror(errno), errno));
+            break;
+        }
+        for (int i = 0; i < ret; ++i) {
+            if (msgs[i].msg_len != packets[numSent].len) {
+                status = ER_OS_ERROR;
+                QCC_LogError(status, ("Short udp send: exp=%d, act=%d", packets[numSent].len, msgs[i].msg_len));
+                break;
+            }
+            ++numSent;
+        }
+    }
+    return status;
+}
+#endif
+
 String UDPPacketStream::ToString(const PacketDest& dest) const
 {
     IPAddress ipAddr(dest.ip, dest.addrSize);
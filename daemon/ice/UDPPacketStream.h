@@ -86,6 +86,27 @@ class UDPPacketStream : public PacketStream {
      */
     QStatus PullPacketBytes(void* buf, size_t reqBytes, size_t& actualBytes, PacketDest& sender, uint32_t timeout = qcc::Event::WAIT_FOREVER);
 
+#if defined(QCC_OS_LINUX)
+    /**
+     * Pull up to maxPackets packets from the socket with a single recvmmsg call.
+     * Datagrams that were too large for their buffer are dropped and counted by
+     * GetTruncatedPackets(). The pulled packets are returned in the first numPackets
+     * entries of packets, so entries (including their buf) may be reordered.
+     *
+     * @param packets      Packet buffers to fill. The len of each buffer must be at least the MTU.
+     * @param maxPackets   Number of entries in packets.
+     * @param numPackets   [OUT] Number of packets pulled.
+     * @param timeout      Time in ms to wait for the first packet, 0 to not wait.
+     * @return   ER_OK if one or more packets were pulled, ER_WOULDBLOCK if none arrived before the timeout.
+     */
+    QStatus PullPacketBatch(PacketBuffer* packets, size_t maxPackets, size_t& numPackets, uint32_t timeout = qcc::Event::WAIT_FOREVER);
+#endif
+
+    /**
+     * Get the number of received datagrams dropped because they did not fit in the packet buffer.
+     */
+    uint32_t GetTruncatedPackets() const { return static_cast<uint32_t>(truncatedPackets); }
+
     /**
      * Get the Event indicating that data is available when signaled.
      *
@@ -109,6 +130,18 @@ class UDPPacketStream : public PacketStream {
      */
     QStatus PushPacketBytes(const void* buf, size_t numBytes, PacketDest& dest);
 
+#if defined(QCC_OS_LINUX)
+    /**
+     * Push a batch of packets to the socket with sendmmsg.
+     *
+     * @param packets      Packets to push.
+     * @param numPackets   Number of entries in packets.
+     * @param numSent      [OUT] Number of packets pushed before an error occurred.
+     * @return   ER_OK if all of the packets were pushed.
+     */
+    QStatus PushPacketBatch(PacketBuffer* packets, size_t numPackets, size_t& numSent);
+#endif
+
     /**
      * Get the Event that indicates when data can be pushed to sink.
      *
@@ -140,6 +173,7 @@ class UDPPacketStream : public PacketStream {
     qcc::SocketFd sock;
     qcc::Event* sourceEvent;
     qcc::Event* sinkEvent;
+    volatile int32_t truncatedPackets;  /**< Datagrams dropped by PullPacketBatch because they were truncated */
 };
 
 }  /* namespace */
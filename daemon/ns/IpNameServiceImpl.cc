@@ -453,7 +453,9 @@ IpNameServiceImpl::IpNameServiceImpl()
     m_loopback(false), m_enableIPv4(false), m_enableIPv6(false),
     m_wakeEvent(), m_forceLazyUpdate(false),
     m_enabled(false), m_doEnable(false), m_doDisable(false),
-    m_ipv4QuietSockFd(-1), m_ipv6QuietSockFd(-1)
+    m_ipv4QuietSockFd(-1), m_ipv6QuietSockFd(-1),
+    m_delta(false), m_retransmitCount(0), m_outboundTimestamp(0), m_coalesceWindow(COALESCE_WINDOW),
+    m_packetsSent(0), m_packetsReceived(0)
 {
     QCC_DbgHLPrintf(("IpNameServiceImpl::IpNameServiceImpl()"));
 
@@ -469,6 +471,8 @@ IpNameServiceImpl::IpNameServiceImpl()
     memset(&m_unreliableIPv4Port[0], 0, sizeof(m_unreliableIPv4Port));
     memset(&m_reliableIPv6Port[0], 0, sizeof(m_reliableIPv6Port));
     memset(&m_unreliableIPv6Port[0], 0, sizeof(m_unreliableIPv6Port));
+
+    memset(&m_lastFullRetransmit[0], 0, sizeof(m_lastFullRetransmit));
 }
 
 QStatus IpNameServiceImpl::Init(const qcc::String& guid, bool loopback)
@@ -496,6 +500,15 @@ QStatus IpNameServiceImpl::Init(const qcc::String& guid, bool loopback)
     m_enableIPv6 = config->Get("ip_name_service/property@enable_ipv6", "true") == "true";
     m_broadcast = config->Get("ip_name_service/property@disable_directed_broadcast", "false") == "false";
 
+    //
+    // Outbound messages queued close together are packed into as few packets
+    // as we can manage.  Delta mode replaces some periodic retransmissions with
+    // a digest of the advertised names; it is off unless asked for since
+    // daemons that predate it only hear the full retransmissions.
+    //
+    m_coalesceWindow = config->Get("ip_name_service/property@coalesce_ms", COALESCE_WINDOW);
+    m_delta = config->Get("ip_name_service/property@delta_advertisements", "false") == "true";
+
     //
     // Override the broadcast bit so we never actually use it (it didn't actually
     // work any better than multicast as it happens).
@@ -1745,6 +1758,14 @@ size_t IpNameServiceImpl::NumAdvertisements(TransportMask transportMask)
     return m_advertised[i].size();
 }
 
+void IpNameServiceImpl::GetPacketCounts(uint32_t& sent, uint32_t& received)
+{
+    m_mutex.Lock();
+    sent = m_packetsSent;
+    received = m_packetsReceived;
+    m_mutex.Unlock();
+}
+
 QStatus IpNameServiceImpl::AdvertiseName(TransportMask transportMask, const qcc::String& wkn, bool quietly)
 {
     QCC_DbgHLPrintf(("IpNameServiceImpl::AdvertiseName(0x%x, \"%s\", %d)", transportMask, wkn.c_str(), quietly));
@@ -2372,6 +2393,9 @@ void IpNameServiceImpl::QueueProtocolMessage(Header& header)
         qcc::Sleep(10);
         m_mutex.Lock();
     }
+    if (m_outbound.empty()) {
+        m_outboundTimestamp = qcc::GetTimestamp();
+    }
     m_outbound.push_back(header);
     m_wakeEvent.SetEvent();
     // printf("%s: m_mutex.Unlock()\n", __FUNCTION__);
@@ -2500,6 +2524,8 @@ void IpNameServiceImpl::SendProtocolMessage(
     uint8_t* buffer = new uint8_t[size];
     header.Serialize(buffer);
 
+    ++m_packetsSent;
+
     size_t sent;
 
     //
@@ -2765,10 +2791,15 @@ void IpNameServiceImpl::RewriteVersionSpecific(
         break;
 
     case 1:
+    case 2:
     {
-        QCC_DbgPrintf(("IpNameServiceImpl::RewriteVersionSpecific(): Answer gets version one"));
+        QCC_DbgPrintf(("IpNameServiceImpl::RewriteVersionSpecific(): Answer gets version %d", msgVersion));
 
-        isAt->SetVersion(1, 1);
+        //
+        // A version two answer (a digest) carries its endpoints exactly as a
+        // version one answer does.
+        //
+        isAt->SetVersion(msgVersion, msgVersion);
 
         uint32_t transportIndex = IndexFromBit(isAt->GetTransportMask());
         assert(transportIndex < 16 && "IpNameServiceImpl::RewriteVersionSpecific(): Bad transport index in messageg");
@@ -3319,9 +3350,107 @@ void IpNameServiceImpl::SendOutboundMessageActively(Header& header)
     }
 }
 
+//
+// Return the transports on whose behalf the questions and answers in a message
+// are sent.  Messages are sent out the interfaces opened by any of these
+// transports, so only messages on behalf of the same transports may be packed
+// together.
+//
+static TransportMask HeaderTransportMask(Header& header)
+{
+    TransportMask mask = TRANSPORT_NONE;
+
+    for (uint32_t i = 0; i < header.GetNumberQuestions(); ++i) {
+        WhoHas* whoHas;
+        header.GetQuestion(i, &whoHas);
+        mask |= whoHas->GetTransportMask();
+    }
+
+    for (uint32_t i = 0; i < header.GetNumberAnswers(); ++i) {
+        IsAt* isAt;
+        header.GetAnswer(i, &isAt);
+        mask |= isAt->GetTransportMask();
+    }
+
+    return mask;
+}
+
+//
+// Pack the messages on a list into as few messages as possible.  A message is
+// appended to an earlier message of the same version if the two are sent on
+// behalf of the same transports, to the same destination with the same timer
+// and the result still fits into a name service packet.  Messages of different
+// versions go to different audiences, so we can pack around them; but we never
+// move a message past an earlier one of the same version we could not pack it
+// into, since an advertisement and its cancellation must arrive in order.
+//
+static void CoalesceHeaders(list<Header>& headers)
+{
+    for (list<Header>::iterator i = headers.begin(); i != headers.end(); ++i) {
+        uint32_t nsVersion, msgVersion;
+        (*i).GetVersion(nsVersion, msgVersion);
+        TransportMask mask = HeaderTransportMask(*i);
+
+        list<Header>::iterator j = i;
+        ++j;
+        while (j != headers.end()) {
+            uint32_t jNsVersion, jMsgVersion;
+            (*j).GetVersion(jNsVersion, jMsgVersion);
+            if (jNsVersion != nsVersion || jMsgVersion != msgVersion) {
+                ++j;
+                continue;
+            }
+
+            if ((*j).GetTimer() != (*i).GetTimer() ||
+                (*j).DestinationSet() != (*i).DestinationSet() ||
+                ((*i).DestinationSet() && !((*j).GetDestination().addr == (*i).GetDestination().addr &&
+                                            (*j).GetDestination().port == (*i).GetDestination().port)) ||
+                HeaderTransportMask(*j) != mask) {
+                break;
+            }
+
+            Header merged = *i;
+            for (uint32_t k = 0; k < (*j).GetNumberQuestions(); ++k) {
+                merged.AddQuestion((*j).GetQuestion(k));
+            }
+            for (uint32_t k = 0; k < (*j).GetNumberAnswers(); ++k) {
+                merged.AddAnswer((*j).GetAnswer(k));
+            }
+
+            //
+            // Addresses are written into every answer as the message goes out
+            // an interface, so leave the usual 20 bytes of room for them in
+            // each answer.
+            //
+            size_t worstCase = merged.GetSerializedSize() + 20 * merged.GetNumberAnswers();
+            if (merged.GetNumberQuestions() > 255 || merged.GetNumberAnswers() > 255 ||
+                worstCase > IpNameServiceImpl::NS_MESSAGE_MAX) {
+                break;
+            }
+
+            *i = merged;
+            j = headers.erase(j);
+        }
+    }
+}
+
 void IpNameServiceImpl::SendOutboundMessages(void)
 {
     QCC_DbgPrintf(("IpNameServiceImpl::SendOutboundMessages()"));
+
+    //
+    // Hold on to messages until the coalescing window has passed so that a
+    // burst of advertisements and discovery requests goes out in as few
+    // packets as possible.  If we are on the way out, everything goes now.
+    //
+    if (m_outbound.empty()) {
+        return;
+    }
+    if (m_coalesceWindow && !m_terminal && qcc::GetTimestamp() - m_outboundTimestamp < m_coalesceWindow) {
+        return;
+    }
+    CoalesceHeaders(m_outbound);
+
     int count =  m_outbound.size();
     //
     // Send any messages we have queued for transmission.  We expect to be
@@ -3365,6 +3494,13 @@ void IpNameServiceImpl::SendOutboundMessages(void)
         m_mutex.Lock();
 
     }
+
+    //
+    // Anything queued while we were sending starts a new window.
+    //
+    if (!m_outbound.empty()) {
+        m_outboundTimestamp = qcc::GetTimestamp();
+    }
 }
 
 void* IpNameServiceImpl::Run(void* arg)
@@ -3524,6 +3660,20 @@ void* IpNameServiceImpl::Run(void* arg)
         checkEvents.push_back(&timerEvent);
         checkEvents.push_back(&m_wakeEvent);
 
+        //
+        // If messages are being held back to be packed together, we need to
+        // wake up when their coalescing window closes.
+        //
+        uint32_t holdMs = 0;
+        if (!m_outbound.empty() && m_coalesceWindow) {
+            uint32_t elapsed = qcc::GetTimestamp() - m_outboundTimestamp;
+            holdMs = (elapsed < m_coalesceWindow) ? m_coalesceWindow - elapsed : 1;
+        }
+        qcc::Event coalesceEvent(holdMs, 0);
+        if (holdMs) {
+            checkEvents.push_back(&coalesceEvent);
+        }
+
         //
         // We also need to wait on events from all of the sockets that
         // correspond to the "live" interfaces we need to listen for inbound
@@ -3611,6 +3761,12 @@ void* IpNameServiceImpl::Run(void* arg)
                 // it.
                 //
                 m_wakeEvent.ResetEvent();
+            } else if (*i == &coalesceEvent) {
+                //
+                // The coalescing window of the held outbound messages has
+                // closed.  They are sent at the top of the loop.
+                //
+                QCC_DbgPrintf(("IpNameServiceImpl::Run(): Coalesce event fired"));
             } else {
                 QCC_DbgPrintf(("IpNameServiceImpl::Run(): Socket event fired"));
                 //
@@ -3652,6 +3808,10 @@ void* IpNameServiceImpl::Run(void* arg)
 
                 QCC_DbgHLPrintf(("IpNameServiceImpl::Run(): Got IPNS message from \"%s\"", address.ToString().c_str()));
 
+                m_mutex.Lock();
+                ++m_packetsReceived;
+                m_mutex.Unlock();
+
                 //
                 // We got a message over the multicast channel.  Deal with it.
                 //
@@ -3675,6 +3835,12 @@ void IpNameServiceImpl::Retry(void)
     //
     ++tick;
 
+    //
+    // Collect the requests that are due so they can be packed together before
+    // they go out.
+    //
+    list<Header> due;
+
     //
     // use Meyers' idiom to keep iterators sane.
     //
@@ -3692,15 +3858,7 @@ void IpNameServiceImpl::Retry(void)
         }
 
         if (tick >= retryTick) {
-            //
-            // Send the message out over the multicast link (again).
-            //
-            if ((*i).DestinationSet()) {
-                SendOutboundMessageQuietly(*i);
-            } else {
-                SendOutboundMessageActively(*i);
-            }
-            qcc::Sleep(rand() % 128);
+            due.push_back(*i);
 
             uint32_t count = (*i).GetRetries();
             ++count;
@@ -3716,6 +3874,20 @@ void IpNameServiceImpl::Retry(void)
             ++i;
         }
     }
+
+    CoalesceHeaders(due);
+
+    for (list<Header>::iterator i = due.begin(); (m_state == IMPL_RUNNING) && (i != due.end()); ++i) {
+        //
+        // Send the message out over the multicast link (again).
+        //
+        if ((*i).DestinationSet()) {
+            SendOutboundMessageQuietly(*i);
+        } else {
+            SendOutboundMessageActively(*i);
+        }
+        qcc::Sleep(rand() % 128);
+    }
 }
 
 void IpNameServiceImpl::Retransmit(uint32_t transportIndex, bool exiting, bool quietly, const qcc::IPEndpoint& destination)
@@ -3756,6 +3928,14 @@ void IpNameServiceImpl::Retransmit(uint32_t transportIndex, bool exiting, bool q
         return;
     }
 
+    //
+    // Remember when everyone last heard all of our names so we can ignore
+    // requests for them that were crossing this retransmission on the wire.
+    //
+    if (quietly == false) {
+        m_lastFullRetransmit[transportIndex] = qcc::GetTimestamp();
+    }
+
     //
     // We are now at version one of the protocol.  There is a significant
     // difference between version zero and version one messages, so down-version
@@ -4145,6 +4325,77 @@ void IpNameServiceImpl::Retransmit(uint32_t transportIndex, bool exiting, bool q
     m_mutex.Unlock();
 }
 
+//
+// The digest of a list of advertised names is the 32-bit FNV-1a hash of the
+// names in sorted order, each followed by a zero octet.  Both std::list (kept
+// sorted) and std::set provide names in that order.
+//
+template <class Iterator>
+static uint32_t NameDigest(Iterator begin, Iterator end)
+{
+    uint32_t hash = 2166136261U;
+    for (Iterator i = begin; i != end; ++i) {
+        for (size_t j = 0; j < (*i).size(); ++j) {
+            hash ^= static_cast<uint8_t>((*i)[j]);
+            hash *= 16777619U;
+        }
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+void IpNameServiceImpl::RetransmitDigest(uint32_t transportIndex)
+{
+    QCC_DbgPrintf(("IpNameServiceImpl::RetransmitDigest()"));
+
+    m_mutex.Lock();
+
+    if (m_advertised[transportIndex].empty()) {
+        QCC_DbgPrintf(("IpNameServiceImpl::RetransmitDigest(): Nothing to do for transportIndex %d", transportIndex));
+        m_mutex.Unlock();
+        return;
+    }
+
+    //
+    // A digest is a version two is-at with no names, but with the endpoints of
+    // a version one is-at so that a daemon whose copy of our names matches
+    // the digest can refresh them exactly as if it had heard them again.
+    //
+    IsAt isAt;
+    isAt.SetVersion(2, 2);
+    isAt.SetTransportMask(MaskFromIndex(transportIndex));
+    isAt.SetCompleteFlag(true);
+
+    if (m_reliableIPv4Port[transportIndex]) {
+        isAt.SetReliableIPv4("", m_reliableIPv4Port[transportIndex]);
+    }
+    if (m_unreliableIPv4Port[transportIndex]) {
+        isAt.SetUnreliableIPv4("", m_unreliableIPv4Port[transportIndex]);
+    }
+    if (m_reliableIPv6Port[transportIndex]) {
+        isAt.SetReliableIPv6("", m_reliableIPv6Port[transportIndex]);
+    }
+    if (m_unreliableIPv6Port[transportIndex]) {
+        isAt.SetUnreliableIPv6("", m_unreliableIPv6Port[transportIndex]);
+    }
+
+    isAt.SetGuid(m_guid);
+
+    size_t count = m_advertised[transportIndex].size();
+    isAt.SetDigest(NameDigest(m_advertised[transportIndex].begin(), m_advertised[transportIndex].end()),
+                   static_cast<uint16_t>(count < 0xffff ? count : 0xffff));
+
+    Header header;
+    header.SetVersion(2, 2);
+    header.SetTimer(m_tDuration);
+    header.AddAnswer(isAt);
+    header.ClearDestination();
+
+    SendOutboundMessageActively(header);
+
+    m_mutex.Unlock();
+}
+
 void IpNameServiceImpl::DoPeriodicMaintenance(void)
 {
 #if HAPPY_WANDERER
@@ -4166,14 +4417,37 @@ void IpNameServiceImpl::DoPeriodicMaintenance(void)
     if (m_timer) {
         --m_timer;
         if (m_timer == m_tRetransmit) {
-            QCC_DbgPrintf(("IpNameServiceImpl::DoPeriodicMaintenance(): Retransmit()"));
+            //
+            // In delta mode only one in DELTA_FULL_MODULUS retransmissions
+            // carries our names, the others carry a digest of them.
+            //
+            bool digest = m_delta && (m_retransmitCount % DELTA_FULL_MODULUS) != 0;
+            ++m_retransmitCount;
+
+            QCC_DbgPrintf(("IpNameServiceImpl::DoPeriodicMaintenance(): %s()", digest ? "RetransmitDigest" : "Retransmit"));
             for (uint32_t index = 0; index < N_TRANSPORTS; ++index) {
-                Retransmit(index, false, false, qcc::IPEndpoint("0.0.0.0", 0));
+                if (digest) {
+                    RetransmitDigest(index);
+                } else {
+                    Retransmit(index, false, false, qcc::IPEndpoint("0.0.0.0", 0));
+                }
             }
             m_timer = m_tDuration;
         }
     }
 
+    //
+    // Forget what we heard of remote advertisements once they have expired.
+    //
+    uint32_t now = qcc::GetTimestamp();
+    for (map<pair<qcc::String, uint32_t>, PeerAdvertisement>::iterator i = m_peers.begin(); i != m_peers.end();) {
+        if (static_cast<int32_t>(now - i->second.m_expiry) > 0) {
+            m_peers.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+
     // printf("%s: m_mutex.Unlock()\n", __FUNCTION__);
     m_mutex.Unlock();
 }
@@ -4605,6 +4879,16 @@ void IpNameServiceImpl::HandleProtocolAnswer(IsAt isAt, uint32_t timer, const qc
         //
         qcc::String busAddress(addrbuf);
 
+        //
+        // Digests only cover the names a daemon advertises over multicast, so
+        // quiet responses, which come from an unbound socket rather than the
+        // name service port, must not be counted.  Nobody needs the copy of
+        // the names unless we are in delta mode.
+        //
+        if (m_delta && endpoint.port == MULTICAST_PORT) {
+            RecordPeerAdvertisement(guid, transportIndex, busAddress, wkn, timer);
+        }
+
         if (m_callback[transportIndex]) {
             m_protect_callback = true;
             m_mutex.Unlock();
@@ -4621,6 +4905,168 @@ void IpNameServiceImpl::HandleProtocolAnswer(IsAt isAt, uint32_t timer, const qc
     m_mutex.Unlock();
 }
 
+void IpNameServiceImpl::RecordPeerAdvertisement(const qcc::String& guid, uint32_t transportIndex, const qcc::String& busAddress,
+                                                const vector<qcc::String>& wkn, uint32_t timer)
+{
+    //
+    // We expect to be called with the mutex locked.  We don't trust the
+    // complete flag here since advertisements of new names are sent with it
+    // set; instead we accumulate names, drop them when they are withdrawn and
+    // start over whenever a digest tells us we have it wrong.
+    //
+    pair<qcc::String, uint32_t> key(guid, transportIndex);
+
+    if (timer == 0) {
+        map<pair<qcc::String, uint32_t>, PeerAdvertisement>::iterator i = m_peers.find(key);
+        if (i != m_peers.end()) {
+            for (uint32_t j = 0; j < wkn.size(); ++j) {
+                i->second.m_names.erase(wkn[j]);
+            }
+            if (i->second.m_names.empty()) {
+                m_peers.erase(i);
+            }
+        }
+        return;
+    }
+
+    PeerAdvertisement& peer = m_peers[key];
+    peer.m_names.insert(wkn.begin(), wkn.end());
+    peer.m_busAddresses.insert(busAddress);
+    peer.m_expiry = qcc::GetTimestamp() + timer * 1000;
+}
+
+void IpNameServiceImpl::HandleProtocolResync(WhoHas whoHas, const qcc::IPEndpoint& endpoint)
+{
+    QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolResync(%s)", endpoint.ToString().c_str()));
+
+    //
+    // A version two question names the daemons whose advertisements the
+    // asker has lost track of.  If we are one of them, we retransmit all of
+    // our names over the multicast group where anyone else who missed them
+    // can pick them up too.
+    //
+    bool forUs = false;
+    for (uint32_t i = 0; i < whoHas.GetNumberNames(); ++i) {
+        if (whoHas.GetName(i) == m_guid) {
+            forUs = true;
+            break;
+        }
+    }
+
+    if (forUs == false) {
+        return;
+    }
+
+    m_mutex.Lock();
+
+    uint32_t now = qcc::GetTimestamp();
+    for (uint32_t index = 0; index < N_TRANSPORTS; ++index) {
+        if (m_advertised[index].empty() || now - m_lastFullRetransmit[index] < RESYNC_HOLDDOWN * 1000) {
+            continue;
+        }
+
+        m_mutex.Unlock();
+        Retransmit(index, false, false, qcc::IPEndpoint("0.0.0.0", 0));
+        m_mutex.Lock();
+    }
+
+    m_mutex.Unlock();
+}
+
+void IpNameServiceImpl::HandleProtocolDigest(IsAt isAt, uint32_t timer, const qcc::IPEndpoint& endpoint)
+{
+    QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolDigest(%s)", endpoint.ToString().c_str()));
+
+    TransportMask transportMask = isAt.GetTransportMask();
+    if (CountOnes(transportMask) != 1) {
+        QCC_LogError(ER_BAD_TRANSPORT_MASK, ("IpNameServiceImpl::HandleProtocolDigest(): Bad transport mask"));
+        return;
+    }
+
+    uint32_t transportIndex = IndexFromBit(transportMask);
+    assert(transportIndex < 16 && "IpNameServiceImpl::HandleProtocolDigest(): Bad transport index");
+
+    m_mutex.Lock();
+
+    //
+    // If nobody is discovering over this transport we never kept a copy of
+    // the names and have no interest in them either.
+    //
+    if (m_callback[transportIndex] == NULL) {
+        QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolDigest(): No callback for transport, so nothing to do"));
+        m_mutex.Unlock();
+        return;
+    }
+
+    qcc::String guid = isAt.GetGuid();
+    pair<qcc::String, uint32_t> key(guid, transportIndex);
+    uint32_t now = qcc::GetTimestamp();
+
+    map<pair<qcc::String, uint32_t>, PeerAdvertisement>::iterator i = m_peers.find(key);
+    if (i != m_peers.end() &&
+        i->second.m_names.size() == isAt.GetDigestCount() &&
+        NameDigest(i->second.m_names.begin(), i->second.m_names.end()) == isAt.GetDigest()) {
+        //
+        // Our copy is current, so this is as good as hearing all of the names
+        // again.  Call back with the names for each address we heard them on
+        // so the timers are refreshed.
+        //
+        QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolDigest(): Digest matches, refreshing %d names", static_cast<int>(i->second.m_names.size())));
+        i->second.m_expiry = now + timer * 1000;
+
+        vector<qcc::String> wkn(i->second.m_names.begin(), i->second.m_names.end());
+        vector<qcc::String> busAddresses(i->second.m_busAddresses.begin(), i->second.m_busAddresses.end());
+
+        for (uint32_t j = 0; j < busAddresses.size(); ++j) {
+            if (m_callback[transportIndex]) {
+                m_protect_callback = true;
+                m_mutex.Unlock();
+                QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolDigest(): Calling back with %s", busAddresses[j].c_str()));
+                (*m_callback[transportIndex])(busAddresses[j], guid, wkn, timer);
+                m_mutex.Lock();
+                m_protect_callback = false;
+            }
+        }
+
+        m_mutex.Unlock();
+        return;
+    }
+
+    //
+    // Our copy is stale or we never had one.  Start over and ask for all of
+    // the names, but not more often than we retry discovery requests in case
+    // the answer is still on its way.
+    //
+    PeerAdvertisement& peer = m_peers[key];
+    peer.m_names.clear();
+    peer.m_busAddresses.clear();
+    peer.m_expiry = now + timer * 1000;
+
+    if (peer.m_resyncRequested && now - peer.m_resyncRequested < RETRY_INTERVAL * 1000) {
+        QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolDigest(): Digest mismatch, resync already requested"));
+        m_mutex.Unlock();
+        return;
+    }
+    peer.m_resyncRequested = now;
+
+    QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolDigest(): Digest mismatch, requesting names from %s", guid.c_str()));
+
+    WhoHas whoHas;
+    whoHas.SetVersion(2, 2);
+    whoHas.SetTransportMask(transportMask);
+    whoHas.AddName(guid);
+
+    Header header;
+    header.SetVersion(2, 2);
+    header.SetTimer(m_tDuration);
+    header.AddQuestion(whoHas);
+    header.ClearDestination();
+
+    SendOutboundMessageActively(header);
+
+    m_mutex.Unlock();
+}
+
 void IpNameServiceImpl::HandleProtocolMessage(uint8_t const* buffer, uint32_t nbytes, const qcc::IPEndpoint& endpoint)
 {
     QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolMessage(0x%x, %d, %s)", buffer, nbytes, endpoint.ToString().c_str()));
@@ -4642,15 +5088,34 @@ void IpNameServiceImpl::HandleProtocolMessage(uint8_t const* buffer, uint32_t nb
     }
 
     //
-    // We only understand version zero and one messages.
+    // We only understand version zero, one and two messages.
     //
     uint32_t nsVersion, msgVersion;
     header.GetVersion(nsVersion, msgVersion);
-    if (msgVersion != 0 && msgVersion != 1) {
+    if (msgVersion != 0 && msgVersion != 1 && msgVersion != 2) {
         QCC_DbgPrintf(("IpNameServiceImpl::HandleProtocolMessage(): Unknown version: Error"));
         return;
     }
 
+    //
+    // Version two messages are advertisement digests and requests for the
+    // names behind a digest that did not match.
+    //
+    if (msgVersion == 2) {
+        for (uint8_t i = 0; i < header.GetNumberQuestions(); ++i) {
+            HandleProtocolResync(header.GetQuestion(i), endpoint);
+        }
+
+        for (uint8_t i = 0; i < header.GetNumberAnswers(); ++i) {
+            IsAt isAt = header.GetAnswer(i);
+            isAt.SetVersion(nsVersion, msgVersion);
+            if (m_loopback || (isAt.GetGuid() != m_guid)) {
+                HandleProtocolDigest(isAt, header.GetTimer(), endpoint);
+            }
+        }
+        return;
+    }
+
     //
     // If the received packet contains questions, see if we can answer them.
     // We have the underlying device in loopback mode so we can get receive
@@ -28,6 +28,9 @@
 
 #include <vector>
 #include <list>
+#include <map>
+#include <set>
+#include <utility>
 
 #include <qcc/String.h>
 #include <qcc/Thread.h>
@@ -128,6 +131,31 @@ class IpNameServiceImpl : public qcc::Thread {
      */
     static const uint32_t RETRY_INTERVAL = 5;
 
+    /**
+     * @brief The default time for which queued outbound messages are held
+     * before being sent.  Messages queued within this window (for example by
+     * an application advertising many names one at a time) are packed into as
+     * few name service packets as possible.  Units are milliseconds.
+     */
+    static const uint32_t COALESCE_WINDOW = 50;
+
+    /**
+     * @brief In delta mode, periodic retransmissions alternate between the
+     * complete list of advertised names and a short digest of that list.  One
+     * in DELTA_FULL_MODULUS retransmissions carries the complete list so that
+     * daemons that do not understand digests still hear our names well
+     * within DEFAULT_DURATION.
+     */
+    static const uint32_t DELTA_FULL_MODULUS = 2;
+
+    /**
+     * @brief The minimum time between complete retransmissions made in
+     * response to requests from daemons whose copy of our advertisements is
+     * stale.  Requests arriving during this time are answered by the
+     * retransmission already made.  Units are seconds.
+     */
+    static const uint32_t RESYNC_HOLDDOWN = 2;
+
     /**
      * The modulus indicating the minimum time between interface lazy updates.
      * Units are seconds.
@@ -712,6 +740,16 @@ class IpNameServiceImpl : public qcc::Thread {
      */
     size_t NumAdvertisements(TransportMask transportMask);
 
+    /**
+     * @brief Get the number of name service packets sent and received.
+     *
+     * A message sent out over several interfaces counts once per interface.
+     *
+     * @param[out] sent The number of packets sent.
+     * @param[out] received The number of packets received.
+     */
+    void GetPacketCounts(uint32_t& sent, uint32_t& received);
+
     /**
      * @brief Handle the suspending event of the process. Release exclusive held socket file descriptor and port.
      */
@@ -1008,6 +1046,49 @@ class IpNameServiceImpl : public qcc::Thread {
      */
     void HandleProtocolAnswer(IsAt isAt, uint32_t timer, const qcc::IPEndpoint& address);
 
+    /**
+     * @internal
+     * @brief Do something with a received request to retransmit our complete
+     * advertisements (a version two question).
+     */
+    void HandleProtocolResync(WhoHas whoHas, const qcc::IPEndpoint& endpoint);
+
+    /**
+     * @internal
+     * @brief Do something with a received advertisement digest (a version two
+     * answer).
+     */
+    void HandleProtocolDigest(IsAt isAt, uint32_t timer, const qcc::IPEndpoint& endpoint);
+
+    /**
+     * @internal
+     * @brief Remember the names and bus address heard in a version one answer
+     * so that later digests of the same advertisement can be checked against
+     * them.  Only multicast answers are recorded, and only in delta mode.
+     */
+    void RecordPeerAdvertisement(const qcc::String& guid, uint32_t transportIndex, const qcc::String& busAddress,
+                                 const std::vector<qcc::String>& wkn, uint32_t timer);
+
+    /**
+     * @internal
+     * @brief What we have heard of the advertisements of a transport on a
+     * remote daemon.  Used to answer digests without the names being resent.
+     */
+    class PeerAdvertisement {
+      public:
+        PeerAdvertisement() : m_expiry(0), m_resyncRequested(0) { }
+        std::set<qcc::String> m_names;          /**< The names advertised, kept sorted for the digest */
+        std::set<qcc::String> m_busAddresses;   /**< The bus addresses the names were heard with */
+        uint32_t m_expiry;                      /**< The time (ms) after which the entry is forgotten */
+        uint32_t m_resyncRequested;             /**< The time (ms) we last asked for the complete names */
+    };
+
+    /**
+     * @internal
+     * @brief Remote advertisements keyed by daemon GUID and transport index.
+     */
+    std::map<std::pair<qcc::String, uint32_t>, PeerAdvertisement> m_peers;
+
     /**
      * One possible callback for each of the corresponding transport masks in a
      * sixteen-bit word.
@@ -1140,6 +1221,33 @@ class IpNameServiceImpl : public qcc::Thread {
      */
     void Retransmit(uint32_t index, bool exiting, bool quietly, const qcc::IPEndpoint& destination);
 
+    /**
+     * @internal
+     * @brief Retransmit a digest of exported advertisements (delta mode).
+     */
+    void RetransmitDigest(uint32_t index);
+
+    /**
+     * @internal
+     * @brief Set to true to send digests in place of some periodic
+     * retransmissions.
+     */
+    bool m_delta;
+
+    /**
+     * @internal
+     * @brief The number of periodic retransmissions made, used to choose
+     * between full retransmissions and digests in delta mode.
+     */
+    uint32_t m_retransmitCount;
+
+    /**
+     * @internal
+     * @brief The time (ms) of the last complete multicast retransmission for
+     * each transport.
+     */
+    uint32_t m_lastFullRetransmit[N_TRANSPORTS];
+
     /**
      * @internal
      * @brief Vector of name service messages reflecting recent locate
@@ -1223,6 +1331,27 @@ class IpNameServiceImpl : public qcc::Thread {
      */
     std::list<Header> m_outbound;
 
+    /**
+     * @internal
+     * @brief The time (ms) at which the oldest message on the outbound list
+     * was queued.
+     */
+    uint32_t m_outboundTimestamp;
+
+    /**
+     * @internal
+     * @brief The time (ms) outbound messages are held so they can be packed
+     * together.  Zero sends every message as soon as it is queued.
+     */
+    uint32_t m_coalesceWindow;
+
+    /**
+     * @internal
+     * @brief Counts of name service packets sent and received.
+     */
+    uint32_t m_packetsSent;
+    uint32_t m_packetsReceived;
+
 #if defined(QCC_OS_GROUP_WINDOWS)
     /**
      * @internal @brief A socket to hold to keep winsock initialized
@@ -114,7 +114,8 @@ IsAt::IsAt()
     m_flagT(false), m_flagU(false), m_flagS(false), m_flagF(false),
     m_flagR4(false), m_flagU4(false), m_flagR6(false), m_flagU6(false),
     m_port(0),
-    m_reliableIPv4Port(0), m_unreliableIPv4Port(0), m_reliableIPv6Port(0), m_unreliableIPv6Port(0)
+    m_reliableIPv4Port(0), m_unreliableIPv4Port(0), m_reliableIPv6Port(0), m_unreliableIPv6Port(0),
+    m_digest(0), m_digestCount(0)
 {
 }
 
@@ -346,6 +347,7 @@ size_t IsAt::GetSerializedSize(void) const
         break;
 
     case 1:
+    case 2:
         //
         // We have one octet for type and flags, one octet for count and
         // two octets for the transport mask.  Four octets to start.
@@ -400,6 +402,13 @@ size_t IsAt::GetSerializedSize(void) const
             s.Set(m_names[i]);
             size += s.GetSerializedSize();
         }
+
+        //
+        // Version two adds four octets of digest and two octets of name count.
+        //
+        if ((m_version & 0xf) == 2) {
+            size += 6;
+        }
         break;
 
     default:
@@ -530,6 +539,7 @@ size_t IsAt::Serialize(uint8_t* buffer) const
         break;
 
     case 1:
+    case 2:
         //
         // The first octet is type (M = 1) and flags.
         //
@@ -671,6 +681,17 @@ size_t IsAt::Serialize(uint8_t* buffer) const
             size += stringSize;
             p += stringSize;
         }
+
+        if ((m_version & 0xf) == 2) {
+            *p++ = static_cast<uint8_t>(m_digest >> 24);
+            *p++ = static_cast<uint8_t>(m_digest >> 16);
+            *p++ = static_cast<uint8_t>(m_digest >> 8);
+            *p++ = static_cast<uint8_t>(m_digest);
+            *p++ = static_cast<uint8_t>(m_digestCount >> 8);
+            *p++ = static_cast<uint8_t>(m_digestCount);
+            QCC_DbgPrintf(("IsAt::Serialize(): Digest 0x%x over %d names", m_digest, m_digestCount));
+            size += 6;
+        }
         break;
 
     default:
@@ -847,6 +868,7 @@ size_t IsAt::Deserialize(uint8_t const* buffer, uint32_t bufsize)
         break;
 
     case 1:
+    case 2:
         //
         // If there's not enough room in the buffer to get the fixed part out then
         // bail (one byte of type and flags, one byte of name count)
@@ -1048,6 +1070,24 @@ size_t IsAt::Deserialize(uint8_t const* buffer, uint32_t bufsize)
             p += stringSize;
             bufsize -= stringSize;
         }
+
+        //
+        // Version two is-at messages end with the digest of the complete list
+        // of names and the number of names it covers.
+        //
+        if ((m_version & 0xf) == 2) {
+            if (bufsize < 6) {
+                QCC_DbgPrintf(("IsAt::Deserialize(): Insufficient bufsize %d for digest", bufsize));
+                return 0;
+            }
+            m_digest = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                       (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+            m_digestCount = (static_cast<uint16_t>(p[4]) << 8) | static_cast<uint16_t>(p[5]);
+            QCC_DbgPrintf(("IsAt::Deserialize(): Digest 0x%x over %d names", m_digest, m_digestCount));
+            size += 6;
+            p += 6;
+            bufsize -= 6;
+        }
         break;
 
     default:
@@ -1103,6 +1143,7 @@ size_t WhoHas::GetSerializedSize(void) const
     switch (m_version & 0xf) {
     case 0:
     case 1:
+    case 2:
         //
         // We have one octet for type and flags and one octet for count.
         // Two octets to start.
@@ -1267,6 +1308,7 @@ size_t WhoHas::Deserialize(uint8_t const* buffer, uint32_t bufsize)
         break;
 
     case 1:
+    case 2:
         m_flagT = m_flagU = m_flagS = m_flagF = false;
         break;
 
@@ -1507,12 +1549,12 @@ size_t Header::Deserialize(uint8_t const* buffer, uint32_t bufsize)
     uint8_t nsVersion, msgVersion;
     nsVersion = buffer[0] >> 4;
     msgVersion = buffer[0] & 0xf;
-    if (nsVersion != 0 && nsVersion != 1) {
+    if (nsVersion > 2) {
         QCC_DbgPrintf(("Header::Deserialize(): Bad remote name service version %d", nsVersion));
         return 0;
     }
 
-    if (msgVersion != 0 && msgVersion != 1) {
+    if (msgVersion > 2) {
         QCC_DbgPrintf(("Header::Deserialize(): Bad message version %d", msgVersion));
         return 0;
     }
@@ -230,6 +230,37 @@ namespace ajn {
  * @li @c TransportMask The bit mask of transport identifiers that indicates which
  *     AllJoyn transport is making the advertisement.
  *
+ * <b>Version 2</b>
+ *
+ * Version two is-at messages are digests of an advertisement.  A daemon that
+ * periodically retransmits hundreds of names can send a single digest instead
+ * of the several full version one messages it would take to carry its names.
+ * Receivers that hold a copy of the names matching the digest refresh them;
+ * receivers whose copy is stale ask for the names with a version two who-has.
+ * Version one daemons discard version two messages, so digests are only ever
+ * sent in addition to full version one advertisements.
+ *
+ * The message is a version one is-at followed by the digest.  The count of
+ * StringData records is normally zero.
+ *
+ * @verbatim
+ *      0                   1                   2                   3
+ *      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ *     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *     |                                                               |
+ *     ~                 Version one IS-AT message                     ~
+ *     |                                                               |
+ *     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *     |                            Digest                             |
+ *     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *     |          Name Count           |
+ *     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * @endverbatim
+ *
+ * @li @c Digest The 32-bit FNV-1a hash of all of the well-known names actively
+ *     advertised by the transport, in sorted order, each followed by a zero octet.
+ * @li @c Name Count The number of names covered by the digest.
+ *
  * <b>WHO-HAS Message</b>
  *
  * The WHO-HAS message is a "question" message used to ask AllJoyn daemons if
@@ -290,6 +321,14 @@ namespace ajn {
  * @li @c Count The number of StringData items that follow.  Each StringData item
  *     describes one well-known bus name that the querying daemon is interested in.
  *
+ * <b>Version 2</b>
+ *
+ * Version two who-has messages have the same layout as version one, but the
+ * StringData records are daemon GUIDs rather than well-known names.  They are
+ * sent by a daemon that received a version two is-at digest that does not
+ * match its copy of the advertisement, and ask the daemons named to retransmit
+ * their complete advertisements.
+ *
  * <b>Messages<b>
  *
  * A name service message consists of a header, followed by a variable
@@ -1198,6 +1237,35 @@ class IsAt : public ProtocolElement {
      */
     qcc::String GetName(uint32_t index) const;
 
+    /**
+     * @internal
+     * @brief Set the digest of the complete list of names advertised by the
+     * sending transport.
+     *
+     * @param digest The digest of the names.
+     * @param count The number of names covered by the digest.
+     *
+     * @warning Useful for version two objects only.
+     */
+    void SetDigest(uint32_t digest, uint16_t count) { m_digest = digest; m_digestCount = count; }
+
+    /**
+     * @internal
+     * @brief Get the digest of the complete list of names advertised by the
+     * sending transport.
+     *
+     * @warning Useful for version two objects only.
+     */
+    uint32_t GetDigest(void) const { return m_digest; }
+
+    /**
+     * @internal
+     * @brief Get the number of names covered by the digest.
+     *
+     * @warning Useful for version two objects only.
+     */
+    uint16_t GetDigestCount(void) const { return m_digestCount; }
+
     /**
      * @internal
      * @brief Get the size of a buffer that will allow the answer object and
@@ -1267,6 +1335,9 @@ class IsAt : public ProtocolElement {
 
     qcc::String m_guid;
     std::vector<qcc::String> m_names;
+
+    uint32_t m_digest;        /**< Version two only */
+    uint16_t m_digestCount;   /**< Version two only */
 };
 
 /**
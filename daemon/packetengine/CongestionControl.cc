@@ -0,0 +1,305 @@
+/**
+ * @file
+ * Congestion controllers for PacketEngine channels.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <cmath>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/Util.h>
+
+#include "CongestionControl.h"
+
+#define QCC_MODULE "PACKET"
+
+using namespace qcc;
+
+namespace ajn {
+
+/* CUBIC constants (RFC 8312) */
+static const double CUBIC_C = 0.4;
+static const double CUBIC_BETA = 0.7;
+
+/* Gains applied to the estimated bandwidth-delay product by the BBR-like controller */
+static const double BBR_CWND_GAIN = 2.0;
+static const double BBR_STARTUP_GROWTH = 1.25;
+static const double BBR_PROBE_GAINS[] = { 1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+
+/**
+ * The PacketEngine's original algorithm: slow start up to the threshold, then one more packet
+ * per window of acks. The window is halved on loss and on timeout.
+ */
+class RenoCongestionControl : public CongestionControl {
+  public:
+    RenoCongestionControl(uint16_t maxWindow) :
+        CongestionControl(maxWindow), cwnd(1), ssThresh(maxWindow), consecutiveAcks(0) { }
+
+    CongestionControlType GetType() const { return CONGESTION_CONTROL_RENO; }
+
+    void OnAck(uint16_t ackedPackets, uint32_t rttMs, uint64_t now)
+    {
+        while (ackedPackets && (cwnd < maxWindow)) {
+            if ((cwnd < ssThresh) || (consecutiveAcks >= cwnd)) {
+                ++cwnd;
+                consecutiveAcks = 0;
+            } else {
+                ++consecutiveAcks;
+            }
+            --ackedPackets;
+        }
+    }
+
+    void OnLoss(uint64_t now)
+    {
+        if (cwnd > 1) {
+            cwnd = cwnd >> 1;
+            ssThresh = (cwnd > 2) ? cwnd : 2;
+        }
+    }
+
+    void OnTimeout(uint64_t now) { OnLoss(now); }
+
+    uint16_t GetWindow() const { return cwnd; }
+
+    bool InSlowStart() const { return cwnd <= ssThresh; }
+
+  private:
+    uint16_t cwnd;
+    uint16_t ssThresh;
+    uint16_t consecutiveAcks;
+};
+
+/**
+ * CUBIC: after a loss the window grows along a cubic curve that is flat around the window
+ * where the loss happened, so it returns quickly to the previous rate and probes beyond it
+ * carefully. The window never grows slower than Reno would.
+ */
+class CubicCongestionControl : public CongestionControl {
+  public:
+    CubicCongestionControl(uint16_t maxWindow) :
+        CongestionControl(maxWindow), cwnd(1.0), ssThresh(maxWindow), wMax(0.0), wEst(0.0), k(0.0), epochStart(0), srttMs(0) { }
+
+    CongestionControlType GetType() const { return CONGESTION_CONTROL_CUBIC; }
+
+    void OnAck(uint16_t ackedPackets, uint32_t rttMs, uint64_t now)
+    {
+        if (rttMs) {
+            srttMs = srttMs ? ((7 * srttMs + rttMs) >> 3) : rttMs;
+        }
+        if (cwnd < ssThresh) {
+            cwnd += ackedPackets;
+        } else {
+            if (epochStart == 0) {
+                epochStart = now;
+                if (cwnd < wMax) {
+                    k = ::pow((wMax - cwnd) / CUBIC_C, 1.0 / 3.0);
+                } else {
+                    k = 0.0;
+                    wMax = cwnd;
+                }
+                wEst = cwnd;
+            }
+            /* Window the cubic curve gives one RTT from now */
+            double t = static_cast<double>(now - epochStart + srttMs) / 1000.0;
+            double target = CUBIC_C * (t - k) * (t - k) * (t - k) + wMax;
+
+            /* Reno friendly window */
+            wEst += (3.0 * (1.0 - CUBIC_BETA) / (1.0 + CUBIC_BETA)) * ackedPackets / cwnd;
+            if (target < wEst) {
+                target = wEst;
+            }
+            if (target > cwnd) {
+                cwnd += ((target - cwnd) / cwnd) * ackedPackets;
+            }
+        }
+        if (cwnd > maxWindow) {
+            cwnd = maxWindow;
+        }
+    }
+
+    void OnLoss(uint64_t now)
+    {
+        /* Fast convergence: give up bandwidth sooner if the window was still below the last peak */
+        wMax = (cwnd < wMax) ? (cwnd * (1.0 + CUBIC_BETA) / 2.0) : cwnd;
+        cwnd = cwnd * CUBIC_BETA;
+        if (cwnd < 2.0) {
+            cwnd = 2.0;
+        }
+        ssThresh = cwnd;
+        epochStart = 0;
+    }
+
+    void OnTimeout(uint64_t now)
+    {
+        OnLoss(now);
+        cwnd = 1.0;
+    }
+
+    uint16_t GetWindow() const { return ClampWindow(cwnd); }
+
+    bool InSlowStart() const { return cwnd < ssThresh; }
+
+  private:
+    double cwnd;
+    double ssThresh;
+    double wMax;                /* Window at the last loss */
+    double wEst;                /* Window Reno would have reached in this epoch */
+    double k;                   /* Seconds from the start of the epoch until the curve reaches wMax */
+    uint64_t epochStart;        /* Start of the current growth epoch, 0 if none */
+    uint32_t srttMs;
+};
+
+/**
+ * A BBR-like controller. The bottleneck delivery rate is the max rate seen over the last
+ * BW_ROUNDS rounds and the propagation delay is the min RTT seen over MIN_RTT_WINDOW_MS. The
+ * window follows a multiple of their product. The window grows exponentially at start up until
+ * the delivery rate stops increasing, after which a gain cycle probes for more bandwidth
+ * one round in eight. Loss found by selective acks does not shrink the window.
+ *
+ * Unlike BBR this does not pace packets, the PacketEngine sends whatever the window allows.
+ */
+class BbrCongestionControl : public CongestionControl {
+  public:
+    BbrCongestionControl(uint16_t maxWindow) :
+        CongestionControl(maxWindow), cwnd(1.0), startup(true), minRttMs(0), minRttTs(0),
+        roundStart(0), roundDelivered(0), round(0), fullBw(0.0), fullBwRounds(0)
+    {
+        for (size_t i = 0; i < BW_ROUNDS; ++i) {
+            bwSamples[i] = 0.0;
+        }
+    }
+
+    CongestionControlType GetType() const { return CONGESTION_CONTROL_BBR; }
+
+    void OnAck(uint16_t ackedPackets, uint32_t rttMs, uint64_t now)
+    {
+        if (rttMs && ((minRttMs == 0) || (rttMs <= minRttMs) || ((now - minRttTs) > MIN_RTT_WINDOW_MS))) {
+            minRttMs = rttMs;
+            minRttTs = now;
+        }
+
+        /* Sample the delivery rate once per round trip */
+        if (roundStart == 0) {
+            roundStart = now;
+        }
+        roundDelivered += ackedPackets;
+        uint32_t roundMs = (minRttMs > 0) ? minRttMs : 1;
+        if ((now - roundStart) >= roundMs) {
+            bwSamples[round % BW_ROUNDS] = static_cast<double>(roundDelivered) / (now - roundStart);
+            ++round;
+            roundStart = now;
+            roundDelivered = 0;
+            if (startup) {
+                double bw = GetMaxBw();
+                if (bw >= (fullBw * BBR_STARTUP_GROWTH)) {
+                    fullBw = bw;
+                    fullBwRounds = 0;
+                } else if (++fullBwRounds >= 3) {
+                    startup = false;
+                }
+            }
+        }
+
+        if (startup) {
+            cwnd += ackedPackets;
+        } else {
+            double target = GetMaxBw() * minRttMs * BBR_CWND_GAIN * BBR_PROBE_GAINS[round % ArraySize(BBR_PROBE_GAINS)];
+            if (target < MIN_WINDOW) {
+                target = MIN_WINDOW;
+            }
+            cwnd = ((cwnd + ackedPackets) < target) ? (cwnd + ackedPackets) : target;
+        }
+        if (cwnd > maxWindow) {
+            cwnd = maxWindow;
+        }
+    }
+
+    void OnLoss(uint64_t now) { }
+
+    void OnTimeout(uint64_t now)
+    {
+        /* Keep the model, acks grow the window back to the target */
+        if (cwnd > MIN_WINDOW) {
+            cwnd = MIN_WINDOW;
+        }
+    }
+
+    uint16_t GetWindow() const { return ClampWindow(cwnd); }
+
+    bool InSlowStart() const { return startup; }
+
+  private:
+    static const size_t BW_ROUNDS = 10;
+    static const uint32_t MIN_RTT_WINDOW_MS = 10000;
+    static const uint16_t MIN_WINDOW = 4;
+
+    double GetMaxBw() const
+    {
+        double bw = 0.0;
+        for (size_t i = 0; i < BW_ROUNDS; ++i) {
+            bw = (bwSamples[i] > bw) ? bwSamples[i] : bw;
+        }
+        return bw;
+    }
+
+    double cwnd;
+    bool startup;
+    uint32_t minRttMs;
+    uint64_t minRttTs;
+    uint64_t roundStart;
+    uint32_t roundDelivered;
+    uint32_t round;
+    double bwSamples[BW_ROUNDS];    /* Delivered packets per ms over the last BW_ROUNDS rounds */
+    double fullBw;
+    uint32_t fullBwRounds;
+};
+
+CongestionControl* CongestionControl::Create(CongestionControlType type, uint16_t maxWindow)
+{
+    switch (type) {
+    case CONGESTION_CONTROL_CUBIC:
+        return new CubicCongestionControl(maxWindow);
+
+    case CONGESTION_CONTROL_BBR:
+        return new BbrCongestionControl(maxWindow);
+
+    case CONGESTION_CONTROL_RENO:
+    default:
+        return new RenoCongestionControl(maxWindow);
+    }
+}
+
+QStatus CongestionControl::ParseType(const qcc::String& name, CongestionControlType& type)
+{
+    if (name == "reno") {
+        type = CONGESTION_CONTROL_RENO;
+    } else if (name == "cubic") {
+        type = CONGESTION_CONTROL_CUBIC;
+    } else if (name == "bbr") {
+        type = CONGESTION_CONTROL_BBR;
+    } else {
+        return ER_BAD_ARG_1;
+    }
+    return ER_OK;
+}
+
+}
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * Congestion controllers for PacketEngine channels.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_CONGESTIONCONTROL_H
+#define _ALLJOYN_CONGESTIONCONTROL_H
+
+#include <qcc/platform.h>
+#include <qcc/String.h>
+
+namespace ajn {
+
+/**
+ * Congestion control algorithms available to PacketEngine channels.
+ */
+enum CongestionControlType {
+    CONGESTION_CONTROL_RENO,    /**< Slow start, one packet per window increase, halve the window on loss */
+    CONGESTION_CONTROL_CUBIC,   /**< CUBIC window growth with a multiplicative decrease of 0.7 on loss */
+    CONGESTION_CONTROL_BBR      /**< Window sized from the measured delivery rate and min RTT, loss does not shrink it */
+};
+
+/**
+ * CongestionControl decides how many unacknowledged packets a channel may have in flight.
+ *
+ * The PacketEngine calls OnAck for newly acknowledged packets, OnLoss once per loss episode found
+ * by selective acks and OnTimeout once per episode of retransmission timeouts. All calls for
+ * a channel are made with the channel's tx lock held.
+ */
+class CongestionControl {
+  public:
+    /**
+     * Create a congestion controller.
+     *
+     * @param type        Algorithm to use.
+     * @param maxWindow   Largest window the controller may return.
+     * @return  A new controller, owned by the caller.
+     */
+    static CongestionControl* Create(CongestionControlType type, uint16_t maxWindow);
+
+    /**
+     * Get the algorithm for a configuration name ("reno", "cubic" or "bbr").
+     *
+     * @param name        Algorithm name.
+     * @param[out] type   The algorithm.
+     * @return  ER_OK if successful, ER_BAD_ARG_1 if the name is not known.
+     */
+    static QStatus ParseType(const qcc::String& name, CongestionControlType& type);
+
+    /** Destructor */
+    virtual ~CongestionControl() { }
+
+    /**
+     * Get the algorithm of this controller.
+     */
+    virtual CongestionControlType GetType() const = 0;
+
+    /**
+     * Packets were acknowledged.
+     *
+     * @param ackedPackets  Number of packets newly acknowledged.
+     * @param rttMs         Round trip time sample in ms, 0 if the ack has no sample.
+     * @param now           Current time in ms.
+     */
+    virtual void OnAck(uint16_t ackedPackets, uint32_t rttMs, uint64_t now) = 0;
+
+    /**
+     * A packet was found lost by selective acks and is being fast retransmitted.
+     *
+     * @param now           Current time in ms.
+     */
+    virtual void OnLoss(uint64_t now) = 0;
+
+    /**
+     * A packet's retransmission timer expired.
+     *
+     * @param now           Current time in ms.
+     */
+    virtual void OnTimeout(uint64_t now) = 0;
+
+    /**
+     * Get the number of packets allowed in flight.
+     */
+    virtual uint16_t GetWindow() const = 0;
+
+    /**
+     * Check if the window is still growing exponentially. Receivers are asked to ack each packet
+     * while this is true.
+     */
+    virtual bool InSlowStart() const = 0;
+
+  protected:
+    CongestionControl(uint16_t maxWindow) : maxWindow(maxWindow) { }
+
+    /** Convert a fractional window to a packet count in [1, maxWindow] */
+    uint16_t ClampWindow(double window) const
+    {
+        return (window < 1.0) ? 1 : ((window > maxWindow) ? maxWindow : static_cast<uint16_t>(window));
+    }
+
+    uint16_t maxWindow;
+};
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 #include <qcc/time.h>
 
 #include "Packet.h"
+#include "PacketCRC.h"
 #include "PacketStream.h"
 
 #if defined(QCC_OS_DARWIN)
@@ -77,6 +78,7 @@ Packet::Packet(size_t _mtu) :
     fastRetransmit(false),
     mtu(_mtu),
     crc16(0),
+    payloadCrcValid(false),
     version(0)
 {
 }
@@ -95,6 +97,7 @@ Packet::Packet(const Packet& other) :
     fastRetransmit(other.fastRetransmit),
     mtu(other.mtu),
     crc16(other.crc16),
+    payloadCrcValid(other.payloadCrcValid),
     version(other.version)
 {
 }
@@ -118,6 +121,7 @@ Packet& Packet::operator=(const Packet& other)
         fastRetransmit = other.fastRetransmit;
         mtu = other.mtu;
         crc16 = other.crc16;
+        payloadCrcValid = other.payloadCrcValid;
         version = other.version;
     }
     return *this;
@@ -134,11 +138,15 @@ size_t Packet::SetPayload(const void* _payload, size_t _payloadLen)
         _payloadLen = 0;
     }
     payloadLen = std::min(_payloadLen, mtu - PAYLOAD_OFFSET);
+    payloadCrcValid = false;
     if (_payload) {
         payload = buffer + (PAYLOAD_OFFSET / sizeof(uint32_t));
         if (payload != _payload) {
-            ::memmove(payload, _payload, payloadLen);
+            crc16 = PacketCRC16Copy(payload, _payload, payloadLen);
+        } else {
+            crc16 = PacketCRC16(payload, payloadLen);
         }
+        payloadCrcValid = true;
     }
     return payloadLen;
 }
@@ -146,20 +154,31 @@ size_t Packet::SetPayload(const void* _payload, size_t _payloadLen)
 QStatus Packet::Unmarshal(PacketSource& source)
 {
     /* Get bytes from source */
-    size_t actBytes;
+    size_t actBytes = 0;
     QStatus status = source.PullPacketBytes(buffer, mtu, actBytes, sender, 3000);
+    return ParseBuffer(status, actBytes);
+}
+
+QStatus Packet::Unmarshal(const PacketDest& sender, size_t numBytes)
+{
+    this->sender = sender;
+    return ParseBuffer(ER_OK, numBytes);
+}
+
+QStatus Packet::ParseBuffer(QStatus status, size_t actBytes)
+{
     uint8_t* tBuf = reinterpret_cast<uint8_t*>(buffer);
 
+    payloadCrcValid = false;
     if (actBytes < PAYLOAD_OFFSET) {
         status = ER_PACKET_BAD_FORMAT;
     }
 
     if (status == ER_OK) {
         /* Crc check */
-        uint16_t crc = 0;
         uint16_t packetCrc = letoh16(*reinterpret_cast<uint16_t*>(tBuf + CRC_OFFSET));
-        CRC16_Compute(tBuf, CRC_OFFSET, &crc);
-        CRC16_Compute(tBuf + PAYLOAD_OFFSET, actBytes - PAYLOAD_OFFSET, &crc);
+        uint16_t crc = PacketCRC16(tBuf, CRC_OFFSET);
+        crc = PacketCRC16(tBuf + PAYLOAD_OFFSET, actBytes - PAYLOAD_OFFSET, crc);
         status = (crc == packetCrc) ? ER_OK : ER_PACKET_BAD_CRC;
     }
 
@@ -212,10 +231,14 @@ void Packet::Marshal()
     if ((tBuf + PAYLOAD_OFFSET) != reinterpret_cast<uint8_t*>(payload)) {
         ::memmove(tBuf + PAYLOAD_OFFSET, payload, payloadLen);
     }
-    uint16_t crc = 0;
-    CRC16_Compute(tBuf, CRC_OFFSET, &crc);
+    uint16_t crc = PacketCRC16(tBuf, CRC_OFFSET);
     if (payloadLen) {
-        CRC16_Compute(tBuf + PAYLOAD_OFFSET, payloadLen, &crc);
+        if (payloadCrcValid) {
+            /* Payload CRC was computed by SetPayload */
+            crc = PacketCRC16Combine(crc, crc16, payloadLen);
+        } else {
+            crc = PacketCRC16(tBuf + PAYLOAD_OFFSET, payloadLen, crc);
+        }
     }
     *reinterpret_cast<uint16_t*>(tBuf + CRC_OFFSET) = htole16(crc);
 }
@@ -233,6 +256,7 @@ void Packet::Clean()
     sendAttempts = 0;
     fastRetransmit = false;
     crc16 = 0;
+    payloadCrcValid = false;
     version = 0;
 }
 
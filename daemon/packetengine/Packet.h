@@ -93,6 +93,14 @@ class Packet {
     /** Destructor */
     ~Packet();
 
+    /**
+     * Copy a payload into the packet. The CRC of the payload is computed while it is copied so
+     * Marshal only needs to checksum the header.
+     *
+     * @param payload      Payload bytes.
+     * @param payloadLen   Number of payload bytes.
+     * @return  The number of bytes that fit in the packet.
+     */
     size_t SetPayload(const void* payload, size_t payloadLen);
     void SetSender(const PacketDest& sender) { this->sender = sender; }
     const PacketDest& GetSender() const { return sender; }
@@ -105,6 +113,15 @@ class Packet {
      */
     QStatus Unmarshal(PacketSource& source);
 
+    /**
+     * Unmarshal a serialized packet that has already been pulled into the buffer member.
+     *
+     * @param sender     Sender of the packet.
+     * @param numBytes   Number of bytes in the buffer.
+     * @return ER_OK if successful.
+     */
+    QStatus Unmarshal(const PacketDest& sender, size_t numBytes);
+
     /**
      * Marshal packet state into serialized form.
      * After calling this method, the packet's object state will be serialized into the buffer member.
@@ -118,11 +135,14 @@ class Packet {
 
   private:
     size_t mtu;
-    uint16_t crc16;
+    uint16_t crc16;          /* CRC of the payload, valid if payloadCrcValid is true */
+    bool payloadCrcValid;
     uint8_t version;
     PacketDest sender;
 
     Packet();
+
+    QStatus ParseBuffer(QStatus status, size_t actBytes);
 };
 
 class PacketReceiver {
@@ -0,0 +1,214 @@
+/**
+ * @file
+ * Fast CRC16 for PacketEngine packets.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <cstring>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/Util.h>
+
+#include "PacketCRC.h"
+
+#define QCC_MODULE "PACKET"
+
+using namespace qcc;
+
+namespace ajn {
+
+#define CRC16_POLY 0x1021
+
+/*
+ * crcTable[k][b] is the CRC of byte b followed by k zero bytes, so eight bytes can be folded into
+ * the CRC with eight independent table lookups.
+ */
+typedef const uint16_t (*CRCTable)[256];
+static uint16_t crcTable[8][256];
+
+/*
+ * The tables are built and checked by the first caller rather than by a static constructor, so
+ * nothing runs or logs during static initialization. activeTable is published once the tables
+ * pass the check. Until then, or if the check fails, callers use CRC16_Compute.
+ */
+static volatile int32_t crcTableInit = 0;
+static CRCTable volatile activeTable = NULL;
+
+static inline uint16_t TableCRC(CRCTable table, const uint8_t* p, size_t len, uint16_t crc)
+{
+    while (len >= 8) {
+        crc = table[7][p[0] ^ (crc >> 8)] ^ table[6][p[1] ^ (crc & 0xFF)] ^
+              table[5][p[2]] ^ table[4][p[3]] ^ table[3][p[4]] ^
+              table[2][p[5]] ^ table[1][p[6]] ^ table[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = static_cast<uint16_t>(crc << 8) ^ table[0][(crc >> 8) ^ *p++];
+    }
+    return crc;
+}
+
+static inline uint16_t TableCRCCopy(CRCTable table, uint8_t* d, const uint8_t* p, size_t len, uint16_t crc)
+{
+    while (len >= 8) {
+        ::memcpy(d, p, 8);
+        crc = table[7][p[0] ^ (crc >> 8)] ^ table[6][p[1] ^ (crc & 0xFF)] ^
+              table[5][p[2]] ^ table[4][p[3]] ^ table[3][p[4]] ^
+              table[2][p[5]] ^ table[1][p[6]] ^ table[0][p[7]];
+        d += 8;
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        *d++ = *p;
+        crc = static_cast<uint16_t>(crc << 8) ^ table[0][(crc >> 8) ^ *p++];
+    }
+    return crc;
+}
+
+/* Multiply two polynomials modulo the CRC polynomial */
+static uint16_t MulMod(uint16_t a, uint16_t b)
+{
+    uint16_t r = 0;
+    for (int i = 15; i >= 0; --i) {
+        r = static_cast<uint16_t>(r << 1) ^ ((r & 0x8000) ? CRC16_POLY : 0);
+        if ((b >> i) & 1) {
+            r ^= a;
+        }
+    }
+    return r;
+}
+
+/* Advance a CRC over len zero bytes: crc * x^(8 * len) mod poly */
+static uint16_t ShiftCRC(uint16_t crc, size_t len)
+{
+    uint16_t xPow = 1;
+    uint16_t base = 0x0100;   /* x^8 */
+    while (len) {
+        if (len & 1) {
+            xPow = MulMod(xPow, base);
+        }
+        base = MulMod(base, base);
+        len >>= 1;
+    }
+    return MulMod(crc, xPow);
+}
+
+/*
+ * Build the tables and check them against CRC16_Compute before use.
+ */
+static bool InitCRCTables()
+{
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint16_t crc = static_cast<uint16_t>(b << 8);
+        for (int i = 0; i < 8; ++i) {
+            crc = static_cast<uint16_t>(crc << 1) ^ ((crc & 0x8000) ? CRC16_POLY : 0);
+        }
+        crcTable[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (int k = 1; k < 8; ++k) {
+            uint16_t prev = crcTable[k - 1][b];
+            crcTable[k][b] = static_cast<uint16_t>(prev << 8) ^ crcTable[0][prev >> 8];
+        }
+    }
+
+    uint8_t test[67];
+    for (size_t i = 0; i < sizeof(test); ++i) {
+        test[i] = static_cast<uint8_t>(i * 151 + 7);
+    }
+    for (size_t len = 0; len <= sizeof(test); ++len) {
+        uint16_t ref = 0;
+        CRC16_Compute(test, len, &ref);
+        if (TableCRC(crcTable, test, len, 0) != ref) {
+            return false;
+        }
+        size_t split = len / 3;
+        uint16_t crcA = 0;
+        uint16_t crcB = 0;
+        CRC16_Compute(test, split, &crcA);
+        CRC16_Compute(test + split, len - split, &crcB);
+        if ((ShiftCRC(crcA, len - split) ^ crcB) != ref) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static CRCTable GetCRCTable()
+{
+    CRCTable table = activeTable;
+    if (!table && (crcTableInit == 0) && (IncrementAndFetch(&crcTableInit) == 1)) {
+        if (InitCRCTables()) {
+            /* The atomic op orders the table writes before the table is published */
+            IncrementAndFetch(&crcTableInit);
+            table = crcTable;
+            activeTable = table;
+        } else {
+            QCC_LogError(ER_FAIL, ("CRC16 table check failed. Using CRC16_Compute"));
+        }
+    }
+    return table;
+}
+
+uint16_t PacketCRC16(const void* buf, size_t len, uint16_t crc)
+{
+    CRCTable table = GetCRCTable();
+    if (table) {
+        return TableCRC(table, static_cast<const uint8_t*>(buf), len, crc);
+    }
+    CRC16_Compute(static_cast<const uint8_t*>(buf), len, &crc);
+    return crc;
+}
+
+uint16_t PacketCRC16Copy(void* dst, const void* src, size_t len, uint16_t crc)
+{
+    CRCTable table = GetCRCTable();
+    if (table) {
+        return TableCRCCopy(table, static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src), len, crc);
+    }
+    ::memcpy(dst, src, len);
+    CRC16_Compute(static_cast<const uint8_t*>(src), len, &crc);
+    return crc;
+}
+
+uint16_t PacketCRC16Combine(uint16_t crcA, uint16_t crcB, size_t lenB)
+{
+    if (GetCRCTable()) {
+        return ShiftCRC(crcA, lenB) ^ crcB;
+    }
+    /* Any CRC without a final xor is advanced over zero bytes the same way */
+    static const uint8_t zeros[64] = { 0 };
+    while (lenB > 0) {
+        size_t n = (lenB < sizeof(zeros)) ? lenB : sizeof(zeros);
+        CRC16_Compute(zeros, n, &crcA);
+        lenB -= n;
+    }
+    return crcA ^ crcB;
+}
+
+bool PacketCRC16IsAccelerated()
+{
+    return GetCRCTable() != NULL;
+}
+
+}
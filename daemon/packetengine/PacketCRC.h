@@ -0,0 +1,75 @@
+/**
+ * @file
+ * Fast CRC16 for PacketEngine packets.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_PACKETCRC_H
+#define _ALLJOYN_PACKETCRC_H
+
+#include <qcc/platform.h>
+
+namespace ajn {
+
+/*
+ * These functions compute the same CRC as qcc::CRC16_Compute (CRC-16/CCITT, polynomial 0x1021,
+ * most significant bit first). A slice-by-8 table is built on first use and used once it agrees
+ * with CRC16_Compute, otherwise every call falls back to CRC16_Compute.
+ */
+
+/**
+ * Continue a CRC over a buffer.
+ *
+ * @param buf    Bytes to add to the CRC.
+ * @param len    Number of bytes.
+ * @param crc    Running CRC, 0 to start a new CRC.
+ * @return  The updated CRC.
+ */
+uint16_t PacketCRC16(const void* buf, size_t len, uint16_t crc = 0);
+
+/**
+ * Copy a buffer and continue a CRC over the copied bytes in the same pass.
+ * The buffers must not overlap.
+ *
+ * @param dst    Destination buffer.
+ * @param src    Source buffer.
+ * @param len    Number of bytes to copy.
+ * @param crc    Running CRC, 0 to start a new CRC.
+ * @return  The updated CRC.
+ */
+uint16_t PacketCRC16Copy(void* dst, const void* src, size_t len, uint16_t crc = 0);
+
+/**
+ * Combine the CRCs of two buffers into the CRC of their concatenation.
+ *
+ * @param crcA   CRC of the first buffer.
+ * @param crcB   CRC of the second buffer started from 0.
+ * @param lenB   Length of the second buffer.
+ * @return  The CRC of the first buffer followed by the second.
+ */
+uint16_t PacketCRC16Combine(uint16_t crcA, uint16_t crcB, size_t lenB);
+
+/**
+ * Check if the table driven CRC is in use.
+ *
+ * @return  false if the CRC functions fall back to CRC16_Compute.
+ */
+bool PacketCRC16IsAccelerated();
+
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include <limits>
 
 #include <qcc/Crypto.h>
+#include <qcc/StringUtil.h>
 #include <qcc/Util.h>
 #include "PacketEngine.h"
 
@@ -120,16 +121,19 @@ static uint32_t GetValidWindowSize(uint32_t inWinSize)
     return allowedSize;
 }
 
-PacketEngine::PacketEngine(const qcc::String& name, uint32_t maxWindowSize) :
+PacketEngine::PacketEngine(const qcc::String& name, uint32_t maxWindowSize, uint32_t numShards) :
     name(name),
-    rxPacketThread(name),
-    txPacketThread(name),
     timer("PacketEngineTimer"),
     maxWindowSize(maxWindowSize),
-    isRunning(false),
-    rxPacketThreadReload(false)
+    congestionControlType(CONGESTION_CONTROL_RENO),
+    isRunning(false)
 {
-    QCC_DbgTrace(("PacketEngine::PacketEngine(%p)", this));
+    QCC_DbgTrace(("PacketEngine::PacketEngine(%p, numShards=%u)", this, numShards));
+
+    numShards = ::max(numShards, (uint32_t) 1);
+    for (uint32_t i = 0; i < numShards; ++i) {
+        shards.push_back(new Shard((numShards == 1) ? name : name + "-" + U32ToString(i), i));
+    }
 
     /* Check that window size is a power of 2 */
 #ifndef NDEBUG
@@ -148,19 +152,28 @@ PacketEngine::PacketEngine(const qcc::String& name, uint32_t maxWindowSize) :
 PacketEngine::~PacketEngine()
 {
     QCC_DbgTrace(("~PacketEngine(%p)", this));
-    rxPacketThreadReload = true;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        shards[i]->rxPacketThreadReload = true;
+    }
     Stop();
     Join();
+    for (size_t i = 0; i < shards.size(); ++i) {
+        delete shards[i];
+    }
+    shards.clear();
 }
 
-QStatus PacketEngine::Start(uint32_t mtu) {
+QStatus PacketEngine::Start(uint32_t mtu, uint32_t poolPrealloc, uint32_t poolHighWater) {
     QCC_DbgTrace(("PacketEngine::Start()"));
     isRunning = true;
-    QStatus status = pool.Start(mtu);
-    QStatus tStatus = rxPacketThread.Start(this);
-    status = (status == ER_OK) ? tStatus : status;
-    tStatus = txPacketThread.Start(this);
-    status = (status == ER_OK) ? tStatus : status;
+    QStatus status = pool.Start(mtu, poolPrealloc, poolHighWater);
+    QStatus tStatus;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        tStatus = shards[i]->rxPacketThread.Start(this);
+        status = (status == ER_OK) ? tStatus : status;
+        tStatus = shards[i]->txPacketThread.Start(this);
+        status = (status == ER_OK) ? tStatus : status;
+    }
     tStatus = timer.Start();
     status = (status == ER_OK) ? tStatus : status;
     isRunning = (status == ER_OK);
@@ -170,10 +183,13 @@ QStatus PacketEngine::Start(uint32_t mtu) {
 QStatus PacketEngine::Stop() {
     QCC_DbgTrace(("PacketEngine::Stop()"));
     QStatus status = timer.Stop();
-    QStatus tStatus = txPacketThread.Stop();
-    status = (status == ER_OK) ? tStatus : status;
-    tStatus = rxPacketThread.Stop();
-    status = (status == ER_OK) ? tStatus : status;
+    QStatus tStatus;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        tStatus = shards[i]->txPacketThread.Stop();
+        status = (status == ER_OK) ? tStatus : status;
+        tStatus = shards[i]->rxPacketThread.Stop();
+        status = (status == ER_OK) ? tStatus : status;
+    }
     tStatus = pool.Stop();
     isRunning = false;
     return (status == ER_OK) ? tStatus : status;
@@ -182,9 +198,14 @@ QStatus PacketEngine::Stop() {
 QStatus PacketEngine::Join() {
     QCC_DbgTrace(("PacketEngine::Join()"));
 
-    QStatus status = rxPacketThread.Join();
-    QStatus tStatus = txPacketThread.Join();
-    status = (status == ER_OK) ? tStatus : status;
+    QStatus status = ER_OK;
+    QStatus tStatus;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        tStatus = shards[i]->rxPacketThread.Join();
+        status = (status == ER_OK) ? tStatus : status;
+        tStatus = shards[i]->txPacketThread.Join();
+        status = (status == ER_OK) ? tStatus : status;
+    }
     tStatus = timer.Join();
     return (status == ER_OK) ? tStatus : status;
 }
@@ -193,10 +214,19 @@ QStatus PacketEngine::AddPacketStream(PacketStream& stream, PacketEngineListener
 {
     QCC_DbgTrace(("PacketEngine::AddPacketStream(%p)", &stream));
 
-    channelInfoLock.Lock();
+    /* Give the stream to the rx thread that reads the fewest streams */
+    packetStreamsLock.Lock();
+    size_t idx = 0;
+    for (size_t i = 1; i < shards.size(); ++i) {
+        if (shards[i]->numRxStreams < shards[idx]->numRxStreams) {
+            idx = i;
+        }
+    }
     packetStreams[&stream.GetSourceEvent()] = pair<PacketStream*, PacketEngineListener*>(&stream, &listener);
-    channelInfoLock.Unlock();
-    rxPacketThread.Alert();
+    rxStreamShards[&stream.GetSourceEvent()] = idx;
+    ++shards[idx]->numRxStreams;
+    packetStreamsLock.Unlock();
+    shards[idx]->rxPacketThread.Alert();
     return ER_OK;
 }
 
@@ -223,18 +253,23 @@ QStatus PacketEngine::RemovePacketStream(PacketStream& pktStream)
     }
 
     /* Remove packetStream itself */
-    channelInfoLock.Lock();
+    packetStreamsLock.Lock();
     map<Event*, pair<PacketStream*, PacketEngineListener*> >::iterator it = packetStreams.find(&pktStream.GetSourceEvent());
     if (it != packetStreams.end()) {
         packetStreams.erase(it);
-        rxPacketThreadReload = false;
-        channelInfoLock.Unlock();
-        rxPacketThread.Alert();
-        while (isRunning && !rxPacketThreadReload && (Thread::GetThread() != &rxPacketThread)) {
+        map<Event*, size_t>::iterator rit = rxStreamShards.find(&pktStream.GetSourceEvent());
+        Shard& shard = *shards[rit->second];
+        rxStreamShards.erase(rit);
+        --shard.numRxStreams;
+        shard.rxPacketThreadReload = false;
+        packetStreamsLock.Unlock();
+        /* Wait for the rx thread that read the stream to stop using it */
+        shard.rxPacketThread.Alert();
+        while (isRunning && !shard.rxPacketThreadReload && (Thread::GetThread() != &shard.rxPacketThread)) {
             qcc::Sleep(20);
         }
     } else {
-        channelInfoLock.Unlock();
+        packetStreamsLock.Unlock();
         status = ER_FAIL;
         QCC_LogError(status, ("Cannot find PacketStream"));
     }
@@ -350,7 +385,7 @@ QStatus PacketEngine::DeliverControlMsg(PacketEngine::ChannelInfo& ci, const voi
     ci.txLock.Lock();
     ci.txControlQueue.push_back(p);
     ci.txLock.Unlock();
-    QStatus status = txPacketThread.Alert();
+    QStatus status = AlertTxThread(ci.id);
     return status;
 }
 
@@ -586,9 +621,9 @@ PacketEngine::ChannelInfo::ChannelInfo(PacketEngine& engine, uint32_t id, const
     txRttMean(0),
     txRttMeanVar(0),
     txRttInit(false),
-    txCongestionWindow(1),
-    txSlowStartThresh(windowSize),
-    txConsecutiveAcks(0),
+    congestionControl(CongestionControl::Create(engine.congestionControlType, windowSize)),
+    txInRecovery(false),
+    txRecoverySeqNum(0),
     txLastMarshalSeqNum(numeric_limits<uint16_t>::max()),
     protocolVersion(0),
     windowSize(windowSize),
@@ -648,9 +683,9 @@ PacketEngine::ChannelInfo::ChannelInfo(const ChannelInfo& other) :
     txRttMean(other.txRttMean),
     txRttMeanVar(other.txRttMeanVar),
     txRttInit(other.txRttInit),
-    txCongestionWindow(other.txCongestionWindow),
-    txSlowStartThresh(other.txSlowStartThresh),
-    txConsecutiveAcks(other.txConsecutiveAcks),
+    congestionControl(CongestionControl::Create(other.congestionControl->GetType(), other.windowSize)),
+    txInRecovery(other.txInRecovery),
+    txRecoverySeqNum(other.txRecoverySeqNum),
     txLastMarshalSeqNum(other.txLastMarshalSeqNum),
     protocolVersion(other.protocolVersion),
     windowSize(other.windowSize),
@@ -727,6 +762,7 @@ PacketEngine::ChannelInfo::~ChannelInfo()
     txLock.Unlock();
 
     delete ackAlarmContext;
+    delete congestionControl;
     delete[] rxPackets;
     delete[] txPackets;
     delete[] rxMask;
@@ -737,10 +773,12 @@ PacketEngine::ChannelInfo* PacketEngine::CreateChannelInfo(uint32_t chanId, cons
                                                            PacketEngineListener& listener, uint16_t windowSize)
 {
     ChannelInfo* ret = NULL;
-    channelInfoLock.Lock();
-    if (channelInfos.find(chanId) == channelInfos.end()) {
+    Shard& shard = GetShard(chanId);
+    shard.channelInfoLock.Lock();
+    if (shard.channelInfos.find(chanId) == shard.channelInfos.end()) {
         /* Make sure packetStream is still on the list while holding channelInfos lock */
         bool found = false;
+        packetStreamsLock.Lock();
         map<Event*, pair<PacketStream*, PacketEngineListener*> >::iterator it = packetStreams.begin();
         while (it != packetStreams.end()) {
             if (it->second.first == &packetStream) {
@@ -749,46 +787,59 @@ PacketEngine::ChannelInfo* PacketEngine::CreateChannelInfo(uint32_t chanId, cons
             }
             ++it;
         }
+        packetStreamsLock.Unlock();
 
         /* Add ChannelInfo if packetStream was valid */
         if (found) {
-            ret = &(channelInfos.insert(pair<uint32_t, ChannelInfo>(chanId, ChannelInfo(*this, chanId, dest, packetStream, listener, windowSize))).first->second);
+            ret = &(shard.channelInfos.insert(pair<uint32_t, ChannelInfo>(chanId, ChannelInfo(*this, chanId, dest, packetStream, listener, windowSize))).first->second);
             ret->useCount = 1;
         }
     }
-    channelInfoLock.Unlock();
+    shard.channelInfoLock.Unlock();
     return ret;
 }
 
 PacketEngine::ChannelInfo* PacketEngine::AcquireChannelInfo(uint32_t chanId)
 {
     ChannelInfo* ret = NULL;
-    channelInfoLock.Lock();
-    map<uint32_t, ChannelInfo>::iterator it = channelInfos.find(chanId);
-    if (it != channelInfos.end()) {
+    Shard& shard = GetShard(chanId);
+    shard.channelInfoLock.Lock();
+    map<uint32_t, ChannelInfo>::iterator it = shard.channelInfos.find(chanId);
+    if (it != shard.channelInfos.end()) {
         ret = &(it->second);
         ret->useCount++;
     }
-    channelInfoLock.Unlock();
+    shard.channelInfoLock.Unlock();
     return ret;
 }
 
 PacketEngine::ChannelInfo* PacketEngine::AcquireNextChannelInfo(PacketEngine::ChannelInfo* inCi)
+{
+    /* Walk the shards in order, moving to the next shard when one runs out of channels */
+    size_t idx = inCi ? (inCi->id % shards.size()) : 0;
+    ChannelInfo* ret = AcquireNextChannelInfo(*shards[idx], inCi);
+    while (!ret && (++idx < shards.size())) {
+        ret = AcquireNextChannelInfo(*shards[idx], NULL);
+    }
+    return ret;
+}
+
+PacketEngine::ChannelInfo* PacketEngine::AcquireNextChannelInfo(Shard& shard, PacketEngine::ChannelInfo* inCi)
 {
     ChannelInfo* ret = NULL;
-    channelInfoLock.Lock();
-    map<uint32_t, ChannelInfo>::iterator it = channelInfos.begin();
+    shard.channelInfoLock.Lock();
+    map<uint32_t, ChannelInfo>::iterator it = shard.channelInfos.begin();
     if (inCi) {
-        it = channelInfos.find(inCi->id);
-        if (it != channelInfos.end()) {
+        it = shard.channelInfos.find(inCi->id);
+        if (it != shard.channelInfos.end()) {
             ++it;
         }
     }
-    if (it != channelInfos.end()) {
+    if (it != shard.channelInfos.end()) {
         ret = &(it->second);
         ret->useCount++;
     }
-    channelInfoLock.Unlock();
+    shard.channelInfoLock.Unlock();
     if (inCi) {
         ReleaseChannelInfo(*inCi);
     }
@@ -797,20 +848,21 @@ PacketEngine::ChannelInfo* PacketEngine::AcquireNextChannelInfo(PacketEngine::Ch
 
 void PacketEngine::ReleaseChannelInfo(ChannelInfo& ci)
 {
-    channelInfoLock.Lock();
+    Shard& shard = GetShard(ci.id);
+    shard.channelInfoLock.Lock();
     if ((--ci.useCount == 0) && (ci.state == ChannelInfo::CLOSED)) {
         PacketEngineStream stream = ci.stream;
         PacketEngineListener& listener = ci.listener;
         PacketDest dest = ci.dest;
 
         /* Erase entry in channelInfos */
-        channelInfos.erase(ci.id);
+        shard.channelInfos.erase(ci.id);
 
         /* Notify disconnect cb (Must be done without holding channelInfoLock) */
-        channelInfoLock.Unlock();
+        shard.channelInfoLock.Unlock();
         listener.PacketEngineDisconnectCB(*this, stream, dest);
     } else {
-        channelInfoLock.Unlock();
+        shard.channelInfoLock.Unlock();
     }
 }
 
@@ -860,10 +912,14 @@ void PacketEngine::SendAckNow(ChannelInfo& ci, uint16_t seqNum)
 uint32_t PacketEngine::GetRetryMs(const ChannelInfo& ci, uint32_t sendAttempt) const
 {
     /*
-     * Retry delay = backoff * max(1000, txRttMean + (4 * txRttMeanVar))
+     * Retry delay = backoff * max(MIN_RETRY_MS, txRttMean + max(ACK_DELAY_MS, 4 * txRttMeanVar))
+     * The ACK_DELAY_MS term covers acks the receiver holds back.
      */
-    uint32_t ret = ci.txRttInit ? ::min(8, (1 << (sendAttempt - 1))) * ::max((uint32_t)1000, static_cast<uint32_t>((ci.txRttMean + (4 * ci.txRttMeanVar)) >> 10)) : 3000;
-    return ret;
+    if (!ci.txRttInit) {
+        return 3000;
+    }
+    uint32_t rto = static_cast<uint32_t>(ci.txRttMean >> 10) + ::max((uint32_t)ACK_DELAY_MS, static_cast<uint32_t>((4 * ci.txRttMeanVar) >> 10));
+    return ::min(8, (1 << (sendAttempt - 1))) * ::max((uint32_t)MIN_RETRY_MS, rto);
 }
 
 void PacketEngine::SendXOn(ChannelInfo& ci)
@@ -893,8 +949,11 @@ void PacketEngine::SendXOn(ChannelInfo& ci)
     ci.rxLock.Unlock();
 }
 
-PacketEngine::RxPacketThread::RxPacketThread(const qcc::String& engineName) : Thread(engineName + "-rx"), engine(NULL)
+PacketEngine::RxPacketThread::RxPacketThread(const qcc::String& engineName, size_t shardIndex) : Thread(engineName + "-rx"), engine(NULL), shardIndex(shardIndex)
 {
+    for (size_t i = 0; i < RX_BATCH_SIZE; ++i) {
+        rxPackets[i] = NULL;
+    }
 }
 
 qcc::ThreadReturn STDCALL PacketEngine::RxPacketThread::Run(void* arg)
@@ -903,44 +962,74 @@ qcc::ThreadReturn STDCALL PacketEngine::RxPacketThread::Run(void* arg)
     vector<Event*> checkEvents, sigEvents;
     QStatus status = ER_OK;
     Event& stopEvent = GetStopEvent();
+    Shard& shard = *engine->shards[shardIndex];
     while (!IsStopping() && (status == ER_OK)) {
         checkEvents.clear();
         sigEvents.clear();
         checkEvents.push_back(&stopEvent);
-        engine->rxPacketThreadReload = true;
-        engine->channelInfoLock.Lock();
-        map<Event*, pair<PacketStream*, PacketEngineListener*> >::iterator sit = engine->packetStreams.begin();
-        while (sit != engine->packetStreams.end()) {
-            checkEvents.push_back(sit->first);
+        shard.rxPacketThreadReload = true;
+        engine->packetStreamsLock.Lock();
+        map<Event*, size_t>::iterator sit = engine->rxStreamShards.begin();
+        while (sit != engine->rxStreamShards.end()) {
+            if (sit->second == shardIndex) {
+                checkEvents.push_back(sit->first);
+            }
             sit++;
         }
-        engine->channelInfoLock.Unlock();
+        engine->packetStreamsLock.Unlock();
         status = Event::Wait(checkEvents, sigEvents, Event::WAIT_FOREVER);
         if (status == ER_OK) {
             while (!sigEvents.empty()) {
-                engine->channelInfoLock.Lock();
+                /*
+                 * The stream cannot be removed until this thread returns to the top of the loop so
+                 * it is safe to use after releasing the lock. No other rx thread reads it.
+                 */
+                engine->packetStreamsLock.Lock();
                 map<Event*, pair<PacketStream*, PacketEngineListener*> >::const_iterator it = engine->packetStreams.find(sigEvents.back());
                 if (it != engine->packetStreams.end()) {
                     PacketStream& stream = *(it->second.first);
                     PacketEngineListener& listener = *(it->second.second);
-                    Packet* p = engine->pool.GetPacket();
-                    status = p->Unmarshal(stream);
-                    engine->channelInfoLock.Unlock();
-                    if (status == ER_OK) {
-                        /* Handle control or data packet */
-                        if (p->flags & PACKET_FLAG_CONTROL) {
-                            HandleControlPacket(p, stream, listener);
-                        } else {
-                            HandleDataPacket(p);
+                    engine->packetStreamsLock.Unlock();
+                    /* Drain as many packets as the stream has ready (up to RX_BATCH_SIZE) */
+                    for (size_t i = 0; i < RX_BATCH_SIZE; ++i) {
+                        if (!rxPackets[i]) {
+                            rxPackets[i] = engine->pool.GetPacket(packetCache);
                         }
-                    } else {
-                        /* Failed to unmarshal a single packet. This is not fatal */
-                        QCC_DbgPrintf(("Packet::Unmarshal failed with %s", QCC_StatusText(status)));
-                        engine->pool.ReturnPacket(p);
+                        rxBatch[i].buf = rxPackets[i]->buffer;
+                        rxBatch[i].len = engine->pool.GetMTU();
+                    }
+                    size_t numPackets = 0;
+                    status = stream.PullPacketBatch(rxBatch, RX_BATCH_SIZE, numPackets, 0);
+                    if (status != ER_OK) {
+                        /* Failing to pull is not fatal */
+                        QCC_DbgPrintf(("PacketStream::PullPacketBatch failed with %s", QCC_StatusText(status)));
+                        numPackets = 0;
                         status = ER_OK;
                     }
+                    for (size_t i = 0; i < numPackets; ++i) {
+                        /* The stream may have reordered the buffers so find the packet that owns this one */
+                        size_t j = i;
+                        while (!rxPackets[j] || (rxPackets[j]->buffer != rxBatch[i].buf)) {
+                            j = (j + 1) % RX_BATCH_SIZE;
+                        }
+                        Packet* p = rxPackets[j];
+                        rxPackets[j] = NULL;
+                        QStatus pStatus = p->Unmarshal(rxBatch[i].dest, rxBatch[i].len);
+                        if (pStatus == ER_OK) {
+                            /* Handle control or data packet */
+                            if (p->flags & PACKET_FLAG_CONTROL) {
+                                HandleControlPacket(p, stream, listener);
+                            } else {
+                                HandleDataPacket(p);
+                            }
+                        } else {
+                            /* Failed to unmarshal a single packet. This is not fatal */
+                            QCC_DbgPrintf(("Packet::Unmarshal failed with %s", QCC_StatusText(pStatus)));
+                            engine->pool.ReturnPacket(p, packetCache);
+                        }
+                    }
                 } else {
-                    engine->channelInfoLock.Unlock();
+                    engine->packetStreamsLock.Unlock();
                     if (sigEvents.back() == &stopEvent) {
                         GetStopEvent().ResetEvent();
                     }
@@ -949,6 +1038,13 @@ qcc::ThreadReturn STDCALL PacketEngine::RxPacketThread::Run(void* arg)
             }
         }
     }
+    for (size_t i = 0; i < RX_BATCH_SIZE; ++i) {
+        if (rxPackets[i]) {
+            engine->pool.ReturnPacket(rxPackets[i], packetCache);
+            rxPackets[i] = NULL;
+        }
+    }
+    engine->pool.FlushCache(packetCache);
     if (status != ER_STOPPING_THREAD) {
         QCC_DbgPrintf(("RxPacketThread::Run() exiting with %s", QCC_StatusText(status)));
     }
@@ -994,7 +1090,7 @@ void PacketEngine::RxPacketThread::HandleControlPacket(Packet* p, PacketStream&
     default:
         break;
     }
-    engine->pool.ReturnPacket(p);
+    engine->pool.ReturnPacket(p, packetCache);
 }
 
 void PacketEngine::RxPacketThread::HandleDataPacket(Packet* p)
@@ -1131,7 +1227,7 @@ void PacketEngine::RxPacketThread::HandleDataPacket(Packet* p)
             } else {
                 /* Received resend */
                 QCC_DbgPrintf(("Received resend of 0x%x from %s (existing=0x%x). Ignoring", seqNum, engine->ToString(ci->packetStream, p->GetSender()).c_str(), p->seqNum));
-                engine->pool.ReturnPacket(p);
+                engine->pool.ReturnPacket(p, packetCache);
             }
             engine->SendAck(*ci, seqNum, (p->flags & PACKET_FLAG_DELAY_ACK));
             ci->rxLock.Unlock();
@@ -1144,12 +1240,12 @@ void PacketEngine::RxPacketThread::HandleDataPacket(Packet* p)
             engine->SendAck(*ci, p->seqNum, false);
             ci->rxLock.Unlock();
             QCC_DbgPrintf(("Received packet from %s with id 0x%x out of range [%x, %x)", engine->ToString(ci->packetStream, p->GetSender()).c_str(), p->seqNum, ci->rxDrain, (ci->rxDrain + ci->windowSize - 1) % ci->windowSize));
-            engine->pool.ReturnPacket(p);
+            engine->pool.ReturnPacket(p, packetCache);
         }
         engine->ReleaseChannelInfo(*ci);
     } else {
         QCC_DbgPrintf(("Received packet from %s with invalid chanId (0x%x)", engine->ToString(ci->packetStream, p->GetSender()).c_str(), p->chanId));
-        engine->pool.ReturnPacket(p);
+        engine->pool.ReturnPacket(p, packetCache);
     }
 }
 
@@ -1349,6 +1445,8 @@ void PacketEngine::RxPacketThread::HandleAck(Packet* controlPacket)
             ci->remoteRxDrain = remoteRxDrain;
 
             /* Find and validate the packet that this ack refers to */
+            uint64_t now = GetTimestamp64();
+            uint32_t rttMs = 0;
             Packet*& p = ci->txPackets[controlPacket->seqNum % ci->windowSize];
             if (p && (p->seqNum == controlPacket->seqNum)) {
                 /*
@@ -1358,75 +1456,70 @@ void PacketEngine::RxPacketThread::HandleAck(Packet* controlPacket)
                  * txRttMeanDev = txRttMeanDev + ((|err| - txRttMeanDev) / 4)
                  */
                 if (p->sendAttempts == 1) {
-                    uint64_t now = GetTimestamp64();
-                    int32_t rtt = static_cast<int32_t>((now - p->sendTs + 1) << 10);
+                    rttMs = static_cast<uint32_t>(now - p->sendTs + 1);
+                    int32_t rtt = static_cast<int32_t>(rttMs << 10);
                     if (ci->txRttInit) {
                         int32_t err = (rtt - ci->txRttMean);
                         ci->txRttMean = ci->txRttMean + (err >> 3);
                         ci->txRttMeanVar = ci->txRttMeanVar + ((((err > 0) ? err : -err) - ci->txRttMeanVar) >> 2);
                     } else {
                         ci->txRttMean = rtt;
+                        ci->txRttMeanVar = rtt >> 1;
                         ci->txRttInit = true;
                     }
                 }
                 /* Remove packet from tx queue */
                 //printf("tx(%d): clr0 s=0x%x, txD=0x%x, idx=0x%x\n", (GetTimestamp() / 100) % 100000, p->seqNum, ci->txDrain, controlPacket->seqNum % ci->windowSize);
-                engine->pool.ReturnPacket(p);
+                engine->pool.ReturnPacket(p, packetCache);
                 p = NULL;
                 ackedPackets++;
             }
             /* Advance txDrain to remoteRxAck */
             AdvanceTxDrain(*ci, remoteRxAck, ackedPackets);
 
-            /* Clear acked packets (set bits in mask) between remoteRxAck and txDrain */
-            uint16_t ackIdx = controlPacket->seqNum % ci->windowSize;
-            uint16_t drainIdx = ci->txDrain % ci->windowSize;
-            while (ackIdx != drainIdx) {
-                /* If bit is set in mask, then packet is acked and can be cleared */
-                uint32_t m = letoh32(controlPacket->payload[3 + (drainIdx / 32)]);
-                if (m & (0x01 << (drainIdx % 32))) {
-                    if (ci->txPackets[drainIdx]) {
-                        //printf("tx(%d): ack clr2 s=0x%x, txD=0x%x, idx=0x%x, txF=0x%x\n", (GetTimestamp() / 100) % 100000, ci->txPackets[drainIdx]->seqNum, ci->txDrain, drainIdx, ci->txFill);
-                        engine->pool.ReturnPacket(ci->txPackets[drainIdx]);
-                        ci->txPackets[drainIdx] = NULL;
-                        ackedPackets++;
-                    }
-                }
-                drainIdx = (drainIdx == (ci->windowSize - 1)) ? 0 : (drainIdx + 1);
+            /* The loss episode is over once everything sent before it has been acked */
+            if (ci->txInRecovery && IN_WINDOW(uint16_t, ci->txRecoverySeqNum, numeric_limits<uint16_t>::max() >> 1, ci->txDrain)) {
+                ci->txInRecovery = false;
             }
 
             /*
-             * Check for fast retransmit by examining packets between remoteRxAck and current packet's seqNum.
-             * Fast retransmit occurs if there is a hole in acked packets that is 3 or more back from the packet
-             * seqNum which hasn't already been fast retransmitted.
+             * Walk the selective ack mask from the newest packet the receiver could hold down to
+             * txDrain. Packets whose bit is set have been received and can be cleared. A packet
+             * that has been sent but whose bit is clear is lost once DUP_THRESHOLD later packets
+             * have been received, it is marked for fast retransmit (at most once).
              */
-            uint32_t idx = controlPacket->seqNum % ci->windowSize;
-            ackIdx = ((remoteRxAck == 0) ? (ci->windowSize - 1) : (remoteRxAck - 1)) % ci->windowSize;
-            uint16_t ackCount = 0;
-            while (idx != ackIdx) {
+            uint16_t sackEnd = ci->remoteRxDrain + ci->windowSize - 1;
+            uint16_t sackLen = sackEnd - ci->txDrain;
+            if (IN_WINDOW(uint16_t, ci->txDrain, sackLen, ci->txFill)) {
+                sackEnd = ci->txFill;
+            }
+            uint16_t sackedAbove = 0;
+            for (uint16_t seqNum = sackEnd; seqNum != ci->txDrain;) {
+                --seqNum;
+                uint32_t idx = seqNum % ci->windowSize;
+                Packet*& tp = ci->txPackets[idx];
                 uint32_t m = letoh32(controlPacket->payload[3 + (idx / 32)]);
                 if (m & (0x01 << (idx % 32))) {
-                    ++ackCount;
-                } else if ((ackCount >= 3) && ci->txPackets[idx] && (ci->txPackets[idx]->sendAttempts > 0) && !ci->txPackets[idx]->fastRetransmit) {
-                    ci->txPackets[idx]->fastRetransmit = true;
-                    ci->txPackets[idx]->sendTs = 0;
-                    //printf("tx(%d): fast retrans s=0x%x\n", (GetTimestamp() / 100) % 100000, ci->txPackets[idx]->seqNum);
+                    ++sackedAbove;
+                    if (tp && (tp->seqNum == seqNum) && (tp->sendAttempts > 0)) {
+                        //printf("tx(%d): ack clr2 s=0x%x, txD=0x%x, idx=0x%x, txF=0x%x\n", (GetTimestamp() / 100) % 100000, tp->seqNum, ci->txDrain, idx, ci->txFill);
+                        engine->pool.ReturnPacket(tp, packetCache);
+                        tp = NULL;
+                        ackedPackets++;
+                    }
+                } else if ((sackedAbove >= DUP_THRESHOLD) && tp && (tp->seqNum == seqNum) && (tp->sendAttempts > 0) && !tp->fastRetransmit) {
+                    tp->fastRetransmit = true;
+                    tp->sendTs = 0;
+                    //printf("tx(%d): fast retrans s=0x%x\n", (GetTimestamp() / 100) % 100000, tp->seqNum);
                 }
-                idx = (idx == 0) ? (ci->windowSize - 1) : (idx - 1);
             }
 
-            /* Receiving ack indicates no/reduced congestion. Increase window */
-            while (ackedPackets && (ci->txCongestionWindow < ci->windowSize)) {
-                if ((ci->txCongestionWindow < ci->txSlowStartThresh) || (ci->txConsecutiveAcks >= ci->txCongestionWindow)) {
-                    ++ci->txCongestionWindow;
-                    ci->txConsecutiveAcks = 0;
-                    QCC_DbgPrintf(("Increasing congestion window of %s to %d", engine->ToString(ci->packetStream, ci->dest).c_str(), ci->txCongestionWindow));
-                } else {
-                    ci->txConsecutiveAcks++;
-                }
-                ackedPackets--;
+            /* Receiving ack indicates no/reduced congestion. Let the congestion controller grow the window */
+            if (ackedPackets) {
+                ci->congestionControl->OnAck(ackedPackets, rttMs, now);
+                QCC_DbgPrintf(("Congestion window of %s is %d", engine->ToString(ci->packetStream, ci->dest).c_str(), ci->congestionControl->GetWindow()));
             }
-            engine->txPacketThread.Alert();
+            engine->AlertTxThread(ci->id);
         } else {
             QCC_DbgPrintf(("Invalid ack window: seqNum=0x%x, drain=0x%x, ack=0x%x", controlPacket->seqNum, ci->remoteRxDrain, remoteRxAck));
         }
@@ -1443,7 +1536,7 @@ void PacketEngine::RxPacketThread::AdvanceTxDrain(ChannelInfo& ci, uint16_t newT
         Packet*& tp = ci.txPackets[ci.txDrain % ci.windowSize];
         if (tp != NULL) {
             //printf("tx(%d): advtxdrain clr s=0x%x, txD=0x%x, idx=0x%x\n", (GetTimestamp() / 100) % 100000, tp->seqNum, ci.txDrain, ci.txDrain % ci.windowSize);
-            engine->pool.ReturnPacket(tp);
+            engine->pool.ReturnPacket(tp, packetCache);
             tp = NULL;
             advCount++;
         }
@@ -1482,7 +1575,7 @@ void PacketEngine::RxPacketThread::HandleXOn(Packet* controlPacket)
             }
 
             ci->txLock.Unlock();
-            engine->txPacketThread.Alert();
+            engine->AlertTxThread(ci->id);
         } else {
             ci->txLock.Unlock();
         }
@@ -1523,8 +1616,44 @@ void PacketEngine::RxPacketThread::HandleXOnAck(Packet* controlPacket)
     }
 }
 
-PacketEngine::TxPacketThread::TxPacketThread(const qcc::String& engineName) : Thread(engineName + "-tx"), engine(NULL)
+PacketEngine::TxPacketThread::TxPacketThread(const qcc::String& engineName, size_t shardIndex) : Thread(engineName + "-tx"), engine(NULL), shardIndex(shardIndex), txBatchLen(0)
+{
+}
+
+QStatus PacketEngine::TxPacketThread::QueueTxPacket(ChannelInfo& ci, Packet* p, bool returnToPool)
+{
+    QStatus status = ER_OK;
+    if (txBatchLen == TX_BATCH_SIZE) {
+        status = FlushTxBatch(ci);
+    }
+    if (status == ER_OK) {
+        txBatch[txBatchLen].buf = p->buffer;
+        txBatch[txBatchLen].len = p->payloadLen + Packet::payloadOffset;
+        txBatch[txBatchLen].dest = ci.dest;
+        txBatchPackets[txBatchLen] = p;
+        txBatchReturn[txBatchLen] = returnToPool;
+        ++txBatchLen;
+    } else if (returnToPool) {
+        engine->pool.ReturnPacket(p, packetCache);
+    }
+    return status;
+}
+
+QStatus PacketEngine::TxPacketThread::FlushTxBatch(ChannelInfo& ci)
 {
+    QStatus status = ER_OK;
+    if (txBatchLen > 0) {
+        size_t numSent = 0;
+        status = ci.packetStream.PushPacketBatch(txBatch, txBatchLen, numSent);
+        QCC_DbgPrintf(("TxPacketThread pushed %u of %u packets to %s %s", (unsigned int) numSent, (unsigned int) txBatchLen, engine->ToString(ci.packetStream, ci.dest).c_str(), QCC_StatusText(status)));
+        for (size_t i = 0; i < txBatchLen; ++i) {
+            if (txBatchReturn[i]) {
+                engine->pool.ReturnPacket(txBatchPackets[i], packetCache);
+            }
+        }
+        txBatchLen = 0;
+    }
+    return status;
 }
 
 qcc::ThreadReturn STDCALL PacketEngine::TxPacketThread::Run(void* arg)
@@ -1547,29 +1676,30 @@ qcc::ThreadReturn STDCALL PacketEngine::TxPacketThread::Run(void* arg)
         waitMs = Event::WAIT_FOREVER;
         if (!IsStopping() && (status == ER_OK)) {
             /* Iterate over tx queue and send, resend or expire */
+            Shard& shard = *engine->shards[shardIndex];
             ChannelInfo* ci = NULL;
-            while ((ci = engine->AcquireNextChannelInfo(ci)) != NULL) {
+            while ((ci = engine->AcquireNextChannelInfo(shard, ci)) != NULL) {
                 ci->txLock.Lock();
                 /* Send all control messages */
                 while (!ci->txControlQueue.empty()) {
                     Packet* p = ci->txControlQueue.front();
                     ci->txControlQueue.pop_front();
                     p->Marshal();
-                    status = ci->packetStream.PushPacketBytes(p->buffer, p->payloadLen + Packet::payloadOffset, ci->dest);
                     /* Closedown if control message was a disconnectRsp */
-                    if (letoh32(p->payload[0]) == PACKET_COMMAND_DISCONNECT_RSP) {
+                    bool isDisconnectRsp = (letoh32(p->payload[0]) == PACKET_COMMAND_DISCONNECT_RSP);
+                    status = QueueTxPacket(*ci, p, true);
+                    if (isDisconnectRsp) {
                         QCC_DbgPrintf(("PacketEngine::TxThread: Send DisconnectRsp. Closing id=0x%x", ci->id));
+                        status = FlushTxBatch(*ci);
                         ci->state = ChannelInfo::CLOSED;
-                        engine->pool.ReturnPacket(p);
                         break;
                     }
-                    engine->pool.ReturnPacket(p);
                 }
                 /* Walk from [txDrain, min(txFill,congestion_window,remoteRxDrain+window)) and (re)send any user packets */
                 if (ci && ci->state == ChannelInfo::OPEN) {
                     uint16_t nonExpiredPackets = 0;
                     uint16_t drain = ci->txDrain;
-                    while ((drain != ci->txFill) && IN_WINDOW(uint16_t, ci->remoteRxDrain, ci->windowSize - 1, drain) && (nonExpiredPackets < ci->txCongestionWindow)) {
+                    while ((drain != ci->txFill) && IN_WINDOW(uint16_t, ci->remoteRxDrain, ci->windowSize - 1, drain) && (nonExpiredPackets < ci->congestionControl->GetWindow())) {
                         Packet*& p = ci->txPackets[drain % ci->windowSize];
                         if (p) {
                             uint64_t now = GetTimestamp64();
@@ -1586,10 +1716,11 @@ qcc::ThreadReturn STDCALL PacketEngine::TxPacketThread::Run(void* arg)
                                 uint32_t retryMs = engine->GetRetryMs(*ci, p->sendAttempts);
                                 bool needMarshal = false;
                                 if ((p->sendTs == 0) || ((now - p->sendTs) > retryMs)) {
+                                    bool isFastRetransmit = (p->sendTs == 0) && (p->sendAttempts > 0);
                                     ++p->sendAttempts;
                                     /* Marshal if this is the first send attempt */
                                     if (p->sendAttempts == 1) {
-                                        if (ci->txCongestionWindow > ci->txSlowStartThresh) {
+                                        if (!ci->congestionControl->InSlowStart()) {
                                             p->flags |= PACKET_FLAG_DELAY_ACK;
                                         }
                                         uint16_t gap = p->seqNum - ci->txLastMarshalSeqNum - 1;
@@ -1616,41 +1747,58 @@ qcc::ThreadReturn STDCALL PacketEngine::TxPacketThread::Run(void* arg)
                                     if (needMarshal) {
                                         p->Marshal();
                                     }
-                                    status = ci->packetStream.PushPacketBytes(p->buffer, p->payloadLen + Packet::payloadOffset, ci->dest);
+                                    status = QueueTxPacket(*ci, p, false);
                                     //printf("tx(%d): s=0x%x, len=%d, gap=%d, retry=%d txFill=0x%x, txDrain=0x%x, drain=0x%x, retryMs=%d, actMs=%d, xoff=%s\n", (GetTimestamp() / 100) % 100000, p->seqNum, (int) p->payloadLen, p->gap, p->sendAttempts, ci->txFill, ci->txDrain, drain, retryMs, (int) (now - p->sendTs), (p->flags & PACKET_FLAG_FLOW_OFF) ? "off" : "nc");
-                                    QCC_DbgPrintf(("TxPacketThread sent seqNum=0x%x to %s (try=%d, gap=%d, drain=0x%x) %s", p->seqNum, engine->ToString(ci->packetStream, ci->dest).c_str(), p->sendAttempts, p->gap, drain, QCC_StatusText(status)));
+                                    QCC_DbgPrintf(("TxPacketThread queued seqNum=0x%x to %s (try=%d, gap=%d, drain=0x%x) %s", p->seqNum, engine->ToString(ci->packetStream, ci->dest).c_str(), p->sendAttempts, p->gap, drain, QCC_StatusText(status)));
                                     if (status == ER_OK) {
                                         /* Update sendTs and update (next) wait time */
                                         p->sendTs = GetTimestamp64();
                                         waitMs = ::min(waitMs, engine->GetRetryMs(*ci, p->sendAttempts));
                                     } else {
                                         /* Return packet and close this channel */
-                                        QCC_LogError(status, ("TxPacketThread: PushPacketBytes(%s) failed. Closing channel", engine->ToString(ci->packetStream, ci->dest).c_str()));
+                                        QCC_LogError(status, ("TxPacketThread: PushPacketBatch(%s) failed. Closing channel", engine->ToString(ci->packetStream, ci->dest).c_str()));
                                         ci->state = ChannelInfo::CLOSED;
                                         status = ER_OK;
                                         break;
                                     }
-                                    /* Adjust congestion window down (by factor of 2) if this was a retry */
-                                    if ((p->sendAttempts > 1) && (ci->txCongestionWindow > 1)) {
-                                        ci->txCongestionWindow = ci->txCongestionWindow >> 1;
-                                        ci->txSlowStartThresh = ::max(ci->txCongestionWindow, (uint16_t)2);
-                                        QCC_DbgPrintf(("Decreasing congestion window of %s to %d (ssThresh=%d)", engine->ToString(ci->packetStream, ci->dest).c_str(), ci->txCongestionWindow, ci->txSlowStartThresh));
+                                    /*
+                                     * A resend is a loss. Only the first loss of an episode (a packet first sent after
+                                     * the last reduction) reduces the window so a burst of losses reduces it once.
+                                     */
+                                    if ((p->sendAttempts > 1) && (!ci->txInRecovery || IN_WINDOW(uint16_t, ci->txRecoverySeqNum, ci->windowSize, p->seqNum))) {
+                                        if (isFastRetransmit) {
+                                            ci->congestionControl->OnLoss(now);
+                                        } else {
+                                            ci->congestionControl->OnTimeout(now);
+                                        }
+                                        ci->txInRecovery = true;
+                                        ci->txRecoverySeqNum = ci->txFill;
+                                        QCC_DbgPrintf(("Decreasing congestion window of %s to %d after %s", engine->ToString(ci->packetStream, ci->dest).c_str(), ci->congestionControl->GetWindow(), isFastRetransmit ? "loss" : "timeout"));
                                     }
                                 } else {
-                                    /* Calcualte next retry time */
-                                    waitMs = ::min(waitMs, retryMs);
+                                    /* Wait for the rest of this packet's retry time */
+                                    waitMs = ::min(waitMs, static_cast<uint32_t>(retryMs - (now - p->sendTs)));
                                 }
                             } else {
                                 /* packet has expired or retries are exhausted */
                                 //printf("tx(%d): expire pkt s=0x%x (r=%d)\n", (GetTimestamp() / 100) % 100000, p->seqNum, p->sendAttempts);
                                 QCC_DbgPrintf(("TxPacketThread: Expiring tx packet seqNum=0x%x to %s (sendAttempts=%d)", p->seqNum, engine->ToString(ci->packetStream, ci->dest).c_str(), p->sendAttempts));
-                                engine->pool.ReturnPacket(p);
+                                engine->pool.ReturnPacket(p, packetCache);
                                 p = NULL;
                             }
                         }
                         ++drain;
                     }
-                    //printf("tx(%d): while exited d=0x%x, tD=0x%x, tF=0x%x, rrD=0x%x, nep=%d, cw=%d\n", (GetTimestamp() / 100) % 100000, drain, ci->txDrain, ci->txFill, ci->remoteRxDrain, nonExpiredPackets, ci->txCongestionWindow);
+                    //printf("tx(%d): while exited d=0x%x, tD=0x%x, tF=0x%x, rrD=0x%x, nep=%d, cw=%d\n", (GetTimestamp() / 100) % 100000, drain, ci->txDrain, ci->txFill, ci->remoteRxDrain, nonExpiredPackets, ci->congestionControl->GetWindow());
+                }
+                /* Push whatever is left in the batch before giving up the tx lock */
+                if (txBatchLen > 0) {
+                    status = FlushTxBatch(*ci);
+                    if ((status != ER_OK) && (ci->state == ChannelInfo::OPEN)) {
+                        QCC_LogError(status, ("TxPacketThread: PushPacketBatch(%s) failed. Closing channel", engine->ToString(ci->packetStream, ci->dest).c_str()));
+                        ci->state = ChannelInfo::CLOSED;
+                        status = ER_OK;
+                    }
                 }
                 ci->txLock.Unlock();
             }
@@ -1659,22 +1807,24 @@ qcc::ThreadReturn STDCALL PacketEngine::TxPacketThread::Run(void* arg)
             QCC_DbgPrintf(("TxPacketThread::Run() error (%s). Continuing...", QCC_StatusText(status)));
         }
     }
+    engine->pool.FlushCache(packetCache);
     return (qcc::ThreadReturn) 0;
 }
 
 PacketStream* PacketEngine::GetPacketStream(const PacketEngineStream& stream)
 {
     PacketStream* ret = NULL;
-    channelInfoLock.Lock();
-    map<uint32_t, ChannelInfo>::iterator it = channelInfos.begin();
-    while (it != channelInfos.end()) {
+    Shard& shard = GetShard(stream.GetChannelId());
+    shard.channelInfoLock.Lock();
+    map<uint32_t, ChannelInfo>::iterator it = shard.channelInfos.begin();
+    while (it != shard.channelInfos.end()) {
         if (&(it->second.stream) == &stream) {
             ret = &(it->second.packetStream);
             break;
         }
         ++it;
     }
-    channelInfoLock.Unlock();
+    shard.channelInfoLock.Unlock();
     return ret;
 }
 
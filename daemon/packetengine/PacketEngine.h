@@ -24,6 +24,7 @@
 #include <qcc/platform.h>
 #include <map>
 #include <deque>
+#include <vector>
 
 #include <qcc/Stream.h>
 #include <qcc/SocketStream.h>
@@ -34,6 +35,7 @@
 #include "Packet.h"
 #include "PacketStream.h"
 #include "PacketPool.h"
+#include "CongestionControl.h"
 #include "PacketEngineStream.h"
 
 /**
@@ -53,6 +55,8 @@
 #define DISCONNECT_RETRY_TIMEOUT  500        /**<  MS to wait before retrying DisconnectReq */
 #define DISCONNECT_TIMEOUT        (3 * 1000) /**<  MS to wait for graceful disconnect to complete */
 #define MAX_PACKET_SEND_ATTEMPTS  5          /**<  Max data packet retries before declaring link dead */
+#define MIN_RETRY_MS              200        /**<  Min ms to wait before resending an unacknowledged data packet */
+#define DUP_THRESHOLD             3          /**<  Number of selectively acked packets after a hole that mark it lost */
 #define XON_RETRIES               10         /**<  Num or XON retries before declaring link dead */
 #define ACK_DELAY_MS              10         /**<  Ms of delay before sending acks */
 #define XON_THRESHOLD             4          /**<  Min number of empty slots in rx buffer necessary to send XON */
@@ -153,9 +157,9 @@ class PacketEngine : public qcc::AlarmListener {
         int32_t txRttMeanVar;
         bool txRttInit;
         uint32_t* ackResp;
-        uint16_t txCongestionWindow;
-        uint16_t txSlowStartThresh;
-        uint16_t txConsecutiveAcks;
+        CongestionControl* congestionControl;
+        bool txInRecovery;              /* true until txDrain passes txRecoverySeqNum */
+        uint16_t txRecoverySeqNum;      /* txFill when the window was last reduced */
         uint16_t txLastMarshalSeqNum;
         qcc::Mutex txLock;
 
@@ -170,13 +174,20 @@ class PacketEngine : public qcc::AlarmListener {
 
     class RxPacketThread : public qcc::Thread {
       public:
-        RxPacketThread(const qcc::String& engineName);
+        RxPacketThread(const qcc::String& engineName, size_t shardIndex);
 
       protected:
         qcc::ThreadReturn STDCALL Run(void* arg);
 
       private:
+        /* Max number of packets pulled from a PacketStream per wake-up */
+        static const size_t RX_BATCH_SIZE = 32;
+
         PacketEngine* engine;
+        size_t shardIndex;
+        Packet* rxPackets[RX_BATCH_SIZE];       /* Spare packets for the next pull */
+        PacketBuffer rxBatch[RX_BATCH_SIZE];
+        PacketPool::Cache packetCache;
 
         void HandleControlPacket(Packet* p, PacketStream& packetStream, PacketEngineListener& listener);
         void HandleDataPacket(Packet* p);
@@ -196,24 +207,70 @@ class PacketEngine : public qcc::AlarmListener {
 
     class TxPacketThread : public qcc::Thread {
       public:
-        TxPacketThread(const qcc::String& engineName);
+        TxPacketThread(const qcc::String& engineName, size_t shardIndex);
 
       protected:
         qcc::ThreadReturn STDCALL Run(void* arg);
 
       private:
+        /* Max number of packets pushed to a PacketStream with one PushPacketBatch call */
+        static const size_t TX_BATCH_SIZE = 32;
+
         PacketEngine* engine;
+        size_t shardIndex;
+        PacketBuffer txBatch[TX_BATCH_SIZE];    /* Packets waiting to be pushed */
+        Packet* txBatchPackets[TX_BATCH_SIZE];  /* Packet for each txBatch entry */
+        bool txBatchReturn[TX_BATCH_SIZE];      /* true if the packet goes back to the pool once pushed */
+        size_t txBatchLen;
+        PacketPool::Cache packetCache;
+
+        QStatus QueueTxPacket(ChannelInfo& ci, Packet* p, bool returnToPool);
+        QStatus FlushTxBatch(ChannelInfo& ci);
+    };
+
+    /**
+     * A shard owns the channels whose id hashes to it. Each shard has its own channel map and
+     * lock and its own tx thread that services only the shard's channels.
+     *
+     * Every channel on a PacketStream shares the stream's socket so rx cannot be split by channel.
+     * Instead each PacketStream is read by exactly one shard's rx thread, which keeps the packets
+     * of a stream in order, and that thread looks each packet's channel up in the shard that owns it.
+     */
+    struct Shard {
+        RxPacketThread rxPacketThread;
+        TxPacketThread txPacketThread;
+        qcc::Mutex channelInfoLock;
+        std::map<uint32_t, ChannelInfo> channelInfos;
+        volatile bool rxPacketThreadReload;
+        size_t numRxStreams;    /* Number of PacketStreams read by rxPacketThread */
+
+        Shard(const qcc::String& name, size_t index) : rxPacketThread(name, index), txPacketThread(name, index), rxPacketThreadReload(false), numRxStreams(0) { }
     };
 
     void CloseChannel(ChannelInfo& ci);
 
   public:
 
-    PacketEngine(const qcc::String& name, uint32_t maxWindowSize = 128);
+    /**
+     * Create a PacketEngine.
+     *
+     * @param name            Name of the engine, used to name its threads.
+     * @param maxWindowSize   Max number of unacknowledged packets per channel. Must be a power of 2.
+     * @param numShards       Number of rx/tx thread pairs. Channels are spread over the shards by channel id.
+     */
+    PacketEngine(const qcc::String& name, uint32_t maxWindowSize = 128, uint32_t numShards = 1);
 
     virtual ~PacketEngine();
 
-    QStatus Start(uint32_t maxMTU = 1472);
+    /**
+     * Start the engine.
+     *
+     * @param maxMTU          Largest packet size.
+     * @param poolPrealloc    Number of packets allocated up front.
+     * @param poolHighWater   Max number of free packets kept by the packet pool, 0 to size it from
+     *                        the number of packets in use.
+     */
+    QStatus Start(uint32_t maxMTU = 1472, uint32_t poolPrealloc = 0, uint32_t poolHighWater = 0);
 
     QStatus Stop();
 
@@ -243,19 +300,32 @@ class PacketEngine : public qcc::AlarmListener {
 
     void SendXOn(ChannelInfo& ci);
 
+    void GetPacketPoolStats(PacketPool::Stats& stats) { pool.GetStats(stats); }
+
+    /**
+     * Select the congestion control algorithm used by channels created after this call.
+     * The default is CONGESTION_CONTROL_RENO.
+     *
+     * @param type   Congestion control algorithm.
+     */
+    void SetCongestionControl(CongestionControlType type) { congestionControlType = type; }
+
   private:
 
     qcc::String name;
     PacketPool pool;
-    RxPacketThread rxPacketThread;
-    TxPacketThread txPacketThread;
+    std::vector<Shard*> shards;
+    qcc::Mutex packetStreamsLock;
     std::map<qcc::Event*, std::pair<PacketStream*, PacketEngineListener*> > packetStreams;
+    std::map<qcc::Event*, size_t> rxStreamShards;   /* Index of the shard whose rx thread reads each PacketStream */
     qcc::Timer timer;
-    qcc::Mutex channelInfoLock;
-    std::map<uint32_t, ChannelInfo> channelInfos;
     uint32_t maxWindowSize;
+    CongestionControlType congestionControlType;
     bool isRunning;
-    bool rxPacketThreadReload;
+
+    Shard& GetShard(uint32_t chanId) { return *shards[chanId % shards.size()]; }
+
+    QStatus AlertTxThread(uint32_t chanId) { return GetShard(chanId).txPacketThread.Alert(); }
 
     ChannelInfo* CreateChannelInfo(uint32_t chanId, const PacketDest& dest, PacketStream& packetStream, PacketEngineListener& listener, uint16_t windowSize);
 
@@ -263,6 +333,8 @@ class PacketEngine : public qcc::AlarmListener {
 
     ChannelInfo* AcquireNextChannelInfo(ChannelInfo* inCi);
 
+    ChannelInfo* AcquireNextChannelInfo(Shard& shard, ChannelInfo* inCi);
+
     void ReleaseChannelInfo(ChannelInfo& ci);
 
     void SendAck(ChannelInfo& ci, uint16_t seqNum, bool allowDelay);
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * Debug interface (org.alljoyn.Bus.Debug.PacketEngine) for reading the packet pool counters
+ * of a PacketEngine.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _ALLJOYN_PACKETENGINEDEBUG_H
+#define _ALLJOYN_PACKETENGINEDEBUG_H
+
+// Include contents in debug builds only.
+#ifndef NDEBUG
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/Util.h>
+
+#include "AllJoynDebugObj.h"
+#include "PacketEngine.h"
+
+
+namespace ajn {
+
+namespace debug {
+
+/**
+ * Adds the packet pool counters of a PacketEngine to the AllJoyn debug object.
+ *
+ * @cond ALLJOYN_DEV
+ *
+ * This is implemented entirely in the header file for the same reasons as BTDebugObj: it is
+ * only instantiated in debug builds and is easily excluded from release builds.
+ *
+ * @endcond
+ */
+class PacketEngineDebugObj : public AllJoynDebugObjAddon {
+  public:
+    class PacketEngineDebugProperties : public AllJoynDebugObj::Properties {
+      public:
+        PacketEngineDebugProperties(PacketEngine& engine) : engine(engine) { }
+
+        QStatus Get(const char* propName, MsgArg& val) const
+        {
+            PacketPool::Stats stats;
+            engine.GetPacketPoolStats(stats);
+            if (::strcmp(propName, "PoolHits") == 0) {
+                return val.Set("u", stats.hits);
+            } else if (::strcmp(propName, "PoolMisses") == 0) {
+                return val.Set("u", stats.misses);
+            } else if (::strcmp(propName, "PoolAllocs") == 0) {
+                return val.Set("u", stats.allocs);
+            } else if (::strcmp(propName, "PoolFrees") == 0) {
+                return val.Set("u", stats.frees);
+            } else if (::strcmp(propName, "PoolInUse") == 0) {
+                return val.Set("u", stats.inUse);
+            } else if (::strcmp(propName, "PoolDepotSize") == 0) {
+                return val.Set("u", stats.depotSize);
+            }
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+
+        QStatus Set(const char* propName, MsgArg& val)
+        {
+            const AllJoynDebugObj::Properties::Info* info;
+            size_t infoSize;
+            GetProperyInfo(info, infoSize);
+            for (size_t i = 0; i < infoSize; ++i) {
+                if (::strcmp(propName, info[i].name) == 0) {
+                    return ER_BUS_PROPERTY_ACCESS_DENIED;
+                }
+            }
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+
+        void GetProperyInfo(const AllJoynDebugObj::Properties::Info*& info, size_t& infoSize)
+        {
+            static const AllJoynDebugObj::Properties::Info ourInfo[] = {
+                { "PoolHits",      "u", PROP_ACCESS_READ },
+                { "PoolMisses",    "u", PROP_ACCESS_READ },
+                { "PoolAllocs",    "u", PROP_ACCESS_READ },
+                { "PoolFrees",     "u", PROP_ACCESS_READ },
+                { "PoolInUse",     "u", PROP_ACCESS_READ },
+                { "PoolDepotSize", "u", PROP_ACCESS_READ },
+            };
+            info = ourInfo;
+            infoSize = ArraySize(ourInfo);
+        }
+
+      private:
+        PacketEngine& engine;
+    };
+
+    PacketEngineDebugObj(PacketEngine& engine) : properties(engine)
+    {
+        AllJoynDebugObj* dbg = AllJoynDebugObj::GetAllJoynDebugObj();
+        dbg->AddDebugInterface(this,
+                               "org.alljoyn.Bus.Debug.PacketEngine",
+                               NULL, 0,
+                               properties);
+    }
+
+  private:
+    PacketEngineDebugProperties properties;
+};
+
+
+} // namespace debug
+} // namespace ajn
+
+#endif
+#endif
@@ -149,7 +149,7 @@ QStatus PacketEngineStream::PullBytes(void* buf, size_t reqBytes, size_t& actual
         if (ci->rxFlowOff && ((ci->rxDrain == ci->rxAck) || IN_WINDOW(uint16_t, ci->rxDrain, ci->windowSize - 2 - XON_THRESHOLD, ci->rxFlowSeqNum))) {
             ci->rxFlowOff = false;
             engine->SendXOn(*ci);
-            engine->txPacketThread.Alert();
+            engine->AlertTxThread(chanId);
         }
     }
 
@@ -192,7 +192,7 @@ QStatus PacketEngineStream::PullBytes(void* buf, size_t reqBytes, size_t& actual
     if (ci->rxFlowOff && ((ci->rxDrain == ci->rxAck) || IN_WINDOW(uint16_t, ci->rxDrain, ci->windowSize - 2 - XON_THRESHOLD, ci->rxFlowSeqNum))) {
         ci->rxFlowOff = false;
         engine->SendXOn(*ci);
-        engine->txPacketThread.Alert();
+        engine->AlertTxThread(chanId);
     }
     ci->rxLock.Unlock();
     engine->ReleaseChannelInfo(*ci);
@@ -273,7 +273,7 @@ QStatus PacketEngineStream::PushBytes(const void* buf, size_t numBytes, size_t&
         isFirst = false;
     }
     if (status == ER_OK) {
-        engine->txPacketThread.Alert();
+        engine->AlertTxThread(chanId);
     }
     ci->txLock.Unlock();
     engine->ReleaseChannelInfo(*ci);
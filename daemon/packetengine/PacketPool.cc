@@ -20,6 +20,9 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 #include <qcc/Mutex.h>
+#include <qcc/Util.h>
+
+#include <cstring>
 
 #include "PacketPool.h"
 
@@ -30,13 +33,23 @@ using namespace qcc;
 
 namespace ajn {
 
-PacketPool::PacketPool() : mtu(0), usedCount(0)
+PacketPool::PacketPool() : mtu(0), highWater(0), usedCount(0)
 {
+    ::memset(&stats, 0, sizeof(stats));
 }
 
-QStatus PacketPool::Start(size_t mtu)
+QStatus PacketPool::Start(size_t mtu, size_t prealloc, size_t highWater)
 {
     this->mtu = mtu;
+    this->highWater = ((highWater > 0) && (highWater < prealloc)) ? prealloc : highWater;
+#ifndef PACKET_LEAK_DEBUG
+    lock.Lock();
+    while (freeList.size() < prealloc) {
+        freeList.push_back(new Packet(mtu));
+        stats.allocs++;
+    }
+    lock.Unlock();
+#endif
     return ER_OK;
 }
 
@@ -64,11 +77,13 @@ Packet* PacketPool::GetPacket() {
 #else
     lock.Lock();
     usedCount++;
+    stats.misses++;
     if (freeList.size() > 0) {
         p = freeList.back();
         freeList.pop_back();
         lock.Unlock();
     } else {
+        stats.allocs++;
         lock.Unlock();
         p = new Packet(mtu);
     }
@@ -76,13 +91,48 @@ Packet* PacketPool::GetPacket() {
     return p;
 }
 
+Packet* PacketPool::GetPacket(Cache& cache) {
+#ifdef PACKET_LEAK_DEBUG
+    return GetPacket();
+#else
+    if (cache.count > 0) {
+        cache.hits++;
+        return cache.packets[--cache.count];
+    }
+
+    /* Refill the cache with a magazine from the depot */
+    Packet* p = NULL;
+    lock.Lock();
+    stats.hits += cache.hits;
+    cache.hits = 0;
+    stats.misses++;
+    size_t n = (freeList.size() < MAGAZINE_SIZE) ? freeList.size() : MAGAZINE_SIZE;
+    if (n > 0) {
+        usedCount += n;
+        for (size_t i = 0; i < n; ++i) {
+            cache.packets[cache.count++] = freeList.back();
+            freeList.pop_back();
+        }
+        p = cache.packets[--cache.count];
+        lock.Unlock();
+    } else {
+        usedCount++;
+        stats.allocs++;
+        lock.Unlock();
+        p = new Packet(mtu);
+    }
+    return p;
+#endif
+}
+
 void PacketPool::ReturnPacket(Packet* p) {
 #ifdef PACKET_LEAK_DEBUG
     delete p;
 #else
     lock.Lock();
     --usedCount;
-    if ((freeList.size() * 2) > usedCount) {
+    if (DepotFull()) {
+        stats.frees++;
         lock.Unlock();
         delete p;
     } else {
@@ -93,4 +143,60 @@ void PacketPool::ReturnPacket(Packet* p) {
 #endif
 }
 
+void PacketPool::ReturnPacket(Packet* p, Cache& cache) {
+#ifdef PACKET_LEAK_DEBUG
+    delete p;
+#else
+    if (cache.count == ArraySize(cache.packets)) {
+        /* Cache is full. Send the oldest magazine to the depot */
+        Packet* extra[MAGAZINE_SIZE];
+        size_t numExtra = 0;
+        lock.Lock();
+        stats.hits += cache.hits;
+        cache.hits = 0;
+        usedCount -= MAGAZINE_SIZE;
+        for (size_t i = 0; i < MAGAZINE_SIZE; ++i) {
+            if (!DepotFull()) {
+                freeList.push_back(cache.packets[i]);
+            } else {
+                extra[numExtra++] = cache.packets[i];
+            }
+        }
+        stats.frees += numExtra;
+        lock.Unlock();
+        for (size_t i = 0; i < numExtra; ++i) {
+            delete extra[i];
+        }
+        cache.count -= MAGAZINE_SIZE;
+        ::memmove(cache.packets, cache.packets + MAGAZINE_SIZE, cache.count * sizeof(Packet*));
+    }
+    p->Clean();
+    cache.packets[cache.count++] = p;
+#endif
+}
+
+void PacketPool::FlushCache(Cache& cache) {
+    lock.Lock();
+    stats.hits += cache.hits;
+    cache.hits = 0;
+    usedCount -= cache.count;
+    for (size_t i = 0; i < cache.count; ++i) {
+        freeList.push_back(cache.packets[i]);
+    }
+    cache.count = 0;
+    lock.Unlock();
+}
+
+bool PacketPool::DepotFull() const {
+    return highWater ? (freeList.size() >= highWater) : ((freeList.size() * 2) > usedCount);
+}
+
+void PacketPool::GetStats(Stats& stats) {
+    lock.Lock();
+    stats = this->stats;
+    stats.inUse = static_cast<uint32_t>(usedCount);
+    stats.depotSize = static_cast<uint32_t>(freeList.size());
+    lock.Unlock();
+}
+
 }
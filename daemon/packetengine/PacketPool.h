@@ -25,15 +25,62 @@
 
 #include <vector>
 
+#include <qcc/Mutex.h>
+
 #include "Packet.h"
 
 namespace ajn {
 
+/**
+ * PacketPool recycles Packets for a PacketEngine.
+ *
+ * Free packets are kept in a global depot protected by a lock. A thread that gets and returns
+ * many packets (the PacketEngine rx and tx threads) can own a PacketPool::Cache. Packets are
+ * taken from and returned to a Cache without locking and move between the Cache and the depot a
+ * magazine (MAGAZINE_SIZE packets) at a time.
+ */
 class PacketPool {
   public:
+    /** Number of packets moved between a Cache and the depot with one lock */
+    static const size_t MAGAZINE_SIZE = 32;
+
+    /**
+     * Packets held by a single thread. A Cache must only be used by the thread that owns it and
+     * must be given back with FlushCache before it is destroyed.
+     */
+    class Cache {
+        friend class PacketPool;
+
+      public:
+        Cache() : count(0), hits(0) { }
+
+      private:
+        Packet* packets[2 * MAGAZINE_SIZE];
+        size_t count;
+        uint32_t hits;          /* Hits not yet added to the pool counters */
+    };
+
+    /** Pool counters */
+    struct Stats {
+        uint32_t hits;          /**< GetPacket calls served by a Cache without locking */
+        uint32_t misses;        /**< GetPacket calls that went to the depot */
+        uint32_t allocs;        /**< Packets allocated */
+        uint32_t frees;         /**< Packets freed because the depot was above its high-water mark */
+        uint32_t inUse;         /**< Packets held by callers or Caches */
+        uint32_t depotSize;     /**< Free packets in the depot */
+    };
+
     PacketPool();
 
-    QStatus Start(size_t mtu);
+    /**
+     * Start the pool.
+     *
+     * @param mtu         Size of the packets handed out by the pool.
+     * @param prealloc    Number of packets to allocate up front.
+     * @param highWater   Max number of free packets kept in the depot, packets returned beyond this
+     *                    are freed. 0 keeps at most half as many free packets as are in use.
+     */
+    QStatus Start(size_t mtu, size_t prealloc = 0, size_t highWater = 0);
 
     QStatus Stop();
 
@@ -41,15 +88,50 @@ class PacketPool {
 
     Packet* GetPacket();
 
+    /**
+     * Get a packet using a thread's Cache.
+     *
+     * @param cache   Cache owned by the calling thread.
+     */
+    Packet* GetPacket(Cache& cache);
+
     void ReturnPacket(Packet* p);
 
+    /**
+     * Return a packet to a thread's Cache.
+     *
+     * @param p       Packet to return.
+     * @param cache   Cache owned by the calling thread.
+     */
+    void ReturnPacket(Packet* p, Cache& cache);
+
+    /**
+     * Move all the packets held by a Cache to the depot.
+     *
+     * @param cache   Cache owned by the calling thread.
+     */
+    void FlushCache(Cache& cache);
+
+    /**
+     * Get the pool counters. Cache hits are added to the counters when the Cache next uses the
+     * depot so the hit count can lag.
+     *
+     * @param[out] stats   The counters.
+     */
+    void GetStats(Stats& stats);
+
     uint32_t GetMTU() const { return mtu; }
 
   private:
     size_t mtu;
+    size_t highWater;
     qcc::Mutex lock;
     std::vector<Packet*> freeList;
     size_t usedCount;
+    Stats stats;
+
+    /* Must be called with lock held */
+    bool DepotFull() const;
 };
 
 }
@@ -28,6 +28,15 @@
 
 namespace ajn {
 
+/**
+ * A packet buffer used by the batched PacketSource and PacketSink calls.
+ */
+struct PacketBuffer {
+    void* buf;          /**< Packet bytes */
+    size_t len;         /**< Size of buf on input to PullPacketBatch, number of bytes pulled on output. Number of bytes to push for PushPacketBatch */
+    PacketDest dest;    /**< Sender of a pulled packet or destination of a pushed packet */
+};
+
 /**
  * PacketSource defines a standard interface for packet providers.
  */
@@ -64,6 +73,34 @@ class PacketSource {
      */
     virtual QStatus PullPacketBytes(void* buf, size_t reqBytes, size_t& actualBytes, PacketDest& sender, uint32_t timeout = qcc::Event::WAIT_FOREVER) = 0;
 
+    /**
+     * Pull up to maxPackets packets from the source.
+     * The default implementation pulls a single packet with PullPacketBytes. Sources that can
+     * read several packets with one system call should override this. The pulled packets are
+     * returned in the first numPackets entries of packets, an implementation that drops packets
+     * may reorder the entries (including their buf) to do so.
+     *
+     * @param packets      Packet buffers to fill. The len of each buffer must be at least the MTU of the source.
+     * @param maxPackets   Number of entries in packets.
+     * @param numPackets   [OUT] Number of packets pulled.
+     * @param timeout      Time to wait for the first packet.
+     * @return   ER_OK if one or more packets were pulled. ER_NONE if source is exhausted. Otherwise an error.
+     */
+    virtual QStatus PullPacketBatch(PacketBuffer* packets, size_t maxPackets, size_t& numPackets, uint32_t timeout = qcc::Event::WAIT_FOREVER)
+    {
+        numPackets = 0;
+        if (maxPackets == 0) {
+            return ER_OK;
+        }
+        size_t actualBytes = 0;
+        QStatus status = PullPacketBytes(packets[0].buf, packets[0].len, actualBytes, packets[0].dest, timeout);
+        if (status == ER_OK) {
+            packets[0].len = actualBytes;
+            numPackets = 1;
+        }
+        return status;
+    }
+
     /**
      * Get the Event indicating that data is available when signaled.
      *
@@ -98,6 +135,28 @@ class PacketSink {
      */
     virtual QStatus PushPacketBytes(const void* buf, size_t numBytes, PacketDest& dest) = 0;
 
+    /**
+     * Push a batch of packets into the sink.
+     * The default implementation pushes each packet with PushPacketBytes. Sinks that can write
+     * several packets with one system call should override this.
+     *
+     * @param packets      Packets to push.
+     * @param numPackets   Number of entries in packets.
+     * @param numSent      [OUT] Number of packets pushed before an error occurred.
+     * @return   ER_OK if all of the packets were pushed.
+     */
+    virtual QStatus PushPacketBatch(PacketBuffer* packets, size_t numPackets, size_t& numSent)
+    {
+        QStatus status = ER_OK;
+        for (numSent = 0; numSent < numPackets; ++numSent) {
+            status = PushPacketBytes(packets[numSent].buf, packets[numSent].len, packets[numSent].dest);
+            if (status != ER_OK) {
+                break;
+            }
+        }
+        return status;
+    }
+
     /**
      * Get the Event that indicates when data can be pushed to sink.
      *
@@ -0,0 +1,131 @@
+/**
+ * @file
+ * Microbenchmark for the PacketEngine CRC16 at MTU sized payloads.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+#include <alljoyn/version.h>
+
+#include "Packet.h"
+#include "PacketCRC.h"
+
+#define QCC_MODULE "PACKET"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/* Keeps the compiler from discarding the results */
+static volatile uint16_t g_sink;
+
+static void Report(const char* name, uint64_t elapsed, uint32_t iterations, size_t len)
+{
+    double mbps = (elapsed > 0) ? ((double) iterations * len) / (elapsed * 1000.0) : 0.0;
+    printf("%-32s %8.3f us/packet %10.1f MB/s\n", name, (elapsed * 1000.0) / iterations, mbps);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = 100000;
+    size_t mtu = 1472;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-n", argv[i])) && ((i + 1) < argc)) {
+            iterations = StringToU32(argv[++i], 0, iterations);
+        } else if ((0 == strcmp("-m", argv[i])) && ((i + 1) < argc)) {
+            mtu = StringToU32(argv[++i], 0, (uint32_t) mtu);
+        } else {
+            printf("Usage: packetcrcbench [-n <iterations>] [-m <mtu>]\n");
+            exit(1);
+        }
+    }
+    size_t len = mtu - Packet::payloadOffset;
+
+    vector<uint8_t> src(len);
+    vector<uint8_t> dst(len);
+    for (size_t i = 0; i < len; ++i) {
+        src[i] = (uint8_t) ((i * 131) ^ (i >> 3));
+    }
+
+    uint16_t ref = 0;
+    CRC16_Compute(&src[0], len, &ref);
+    if ((PacketCRC16(&src[0], len) != ref) || (PacketCRC16Copy(&dst[0], &src[0], len) != ref)) {
+        printf("CRC mismatch\n");
+        return 1;
+    }
+    printf("Table driven CRC %s, payload %u bytes\n\n", PacketCRC16IsAccelerated() ? "enabled" : "disabled", (unsigned int) len);
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        uint16_t crc = 0;
+        CRC16_Compute(&src[0], len, &crc);
+        g_sink = crc;
+    }
+    Report("CRC16_Compute", GetTimestamp64() - start, iterations, len);
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        g_sink = PacketCRC16(&src[0], len);
+    }
+    Report("PacketCRC16", GetTimestamp64() - start, iterations, len);
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        ::memcpy(&dst[0], &src[0], len);
+        uint16_t crc = 0;
+        CRC16_Compute(&dst[0], len, &crc);
+        g_sink = crc;
+    }
+    Report("memcpy + CRC16_Compute", GetTimestamp64() - start, iterations, len);
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        g_sink = PacketCRC16Copy(&dst[0], &src[0], len);
+    }
+    Report("PacketCRC16Copy", GetTimestamp64() - start, iterations, len);
+
+    /* The whole send path: copy the payload in and marshal the packet */
+    Packet packet(mtu);
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        packet.SetPayload(&src[0], len);
+        packet.Marshal();
+    }
+    Report("SetPayload + Marshal", GetTimestamp64() - start, iterations, len);
+
+    /* A retransmit only marshals again */
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        packet.Marshal();
+    }
+    Report("Marshal (retransmit)", GetTimestamp64() - start, iterations, len);
+
+    return 0;
+}
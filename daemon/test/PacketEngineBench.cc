@@ -0,0 +1,529 @@
+/**
+ * @file
+ * Loopback throughput benchmark for the sharded PacketEngine. The link can be made to drop,
+ * reorder and delay packets to compare the congestion controllers.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Event.h>
+#include <qcc/IPAddress.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+#include <alljoyn/version.h>
+
+#include "CongestionControl.h"
+#include "PacketEngine.h"
+#include "UDPPacketStream.h"
+
+#define QCC_MODULE "PACKET"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/* Size of each PushBytes call */
+static const size_t CHUNK_SIZE = 4096;
+
+/* Link impairments applied to every packet pushed by an endpoint (data and acks) */
+struct LinkConfig {
+    uint32_t dropPct;       /* Percent of packets dropped */
+    uint32_t reorderPct;    /* Percent of packets held back for an extra delay so later packets overtake them */
+    uint32_t delayMs;       /* One way delay added to every packet */
+};
+
+/**
+ * A PacketStream that wraps a UDPPacketStream and impairs the packets pushed through it.
+ * Packets that are not dropped wait in a delay line until their delivery time, a forwarding
+ * thread then pushes them to the UDP socket. Pulls go straight to the UDP socket. On a clean
+ * link pushes also go straight to the UDP socket.
+ */
+class LossyPacketStream : public PacketStream {
+  public:
+    LossyPacketStream(const LinkConfig& config, uint32_t seed) :
+        udpStream(IPAddress("127.0.0.1"), 0, 1472), config(config), seed(seed), dropped(0), forwarder(*this) { }
+
+    ~LossyPacketStream()
+    {
+        Stop();
+        forwarder.Join();
+    }
+
+    QStatus Start()
+    {
+        QStatus status = udpStream.Start();
+        if (status == ER_OK) {
+            status = forwarder.Start();
+        }
+        return status;
+    }
+
+    QStatus Stop()
+    {
+        forwarder.Stop();
+        return udpStream.Stop();
+    }
+
+    uint16_t GetPort() const { return udpStream.GetPort(); }
+
+    QStatus PullPacketBytes(void* buf, size_t reqBytes, size_t& actualBytes, PacketDest& sender, uint32_t timeout)
+    {
+        return udpStream.PullPacketBytes(buf, reqBytes, actualBytes, sender, timeout);
+    }
+
+    QStatus PullPacketBatch(PacketBuffer* packets, size_t maxPackets, size_t& numPackets, uint32_t timeout)
+    {
+        return udpStream.PullPacketBatch(packets, maxPackets, numPackets, timeout);
+    }
+
+    Event& GetSourceEvent() { return udpStream.GetSourceEvent(); }
+
+    size_t GetSourceMTU() { return udpStream.GetSourceMTU(); }
+
+    QStatus PushPacketBytes(const void* buf, size_t numBytes, PacketDest& dest)
+    {
+        if ((config.dropPct == 0) && (config.reorderPct == 0) && (config.delayMs == 0)) {
+            return udpStream.PushPacketBytes(buf, numBytes, dest);
+        }
+        lock.Lock();
+        if (Random() < config.dropPct) {
+            ++dropped;
+            lock.Unlock();
+            return ER_OK;
+        }
+        uint64_t deliverTs = GetTimestamp64() + config.delayMs;
+        if (Random() < config.reorderPct) {
+            deliverTs += config.delayMs + 10;
+        }
+        DelayedPacket& dp = delayLine.insert(pair<uint64_t, DelayedPacket>(deliverTs, DelayedPacket()))->second;
+        dp.bytes.assign(static_cast<const uint8_t*>(buf), static_cast<const uint8_t*>(buf) + numBytes);
+        dp.dest = dest;
+        lock.Unlock();
+        queuedEvent.SetEvent();
+        return ER_OK;
+    }
+
+    Event& GetSinkEvent() { return udpStream.GetSinkEvent(); }
+
+    size_t GetSinkMTU() { return udpStream.GetSinkMTU(); }
+
+    String ToString(const PacketDest& dest) const { return udpStream.ToString(dest); }
+
+    uint32_t GetDropped()
+    {
+        lock.Lock();
+        uint32_t ret = dropped;
+        lock.Unlock();
+        return ret;
+    }
+
+  private:
+    class ForwardThread : public Thread {
+      public:
+        ForwardThread(LossyPacketStream& stream) : Thread("lossy"), stream(stream) { }
+
+      protected:
+        ThreadReturn STDCALL Run(void* arg)
+        {
+            stream.Forward(*this);
+            return 0;
+        }
+
+      private:
+        LossyPacketStream& stream;
+    };
+
+    /* Push each packet to the UDP socket when its delivery time comes */
+    void Forward(ForwardThread& thread)
+    {
+        while (!thread.IsStopping()) {
+            uint32_t waitMs = Event::WAIT_FOREVER;
+            lock.Lock();
+            uint64_t now = GetTimestamp64();
+            while (!delayLine.empty() && (delayLine.begin()->first <= now)) {
+                DelayedPacket dp = delayLine.begin()->second;
+                delayLine.erase(delayLine.begin());
+                lock.Unlock();
+                udpStream.PushPacketBytes(&dp.bytes[0], dp.bytes.size(), dp.dest);
+                lock.Lock();
+            }
+            if (!delayLine.empty()) {
+                waitMs = static_cast<uint32_t>(delayLine.begin()->first - now);
+            }
+            lock.Unlock();
+            QStatus status = Event::Wait(queuedEvent, waitMs);
+            if (status == ER_ALERTED_THREAD) {
+                break;
+            }
+            queuedEvent.ResetEvent();
+        }
+    }
+
+    struct DelayedPacket {
+        vector<uint8_t> bytes;
+        PacketDest dest;
+    };
+
+    /* Percentile in [0, 100) from a linear congruential generator, called with lock held */
+    uint32_t Random()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % 100;
+    }
+
+    UDPPacketStream udpStream;
+    LinkConfig config;
+    uint32_t seed;
+    uint32_t dropped;
+    Mutex lock;
+    Event queuedEvent;
+    multimap<uint64_t, DelayedPacket> delayLine;
+    ForwardThread forwarder;
+};
+
+/*
+ * One end of the loopback connection: a PacketEngine with its own LossyPacketStream that collects
+ * the streams of the channels connected or accepted on it.
+ */
+class BenchEndpoint : public PacketEngineListener {
+  public:
+    BenchEndpoint(const char* name, uint32_t numShards, const LinkConfig& config, uint32_t seed, CongestionControlType ccType) :
+        lossyStream(config, seed), engine(name, 128, numShards)
+    {
+        engine.SetCongestionControl(ccType);
+    }
+
+    ~BenchEndpoint()
+    {
+        engine.Stop();
+        engine.Join();
+    }
+
+    QStatus Start()
+    {
+        QStatus status = lossyStream.Start();
+        if (status == ER_OK) {
+            status = engine.AddPacketStream(lossyStream, *this);
+        }
+        if (status == ER_OK) {
+            status = engine.Start(::max(lossyStream.GetSourceMTU(), lossyStream.GetSinkMTU()));
+        }
+        return status;
+    }
+
+    QStatus Connect(BenchEndpoint& other)
+    {
+        return engine.Connect(GetPacketDest(IPAddress("127.0.0.1"), other.lossyStream.GetPort()), lossyStream, *this, NULL);
+    }
+
+    void PacketEngineConnectCB(PacketEngine& engine, QStatus status, const PacketEngineStream* stream, const PacketDest& dest, void* context)
+    {
+        if (status == ER_OK) {
+            lock.Lock();
+            streams.push_back(*stream);
+            lock.Unlock();
+        } else {
+            QCC_LogError(status, ("Connect failed"));
+        }
+    }
+
+    bool PacketEngineAcceptCB(PacketEngine& engine, const PacketEngineStream& stream, const PacketDest& dest)
+    {
+        lock.Lock();
+        streams.push_back(stream);
+        lock.Unlock();
+        return true;
+    }
+
+    void PacketEngineDisconnectCB(PacketEngine& engine, const PacketEngineStream& stream, const PacketDest& dest) { }
+
+    size_t NumStreams()
+    {
+        lock.Lock();
+        size_t n = streams.size();
+        lock.Unlock();
+        return n;
+    }
+
+    PacketEngineStream GetStream(size_t i)
+    {
+        lock.Lock();
+        PacketEngineStream s = streams[i];
+        lock.Unlock();
+        return s;
+    }
+
+    void DisconnectAll()
+    {
+        lock.Lock();
+        for (size_t i = 0; i < streams.size(); ++i) {
+            engine.Disconnect(streams[i]);
+        }
+        lock.Unlock();
+    }
+
+    uint32_t GetDropped() { return lossyStream.GetDropped(); }
+
+  private:
+    LossyPacketStream lossyStream;
+    PacketEngine engine;
+    Mutex lock;
+    vector<PacketEngineStream> streams;
+};
+
+class SendThread : public Thread {
+  public:
+    SendThread(const PacketEngineStream& stream, uint64_t endTs) : Thread("send"), stream(stream), endTs(endTs) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        uint8_t buf[CHUNK_SIZE];
+        ::memset(buf, 'A', sizeof(buf));
+        while (!IsStopping() && (GetTimestamp64() < endTs)) {
+            size_t sent;
+            QStatus status = stream.PushBytes(buf, sizeof(buf), sent);
+            if ((status != ER_OK) && (status != ER_TIMEOUT)) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+  private:
+    PacketEngineStream stream;
+    uint64_t endTs;
+};
+
+class RecvThread : public Thread {
+  public:
+    RecvThread(const PacketEngineStream& stream, uint64_t endTs) : Thread("recv"), received(0), stream(stream), endTs(endTs) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        uint8_t buf[CHUNK_SIZE];
+        while (!IsStopping() && (GetTimestamp64() < endTs)) {
+            size_t actual = 0;
+            QStatus status = stream.PullBytes(buf, sizeof(buf), actual, 100);
+            if (status == ER_OK) {
+                received += actual;
+            } else if ((status != ER_TIMEOUT) && (status != ER_NONE)) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+    uint64_t received;
+
+  private:
+    PacketEngineStream stream;
+    uint64_t endTs;
+};
+
+class SendThread : public Thread {
+  public:
+    SendThread(const PacketEngineStream& stream, uint64_t endTs) : Thread("send"), stream(stream), endTs(endTs) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        uint8_t buf[CHUNK_SIZE];
+        ::memset(buf, 'A', sizeof(buf));
+        while (!IsStopping() && (GetTimestamp64() < endTs)) {
+            size_t sent;
+            QStatus status = stream.PushBytes(buf, sizeof(buf), sent);
+            if ((status != ER_OK) && (status != ER_TIMEOUT)) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+  private:
+    PacketEngineStream stream;
+    uint64_t endTs;
+};
+
+class RecvThread : public Thread {
+  public:
+    RecvThread(const PacketEngineStream& stream, uint64_t endTs) : Thread("recv"), received(0), stream(stream), endTs(endTs) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        uint8_t buf[CHUNK_SIZE];
+        while (!IsStopping() && (GetTimestamp64() < endTs)) {
+            size_t actual = 0;
+            QStatus status = stream.PullBytes(buf, sizeof(buf), actual, 100);
+            if (status == ER_OK) {
+                received += actual;
+            } else if ((status != ER_TIMEOUT) && (status != ER_NONE)) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+    uint64_t received;
+
+  private:
+    PacketEngineStream stream;
+    uint64_t endTs;
+};
+
+static void RunBenchmark(const char* ccName, CongestionControlType ccType, const LinkConfig& config,
+                         uint32_t numShards, uint32_t numChannels, uint32_t durationMs)
+{
+    BenchEndpoint client("bench-client", numShards, config, 1, ccType);
+    BenchEndpoint server("bench-server", numShards, config, 2, ccType);
+    QStatus status = client.Start();
+    if (status == ER_OK) {
+        status = server.Start();
+    }
+    for (uint32_t i = 0; (status == ER_OK) && (i < numChannels); ++i) {
+        status = client.Connect(server);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to set up %u channels", numChannels));
+        return;
+    }
+
+    /* Wait for the connects to complete */
+    uint64_t deadline = GetTimestamp64() + 30000;
+    while (((client.NumStreams() < numChannels) || (server.NumStreams() < numChannels)) && (GetTimestamp64() < deadline)) {
+        qcc::Sleep(10);
+    }
+    size_t numStreams = ::min(client.NumStreams(), server.NumStreams());
+    if (numStreams < numChannels) {
+        printf("Only %u of %u channels connected\n", (unsigned int) numStreams, numChannels);
+    }
+
+    uint64_t start = GetTimestamp64();
+    uint64_t endTs = start + durationMs;
+    vector<SendThread*> senders;
+    vector<RecvThread*> receivers;
+    for (size_t i = 0; i < numStreams; ++i) {
+        receivers.push_back(new RecvThread(server.GetStream(i), endTs));
+        receivers.back()->Start();
+        senders.push_back(new SendThread(client.GetStream(i), endTs));
+        senders.back()->Start();
+    }
+    uint64_t received = 0;
+    for (size_t i = 0; i < numStreams; ++i) {
+        senders[i]->Join();
+        delete senders[i];
+        receivers[i]->Join();
+        received += receivers[i]->received;
+        delete receivers[i];
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    client.DisconnectAll();
+    server.DisconnectAll();
+
+    double mbps = (elapsed > 0) ? ((double) received * 8.0) / (elapsed * 1000.0) : 0.0;
+    printf("%-5s %2u shards %4u channels: %10.1f Mbit/s aggregate, %8.1f Mbit/s per channel, %u packets dropped\n",
+           ccName, numShards, (unsigned int) numStreams, mbps, numStreams ? (mbps / numStreams) : 0.0,
+           client.GetDropped() + server.GetDropped());
+}
+
+static void usage(void)
+{
+    printf("Usage: packetenginebench [-k <shards>] [-c <channels>] [-t <ms>] [-l <drop %%>] [-r <reorder %%>] [-d <ms>] [-a <cc>]\n\n");
+    printf("Options:\n");
+    printf("   -h              = Print this help message\n");
+    printf("   -k <shards>     = Largest number of PacketEngine shards, doubled from 1 (default 4)\n");
+    printf("   -c <channels>   = Largest number of channels, quadrupled from 1 (default 64)\n");
+    printf("   -t <ms>         = Duration of each run in milliseconds (default 2000)\n");
+    printf("   -l <drop %%>     = Percent of packets dropped in each direction (default 0)\n");
+    printf("   -r <reorder %%>  = Percent of packets delivered late, out of order (default 0)\n");
+    printf("   -d <ms>         = One way delay in milliseconds (default 0)\n");
+    printf("   -a <cc>         = Congestion control: reno, cubic, bbr or all (default reno)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxShards = 4;
+    uint32_t maxChannels = 64;
+    uint32_t durationMs = 2000;
+    LinkConfig config;
+    config.dropPct = 0;
+    config.reorderPct = 0;
+    config.delayMs = 0;
+    String cc = "reno";
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-k", argv[i])) || (0 == strcmp("-c", argv[i])) || (0 == strcmp("-t", argv[i])) ||
+            (0 == strcmp("-l", argv[i])) || (0 == strcmp("-r", argv[i])) || (0 == strcmp("-d", argv[i])) ||
+            (0 == strcmp("-a", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            if (argv[i][1] == 'a') {
+                cc = argv[i + 1];
+                ++i;
+                continue;
+            }
+            uint32_t* val = NULL;
+            switch (argv[i][1]) {
+            case 'k': val = &maxShards; break;
+            case 'c': val = &maxChannels; break;
+            case 'l': val = &config.dropPct; break;
+            case 'r': val = &config.reorderPct; break;
+            case 'd': val = &config.delayMs; break;
+            default:  val = &durationMs; break;
+            }
+            *val = StringToU32(argv[i + 1], 0, *val);
+            ++i;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    static const char* ccNames[] = { "reno", "cubic", "bbr" };
+    for (size_t c = 0; c < ArraySize(ccNames); ++c) {
+        CongestionControlType ccType;
+        if (((cc != "all") && (cc != ccNames[c])) || (CongestionControl::ParseType(ccNames[c], ccType) != ER_OK)) {
+            continue;
+        }
+        for (uint32_t numShards = 1; numShards <= maxShards; numShards *= 2) {
+            for (uint32_t numChannels = 1; numChannels <= maxChannels; numChannels *= 4) {
+                RunBenchmark(ccNames[c], ccType, config, numShards, numChannels, durationMs);
+            }
+        }
+    }
+    return 0;
+}
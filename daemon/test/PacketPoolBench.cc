@@ -0,0 +1,146 @@
+/**
+ * @file
+ * Microbenchmark comparing PacketPool gets and returns through the depot with per-thread caches.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+#include <alljoyn/version.h>
+
+#include "PacketPool.h"
+
+#define QCC_MODULE "PACKET"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/* Number of packets each thread holds at once, like a window of unacknowledged packets */
+static const size_t BURST_SIZE = 16;
+
+class PoolThread : public Thread {
+  public:
+    PoolThread(PacketPool& pool, uint32_t iterations, bool useCache) :
+        Thread("pool"), pool(pool), iterations(iterations), useCache(useCache) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        Packet* held[BURST_SIZE];
+        for (uint32_t i = 0; i < iterations; ++i) {
+            for (size_t j = 0; j < BURST_SIZE; ++j) {
+                held[j] = useCache ? pool.GetPacket(cache) : pool.GetPacket();
+            }
+            for (size_t j = 0; j < BURST_SIZE; ++j) {
+                if (useCache) {
+                    pool.ReturnPacket(held[j], cache);
+                } else {
+                    pool.ReturnPacket(held[j]);
+                }
+            }
+        }
+        pool.FlushCache(cache);
+        return 0;
+    }
+
+  private:
+    PacketPool& pool;
+    PacketPool::Cache cache;
+    uint32_t iterations;
+    bool useCache;
+};
+
+static void RunBenchmark(uint32_t numThreads, uint32_t iterations, bool useCache, size_t prealloc)
+{
+    PacketPool pool;
+    pool.Start(1472, prealloc);
+
+    vector<PoolThread*> threads;
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        threads.push_back(new PoolThread(pool, iterations, useCache));
+    }
+    uint64_t start = GetTimestamp64();
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        threads[t]->Start();
+    }
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        threads[t]->Join();
+        delete threads[t];
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    PacketPool::Stats stats;
+    pool.GetStats(stats);
+    double ops = (double) numThreads * iterations * BURST_SIZE;
+    printf("%2u threads %-8s: %8.1f ns/packet, hits %u misses %u allocs %u frees %u\n",
+           numThreads, useCache ? "cache" : "depot", (elapsed * 1000000.0) / ops,
+           stats.hits, stats.misses, stats.allocs, stats.frees);
+}
+
+static void usage(void)
+{
+    printf("Usage: packetpoolbench [-t <threads>] [-n <iterations>] [-p <prealloc>]\n\n");
+    printf("Options:\n");
+    printf("   -h              = Print this help message\n");
+    printf("   -t <threads>    = Largest number of threads, doubled from 1 (default 8)\n");
+    printf("   -n <iterations> = Number of bursts of %u packets per thread (default 100000)\n", (unsigned int) BURST_SIZE);
+    printf("   -p <prealloc>   = Number of packets preallocated by the pool (default 0)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxThreads = 8;
+    uint32_t iterations = 100000;
+    uint32_t prealloc = 0;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-t", argv[i])) || (0 == strcmp("-n", argv[i])) || (0 == strcmp("-p", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            uint32_t& val = (argv[i][1] == 't') ? maxThreads : ((argv[i][1] == 'n') ? iterations : prealloc);
+            val = StringToU32(argv[i + 1], 0, val);
+            ++i;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        RunBenchmark(numThreads, iterations, false, prealloc);
+        RunBenchmark(numThreads, iterations, true, prealloc);
+    }
+    return 0;
+}
@@ -26,12 +26,16 @@
 #include <sys/socket.h>
 
 #include <map>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/Log.h>
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Mutex.h>
+#include <qcc/Event.h>
+#include <qcc/IPAddress.h>
+#include <qcc/time.h>
 #include <alljoyn/version.h>
 
 #include "PacketEngine.h"
@@ -410,6 +414,93 @@ static QStatus DoRecvAtRate(PacketEngineController& controller, uint32_t chanIdx
     return status;
 }
 
+/*
+ * Send count packets of packetSize bytes between two UDPPacketStreams on the loopback interface in
+ * bursts of burstSize packets. With batch set the bursts are sent and received with PushPacketBatch
+ * and PullPacketBatch, otherwise one packet at a time. Returns the rate in packets per second.
+ */
+static double UdpLoopbackRate(uint32_t count, size_t packetSize, size_t burstSize, bool batch)
+{
+    IPAddress loopback("127.0.0.1");
+    UDPPacketStream txStream(loopback, 0, 1472);
+    UDPPacketStream rxStream(loopback, 0, 1472);
+    if ((txStream.Start() != ER_OK) || (rxStream.Start() != ER_OK)) {
+        printf("Failed to start loopback UDPPacketStreams\n");
+        return 0.0;
+    }
+    packetSize = ::min(packetSize, txStream.GetSinkMTU());
+
+    vector<uint8_t> txData(packetSize, 'A');
+    vector<uint8_t> rxData(burstSize * rxStream.GetSourceMTU());
+    vector<PacketBuffer> txBufs(burstSize);
+    vector<PacketBuffer> rxBufs(burstSize);
+    PacketDest dest = GetPacketDest(loopback, rxStream.GetPort());
+    for (size_t i = 0; i < burstSize; ++i) {
+        txBufs[i].buf = &txData[0];
+        txBufs[i].len = packetSize;
+        txBufs[i].dest = dest;
+    }
+
+    uint32_t received = 0;
+    uint64_t start = GetTimestamp64();
+    while (received < count) {
+        size_t burst = ::min((size_t)(count - received), burstSize);
+        size_t sent = 0;
+        QStatus status;
+        if (batch) {
+            status = txStream.PushPacketBatch(&txBufs[0], burst, sent);
+        } else {
+            for (status = ER_OK; (status == ER_OK) && (sent < burst);) {
+                status = txStream.PushPacketBytes(&txData[0], packetSize, dest);
+                if (status == ER_OK) {
+                    ++sent;
+                }
+            }
+        }
+        if (status != ER_OK) {
+            printf("Push failed with %s after %u of %u packets\n", QCC_StatusText(status), (unsigned int) sent, (unsigned int) burst);
+            break;
+        }
+        size_t got = 0;
+        while ((status == ER_OK) && (got < sent)) {
+            size_t numPackets = 0;
+            for (size_t i = 0; i < burstSize; ++i) {
+                rxBufs[i].buf = &rxData[i * rxStream.GetSourceMTU()];
+                rxBufs[i].len = rxStream.GetSourceMTU();
+            }
+            if (batch) {
+                status = rxStream.PullPacketBatch(&rxBufs[0], sent - got, numPackets, 1000);
+            } else {
+                status = Event::Wait(rxStream.GetSourceEvent(), 1000);
+                if (status == ER_OK) {
+                    size_t actualBytes = 0;
+                    status = rxStream.PullPacketBytes(rxBufs[0].buf, rxBufs[0].len, actualBytes, rxBufs[0].dest);
+                    numPackets = (status == ER_OK) ? 1 : 0;
+                }
+            }
+            got += numPackets;
+        }
+        if (status != ER_OK) {
+            printf("Pull failed with %s (%u packets lost, %u truncated)\n", QCC_StatusText(status), (unsigned int) (sent - got),
+                   rxStream.GetTruncatedPackets());
+            break;
+        }
+        received += got;
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    rxStream.Stop();
+    txStream.Stop();
+    return (elapsed > 0) ? ((double) received * 1000.0) / elapsed : 0.0;
+}
+
+static void DoUdpRate(uint32_t count, size_t packetSize, size_t burstSize)
+{
+    double single = UdpLoopbackRate(count, packetSize, burstSize, false);
+    double batched = UdpLoopbackRate(count, packetSize, burstSize, true);
+    printf("%u packets of %u bytes in bursts of %u: single %.0f pkts/s, batched %.0f pkts/s\n",
+           count, (unsigned int) packetSize, (unsigned int) burstSize, single, batched);
+}
+
 int main(int argc, char** argv)
 {
     QStatus status = ER_OK;
@@ -563,6 +654,16 @@ int main(int argc, char** argv)
             if (status != ER_OK) {
                 printf("recvtimeout <timeout_in_ms>\n");
             }
+        } else if (cmd == "udprate") {
+            uint32_t count = StringToU32(NextTok(line), 10, 0);
+            uint32_t packetSize = StringToU32(NextTok(line), 10, 1024);
+            uint32_t burstSize = StringToU32(NextTok(line), 10, 32);
+            if ((count != 0) && (packetSize != 0) && (burstSize != 0)) {
+                DoUdpRate(count, packetSize, burstSize);
+            } else {
+                printf("Invalid args\n");
+                printf("udprate <count> [packet_size] [burst_size]\n");
+            }
         } else if (cmd == "exit") {
             break;
         } else if (cmd == "help") {
@@ -576,6 +677,7 @@ int main(int argc, char** argv)
             printf("sendatrate <stream_idx> <msg_size> <ms_per_msg> <count>   - Send test data at specified rate\n");
             printf("sendtimeout <stream_idx> <timeout>                        - Set send timeout to specified ms\n");
             printf("sendttl <ttl_ms>                                          - Set per-message ttl to specified ms or 0 for infinite\n");
+            printf("udprate <count> [packet_size] [burst_size]                - Measure loopback UDP packets/s with single and batched push/pull\n");
             printf("exit                                                      - Exit this program\n");
             printf("\n");
         } else {
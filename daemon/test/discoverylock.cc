@@ -0,0 +1,309 @@
+/**
+ * @file
+ * Benchmark of JoinSession/LeaveSession latency on a daemon whose AllJoynObj is handling a
+ * FoundNames flood. The daemon runs in this process so that the advertiser threads can call
+ * AllJoynObj::FoundNames() the way the name service does. Build it against an earlier daemon to
+ * compare with the name table lock protecting the discovered names.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/BusListener.h>
+#include <alljoyn/SessionPortListener.h>
+#include <alljoyn/TransportMask.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#include "AllJoynObj.h"
+#include "Bus.h"
+#include "BusController.h"
+#include "DaemonConfig.h"
+#include "DaemonTransport.h"
+#include "TransportList.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/* Number of discovered names in each FoundNames call */
+static const uint32_t NAMES_PER_ADVERTISEMENT = 32;
+
+/* Number of name prefixes being discovered */
+static const uint32_t NUM_DISCOVERERS = 64;
+
+/* TTL (seconds) of the advertised names */
+static const uint8_t ADVERTISEMENT_TTL = 120;
+
+static const SessionPort SESSION_PORT = 42;
+
+static const char daemonConfig[] =
+    "<busconfig>"
+    "  <type>alljoyn</type>"
+    "  <limit auth_timeout=\"5000\"/>"
+    "  <limit max_untrusted_clients=\"0\"/>"
+    "</busconfig>";
+
+static const char listenSpec[] = "unix:abstract=alljoyn-discoverylock";
+
+class AcceptAllListener : public SessionPortListener {
+  public:
+    bool AcceptSessionJoiner(SessionPort sessionPort, const char* joiner, const SessionOpts& opts) { return true; }
+};
+
+class FoundNameCounter : public BusListener {
+  public:
+    FoundNameCounter() : found(0) { }
+
+    void FoundAdvertisedName(const char* name, TransportMask transport, const char* namePrefix)
+    {
+        IncrementAndFetch(&found);
+    }
+
+    volatile int32_t found;
+};
+
+/*
+ * Delivers advertisements from a remote daemon as fast as it can. The names are alternately
+ * found and flushed so that every call changes the discovered name state and signals the
+ * discoverer.
+ */
+class AdvertiserThread : public Thread {
+  public:
+    AdvertiserThread(AllJoynObj& ajObj, uint32_t index) : Thread("advertiser"), ajObj(ajObj), index(index), calls(0)
+    {
+        for (uint32_t n = 0; n < NAMES_PER_ADVERTISEMENT; ++n) {
+            names.push_back("org.alljoyn.bench.D" + U32ToString(n % NUM_DISCOVERERS) + ".A" + U32ToString(index) + "N" + U32ToString(n));
+        }
+    }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        String busAddr = "tcp:addr=10.0.0." + U32ToString(index + 1) + ",port=9955";
+        String guid = "guid" + U32ToString(index);
+        while (!IsStopping()) {
+            ajObj.FoundNames(busAddr, guid, TRANSPORT_TCP, &names, (calls & 1) ? 0 : ADVERTISEMENT_TTL);
+            ++calls;
+        }
+        return 0;
+    }
+
+    uint32_t GetCalls() const { return calls; }
+
+  private:
+    AllJoynObj& ajObj;
+    uint32_t index;
+    vector<String> names;
+    uint32_t calls;
+};
+
+/* Joins and leaves a session with the session host, recording the latency of each pair */
+class JoinerThread : public Thread {
+  public:
+    JoinerThread(BusAttachment& bus, const String& sessionHost, uint32_t iterations) :
+        Thread("joiner"), bus(bus), sessionHost(sessionHost), iterations(iterations), status(ER_OK) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        SessionOpts opts(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+        for (uint32_t n = 0; (status == ER_OK) && (n < iterations); ++n) {
+            uint64_t start = GetTimestamp64();
+            SessionId id;
+            status = bus.JoinSession(sessionHost.c_str(), SESSION_PORT, NULL, id, opts);
+            if (status == ER_OK) {
+                status = bus.LeaveSession(id);
+            }
+            if (status != ER_OK) {
+                QCC_LogError(status, ("Join/leave of session with %s failed", sessionHost.c_str()));
+            }
+            latencies.push_back(static_cast<uint32_t>(GetTimestamp64() - start));
+        }
+        return 0;
+    }
+
+    const vector<uint32_t>& GetLatencies() const { return latencies; }
+
+  private:
+    BusAttachment& bus;
+    String sessionHost;
+    uint32_t iterations;
+    QStatus status;
+    vector<uint32_t> latencies;
+};
+
+static QStatus StartClient(BusAttachment& bus)
+{
+    QStatus status = bus.Start();
+    if (status == ER_OK) {
+        status = bus.Connect(listenSpec);
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to connect %s to the daemon", bus.GetUniqueName().c_str()));
+    }
+    return status;
+}
+
+static void RunBenchmark(AllJoynObj& ajObj, uint32_t numAdvertisers, uint32_t numJoiners, uint32_t iterations)
+{
+    AcceptAllListener acceptAll;
+    BusAttachment host("host", true);
+    if (StartClient(host) != ER_OK) {
+        return;
+    }
+    SessionPort port = SESSION_PORT;
+    SessionOpts opts(SessionOpts::TRAFFIC_MESSAGES, false, SessionOpts::PROXIMITY_ANY, TRANSPORT_ANY);
+    QStatus status = host.BindSessionPort(port, opts, acceptAll);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("BindSessionPort failed"));
+        return;
+    }
+
+    FoundNameCounter counter;
+    BusAttachment discoverer("discoverer", true);
+    discoverer.RegisterBusListener(counter);
+    if (StartClient(discoverer) != ER_OK) {
+        return;
+    }
+    for (uint32_t d = 0; d < NUM_DISCOVERERS; ++d) {
+        discoverer.FindAdvertisedName(("org.alljoyn.bench.D" + U32ToString(d)).c_str());
+    }
+
+    vector<BusAttachment*> joinerBuses;
+    for (uint32_t j = 0; (status == ER_OK) && (j < numJoiners); ++j) {
+        joinerBuses.push_back(new BusAttachment("joiner", true));
+        status = StartClient(*joinerBuses[j]);
+    }
+    if (status != ER_OK) {
+        for (size_t j = 0; j < joinerBuses.size(); ++j) {
+            delete joinerBuses[j];
+        }
+        return;
+    }
+    vector<JoinerThread*> joiners;
+    for (uint32_t j = 0; j < numJoiners; ++j) {
+        joiners.push_back(new JoinerThread(*joinerBuses[j], host.GetUniqueName(), iterations));
+    }
+
+    vector<AdvertiserThread*> advertisers;
+    for (uint32_t a = 0; a < numAdvertisers; ++a) {
+        advertisers.push_back(new AdvertiserThread(ajObj, a));
+        advertisers[a]->Start();
+    }
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t j = 0; j < numJoiners; ++j) {
+        joiners[j]->Start();
+    }
+    vector<uint32_t> latencies;
+    for (uint32_t j = 0; j < numJoiners; ++j) {
+        joiners[j]->Join();
+        latencies.insert(latencies.end(), joiners[j]->GetLatencies().begin(), joiners[j]->GetLatencies().end());
+        delete joiners[j];
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    uint32_t foundCalls = 0;
+    for (uint32_t a = 0; a < numAdvertisers; ++a) {
+        advertisers[a]->Stop();
+        advertisers[a]->Join();
+        foundCalls += advertisers[a]->GetCalls();
+        delete advertisers[a];
+    }
+    for (uint32_t j = 0; j < numJoiners; ++j) {
+        delete joinerBuses[j];
+    }
+
+    sort(latencies.begin(), latencies.end());
+    uint32_t p99 = latencies.empty() ? 0 : latencies[(latencies.size() * 99) / 100];
+    uint32_t max = latencies.empty() ? 0 : latencies.back();
+    printf("%10.0f join/leave per s, p99 %4u ms, max %4u ms, %10.0f FoundNames per s, %d FoundAdvertisedName signals\n",
+           (latencies.size() * 1000.0) / (elapsed ? elapsed : 1), p99, max,
+           (foundCalls * 1000.0) / (elapsed ? elapsed : 1), counter.found);
+}
+
+static void usage(void)
+{
+    printf("Usage: discoverylock [-a <advertisers>] [-j <joiners>] [-i <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h               = Print this help message\n");
+    printf("   -a <advertisers> = Number of threads calling FoundNames (default 4)\n");
+    printf("   -j <joiners>     = Number of threads joining and leaving sessions (default 4)\n");
+    printf("   -i <iterations>  = Number of joins per joiner thread (default 1000)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numAdvertisers = 4;
+    uint32_t numJoiners = 4;
+    uint32_t iterations = 1000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-a", argv[i])) || (0 == strcmp("-j", argv[i])) || (0 == strcmp("-i", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            uint32_t& val = (argv[i][1] == 'a') ? numAdvertisers : ((argv[i][1] == 'j') ? numJoiners : iterations);
+            val = StringToU32(argv[i + 1], 0, val);
+            ++i;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    DaemonConfig::Load(daemonConfig);
+
+    TransportFactoryContainer cntr;
+    cntr.Add(new TransportFactory<DaemonTransport>(DaemonTransport::TransportName, true));
+    Bus bus("discoverylock", cntr, listenSpec);
+    BusController controller(bus);
+    QStatus status = controller.Init(listenSpec);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("BusController initialization failed"));
+        return (int) status;
+    }
+
+    RunBenchmark(controller.GetAllJoynObj(), numAdvertisers, numJoiners, iterations);
+
+    bus.StopListen(listenSpec);
+    return 0;
+}
@@ -0,0 +1,293 @@
+/**
+ * @file
+ * Benchmark of the rate at which DaemonRouter::PushMessage routes messages from several sender
+ * threads while endpoints connect and disconnect. The daemon runs in this process so that the
+ * senders can push messages straight into the router. Build it against an earlier daemon to
+ * compare with lookups made under the name table lock.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+
+#include <alljoyn/DBusStd.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+#include "BusEndpoint.h"
+#include "BusInternal.h"
+#include "Bus.h"
+#include "BusController.h"
+#include "DaemonConfig.h"
+#include "DaemonRouter.h"
+#include "DaemonTransport.h"
+#include "TransportList.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/* Number of endpoints connected to the daemon, each owns one well-known name */
+static const uint32_t NUM_ENDPOINTS = 1000;
+
+static const char daemonConfig[] =
+    "<busconfig>"
+    "  <type>alljoyn</type>"
+    "  <limit auth_timeout=\"5000\"/>"
+    "  <limit max_untrusted_clients=\"0\"/>"
+    "</busconfig>";
+
+static const char listenSpec[] = "unix:abstract=alljoyn-nametable";
+
+/* Endpoint that accepts and discards every message routed to it */
+class _SinkEndpoint : public _BusEndpoint {
+  public:
+    _SinkEndpoint(const qcc::String& uniqueName) : _BusEndpoint(ENDPOINT_TYPE_NULL), uniqueName(uniqueName) { }
+
+    QStatus PushMessage(Message& msg) { return ER_OK; }
+
+    const qcc::String& GetUniqueName() const { return uniqueName; }
+
+    bool AllowRemoteMessages() { return true; }
+
+  private:
+    qcc::String uniqueName;
+};
+
+typedef ManagedObj<_SinkEndpoint> SinkEndpoint;
+
+class BenchMessage : public _Message {
+  public:
+    BenchMessage(BusAttachment& bus) : _Message(bus) { }
+
+    QStatus Signal(const qcc::String& destination)
+    {
+        return SignalMsg("", destination.c_str(), 0, "/org/alljoyn/bench", "org.alljoyn.bench.NameTable", "Ping", NULL, 0, 0, 0);
+    }
+};
+
+typedef ManagedObj<BenchMessage> TestMessage;
+
+/*
+ * Pushes messages into the router from one of the connected endpoints. Half of the
+ * destinations are unique names and half are well-known names. Each sender has its own
+ * messages so that the senders only share the router and the name table.
+ */
+class SenderThread : public Thread {
+  public:
+    SenderThread(BusAttachment& bus, DaemonRouter& router, BusEndpoint& sender, const vector<qcc::String>& destinations, uint32_t iterations) :
+        Thread("sender"), router(router), sender(sender), iterations(iterations), routed(0)
+    {
+        for (size_t d = 0; d < destinations.size(); ++d) {
+            TestMessage tmsg(bus);
+            tmsg->Signal(destinations[d]);
+            msgs.push_back(Message::cast(tmsg));
+        }
+    }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t n = 0; n < iterations; ++n) {
+            if (router.PushMessage(msgs[n % msgs.size()], sender) == ER_OK) {
+                ++routed;
+            }
+        }
+        return 0;
+    }
+
+    uint32_t GetRouted() const { return routed; }
+
+  private:
+    DaemonRouter& router;
+    BusEndpoint sender;
+    vector<Message> msgs;
+    uint32_t iterations;
+    uint32_t routed;
+};
+
+/*
+ * Connects and disconnects endpoints that own a well-known name over and over,
+ * standing in for clients attaching to and leaving the daemon.
+ */
+class ConnectThread : public Thread {
+  public:
+    ConnectThread(DaemonRouter& router) : Thread("connect"), router(router), connects(0) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        while (!IsStopping()) {
+            SinkEndpoint sep(router.GenerateUniqueName());
+            BusEndpoint ep = BusEndpoint::cast(sep);
+            router.RegisterEndpoint(ep);
+            uint32_t disposition;
+            router.AddAlias("org.alljoyn.bench.Churn" + U32ToString(connects), ep->GetUniqueName(), DBUS_NAME_FLAG_DO_NOT_QUEUE, disposition);
+            router.UnregisterEndpoint(ep->GetUniqueName(), ep->GetEndpointType());
+            ++connects;
+        }
+        return 0;
+    }
+
+    uint32_t GetConnects() const { return connects; }
+
+  private:
+    DaemonRouter& router;
+    uint32_t connects;
+};
+
+static void RunBenchmark(BusAttachment& bus, DaemonRouter& router, vector<BusEndpoint>& endpoints, const vector<qcc::String>& destinations,
+                         uint32_t numThreads, uint32_t iterations)
+{
+    ConnectThread connector(router);
+    connector.Start();
+
+    vector<SenderThread*> senders;
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        senders.push_back(new SenderThread(bus, router, endpoints[t % endpoints.size()], destinations, iterations));
+    }
+    uint64_t start = GetTimestamp64();
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        senders[t]->Start();
+    }
+    uint32_t routed = 0;
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        senders[t]->Join();
+        routed += senders[t]->GetRouted();
+        delete senders[t];
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    connector.Stop();
+    connector.Join();
+
+    double msgs = (double) numThreads * iterations;
+    printf("%2u sender threads: %12.0f routed msgs/s, %8.1f ns/msg, routed %u of %.0f, %8.0f connects/s\n",
+           numThreads, (routed * 1000.0) / (elapsed ? elapsed : 1), (elapsed * 1000000.0 * numThreads) / msgs,
+           routed, msgs, (connector.GetConnects() * 1000.0) / (elapsed ? elapsed : 1));
+}
+
+/* Time taken to connect a burst of endpoints to a daemon that already has the benchmark endpoints */
+static void RunConnectStorm(DaemonRouter& router, uint32_t numConnects)
+{
+    vector<BusEndpoint> storm;
+    uint64_t start = GetTimestamp64();
+    for (uint32_t c = 0; c < numConnects; ++c) {
+        SinkEndpoint sep(router.GenerateUniqueName());
+        BusEndpoint ep = BusEndpoint::cast(sep);
+        router.RegisterEndpoint(ep);
+        storm.push_back(ep);
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    for (size_t c = 0; c < storm.size(); ++c) {
+        router.UnregisterEndpoint(storm[c]->GetUniqueName(), storm[c]->GetEndpointType());
+    }
+    printf("connect storm     : %u endpoints in %u ms, %8.0f connects/s\n",
+           numConnects, (uint32_t) elapsed, (numConnects * 1000.0) / (elapsed ? elapsed : 1));
+}
+
+static void usage(void)
+{
+    printf("Usage: nametable [-t <threads>] [-i <iterations>] [-c <connects>]\n\n");
+    printf("Options:\n");
+    printf("   -h               = Print this help message\n");
+    printf("   -t <threads>     = Largest number of sender threads, doubled from 1 (default 8)\n");
+    printf("   -i <iterations>  = Number of messages pushed per sender thread (default 1000000)\n");
+    printf("   -c <connects>    = Number of endpoints in the connect storm (default 10000)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxThreads = 8;
+    uint32_t iterations = 1000000;
+    uint32_t numConnects = 10000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-t", argv[i])) || (0 == strcmp("-i", argv[i])) || (0 == strcmp("-c", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            uint32_t& val = (argv[i][1] == 't') ? maxThreads : ((argv[i][1] == 'i') ? iterations : numConnects);
+            val = StringToU32(argv[i + 1], 0, val);
+            ++i;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    DaemonConfig::Load(daemonConfig);
+
+    TransportFactoryContainer cntr;
+    cntr.Add(new TransportFactory<DaemonTransport>(DaemonTransport::TransportName, true));
+    Bus bus("nametable", cntr, listenSpec);
+    BusController controller(bus);
+    QStatus status = controller.Init(listenSpec);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("BusController initialization failed"));
+        return (int) status;
+    }
+    DaemonRouter& router = reinterpret_cast<DaemonRouter&>(bus.GetInternal().GetRouter());
+
+    vector<BusEndpoint> endpoints;
+    vector<qcc::String> destinations;
+    for (uint32_t e = 0; e < NUM_ENDPOINTS; ++e) {
+        SinkEndpoint sep(router.GenerateUniqueName());
+        BusEndpoint ep = BusEndpoint::cast(sep);
+        router.RegisterEndpoint(ep);
+        endpoints.push_back(ep);
+
+        qcc::String alias = "org.alljoyn.bench.Name" + U32ToString(e);
+        uint32_t disposition;
+        router.AddAlias(alias, ep->GetUniqueName(), DBUS_NAME_FLAG_DO_NOT_QUEUE, disposition);
+
+        destinations.push_back(ep->GetUniqueName());
+        destinations.push_back(alias);
+    }
+
+    for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        RunBenchmark(bus, router, endpoints, destinations, numThreads, iterations);
+    }
+    RunConnectStorm(router, numConnects);
+
+    for (size_t e = 0; e < endpoints.size(); ++e) {
+        router.UnregisterEndpoint(endpoints[e]->GetUniqueName(), endpoints[e]->GetEndpointType());
+    }
+    bus.StopListen(listenSpec);
+    return 0;
+}
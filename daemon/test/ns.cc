@@ -32,6 +32,7 @@
 #include <qcc/IfConfig.h>
 #include <qcc/GUID.h>
 #include <qcc/Thread.h>  // For qcc::Sleep()
+#include <qcc/time.h>
 
 #include <alljoyn/Status.h>
 #include <ns/IpNameService.h>
@@ -51,6 +52,29 @@ static const char config[] =
     "  </ip_name_service>"
     "</busconfig>";
 
+static const char legacyConfig[] =
+    "<busconfig>"
+    "  <ip_name_service>"
+    "    <property enable_ipv4=\"true\"/>"
+    "    <property coalesce_ms=\"0\"/>"
+    "  </ip_name_service>"
+    "</busconfig>";
+
+static const char coalesceConfig[] =
+    "<busconfig>"
+    "  <ip_name_service>"
+    "    <property enable_ipv4=\"true\"/>"
+    "  </ip_name_service>"
+    "</busconfig>";
+
+static const char deltaConfig[] =
+    "<busconfig>"
+    "  <ip_name_service>"
+    "    <property enable_ipv4=\"true\"/>"
+    "    <property delta_advertisements=\"true\"/>"
+    "  </ip_name_service>"
+    "</busconfig>";
+
 char const* g_names[] = {
     "org.randomteststring.A",
     "org.randomteststring.B",
@@ -207,6 +231,116 @@ static void PrintFlags(uint32_t flags)
 
 #define ERROR_EXIT exit(1)
 
+//
+// Number of names advertised and retransmission periods observed by the packet
+// count benchmark.
+//
+static const uint32_t BENCH_NAMES = 100;
+static const uint32_t BENCH_PERIODS = 4;
+
+//
+// Wait until the name service has not sent anything for a couple of seconds
+// and return the number of packets it has sent in total.
+//
+static uint32_t WaitForQuiet(IpNameServiceImpl& ns)
+{
+    uint32_t sent, received, last;
+    ns.GetPacketCounts(last, received);
+    for (uint32_t quiet = 0; quiet < 2;) {
+        qcc::Sleep(1000);
+        ns.GetPacketCounts(sent, received);
+        quiet = (sent == last) ? quiet + 1 : 0;
+        last = sent;
+    }
+    return last;
+}
+
+//
+// Advertise a batch of names one at a time the way a busy daemon would, then
+// sit through a few retransmission periods, counting the datagrams the name
+// service sends in each phase.
+//
+static void RunPacketBenchmark(const char* mode, const char* benchConfig, bool useEth0)
+{
+    QStatus status;
+
+    DaemonConfig::Release();
+    DaemonConfig::Load(benchConfig);
+
+    IpNameServiceImpl ns;
+    status = ns.Init(qcc::GUID128().ToString(), false);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Init failed"));
+        ERROR_EXIT;
+    }
+
+    //
+    // Retransmit every five seconds instead of every forty so the benchmark
+    // finishes in reasonable time.
+    //
+    ns.SetCriticalParameters(10, 5, IpNameServiceImpl::QUESTION_TIME, IpNameServiceImpl::QUESTION_MODULUS,
+                             IpNameServiceImpl::NUMBER_RETRIES);
+
+    status = ns.Start();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Start failed"));
+        ERROR_EXIT;
+    }
+
+    std::vector<qcc::IfConfigEntry> entries;
+    status = qcc::IfConfig(entries);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("IfConfig failed"));
+        ERROR_EXIT;
+    }
+
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        if (!useEth0 && entries[i].m_name == "eth0") {
+            continue;
+        }
+        if ((entries[i].m_flags & qcc::IfConfigEntry::UP) && (entries[i].m_flags & qcc::IfConfigEntry::LOOPBACK) == 0) {
+            status = ns.OpenInterface(TRANSPORT_TCP, entries[i].m_name);
+            if (status != ER_OK) {
+                QCC_LogError(status, ("OpenInterface failed"));
+                ERROR_EXIT;
+            }
+        }
+    }
+
+    uint16_t port = rand();
+    status = ns.Enable(TRANSPORT_TCP, port, port, port, port, true, true, true, true);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Enable failed"));
+        ERROR_EXIT;
+    }
+
+    uint32_t start = WaitForQuiet(ns);
+    uint64_t begin = qcc::GetTimestamp64();
+
+    for (uint32_t i = 0; i < BENCH_NAMES; ++i) {
+        char wkn[64];
+        snprintf(wkn, sizeof(wkn), "org.randomteststring.bench%u", i);
+        status = ns.AdvertiseName(TRANSPORT_TCP, wkn, false);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Advertise failed"));
+            ERROR_EXIT;
+        }
+    }
+
+    uint32_t advertised = WaitForQuiet(ns);
+    uint64_t advertiseMs = qcc::GetTimestamp64() - begin;
+
+    qcc::Sleep(BENCH_PERIODS * 5 * 1000);
+    uint32_t sent, received;
+    ns.GetPacketCounts(sent, received);
+
+    ns.Stop();
+    ns.Join();
+
+    printf("%-10s %10u %10u %10.1f %10u\n", mode, advertised - start, sent - advertised,
+           static_cast<double>(sent - advertised) / BENCH_PERIODS, static_cast<uint32_t>(advertiseMs));
+}
+
 int main(int argc, char** argv)
 {
     QStatus status;
@@ -217,10 +351,13 @@ int main(int argc, char** argv)
     bool runtests = false;
     bool wildcard = false;
     bool longnames = false;
+    bool benchmark = false;
 
     for (int i = 1; i < argc; ++i) {
         if (strcmp("-a", argv[i]) == 0) {
             advertise = true;
+        } else if (strcmp("-b", argv[i]) == 0) {
+            benchmark = true;
         } else if (strcmp("-e", argv[i]) == 0) {
             useEth0 = true;
         } else if (strcmp("-l", argv[i]) == 0) {
@@ -239,6 +376,16 @@ int main(int argc, char** argv)
         exit(0);
     }
 
+    if (benchmark) {
+        srand(time(0));
+        printf("Packets sent for %u names advertised one at a time and %u retransmission periods\n", BENCH_NAMES, BENCH_PERIODS);
+        printf("%-10s %10s %10s %10s %10s\n", "mode", "advertise", "retransmit", "per period", "ms");
+        RunPacketBenchmark("legacy", legacyConfig, useEth0);
+        RunPacketBenchmark("coalesce", coalesceConfig, useEth0);
+        RunPacketBenchmark("delta", deltaConfig, useEth0);
+        return 0;
+    }
+
     //
     // Load the configuration information
     //
@@ -0,0 +1,209 @@
+/**
+ * @file
+ * Benchmark comparing indexed rule table matching with a linear scan of the rules.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/version.h>
+
+#include "BusEndpoint.h"
+#include "RuleTable.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static BusAttachment* gBus;
+
+/* Number of distinct interfaces and members used to generate rules */
+static const uint32_t NUM_IFACES = 100;
+static const uint32_t NUM_MEMBERS = 10;
+
+class _TestEndpoint : public _BusEndpoint {
+  public:
+    _TestEndpoint() : _BusEndpoint(ENDPOINT_TYPE_REMOTE) { }
+};
+
+typedef ManagedObj<_TestEndpoint> TestEndpoint;
+
+class _TestMessage : public _Message {
+  public:
+    _TestMessage() : _Message(*gBus) { }
+
+    QStatus Signal(const qcc::String& iface, const qcc::String& member)
+    {
+        return SignalMsg("", NULL, 0, "/org/alljoyn/test", iface, member, NULL, 0, 0, 0);
+    }
+};
+
+typedef ManagedObj<_TestMessage> TestMessage;
+
+static qcc::String IfaceName(uint32_t i)
+{
+    return "org.alljoyn.test.Iface" + U32ToString(i);
+}
+
+static qcc::String MemberName(uint32_t m)
+{
+    return "Signal" + U32ToString(m);
+}
+
+/*
+ * The broadcast routing loop that DaemonRouter used before the rule index was added.
+ */
+static size_t ScanMatch(RuleTable& ruleTable, Message& msg)
+{
+    size_t count = 0;
+    ruleTable.Lock();
+    RuleIterator it = ruleTable.Begin();
+    while (it != ruleTable.End()) {
+        if (it->second.IsMatch(msg)) {
+            ++count;
+            it = ruleTable.AdvanceToNextEndpoint(it->first);
+        } else {
+            ++it;
+        }
+    }
+    ruleTable.Unlock();
+    return count;
+}
+
+static size_t IndexMatch(RuleTable& ruleTable, Message& msg)
+{
+    vector<BusEndpoint> matches;
+    ruleTable.FindMatchingEndpoints(msg, matches);
+    return matches.size();
+}
+
+static void RunBenchmark(uint32_t numRules, uint32_t iterations)
+{
+    RuleTable ruleTable;
+    vector<BusEndpoint> endpoints;
+
+    /*
+     * Each endpoint holds 10 rules. Every 50th rule is a wildcard on the member name so that
+     * the index has to consult more than one bucket.
+     */
+    for (uint32_t r = 0; r < numRules; ++r) {
+        if ((r % 10) == 0) {
+            TestEndpoint tep;
+            endpoints.push_back(BusEndpoint::cast(tep));
+        }
+        Rule rule;
+        rule.type = MESSAGE_SIGNAL;
+        rule.iface = IfaceName(r % NUM_IFACES);
+        if ((r % 50) != 0) {
+            rule.member = MemberName((r / NUM_IFACES) % NUM_MEMBERS);
+        }
+        ruleTable.AddRule(endpoints.back(), rule);
+    }
+
+    vector<Message> msgs;
+    for (uint32_t i = 0; i < NUM_IFACES; ++i) {
+        TestMessage tmsg;
+        QStatus status = tmsg->Signal(IfaceName(i), MemberName(i % NUM_MEMBERS));
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to create test signal"));
+            return;
+        }
+        msgs.push_back(Message::cast(tmsg));
+    }
+
+    size_t scanCount = 0;
+    uint64_t start = GetTimestamp64();
+    for (uint32_t n = 0; n < iterations; ++n) {
+        scanCount += ScanMatch(ruleTable, msgs[n % msgs.size()]);
+    }
+    uint64_t scanTime = GetTimestamp64() - start;
+
+    size_t indexCount = 0;
+    start = GetTimestamp64();
+    for (uint32_t n = 0; n < iterations; ++n) {
+        indexCount += IndexMatch(ruleTable, msgs[n % msgs.size()]);
+    }
+    uint64_t indexTime = GetTimestamp64() - start;
+
+    printf("%7u rules %8u msgs: scan %8.3f us/msg, index %8.3f us/msg, matches %s\n",
+           numRules, iterations,
+           (1000.0 * scanTime) / iterations,
+           (1000.0 * indexTime) / iterations,
+           (scanCount == indexCount) ? "agree" : "DIFFER");
+
+    for (size_t e = 0; e < endpoints.size(); ++e) {
+        ruleTable.RemoveAllRules(endpoints[e]);
+    }
+}
+
+static void usage(void)
+{
+    printf("Usage: ruletable [-i <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h               = Print this help message\n");
+    printf("   -i <iterations>  = Number of messages matched against the 10 rule table (scaled down for larger tables)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = 1000000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp("-i", argv[i])) {
+            ++i;
+            if (i == argc) {
+                printf("option %s requires a parameter\n", argv[i - 1]);
+                usage();
+                exit(1);
+            }
+            iterations = StringToU32(argv[i], 0, iterations);
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    gBus = new BusAttachment("ruletable");
+
+    RunBenchmark(10, iterations);
+    RunBenchmark(1000, iterations / 10);
+    RunBenchmark(100000, iterations / 1000);
+
+    delete gBus;
+    return 0;
+}
@@ -0,0 +1,321 @@
+/**
+ * @file
+ * Benchmark comparing catch-up range requests on the indexed sessionless message store with a
+ * scan of the whole store.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/Thread.h>
+#include <qcc/Util.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/version.h>
+
+#include "SessionlessMessageStore.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static BusAttachment* gBus;
+
+/* Number of signals stored under each change id */
+static const uint32_t SIGNALS_PER_CHANGE_ID = 10;
+
+/* Number of change ids covered by each catch-up request */
+static const uint32_t CATCHUP_WINDOW = 10;
+
+/* TTL (seconds) of the signals read by the catch-up threads; outlives any run */
+static const uint16_t LONG_TTL = 3600;
+
+/* TTL (seconds) of the signals added for the purge, which the benchmark waits out */
+static const uint16_t SHORT_TTL = 1;
+
+class _TestMessage : public _Message {
+  public:
+    _TestMessage() : _Message(*gBus) { }
+
+    QStatus Signal(const qcc::String& objPath, uint16_t ttl)
+    {
+        return SignalMsg("", NULL, 0, objPath, "org.alljoyn.test.Sessionless", "Signal", NULL, 0, ALLJOYN_FLAG_SESSIONLESS, ttl);
+    }
+};
+
+typedef ManagedObj<_TestMessage> TestMessage;
+
+/**
+ * Interface shared by the two stores so the same catch-up threads can drive either.
+ */
+class CatchupTarget {
+  public:
+    virtual ~CatchupTarget() { }
+    virtual size_t HandleRange(uint32_t fromId, uint32_t toId) = 0;
+};
+
+/*
+ * The way SessionlessObj handled a range request before the change id index was added: walk the
+ * whole map and re-find the position after releasing the lock to send each message.
+ */
+class ScanStore : public CatchupTarget {
+  public:
+    void Add(Message& msg, uint32_t changeId)
+    {
+        lock.Lock();
+        messageMap[msg->GetObjectPath()] = pair<uint32_t, Message>(changeId, msg);
+        lock.Unlock();
+    }
+
+    size_t HandleRange(uint32_t fromId, uint32_t toId)
+    {
+        size_t sent = 0;
+        lock.Lock();
+        map<String, pair<uint32_t, Message> >::iterator it = messageMap.begin();
+        while (it != messageMap.end()) {
+            if ((it->second.first >= fromId) && (it->second.first < toId)) {
+                String key = it->first;
+                if (!it->second.second->IsExpired()) {
+                    lock.Unlock();
+                    ++sent;
+                    lock.Lock();
+                }
+                it = messageMap.upper_bound(key);
+            } else {
+                ++it;
+            }
+        }
+        lock.Unlock();
+        return sent;
+    }
+
+    size_t Purge()
+    {
+        size_t count = 0;
+        lock.Lock();
+        map<String, pair<uint32_t, Message> >::iterator it = messageMap.begin();
+        while (it != messageMap.end()) {
+            if (it->second.second->IsExpired()) {
+                messageMap.erase(it++);
+                ++count;
+            } else {
+                ++it;
+            }
+        }
+        lock.Unlock();
+        return count;
+    }
+
+  private:
+    Mutex lock;
+    map<String, pair<uint32_t, Message> > messageMap;
+};
+
+class IndexedStore : public CatchupTarget {
+  public:
+    void Add(Message& msg, uint32_t changeId)
+    {
+        lock.Lock();
+        store.Add(msg, changeId);
+        lock.Unlock();
+    }
+
+    size_t HandleRange(uint32_t fromId, uint32_t toId)
+    {
+        vector<Message> msgs;
+        lock.Lock();
+        store.GetRange(fromId, toId - fromId, msgs);
+        lock.Unlock();
+        return msgs.size();
+    }
+
+    size_t Purge()
+    {
+        uint32_t nextExpire;
+        lock.Lock();
+        size_t count = store.PurgeExpired(nextExpire);
+        lock.Unlock();
+        return count;
+    }
+
+  private:
+    Mutex lock;
+    SessionlessMessageStore store;
+};
+
+class CatchupThread : public Thread {
+  public:
+    CatchupThread(CatchupTarget& target, uint32_t numChangeIds, uint32_t requests, uint32_t seed) :
+        Thread("catchup"), target(target), numChangeIds(numChangeIds), requests(requests), seed(seed), sent(0) { }
+
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t r = 0; r < requests; ++r) {
+            uint32_t fromId = ((seed + r) * 7919) % (numChangeIds - CATCHUP_WINDOW);
+            sent += target.HandleRange(fromId, fromId + CATCHUP_WINDOW);
+        }
+        return 0;
+    }
+
+    CatchupTarget& target;
+    uint32_t numChangeIds;
+    uint32_t requests;
+    uint32_t seed;
+    size_t sent;
+};
+
+static uint64_t RunCatchups(CatchupTarget& target, uint32_t numChangeIds, uint32_t numThreads, uint32_t requests, size_t& sent)
+{
+    vector<CatchupThread*> threads;
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        threads.push_back(new CatchupThread(target, numChangeIds, requests, t));
+    }
+    uint64_t start = GetTimestamp64();
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        threads[t]->Start();
+    }
+    sent = 0;
+    for (uint32_t t = 0; t < numThreads; ++t) {
+        threads[t]->Join();
+        sent += threads[t]->sent;
+        delete threads[t];
+    }
+    return GetTimestamp64() - start;
+}
+
+/* Add signals with object paths first..(first + count - 1) to both stores */
+static QStatus AddSignals(ScanStore& scanStore, IndexedStore& indexedStore, uint32_t first, uint32_t count, uint16_t ttl)
+{
+    for (uint32_t i = first; i < (first + count); ++i) {
+        TestMessage tmsg;
+        QStatus status = tmsg->Signal("/org/alljoyn/test/s" + U32ToString(i), ttl);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to create test signal"));
+            return status;
+        }
+        Message msg = Message::cast(tmsg);
+        scanStore.Add(msg, i / SIGNALS_PER_CHANGE_ID);
+        indexedStore.Add(msg, i / SIGNALS_PER_CHANGE_ID);
+    }
+    return ER_OK;
+}
+
+static void RunBenchmark(uint32_t numSignals, uint32_t numThreads, uint32_t requests)
+{
+    ScanStore scanStore;
+    IndexedStore indexedStore;
+    uint32_t numChangeIds = numSignals / SIGNALS_PER_CHANGE_ID;
+
+    if (AddSignals(scanStore, indexedStore, 0, numSignals, LONG_TTL) != ER_OK) {
+        return;
+    }
+
+    size_t scanSent;
+    uint64_t scanTime = RunCatchups(scanStore, numChangeIds, numThreads, requests, scanSent);
+    size_t indexSent;
+    uint64_t indexTime = RunCatchups(indexedStore, numChangeIds, numThreads, requests, indexSent);
+
+    /*
+     * Add as many short lived signals again, under change ids past the catch-up range, and wait for
+     * them to expire so that the purge has half of the stored signals to remove.
+     */
+    if (AddSignals(scanStore, indexedStore, numSignals, numSignals, SHORT_TTL) != ER_OK) {
+        return;
+    }
+    qcc::Sleep(SHORT_TTL * 1000 + 100);
+
+    uint64_t start = GetTimestamp64();
+    size_t scanPurged = scanStore.Purge();
+    uint64_t scanPurge = GetTimestamp64() - start;
+    start = GetTimestamp64();
+    size_t indexPurged = indexedStore.Purge();
+    uint64_t indexPurge = GetTimestamp64() - start;
+
+    uint32_t totalRequests = numThreads * requests;
+    printf("%6u signals %4u catch-ups: scan %8.3f ms/request, index %8.3f ms/request, purge of %u scan %llu ms index %llu ms, sent %s, purged %s\n",
+           numSignals, numThreads,
+           (double)scanTime / totalRequests,
+           (double)indexTime / totalRequests,
+           (unsigned int)indexPurged,
+           (unsigned long long)scanPurge, (unsigned long long)indexPurge,
+           (scanSent == indexSent) ? "agree" : "DIFFER",
+           ((scanPurged == indexPurged) && (indexPurged == numSignals)) ? "agree" : "DIFFER");
+}
+
+static void usage(void)
+{
+    printf("Usage: sessionless [-n <signals>] [-c <catch-ups>] [-r <requests>]\n\n");
+    printf("Options:\n");
+    printf("   -h              = Print this help message\n");
+    printf("   -n <signals>    = Number of stored sessionless signals (default 10000)\n");
+    printf("   -c <catch-ups>  = Number of concurrent catch-up threads (default 100)\n");
+    printf("   -r <requests>   = Number of range requests made by each catch-up thread (default 10)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numSignals = 10000;
+    uint32_t numThreads = 100;
+    uint32_t requests = 10;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-n", argv[i])) || (0 == strcmp("-c", argv[i])) || (0 == strcmp("-r", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            uint32_t& val = (argv[i][1] == 'n') ? numSignals : ((argv[i][1] == 'c') ? numThreads : requests);
+            val = StringToU32(argv[i + 1], 0, val);
+            ++i;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+    if (numSignals < (SIGNALS_PER_CHANGE_ID * (CATCHUP_WINDOW + 1))) {
+        numSignals = SIGNALS_PER_CHANGE_ID * (CATCHUP_WINDOW + 1);
+    }
+
+    gBus = new BusAttachment("sessionless");
+
+    RunBenchmark(numSignals, 1, requests);
+    RunBenchmark(numSignals, numThreads, requests);
+
+    delete gBus;
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file
+ * Benchmark measuring how quickly the daemon TCP transport accepts and authenticates
+ * connections and how much daemon memory each pending connection costs.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/IPAddress.h>
+#include <qcc/Socket.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/time.h>
+
+#include <alljoyn/version.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+
+/* The leading nul byte followed by the first SASL command sent by a thin client */
+static const char AUTH_REQUEST[] = "\0AUTH ANONYMOUS\r\n";
+
+/*
+ * Get the resident set size of a process in kilobytes from /proc, or 0 if it
+ * cannot be read.
+ */
+static uint32_t GetRssKb(uint32_t pid)
+{
+    qcc::String path = "/proc/" + U32ToString(pid) + "/status";
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) {
+        return 0;
+    }
+    char line[256];
+    uint32_t kb = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            kb = (uint32_t) strtoul(line + 6, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return kb;
+}
+
+/*
+ * Wait for the reply to the AUTH command, returns true if the daemon accepted
+ * the command.
+ */
+static bool WaitReply(SocketFd sock)
+{
+    char buf[128];
+    size_t total = 0;
+    while (total < sizeof(buf)) {
+        size_t received;
+        QStatus status = Recv(sock, buf + total, sizeof(buf) - total, received);
+        if ((status != ER_OK) || (received == 0)) {
+            return false;
+        }
+        total += received;
+        if (buf[total - 1] == '\n') {
+            return (total >= 2) && (strncmp(buf, "OK", 2) == 0);
+        }
+    }
+    return false;
+}
+
+static void usage(void)
+{
+    printf("Usage: tcpauthbench [-a <address>] [-p <port>] [-n <connections>] [-d <pid>]\n\n");
+    printf("Options:\n");
+    printf("   -h                = Print this help message\n");
+    printf("   -a <address>      = Address of the daemon (default 127.0.0.1)\n");
+    printf("   -p <port>         = TCP port of the daemon (default 9955)\n");
+    printf("   -n <connections>  = Number of connections to hold pending (default 1000)\n");
+    printf("   -d <pid>          = Daemon process id, reports memory per pending connection\n");
+}
+
+int main(int argc, char** argv)
+{
+    qcc::String address = "127.0.0.1";
+    uint32_t port = 9955;
+    uint32_t numConns = 1000;
+    uint32_t pid = 0;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp("-a", argv[i])) || (0 == strcmp("-p", argv[i])) ||
+            (0 == strcmp("-n", argv[i])) || (0 == strcmp("-d", argv[i]))) {
+            if ((i + 1) == argc) {
+                printf("option %s requires a parameter\n", argv[i]);
+                usage();
+                exit(1);
+            }
+            switch (argv[i][1]) {
+            case 'a':
+                address = argv[i + 1];
+                break;
+
+            case 'p':
+                port = StringToU32(argv[i + 1], 0, port);
+                break;
+
+            case 'n':
+                numConns = StringToU32(argv[i + 1], 0, numConns);
+                break;
+
+            default:
+                pid = StringToU32(argv[i + 1], 0, pid);
+                break;
+            }
+            ++i;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+    }
+
+    IPAddress addr(address);
+    uint32_t rssBefore = pid ? GetRssKb(pid) : 0;
+    vector<SocketFd> socks;
+
+    /*
+     * Open the connections and send the first SASL command on each before
+     * reading any reply so that the daemon has them all pending at once.
+     */
+    uint64_t start = GetTimestamp64();
+    for (uint32_t n = 0; n < numConns; ++n) {
+        SocketFd sock;
+        QStatus status = Socket(QCC_AF_INET, QCC_SOCK_STREAM, sock);
+        if (status == ER_OK) {
+            status = Connect(sock, addr, static_cast<uint16_t>(port));
+            if (status == ER_OK) {
+                size_t sent;
+                status = Send(sock, AUTH_REQUEST, sizeof(AUTH_REQUEST) - 1, sent);
+            }
+            if (status != ER_OK) {
+                Close(sock);
+            }
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to open connection %u", n));
+            break;
+        }
+        socks.push_back(sock);
+    }
+
+    uint32_t accepted = 0;
+    for (size_t n = 0; n < socks.size(); ++n) {
+        if (WaitReply(socks[n])) {
+            ++accepted;
+        }
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    printf("%u connections, %u accepted, %u rejected in %u ms: %.0f accepts/s\n",
+           (unsigned int) socks.size(), accepted, (unsigned int) socks.size() - accepted, (unsigned int) elapsed,
+           (accepted * 1000.0) / (elapsed ? elapsed : 1));
+
+    if (pid) {
+        /*
+         * The connections are still waiting for BEGIN and the Hello message so
+         * the daemon is holding all of them in the authenticating state.
+         */
+        uint32_t rssAfter = GetRssKb(pid);
+        printf("daemon RSS %u KB before, %u KB with connections pending: %.1f KB per pending connection\n",
+               rssBefore, rssAfter, accepted ? ((double) rssAfter - rssBefore) / accepted : 0.0);
+    }
+
+    for (size_t n = 0; n < socks.size(); ++n) {
+        Shutdown(socks[n]);
+        Close(socks[n]);
+    }
+    return 0;
+}
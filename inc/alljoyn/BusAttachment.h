@@ -49,6 +49,51 @@ class BusAttachment : public MessageReceiver {
 
   public:
 
+    /**
+     * How received method calls and signals are assigned to the handler threads.
+     */
+    typedef enum {
+        DISPATCH_SERIALIZED,    /**< Handlers run one at a time unless a handler calls EnableConcurrentCallbacks() */
+        DISPATCH_SESSION_LANES  /**< Messages from the same sender and session run in order, other sessions run in parallel */
+    } DispatchMode;
+
+    /**
+     * Statistics for the threads that encrypt outgoing messages.
+     */
+    typedef struct {
+        uint32_t numWorkers;          /**< Number of crypto worker threads running */
+        uint32_t queueDepth;          /**< Number of messages waiting for a worker */
+        uint32_t maxQueueDepth;       /**< Largest number of messages that have waited for a worker */
+        uint32_t encryptFailures;     /**< Number of messages a worker could not encrypt */
+        uint64_t messagesEncrypted;   /**< Number of messages encrypted by the workers */
+        uint64_t bytesEncrypted;      /**< Number of message bytes encrypted by the workers */
+    } CryptoWorkerStats;
+
+    /**
+     * Number of messages received on the connections of this bus attachment and the number of
+     * reads from those connections it took to receive them. The values accumulate from when the
+     * bus attachment is created, take the difference of two snapshots to measure an interval.
+     */
+    typedef struct {
+        uint32_t numMsgs;             /**< Number of messages received */
+        uint32_t numReads;            /**< Number of reads (system calls) made to receive them */
+    } RxStats;
+
+    /** Number of buckets in the DispatchLatencyStats histogram */
+    static const size_t DISPATCH_LATENCY_BUCKETS = 24;
+
+    /**
+     * Time that method calls, signals and callbacks wait in a dispatch queue between being queued
+     * and being taken by a handler thread. The values accumulate from when the bus attachment is
+     * started, take the difference of two snapshots to measure an interval.
+     */
+    typedef struct {
+        uint32_t count;                                 /**< Number of entries taken by a handler thread */
+        uint32_t maxUs;                                 /**< Longest wait in microseconds */
+        uint64_t totalUs;                               /**< Sum of the waits in microseconds */
+        uint32_t histogram[DISPATCH_LATENCY_BUCKETS];   /**< Entry i counts waits of less than 2^i microseconds, the last entry counts the rest */
+    } DispatchLatencyStats;
+
     /**
      * Pure virtual base class implemented by classes that wish to call JoinSessionAsync().
      */
@@ -144,8 +189,9 @@ class BusAttachment : public MessageReceiver {
      * @param applicationName       Name of the application.
      * @param allowRemoteMessages   True if this attachment is allowed to receive messages from remote devices.
      * @param concurrency           The maximum number of concurrent method and signal handlers locally executing.
+     * @param dispatchMode          How method and signal handlers are assigned to the handler threads.
      */
-    BusAttachment(const char* applicationName, bool allowRemoteMessages = false, uint32_t concurrency = 4);
+    BusAttachment(const char* applicationName, bool allowRemoteMessages = false, uint32_t concurrency = 4, DispatchMode dispatchMode = DISPATCH_SERIALIZED);
 
     /** Destructor */
     virtual ~BusAttachment();
@@ -157,6 +203,54 @@ class BusAttachment : public MessageReceiver {
      */
     uint32_t GetConcurrency();
 
+    /**
+     * Get the number of messages waiting for a method or signal handler on each handler lane.
+     * In DISPATCH_SESSION_LANES mode there is one lane per handler thread followed by a lane with
+     * its own thread for method replies that no other lane can take, otherwise there is a single
+     * lane shared by all handler threads.
+     *
+     * @param depths    Array to receive the queue depth of each lane (may be NULL).
+     * @param numLanes  Number of entries in the depths array.
+     *
+     * @return  The number of lanes.
+     */
+    size_t GetDispatchQueueDepths(uint32_t* depths = NULL, size_t numLanes = 0);
+
+    /**
+     * Get the time method calls, signals and callbacks have waited to be taken by a handler thread.
+     *
+     * @param stats   Returns the statistics.
+     */
+    void GetDispatchLatencyStats(DispatchLatencyStats& stats);
+
+    /**
+     * Set the number of threads used to encrypt outgoing messages. By default messages are
+     * encrypted by the thread that writes them to the connection. With crypto workers, messages are
+     * encrypted as they are queued so the encryption for different peers runs in parallel.
+     * This must be called before the bus attachment is started.
+     *
+     * @param numWorkers   Number of crypto worker threads, 0 to encrypt on the write path.
+     *
+     * @return
+     *      - #ER_OK if successful.
+     *      - #ER_BUS_BUS_ALREADY_STARTED if the bus attachment has already been started.
+     */
+    QStatus SetCryptoWorkers(uint32_t numWorkers);
+
+    /**
+     * Get the statistics for the crypto worker threads.
+     *
+     * @param stats   Returns the statistics.
+     */
+    void GetCryptoWorkerStats(CryptoWorkerStats& stats);
+
+    /**
+     * Get the number of messages received and of reads made to receive them.
+     *
+     * @param stats   Returns the statistics.
+     */
+    void GetRxStats(RxStats& stats);
+
     /**
      * Get the connect spec used by the BusAttachment
      *
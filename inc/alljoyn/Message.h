@@ -157,6 +157,8 @@ class HeaderFields {
 class _Message;
 class _RemoteEndpoint;
 class BusAttachment;
+class MsgArgArena;
+class MarshalPlan;
 
 /**
  * @cond ALLJOYN_DEV
@@ -189,6 +191,7 @@ class _Message {
     friend class AllJoynObj;
     friend class DeferredMsg;
     friend class AllJoynPeerObj;
+    friend class MsgCursor;
 
   public:
     /**
@@ -702,6 +705,7 @@ class _Message {
      * @param args        The method call argument list (can be NULL)
      * @param numArgs     The number of arguments
      * @param flags       A logical OR of the AllJoyn flags
+     * @param plan        Precompiled marshal plan for the signature (can be NULL)
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
@@ -714,7 +718,8 @@ class _Message {
                     const qcc::String& methodName,
                     const MsgArg* args,
                     size_t numArgs,
-                    uint8_t flags);
+                    uint8_t flags,
+                    const MarshalPlan* plan = NULL);
 
     /**
      * @internal
@@ -731,6 +736,7 @@ class _Message {
      * @param flags       A logical OR of the AllJoyn flags.
      * @param timeToLive  Time-to-live. Units are seconds for sessionless signals. Milliseconds for non-sessionless signals.
      *                    Signals that cannot be sent within this time limit are discarded. Zero indicates reliable delivery.
+     * @param plan        Precompiled marshal plan for the signature (can be NULL)
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
@@ -744,7 +750,8 @@ class _Message {
                       const MsgArg* args,
                       size_t numArgs,
                       uint8_t flags,
-                      uint16_t timeToLive);
+                      uint16_t timeToLive,
+                      const MarshalPlan* plan = NULL);
 
 
     /**
@@ -816,16 +823,52 @@ class _Message {
      */
     QStatus Deliver(RemoteEndpoint& endpoint);
 
+    /**
+     * @internal
+     * Write state for a message that is being delivered to a remote endpoint. The marshaled
+     * message buffer is shared read-only by every endpoint the message is queued on so the
+     * write position is owned by the endpoint rather than by the message.
+     */
+    struct WriteContext {
+        AllJoynMessageState writeState; ///< The current state of the message during write.
+        const uint8_t* writePtr;        ///< Pointer to the current write position in the buffer.
+        size_t countWrite;              ///< Number of bytes remaining to write for completion of the message.
+
+        WriteContext() : writeState(MESSAGE_NEW), writePtr(NULL), countWrite(0) { }
+
+        /**
+         * Reset the context to start writing a new message.
+         */
+        void Reset() { writeState = MESSAGE_NEW; writePtr = NULL; countWrite = 0; }
+    };
+
+    /**
+     * @internal
+     * Start delivery of a marshaled message to a remote endpoint. This checks that the message
+     * can be sent, encrypts it if required and sets the write context to the start of the
+     * marshaled buffer. No data is written to the endpoint.
+     *
+     * @param endpoint   Endpoint to receive marshaled message.
+     * @param context    The endpoint's write state for this message.
+     * @return
+     *      - #ER_OK if successful. The context state is MESSAGE_COMPLETE if the message is not
+     *        to be written, e.g. because its time-to-live has expired.
+     *      - An error status otherwise. If the context state is MESSAGE_COMPLETE only this
+     *        message has failed and the endpoint can continue with the next message.
+     */
+    QStatus BeginDelivery(RemoteEndpoint& endpoint, WriteContext& context);
+
     /**
      * @internal
      * Deliver a marshaled message to a remote endpoint. Non-blocking
      *
      * @param endpoint   Endpoint to receive marshaled message.
+     * @param context    The endpoint's write state for this message.
      * @return
      *      - #ER_OK if successful
      *      - An error status otherwise
      */
-    QStatus DeliverNonBlocking(RemoteEndpoint& endpoint);
+    QStatus DeliverNonBlocking(RemoteEndpoint& endpoint, WriteContext& context);
     /**
      * @internal
      * Marshal the message again with the new sender name if one was provided.
@@ -929,6 +972,7 @@ class _Message {
     uint64_t* msgBuf;            ///< Pointer to the current msg buffer (8 byte aligned pointer into _msgBuf).
     MsgArg* msgArgs;             ///< Pointer to the unmarshaled arguments.
     uint8_t numMsgArgs;          ///< Number of message args (signature cannot be longer than 255 chars).
+    MsgArgArena* argArena;       ///< Storage for the MsgArgs and swapped scalar arrays nested in msgArgs.
 
     size_t bufSize;              ///< The current allocated size of the msg buffer.
     uint8_t* bufEOD;             ///< End of data currently in buffer.
@@ -947,16 +991,14 @@ class _Message {
     qcc::SocketFd* handles;      ///< Array of file/socket descriptors.
     size_t numHandles;           ///< Number of handles in the handles array
     bool encrypt;                ///< True if the message is to be encrypted
+    bool encryptPending;         ///< True while the message is waiting to be encrypted by a crypto worker
+    QStatus encryptStatus;       ///< Result of encryption done by a crypto worker ahead of delivery
 
     AllJoynMessageState readState;  ///< The current state of the message during read.
     size_t pktSize;                 ///< Packet size for this message.
     size_t countRead;               ///< Number of bytes remaining to read for completion of the message.
     size_t maxFds;                  ///< Store the number of max FDs for the endpoint, so it doesnt need to be calculated each time.
 
-    AllJoynMessageState writeState; ///< The current state of the message during write.
-    uint8_t* writePtr;              ///< Pointer to the current write position in the buffer.
-    size_t countWrite;              ///< Number of bytes remaining to write for completion of the message.
-
     /**
      * The header fields for this message. Which header fields are present depends on the message
      * type defined in the message header.
@@ -995,9 +1037,13 @@ class _Message {
                            const MsgArg* args,
                            uint8_t numArgs,
                            uint8_t flags,
-                           SessionId sessionId);
+                           SessionId sessionId,
+                           const MarshalPlan* plan = NULL);
 
     QStatus MarshalArgs(const MsgArg* arg, size_t numArgs);
+    QStatus MarshalArgs(const MarshalPlan& plan, const MsgArg* args, size_t numArgs);
+    QStatus MarshalPlanArg(const MarshalPlan& plan, size_t op, const MsgArg* arg);
+    void MarshalFixed(const MarshalPlan& plan, size_t op, const MsgArg* arg, uint8_t* pos);
     void MarshalHeaderFields();
     size_t ComputeHeaderLen();
 
@@ -1007,6 +1053,21 @@ class _Message {
      */
     qcc::String ToString(const MsgArg* args, size_t numArgs) const;
 
+    /**
+     * Get a buffer for a message. Buffers for small messages come from a free list.
+     *
+     * @param size  The number of bytes needed.
+     * @return  The buffer, release it with FreeMsgBuf().
+     */
+    static uint8_t* AllocMsgBuf(size_t size);
+
+    /**
+     * Release a buffer from AllocMsgBuf().
+     *
+     * @param buf  The buffer (can be NULL).
+     */
+    static void FreeMsgBuf(uint8_t* buf);
+
     /* Internal methods for read */
     inline QStatus InterpretHeader();
     QStatus PullBytes(RemoteEndpoint& endpoint, bool checkSender, bool pedantic = true, uint32_t timeout = 0);
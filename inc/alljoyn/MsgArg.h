@@ -232,6 +232,7 @@ typedef struct {
 class MsgArg {
     friend class _Message;
     friend class MsgArgUtils;
+    friend class MsgCursor;
 
   public:
 
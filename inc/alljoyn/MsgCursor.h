@@ -0,0 +1,198 @@
+#ifndef _ALLJOYN_MSGCURSOR_H
+#define _ALLJOYN_MSGCURSOR_H
+/**
+ * @file
+ * This file defines a class for reading message arguments directly from the message body
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include MsgCursor.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * A MsgCursor reads the arguments of a message one at a time directly from the marshaled message
+ * body. Unlike Message::GetArgs() it does not build MsgArgs for the entire body, arguments that
+ * are not needed can be skipped without being decoded and containers can be entered so that only
+ * the values of interest are decoded.
+ *
+ * Strings, object paths, signatures and scalar arrays read through a cursor point into the message
+ * body and are only valid while the message exists. A cursor must not be shared between threads.
+ *
+ * Encrypted messages are decrypted when the cursor is created which requires the arguments to be
+ * unmarshaled in full.
+ */
+class MsgCursor {
+  public:
+
+    /**
+     * Create a cursor positioned at the first argument of a message.
+     *
+     * @param msg  The message to read.
+     */
+    MsgCursor(Message& msg);
+
+    /**
+     * Destructor
+     */
+    ~MsgCursor();
+
+    /**
+     * Get the type of the value at the cursor position.
+     *
+     * @return  The type of the next value or ALLJOYN_INVALID if there are no more values in the
+     *          body or in the container the cursor has entered.
+     */
+    AllJoynTypeId GetTypeId() const;
+
+    /**
+     * Check if there are no more values in the body or in the container the cursor has entered.
+     */
+    bool AtEnd() const { return GetTypeId() == ALLJOYN_INVALID; }
+
+    /**
+     * Get the container nesting depth of the cursor, 0 when the cursor is reading the body.
+     */
+    size_t GetDepth() const { return depth; }
+
+    /**
+     * Decode the value at the cursor position and advance past it. Nested containers are
+     * decoded in full and are owned by the MsgArg.
+     *
+     * @param arg  Returns the value.
+     *
+     * @return
+     *      - #ER_OK if the value was decoded.
+     *      - #ER_BUS_END_OF_ARGS if there are no more values.
+     *      - An error status otherwise.
+     */
+    QStatus Next(MsgArg& arg);
+
+    /**
+     * Advance past the value at the cursor position without decoding it. Arrays are skipped
+     * without looking at their elements.
+     *
+     * @return
+     *      - #ER_OK if the value was skipped.
+     *      - #ER_BUS_END_OF_ARGS if there are no more values.
+     *      - An error status otherwise.
+     */
+    QStatus Skip();
+
+    /**
+     * Decode the value at the cursor position into variables in the same way as MsgArg::Get() and
+     * advance past it. The signature must be a single complete type. Pointers returned by this
+     * function are valid until the next call on the cursor.
+     *
+     * @param signature  The signature of the value to decode.
+     * @param ...        Pointers to the variables to receive the value.
+     *
+     * @return
+     *      - #ER_OK if the value was decoded.
+     *      - #ER_BUS_SIGNATURE_MISMATCH if the value does not match the signature.
+     *      - #ER_BUS_END_OF_ARGS if there are no more values.
+     *      - An error status otherwise.
+     */
+    QStatus Get(const char* signature, ...);
+
+    /**
+     * Position the cursor at the first value inside the array, struct, dictionary entry or
+     * variant at the cursor position.
+     *
+     * @return
+     *      - #ER_OK if the cursor entered the container.
+     *      - #ER_BUS_BAD_VALUE if the value at the cursor position is not a container.
+     *      - #ER_BUS_END_OF_ARGS if there are no more values.
+     *      - An error status otherwise.
+     */
+    QStatus Enter();
+
+    /**
+     * Skip the rest of the container the cursor has entered and position the cursor at the value
+     * following the container.
+     *
+     * @return
+     *      - #ER_OK if the cursor left the container.
+     *      - #ER_FAIL if the cursor is not in a container.
+     *      - An error status otherwise.
+     */
+    QStatus Leave();
+
+    /**
+     * Look up a key in the dictionary at the cursor position and advance past the dictionary.
+     * Only the keys and the value that is found are decoded.
+     *
+     * @param key    The key to look up.
+     * @param value  Returns the value if the key is found.
+     *
+     * If an error other than #ER_BUS_ELEMENT_NOT_FOUND is returned the cursor is left at the
+     * dictionary.
+     *
+     * @return
+     *      - #ER_OK if the key was found.
+     *      - #ER_BUS_ELEMENT_NOT_FOUND if the key was not found.
+     *      - #ER_BUS_NOT_A_DICTIONARY if the value at the cursor position is not a dictionary
+     *        with string keys.
+     *      - An error status otherwise.
+     */
+    QStatus Lookup(const char* key, MsgArg& value);
+
+  private:
+
+    /** Maximum container nesting (32 arrays and 32 structs) */
+    static const size_t MAX_DEPTH = 64;
+
+    /**
+     * The body or a container the cursor has entered.
+     */
+    struct Level {
+        AllJoynTypeId typeId;   /**< Container type or ALLJOYN_INVALID for the body */
+        const char* sig;        /**< Signature of the next value (element signature for arrays) */
+        const char* nextSig;    /**< Signature following the container in the enclosing level */
+        uint8_t* end;           /**< End of the array or body */
+    };
+
+    QStatus SkipValue(const char*& sigPtr);
+    QStatus ReadLength(uint32_t& len);
+    void Advance(const char* sigPtr);
+
+    Message msg;                /**< The message being read */
+    Message parser;             /**< Decodes values from the body of msg, keeps the parse state out of msg */
+    uint8_t* pos;               /**< Position in the message body */
+    uint8_t* eod;               /**< End of the message data */
+    bool endianSwap;            /**< True if the body is not in native byte order */
+    QStatus status;             /**< Error if the cursor could not be positioned on the body */
+    size_t depth;               /**< Current container nesting */
+    Level levels[MAX_DEPTH + 1];
+    MsgArg value;               /**< Last value decoded by Get() */
+
+    /* Copy constructor and assignment operator are not allowed */
+    MsgCursor(const MsgCursor& other);
+    MsgCursor& operator=(const MsgCursor& other);
+};
+
+}
+
+#endif
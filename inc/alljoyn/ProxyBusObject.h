@@ -428,6 +428,54 @@ class ProxyBusObject : public MessageReceiver {
         MsgArg arg("s", s.c_str()); return SetProperty(iface, property, arg, timeout);
     }
 
+    /**
+     * Cache the properties of an interface on the remote object. The cache is populated with one
+     * GetAll call and kept up to date from the PropertiesChanged signals of the remote object, after
+     * which GetProperty() and GetAllProperties() are answered without a round trip where possible.
+     *
+     * How each property is cached depends on its org.freedesktop.DBus.Property.EmitsChangedSignal
+     * annotation:
+     *      - "true": the value is cached and replaced by the value carried in PropertiesChanged.
+     *      - "invalidates": the value is cached until PropertiesChanged names the property, the
+     *        next read then fetches it from the remote object.
+     *      - "const": the value is cached until caching is disabled.
+     *      - "false" or no annotation: the value is never cached and is always read remotely.
+     *
+     * Only PropertiesChanged signals sent by the current owner of the service name are applied,
+     * and the cached values are dropped when the name changes owner. The asynchronous property
+     * methods are not served from the cache. Copies of this proxy bus object do not inherit the
+     * cache.
+     *
+     * @param iface     Name of the interface whose properties are cached.
+     * @param timeout   Timeout specified in milliseconds to wait for the GetAll reply
+     *
+     * @return
+     *      - #ER_OK if caching is enabled or was already enabled for the interface.
+     *      - #ER_BUS_OBJECT_NO_SUCH_INTERFACE if the no such interface on this remote object.
+     *      - An error status otherwise
+     */
+    QStatus EnablePropertyCaching(const char* iface, uint32_t timeout = DefaultCallTimeout);
+
+    /**
+     * Stop caching the properties of an interface and discard the cached values.
+     *
+     * @param iface     Name of the interface passed to EnablePropertyCaching().
+     *
+     * @return
+     *      - #ER_OK if caching was disabled.
+     *      - #ER_BUS_OBJECT_NO_SUCH_INTERFACE if caching was not enabled for the interface.
+     */
+    QStatus DisablePropertyCaching(const char* iface);
+
+    /**
+     * Get the number of GetProperty() and GetAllProperties() calls on cached interfaces that were
+     * answered from the cache and the number that needed a round trip to the remote object.
+     *
+     * @param[out] hits    Number of reads answered from the cache.
+     * @param[out] misses  Number of reads sent to the remote object.
+     */
+    void GetPropertyCacheStats(uint32_t& hits, uint32_t& misses) const;
+
     /**
      * Returns the interfaces implemented by this object. Note that all proxy bus objects
      * automatically inherit the "org.freedesktop.DBus.Peer" which provides the built-in "ping"
@@ -964,6 +1012,75 @@ class ProxyBusObject : public MessageReceiver {
      */
     void SetPropMethodCB(Message& message, void* context);
 
+    /**
+     * @internal
+     * PropertiesChanged signal handler that updates the property cache. (Internal use only)
+     */
+    void PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg);
+
+    /**
+     * @internal
+     * NameOwnerChanged signal handler that tracks the owner of the cached object. (Internal use only)
+     */
+    void CacheNameOwnerChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg);
+
+    /**
+     * @internal
+     * Register the signal handlers and match rule that keep the property cache up to date.
+     */
+    QStatus RegisterPropertyCacheHandlers();
+
+    /**
+     * @internal
+     * Undo RegisterPropertyCacheHandlers().
+     */
+    void UnregisterPropertyCacheHandlers();
+
+    /**
+     * @internal
+     * Look up a property in the property cache and count the hit or miss.
+     *
+     * @param iface       Interface of the property.
+     * @param property    The name of the property.
+     * @param[out] value  The cached value if there is one.
+     * @param[out] epoch  Cache epoch to pass to CacheProperty() after a miss, 0 if the property is not cached.
+     *
+     * @return  true if the value was found in the cache.
+     */
+    bool GetCachedProperty(const InterfaceDescription* iface, const char* property, MsgArg& value, uint32_t& epoch) const;
+
+    /**
+     * @internal
+     * Look up all properties of an interface in the property cache and count the hit or miss.
+     *
+     * @param iface        The interface.
+     * @param[out] values  The cached values as "a{sv}" if all readable properties are cached.
+     * @param[out] epoch   Cache epoch to pass to CacheProperties() after a miss, 0 if the interface is not cached.
+     *
+     * @return  true if the values were found in the cache.
+     */
+    bool GetCachedProperties(const InterfaceDescription* iface, MsgArg& values, uint32_t& epoch) const;
+
+    /**
+     * @internal
+     * Add a property value read from the remote object to the property cache unless the cache
+     * changed since the read was started.
+     */
+    void CacheProperty(const InterfaceDescription* iface, const char* property, const MsgArg& value, uint32_t epoch) const;
+
+    /**
+     * @internal
+     * Add the "a{sv}" property values read from the remote object to the property cache unless
+     * the cache changed since the read was started.
+     */
+    void CacheProperties(const InterfaceDescription* iface, const MsgArg& values, uint32_t epoch) const;
+
+    /**
+     * @internal
+     * Drop a property from the property cache.
+     */
+    void InvalidateProperty(const char* iface, const char* property) const;
+
     /**
      * @internal
      * Set the B2B endpoint to use for all communication with remote object.
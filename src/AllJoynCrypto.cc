@@ -41,54 +41,122 @@ namespace ajn {
 
 const size_t Crypto::MACLength = 8;
 
-static qcc::String ConcatenateCompressedFields(uint8_t* hdr, size_t hdrLen, const HeaderFields& hdrFields)
+/*
+ * Build the authenticated data for a message with compressed headers. The compressible header
+ * fields are not sent but are authenticated to prevent an attacker sending a bogus expansion
+ * rule. The buffer is reused so once it has grown to fit the largest header no allocation is
+ * needed.
+ */
+static void ConcatenateCompressedFields(uint8_t* hdr, size_t hdrLen, const HeaderFields& hdrFields, std::vector<uint8_t>& aad)
 {
-    qcc::String result((char*)hdr, hdrLen, 256);
+    aad.assign(hdr, hdr + hdrLen);
 
     for (uint32_t fieldId = ALLJOYN_HDR_FIELD_PATH; fieldId < ArraySize(hdrFields.field); fieldId++) {
         if (!HeaderFields::Compressible[fieldId]) {
             continue;
         }
         const MsgArg* field = &hdrFields.field[fieldId];
-        char buf[8];
+        uint8_t buf[8];
         size_t pos = 0;
-        buf[pos++] = (char)fieldId;
-        buf[pos++] = (char)field->typeId;
+        buf[pos++] = (uint8_t)fieldId;
+        buf[pos++] = (uint8_t)field->typeId;
         switch (field->typeId) {
         case ALLJOYN_SIGNATURE:
-            result.append(buf, pos);
-            result.append(field->v_signature.sig, field->v_signature.len);
+            aad.insert(aad.end(), buf, buf + pos);
+            aad.insert(aad.end(), (const uint8_t*)field->v_signature.sig, (const uint8_t*)field->v_signature.sig + field->v_signature.len);
             break;
 
         case ALLJOYN_OBJECT_PATH:
         case ALLJOYN_STRING:
-            result.append(buf, pos);
-            result.append(field->v_string.str, field->v_string.len);
+            aad.insert(aad.end(), buf, buf + pos);
+            aad.insert(aad.end(), (const uint8_t*)field->v_string.str, (const uint8_t*)field->v_string.str + field->v_string.len);
             break;
 
         case ALLJOYN_UINT32:
             /* Write integer as little endian */
-            buf[pos++] = (char)(field->v_uint32 >> 0);
-            buf[pos++] = (char)(field->v_uint32 >> 8);
-            buf[pos++] = (char)(field->v_uint32 >> 16);
-            buf[pos++] = (char)(field->v_uint32 >> 24);
-            result.append(buf, pos);
+            buf[pos++] = (uint8_t)(field->v_uint32 >> 0);
+            buf[pos++] = (uint8_t)(field->v_uint32 >> 8);
+            buf[pos++] = (uint8_t)(field->v_uint32 >> 16);
+            buf[pos++] = (uint8_t)(field->v_uint32 >> 24);
+            aad.insert(aad.end(), buf, buf + pos);
             break;
 
         default:
             break;
         }
     }
-    return result;
 }
 
-QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+void CryptoContext::Reset()
+{
+    lock.Lock(MUTEX_CONTEXT);
+    delete aes;
+    aes = NULL;
+    key.Erase();
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+Crypto_AES& CryptoContext::GetCipher(const KeyBlob& keyBlob)
+{
+    /*
+     * The key is compared as well as being reset on a rekey so a stale cipher can never be used.
+     */
+    if (!aes || (key.GetType() != keyBlob.GetType()) || (key.GetSize() != keyBlob.GetSize()) ||
+        (memcmp(key.GetData(), keyBlob.GetData(), keyBlob.GetSize()) != 0)) {
+        delete aes;
+        key = keyBlob;
+        aes = new Crypto_AES(keyBlob, Crypto_AES::CCM);
+    }
+    return *aes;
+}
+
+/*
+ * Encrypt or decrypt the body of a message with AES-CCM
+ */
+static QStatus MessageCCM(bool encrypt, Crypto_AES& aes, const _Message& message, const KeyBlob& nonce, uint8_t* msgBuf, size_t hdrLen,
+                          size_t& bodyLen, std::vector<uint8_t>& aad)
+{
+    uint8_t* body = msgBuf + hdrLen;
+    const uint8_t* addData = msgBuf;
+    size_t addLen = hdrLen;
+
+    if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
+        ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields(), aad);
+        addData = &aad[0];
+        addLen = aad.size();
+    }
+    if (encrypt) {
+        return aes.Encrypt_CCM(body, body, bodyLen, nonce, addData, addLen, Crypto::MACLength);
+    } else {
+        return aes.Decrypt_CCM(body, body, bodyLen, nonce, addData, addLen, Crypto::MACLength);
+    }
+}
+
+/*
+ * Encrypt or decrypt using the cached cipher from the context if there is one
+ */
+QStatus Crypto::MessageCCM(bool encrypt, const _Message& message, const KeyBlob& keyBlob, const KeyBlob& nonce, uint8_t* msgBuf, size_t hdrLen,
+                           size_t& bodyLen, CryptoContext* context)
+{
+    QStatus status;
+    if (context) {
+        context->lock.Lock(MUTEX_CONTEXT);
+        status = MessageCCM(encrypt, context->GetCipher(keyBlob), message, nonce, msgBuf, hdrLen, bodyLen, context->aad);
+        context->lock.Unlock(MUTEX_CONTEXT);
+    } else {
+        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
+        std::vector<uint8_t> aad;
+        status = MessageCCM(encrypt, aes, message, nonce, msgBuf, hdrLen, bodyLen, aad);
+    }
+    return status;
+}
+
+QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen, CryptoContext* context)
 {
     QStatus status;
     switch (keyBlob.GetType()) {
     case KeyBlob::AES:
     {
-        uint8_t* body = msgBuf + hdrLen;
         uint8_t nd[5];
         uint32_t serial = message.GetCallSerial();
 
@@ -102,17 +170,7 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
         QCC_DbgHLPrintf(("Encrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
         QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
-        if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
-            /*
-             * To prevent an attack where the attacker sends a bogus expansion rule we
-             * authenticate the compressed headers even though we won't be sending them.
-             */
-            qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
-        } else {
-            status = aes.Encrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
-        }
+        status = MessageCCM(true, message, keyBlob, nonce, msgBuf, hdrLen, bodyLen, context);
     }
     break;
 
@@ -124,13 +182,12 @@ QStatus Crypto::Encrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
     return status;
 }
 
-QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen)
+QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen, CryptoContext* context)
 {
     QStatus status;
     switch (keyBlob.GetType()) {
     case KeyBlob::AES:
     {
-        uint8_t* body = msgBuf + hdrLen;
         uint8_t nd[5];
         uint32_t serial = message.GetCallSerial();
 
@@ -144,17 +201,7 @@ QStatus Crypto::Decrypt(const _Message& message, const KeyBlob& keyBlob, uint8_t
         QCC_DbgHLPrintf(("Decrypt key:   %s", BytesToHexString(keyBlob.GetData(), keyBlob.GetSize()).c_str()));
         QCC_DbgHLPrintf(("        nonce: %s", BytesToHexString(nonce.GetData(), nonce.GetSize()).c_str()));
 
-        Crypto_AES aes(keyBlob, Crypto_AES::CCM);
-        if (message.GetFlags() & ALLJOYN_FLAG_COMPRESSED) {
-            /*
-             * To prevent an attack where the attacker sends a bogus expansion rule we
-             * authenticate the compressed headers even though we won't be sending them.
-             */
-            qcc::String extHdr = ConcatenateCompressedFields(msgBuf, hdrLen, message.GetHeaderFields());
-            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, extHdr.data(), extHdr.size(), MACLength);
-        } else {
-            status = aes.Decrypt_CCM(body, body, bodyLen, nonce, msgBuf, hdrLen, MACLength);
-        }
+        status = MessageCCM(false, message, keyBlob, nonce, msgBuf, hdrLen, bodyLen, context);
     }
     break;
 
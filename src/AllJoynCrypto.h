@@ -26,7 +26,12 @@
 #endif
 
 #include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/Crypto.h>
 #include <qcc/KeyBlob.h>
+#include <qcc/Mutex.h>
 
 #include <alljoyn/Message.h>
 
@@ -35,6 +40,50 @@
 
 namespace ajn {
 
+/**
+ * Caches the expanded AES key for a message key so the key schedule is computed once per key
+ * rather than once per message. Each peer key has a context for encryption and another for
+ * decryption so that sending and receiving do not contend for the same context.
+ */
+class CryptoContext {
+    friend class Crypto;
+
+  public:
+
+    /**
+     * Constructor
+     */
+    CryptoContext() : aes(NULL) { }
+
+    /**
+     * Destructor
+     */
+    ~CryptoContext() { delete aes; }
+
+    /**
+     * Discard the cached cipher. This is called when the key the cipher was expanded from is
+     * changed or cleared.
+     */
+    void Reset();
+
+  private:
+
+    /**
+     * Get the cipher for a key, expanding the key if it is not the key the cached cipher was
+     * expanded from. Must be called with the lock held.
+     */
+    qcc::Crypto_AES& GetCipher(const qcc::KeyBlob& keyBlob);
+
+    /* Copy constructor and assignment operator are not allowed */
+    CryptoContext(const CryptoContext& other);
+    CryptoContext& operator=(const CryptoContext& other);
+
+    qcc::Mutex lock;             ///< Serializes use of the cipher
+    qcc::KeyBlob key;            ///< The key the cipher was expanded from
+    qcc::Crypto_AES* aes;        ///< The cached cipher
+    std::vector<uint8_t> aad;    ///< Reused buffer for the authenticated data of compressed headers
+};
+
 /**
  * Class for encapsulating AllJoyn message encryption and decryption operations.
  */
@@ -53,12 +102,14 @@ class Crypto {
      * @param hdrLen          The length of the header part of the message that will not be encrypted.
      * @param bodyLen[in/out] On input the size of the plaintext body, on output the size of the
      *                        encrypted body.
+     * @param context         Cached cipher for the key blob or NULL to expand the key for this message.
      *
      * @return - ER_OK if the data was succesfully encrypted.
      *         - ER_BUS_KEYBLOB_OP_INVALID if the key blob cannot be used for encryption.
      *         - Other errors if the arguments are invalid.
      */
-    static QStatus Encrypt(const _Message& message, const qcc::KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen);
+    static QStatus Encrypt(const _Message& message, const qcc::KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen,
+                           CryptoContext* context = NULL);
 
     /**
      * Decrypt and authenticate marshaled message inplace using the key blob provided and the
@@ -70,12 +121,14 @@ class Crypto {
      * @param hdrLen          The length of the non-encrypted header part of the message.
      * @param bodyLen[in/out] On input the size of the crypttext body, on output the size of the
      *                        decrypted body.
+     * @param context         Cached cipher for the key blob or NULL to expand the key for this message.
      *
      * @return - ER_OK if the data was succesfully decrypted.
      *         - ER_BUS_KEYBLOB_OP_INVALID if the key blob cannot be used for decryption.
      *         - Other errors if the arguments are invalid.
      */
-    static QStatus Decrypt(const _Message& message, const qcc::KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen);
+    static QStatus Decrypt(const _Message& message, const qcc::KeyBlob& keyBlob, uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen,
+                           CryptoContext* context = NULL);
 
     /**
      * Compute a SHA1 hash over the header fields and return the result in a key blob.
@@ -92,6 +145,11 @@ class Crypto {
      */
     static const size_t MACLength;
 
+  private:
+
+    static QStatus MessageCCM(bool encrypt, const _Message& message, const qcc::KeyBlob& keyBlob, const qcc::KeyBlob& nonce,
+                              uint8_t* msgBuf, size_t hdrLen, size_t& bodyLen, CryptoContext* context);
+
 };
 
 
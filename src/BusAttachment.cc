@@ -104,19 +104,22 @@ BusAttachment::Internal::Internal(const char* appName,
                                   Router* router,
                                   bool allowRemoteMessages,
                                   const char* listenAddresses,
-                                  uint32_t concurrency) :
+                                  uint32_t concurrency,
+                                  DispatchMode dispatchMode) :
     application(appName ? appName : "unknown"),
     bus(bus),
     listenersLock(),
     listeners(),
     m_ioDispatch("iodisp", 128),
-    transportList(bus, factories, &m_ioDispatch, concurrency),
+    transportList(bus, factories, &m_ioDispatch, concurrency, dispatchMode),
     keyStore(application),
     authManager(keyStore),
     globalGuid(qcc::GUID128()),
     msgSerial(1),
     router(router ? router : new ClientRouter),
     localEndpoint(transportList.GetLocalTransport()->GetLocalEndpoint()),
+    rxMsgCount(0),
+    rxReadCount(0),
     allowRemoteMessages(allowRemoteMessages),
     listenAddresses(listenAddresses ? listenAddresses : ""),
     stopLock(),
@@ -185,11 +188,11 @@ static class ClientTransportFactoryContainer : public TransportFactoryContainer
 } clientTransportsContainer;
 
 
-BusAttachment::BusAttachment(const char* applicationName, bool allowRemoteMessages, uint32_t concurrency) :
+BusAttachment::BusAttachment(const char* applicationName, bool allowRemoteMessages, uint32_t concurrency, DispatchMode dispatchMode) :
     isStarted(false),
     isStopping(false),
     concurrency(concurrency),
-    busInternal(new Internal(applicationName, *this, clientTransportsContainer, NULL, allowRemoteMessages, NULL, concurrency)),
+    busInternal(new Internal(applicationName, *this, clientTransportsContainer, NULL, allowRemoteMessages, NULL, concurrency, dispatchMode)),
     joinObj(this)
 {
     clientTransportsContainer.Init();
@@ -300,6 +303,36 @@ uint32_t BusAttachment::GetConcurrency()
     return concurrency;
 }
 
+size_t BusAttachment::GetDispatchQueueDepths(uint32_t* depths, size_t numLanes)
+{
+    return busInternal->localEndpoint->GetDispatchQueueDepths(depths, numLanes);
+}
+
+void BusAttachment::GetDispatchLatencyStats(DispatchLatencyStats& stats)
+{
+    busInternal->localEndpoint->GetDispatchLatencyStats(stats);
+}
+
+QStatus BusAttachment::SetCryptoWorkers(uint32_t numWorkers)
+{
+    if (isStarted) {
+        return ER_BUS_BUS_ALREADY_STARTED;
+    }
+    busInternal->cryptoWorkerPool.SetNumWorkers(numWorkers);
+    return ER_OK;
+}
+
+void BusAttachment::GetCryptoWorkerStats(CryptoWorkerStats& stats)
+{
+    busInternal->cryptoWorkerPool.GetStats(stats);
+}
+
+void BusAttachment::GetRxStats(RxStats& stats)
+{
+    stats.numMsgs = static_cast<uint32_t>(busInternal->rxMsgCount);
+    stats.numReads = static_cast<uint32_t>(busInternal->rxReadCount);
+}
+
 qcc::String BusAttachment::GetConnectSpec()
 {
     return connectSpec;
@@ -337,8 +370,13 @@ QStatus BusAttachment::Start()
 
     isStarted = true;
 
+    /* Start the crypto workers before any endpoints can queue messages */
+    status = busInternal->cryptoWorkerPool.Start();
+
     /* Start the transports */
-    status = busInternal->transportList.Start(busInternal->GetListenAddresses());
+    if (status == ER_OK) {
+        status = busInternal->transportList.Start(busInternal->GetListenAddresses());
+    }
 
     if ((status == ER_OK) && isStopping) {
         status = ER_BUS_STOPPING;
@@ -347,6 +385,7 @@ QStatus BusAttachment::Start()
 
     if (status != ER_OK) {
         QCC_LogError(status, ("BusAttachment::Start failed to start"));
+        busInternal->cryptoWorkerPool.Stop();
         busInternal->transportList.Stop();
         WaitStopInternal();
     }
@@ -613,6 +652,9 @@ QStatus BusAttachment::StopInternal(bool blockUntilStopped)
             QCC_LogError(status, ("TransportList::Stop() failed"));
         }
 
+        /* Stop the crypto workers, messages they have not encrypted are encrypted by the writers */
+        busInternal->cryptoWorkerPool.Stop();
+
         /* Stop the threads currently waiting for join to complete */
         busInternal->joinLock.Lock();
         map<Thread*, Internal::JoinContext>::iterator jit = busInternal->joinThreads.begin();
@@ -661,6 +703,7 @@ void BusAttachment::WaitStopInternal()
          */
         if (isStarted) {
             busInternal->transportList.Join();
+            busInternal->cryptoWorkerPool.Join();
 
             /* Clear peer state */
             busInternal->peerStateTable.Clear();
@@ -38,6 +38,7 @@
 
 #include "AuthManager.h"
 #include "ClientRouter.h"
+#include "CryptoWorkerPool.h"
 #include "KeyStore.h"
 #include "PeerState.h"
 #include "Transport.h"
@@ -130,6 +131,24 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
      * @return  The iodispatch
      */
     qcc::IODispatch& GetIODispatch(void) { return m_ioDispatch; }
+
+    /**
+     * Get the pool of threads that encrypt messages queued on remote endpoints.
+     *
+     * @return  The crypto worker pool
+     */
+    CryptoWorkerPool& GetCryptoWorkerPool(void) { return cryptoWorkerPool; }
+
+    /**
+     * Count a message received by a remote endpoint of this bus.
+     */
+    void CountRxMessage(void) { qcc::IncrementAndFetch(&rxMsgCount); }
+
+    /**
+     * Count a read from the connection of a remote endpoint of this bus.
+     */
+    void CountRxRead(void) { qcc::IncrementAndFetch(&rxReadCount); }
+
     /**
      * Get the header compression rules
      *
@@ -151,7 +170,8 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
              Router* router,
              bool allowRemoteMessages,
              const char* listenAddresses,
-             uint32_t concurrency);
+             uint32_t concurrency,
+             DispatchMode dispatchMode = DISPATCH_SERIALIZED);
 
     /*
      * Destructor also called by BusAttachment
@@ -286,6 +306,9 @@ class BusAttachment::Internal : public MessageReceiver, public JoinSessionAsyncC
     PeerStateTable peerStateTable;        /* Table that maintains state information about remote peers */
     LocalEndpoint localEndpoint;          /* The local endpoint */
     CompressionRules compressionRules;    /* Rules for compresssing and decompressing headers */
+    CryptoWorkerPool cryptoWorkerPool;    /* Threads that encrypt messages queued on remote endpoints */
+    int32_t rxMsgCount;                   /* Number of messages received by remote endpoints */
+    int32_t rxReadCount;                  /* Number of reads remote endpoints made to receive them */
     std::map<qcc::StringMapKey, InterfaceDescription> ifaceDescriptions;
 
     bool allowRemoteMessages;             /* true iff endpoints of this attachment can receive messages from remote devices */
@@ -41,6 +41,7 @@
 #include "AllJoynPeerObj.h"
 #include "MethodTable.h"
 #include "BusInternal.h"
+#include "MarshalPlan.h"
 
 
 #define QCC_MODULE "ALLJOYN"
@@ -513,7 +514,8 @@ QStatus BusObject::Signal(const char* destination,
                             args,
                             numArgs,
                             flags,
-                            timeToLive);
+                            timeToLive,
+                            MarshalPlan::Get(signalMember.signature));
     if (status == ER_OK) {
         BusEndpoint bep = BusEndpoint::cast(bus->GetInternal().GetLocalEndpoint());
         status = bus->GetInternal().GetRouter().PushMessage(msg, bep);
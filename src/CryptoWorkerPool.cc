@@ -0,0 +1,174 @@
+/**
+ * @file
+ *
+ * This file implements a pool of threads that encrypt messages queued on remote endpoints.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <algorithm>
+#include <string.h>
+
+#include <qcc/Debug.h>
+
+#include "CryptoWorkerPool.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+CryptoWorkerPool::CryptoWorkerPool() : numWorkers(0), running(false)
+{
+    ::memset(&stats, 0, sizeof(stats));
+}
+
+CryptoWorkerPool::~CryptoWorkerPool()
+{
+    Stop();
+    Join();
+}
+
+QStatus CryptoWorkerPool::Start()
+{
+    QStatus status = ER_OK;
+
+    if (numWorkers == 0) {
+        return ER_OK;
+    }
+    lock.Lock(MUTEX_CONTEXT);
+    running = true;
+    stats.numWorkers = numWorkers;
+    lock.Unlock(MUTEX_CONTEXT);
+    for (uint32_t i = 0; (status == ER_OK) && (i < numWorkers); ++i) {
+        Worker* worker = new Worker(*this);
+        workers.push_back(worker);
+        status = worker->Start();
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to start crypto workers"));
+        Stop();
+        Join();
+    }
+    return status;
+}
+
+void CryptoWorkerPool::Stop()
+{
+    std::deque<Job> cancelled;
+
+    lock.Lock(MUTEX_CONTEXT);
+    running = false;
+    cancelled.swap(jobs);
+    stats.queueDepth = 0;
+    lock.Unlock(MUTEX_CONTEXT);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Stop();
+    }
+    /*
+     * Hand the messages back unencrypted so the endpoint writers are not left waiting for them
+     */
+    while (!cancelled.empty()) {
+        cancelled.front().ep->EncryptTxMessage(cancelled.front().msg, false);
+        cancelled.pop_front();
+    }
+}
+
+void CryptoWorkerPool::Join()
+{
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Join();
+        delete workers[i];
+    }
+    workers.clear();
+    lock.Lock(MUTEX_CONTEXT);
+    stats.numWorkers = 0;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+QStatus CryptoWorkerPool::Submit(RemoteEndpoint& ep, Message& msg, size_t size)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    if (!running) {
+        lock.Unlock(MUTEX_CONTEXT);
+        return ER_BUS_STOPPING;
+    }
+    jobs.push_back(Job(ep, msg, size));
+    stats.queueDepth = (uint32_t)jobs.size();
+    stats.maxQueueDepth = (std::max)(stats.maxQueueDepth, stats.queueDepth);
+    workEvent.SetEvent();
+    lock.Unlock(MUTEX_CONTEXT);
+    return ER_OK;
+}
+
+bool CryptoWorkerPool::Cancel(const Message& msg)
+{
+    bool cancelled = false;
+    lock.Lock(MUTEX_CONTEXT);
+    for (std::deque<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+        if (it->msg.iden(msg)) {
+            jobs.erase(it);
+            stats.queueDepth = (uint32_t)jobs.size();
+            cancelled = true;
+            break;
+        }
+    }
+    lock.Unlock(MUTEX_CONTEXT);
+    return cancelled;
+}
+
+void CryptoWorkerPool::GetStats(BusAttachment::CryptoWorkerStats& stats)
+{
+    lock.Lock(MUTEX_CONTEXT);
+    stats = this->stats;
+    lock.Unlock(MUTEX_CONTEXT);
+}
+
+qcc::ThreadReturn STDCALL CryptoWorkerPool::Worker::Run(void* arg)
+{
+    while (!IsStopping()) {
+        pool.lock.Lock(MUTEX_CONTEXT);
+        if (pool.jobs.empty()) {
+            pool.workEvent.ResetEvent();
+            pool.lock.Unlock(MUTEX_CONTEXT);
+            Event::Wait(pool.workEvent);
+            continue;
+        }
+        Job job = pool.jobs.front();
+        pool.jobs.pop_front();
+        pool.stats.queueDepth = (uint32_t)pool.jobs.size();
+        pool.lock.Unlock(MUTEX_CONTEXT);
+
+        QStatus status = job.ep->EncryptTxMessage(job.msg, true);
+
+        pool.lock.Lock(MUTEX_CONTEXT);
+        if (status == ER_OK) {
+            ++pool.stats.messagesEncrypted;
+            pool.stats.bytesEncrypted += job.size;
+        } else {
+            ++pool.stats.encryptFailures;
+        }
+        pool.lock.Unlock(MUTEX_CONTEXT);
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,166 @@
+#ifndef _ALLJOYN_CRYPTOWORKERPOOL_H
+#define _ALLJOYN_CRYPTOWORKERPOOL_H
+/**
+ * @file
+ * This file defines a pool of threads that encrypt messages queued on remote endpoints.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include CryptoWorkerPool.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <deque>
+#include <vector>
+
+#include <qcc/Event.h>
+#include <qcc/Mutex.h>
+#include <qcc/Thread.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+
+#include "RemoteEndpoint.h"
+
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * Encrypting a message is done lazily by the thread that writes it to the endpoint. When a bus
+ * attachment sends large encrypted messages to many peers this puts all of the AES-CCM work on the
+ * few threads that service the sockets. The crypto worker pool moves that work onto its own threads:
+ * an encrypted message is handed to the pool when it is queued on a remote endpoint and the
+ * endpoint writer does not take the message until a worker has encrypted it.
+ *
+ * The pool is disabled unless a number of workers is set before the bus attachment is started.
+ */
+class CryptoWorkerPool {
+  public:
+
+    /**
+     * Constructor for a pool with no workers
+     */
+    CryptoWorkerPool();
+
+    /**
+     * Destructor
+     */
+    ~CryptoWorkerPool();
+
+    /**
+     * Set the number of worker threads. This only takes effect when the pool is next started.
+     *
+     * @param numWorkers  Number of workers, 0 disables the pool.
+     */
+    void SetNumWorkers(uint32_t numWorkers) { this->numWorkers = numWorkers; }
+
+    /**
+     * Start the worker threads if the number of workers is not zero.
+     *
+     * @return
+     *      - #ER_OK if the pool was started or is disabled.
+     *      - An error status otherwise.
+     */
+    QStatus Start();
+
+    /**
+     * Stop the worker threads. Messages that are still waiting for a worker are released to be
+     * encrypted by the endpoint writer.
+     */
+    void Stop();
+
+    /**
+     * Wait for the worker threads to exit.
+     */
+    void Join();
+
+    /**
+     * Check if the pool is accepting messages.
+     */
+    bool IsRunning() const { return running; }
+
+    /**
+     * Queue a message for encryption. The endpoint is told when the message is ready with
+     * _RemoteEndpoint::EncryptTxMessage().
+     *
+     * @param ep    The endpoint the message is queued on.
+     * @param msg   The message to encrypt.
+     * @param size  Size of the marshaled message for the statistics.
+     *
+     * @return
+     *      - #ER_OK if the message was queued.
+     *      - #ER_BUS_STOPPING if the pool is not running.
+     */
+    QStatus Submit(RemoteEndpoint& ep, Message& msg, size_t size);
+
+    /**
+     * Remove a message that has not yet been taken by a worker. A message a worker has already
+     * taken is still passed to _RemoteEndpoint::EncryptTxMessage().
+     *
+     * @param msg   The message passed to Submit().
+     *
+     * @return  true if the message was removed.
+     */
+    bool Cancel(const Message& msg);
+
+    /**
+     * Get the statistics for the pool.
+     *
+     * @param stats  Returns the statistics.
+     */
+    void GetStats(BusAttachment::CryptoWorkerStats& stats);
+
+  private:
+
+    /**
+     * A message waiting to be encrypted
+     */
+    struct Job {
+        RemoteEndpoint ep;   /**< The endpoint the message is queued on */
+        Message msg;         /**< The message */
+        size_t size;         /**< Size of the marshaled message */
+        Job(const RemoteEndpoint& ep, const Message& msg, size_t size) : ep(ep), msg(msg), size(size) { }
+    };
+
+    class Worker : public qcc::Thread {
+      public:
+        Worker(CryptoWorkerPool& pool) : Thread("cryptoWorker"), pool(pool) { }
+        qcc::ThreadReturn STDCALL Run(void* arg);
+
+        CryptoWorkerPool& pool;
+    };
+
+    /* Copy constructor and assignment operator are not allowed */
+    CryptoWorkerPool(const CryptoWorkerPool& other);
+    CryptoWorkerPool& operator=(const CryptoWorkerPool& other);
+
+    qcc::Mutex lock;                     /**< Protects the job queue and the statistics */
+    qcc::Event workEvent;                /**< Set when a job is queued */
+    std::deque<Job> jobs;                /**< Messages waiting for a worker, oldest first */
+    std::vector<Worker*> workers;        /**< Worker threads */
+    uint32_t numWorkers;                 /**< Number of workers started by Start() */
+    bool running;                        /**< True between Start and Stop */
+    BusAttachment::CryptoWorkerStats stats;
+};
+
+}
+
+#endif
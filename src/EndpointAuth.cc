@@ -151,7 +151,6 @@ static const uint32_t REDIRECT_TIMEOUT = 30 * 1000;
 
 QStatus EndpointAuth::WaitHello(qcc::String& authUsed)
 {
-    qcc::String redirection;
     QStatus status;
     Message hello(bus);
 
@@ -160,6 +159,14 @@ QStatus EndpointAuth::WaitHello(qcc::String& authUsed)
     if (status != ER_OK) {
         return status;
     }
+    return HandleHello(hello, authUsed, true);
+}
+
+QStatus EndpointAuth::HandleHello(Message& hello, qcc::String& authUsed, bool waitRedirect)
+{
+    qcc::String redirection;
+    QStatus status;
+
     status = hello->Unmarshal(endpoint, false);
     if (ER_OK == status) {
         if (hello->GetType() != MESSAGE_METHOD_CALL) {
@@ -264,7 +271,12 @@ QStatus EndpointAuth::WaitHello(qcc::String& authUsed)
             QCC_LogError(status, ("%s", __FUNCTION__));
         }
     }
-    if ((ER_OK == status) && !redirection.empty()) {
+    if ((ER_OK == status) && !redirection.empty() && !waitRedirect) {
+        /*
+         * A non-blocking establishment cannot wait for the other end to close the socket.
+         */
+        status = ER_BUS_ENDPOINT_REDIRECTED;
+    } else if ((ER_OK == status) && !redirection.empty()) {
         /*
          * We expect the other end to shutdown the endpoint socket as soon as it receives the
          * redirection error response. The only way we can tell if the socket is closed is by
@@ -477,4 +489,97 @@ ExitEstablish:
     return status;
 }
 
-}
\ No newline at end of file
+void EndpointAuth::EstablishStart(const qcc::String& authMechanisms, AuthListener* listener)
+{
+    QCC_DbgPrintf(("EndpointAuth::EstablishStart authMechanisms=\"%s\"", authMechanisms.c_str()));
+
+    assert(isAccepting && !sasl);
+
+    if (listener) {
+        authListener.Set(listener);
+    }
+    sasl = new SASLEngine(bus, AuthMechanism::CHALLENGER, authMechanisms, NULL, authListener, this);
+    /*
+     * The server's GUID is sent to the client when the authentication succeeds
+     */
+    sasl->SetLocalId(bus.GetInternal().GetGlobalGUID().ToString());
+    step = STEP_SASL;
+    line.clear();
+}
+
+QStatus EndpointAuth::EstablishContinue(qcc::String& authUsed)
+{
+    QStatus status = ER_OK;
+    size_t numPushed;
+    SASLEngine::AuthState state;
+    qcc::String outStr;
+
+    assert(sasl);
+
+    while (step == STEP_SASL) {
+        /*
+         * Read the challenge a byte at a time so nothing past the end of the line is consumed
+         */
+        uint8_t c;
+        size_t actual;
+        status = endpoint->GetSource().PullBytes(&c, 1, actual, 0);
+        if ((status == ER_TIMEOUT) || (status == ER_WOULDBLOCK)) {
+            return ER_WOULDBLOCK;
+        }
+        if ((status == ER_OK) && (actual != 1)) {
+            status = ER_SOCK_OTHER_END_CLOSED;
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("Failed to read from stream"));
+            goto ExitEstablish;
+        }
+        if (c == '\r') {
+            continue;
+        } else if (c != '\n') {
+            line.push_back(c);
+            continue;
+        }
+        status = sasl->Advance(line, outStr, state);
+        line.clear();
+        if (status != ER_OK) {
+            QCC_DbgPrintf(("Server authentication failed %s", QCC_StatusText(status)));
+            goto ExitEstablish;
+        }
+        if (state == SASLEngine::ALLJOYN_AUTH_SUCCESS) {
+            step = STEP_HELLO;
+            break;
+        }
+        /*
+         * Send the response
+         */
+        status = endpoint->GetSink().PushBytes((void*)(outStr.data()), outStr.length(), numPushed);
+        if (status == ER_OK) {
+            QCC_DbgPrintf(("Sent %s", outStr.c_str()));
+        } else {
+            QCC_LogError(status, ("Failed to write to stream"));
+            goto ExitEstablish;
+        }
+    }
+
+    /*
+     * Read as much of the hello message as has arrived
+     */
+    status = hello->ReadNonBlocking(endpoint, false);
+    if ((status == ER_TIMEOUT) || (status == ER_WOULDBLOCK)) {
+        return ER_WOULDBLOCK;
+    }
+    if (status == ER_OK) {
+        authUsed = sasl->GetMechanism();
+        status = HandleHello(hello, authUsed, false);
+    }
+
+ExitEstablish:
+
+    authListener.Set(NULL);
+
+    QCC_DbgPrintf(("Establish complete %s", QCC_StatusText(status)));
+
+    return status;
+}
+
+}
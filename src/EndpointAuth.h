@@ -59,13 +59,16 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
         endpoint(endpoint),
         uniqueName(bus.GetInternal().GetRouter().GenerateUniqueName()),
         isAccepting(isAcceptor),
-        remoteProtocolVersion(0)
+        remoteProtocolVersion(0),
+        sasl(NULL),
+        step(STEP_SASL),
+        hello(bus)
     { }
 
     /**
      * Destructor
      */
-    ~EndpointAuth() { };
+    ~EndpointAuth() { delete sasl; };
 
     /**
      * Establish a connection.
@@ -83,6 +86,29 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
      */
     QStatus Establish(const qcc::String& authMechanisms, qcc::String& authUsed, qcc::String& redirection, AuthListener* listener = NULL);
 
+    /**
+     * Start establishing an accepted connection without blocking. The conversation is advanced by
+     * calling EstablishContinue() each time there is data to read from the endpoint.
+     *
+     * @param authMechanisms  The authentication mechanisms to accept.
+     * @param listener        Authentication credentials listener
+     */
+    void EstablishStart(const qcc::String& authMechanisms, AuthListener* listener = NULL);
+
+    /**
+     * Consume whatever the remote side has sent so far and reply to it. This never waits for
+     * more data to arrive.
+     *
+     * @param authUsed        Returns the name of the authentication method that was used to establish the connection.
+     *
+     * @return
+     *      - ER_OK if the connection is established
+     *      - ER_WOULDBLOCK if more data must be received before the connection is established
+     *      - ER_BUS_ENDPOINT_REDIRECTED if the endpoint is being redirected.
+     *      - An error status otherwise
+     */
+    QStatus EstablishContinue(qcc::String& authUsed);
+
     /**
      * Get the unique bus name assigned by the bus for this endpoint.
      *
@@ -143,10 +169,24 @@ class EndpointAuth : public SASLEngine::ExtensionHandler {
 
     ProtectedAuthListener authListener;  ///< Authentication listener
 
+    /**
+     * Steps of a non-blocking establishment
+     */
+    enum EstablishStep {
+        STEP_SASL,                   ///< Exchanging SASL commands
+        STEP_HELLO                   ///< Waiting for the hello message
+    };
+
+    SASLEngine* sasl;                ///< SASL conversation of a non-blocking establishment
+    EstablishStep step;              ///< Step of a non-blocking establishment
+    qcc::String line;                ///< Partial SASL command received by a non-blocking establishment
+    Message hello;                   ///< Partial hello message received by a non-blocking establishment
+
     /* Internal methods */
 
     QStatus Hello(qcc::String& redirection);
     QStatus WaitHello(qcc::String& authUsed);
+    QStatus HandleHello(Message& hello, qcc::String& authUsed, bool waitRedirect);
 };
 
 }
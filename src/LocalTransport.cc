@@ -22,7 +22,18 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 
+#include <algorithm>
 #include <list>
+#include <map>
+#include <deque>
+#include <vector>
+#include <string.h>
+
+#if defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 #include <qcc/Debug.h>
 #include <qcc/GUID.h>
@@ -55,16 +66,202 @@ namespace ajn {
 
 static const uint32_t LOCAL_ENDPOINT_CONCURRENCY = 4;
 
+/* Number of entries in the dispatcher run queue, must be a power of two */
+static const uint32_t DISPATCH_QUEUE_SIZE = 64;
+
+/* Longest time a producer waits for room in a full run queue before checking if the dispatcher stopped */
+static const uint32_t DISPATCH_FULL_WAIT_MS = 100;
+
+/*
+ * Monotonic clock in microseconds for the dispatch latency statistics. The qcc timestamps only
+ * have millisecond resolution.
+ */
+static uint64_t DispatchClockUs()
+{
+#if defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) {
+        ::QueryPerformanceFrequency(&freq);
+    }
+    ::QueryPerformanceCounter(&now);
+    return (uint64_t)((now.QuadPart * 1000000) / freq.QuadPart);
+#else
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+#endif
+}
+
+/*
+ * Set *mem to newValue if it is equal to oldValue, as a single atomic operation and full memory
+ * barrier. Returns true if *mem was changed.
+ */
+static inline bool CompareAndSwap(volatile int32_t* mem, int32_t oldValue, int32_t newValue)
+{
+#if defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+    return ::InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(mem), newValue, oldValue) == oldValue;
+#else
+    return __sync_bool_compare_and_swap(mem, oldValue, newValue);
+#endif
+}
 
-class _LocalEndpoint::Dispatcher : public qcc::Timer, public qcc::AlarmListener {
+/*
+ * The dispatcher runs method call, signal and deferred callback handlers on a pool of worker
+ * threads. Work is passed to the workers through bounded lock-free run queues so dispatching a
+ * message does not allocate, sort or lock. Only work that has to wait goes through a timer.
+ *
+ * By default all workers share one run queue and, as with the timer this replaces, handlers are
+ * run one at a time unless a handler calls EnableReentrancy(). The worker holding the reentrancy
+ * lock is the only one taking work off the run queue so the queue has a single consumer at any
+ * time. Signals from the same sender are never run concurrently, a signal that arrives while an
+ * earlier signal from the same sender is still in a handler that enabled reentrancy is held back
+ * until that handler returns.
+ *
+ * In BusAttachment::DISPATCH_SESSION_LANES mode each worker owns a run queue (a lane) and there is
+ * no reentrancy lock. Method calls and signals are hashed onto a lane by sender and session id so
+ * messages from the same sender in the same session are handled in order while other sessions are
+ * handled in parallel. Replies are not ordered, they go to any lane that is not running a handler
+ * that enabled reentrancy since that handler may be waiting for the reply. When every lane is
+ * running such a handler, or is full, replies go to a reply lane with a worker of its own.
+ *
+ * A producer that finds a run queue full waits for its workers to make room. A worker cannot wait
+ * for itself, so work that a worker queues on its own full run queue goes to an overflow list on
+ * that queue instead. Once the overflow list is in use all new work goes behind it until the
+ * workers have drained it, so work is still taken in the order it was queued.
+ */
+class _LocalEndpoint::Dispatcher : public qcc::AlarmListener {
   public:
-    Dispatcher(_LocalEndpoint* endpoint, uint32_t concurrency = LOCAL_ENDPOINT_CONCURRENCY) : Timer("lepDisp", true, concurrency, true, 10), AlarmListener(), endpoint(endpoint) { }
+    Dispatcher(_LocalEndpoint* endpoint, BusAttachment& bus, uint32_t concurrency = LOCAL_ENDPOINT_CONCURRENCY,
+               BusAttachment::DispatchMode mode = BusAttachment::DISPATCH_SERIALIZED);
+
+    ~Dispatcher();
+
+    QStatus Start();
+
+    QStatus Stop();
+
+    QStatus Join();
+
+    /**
+     * Queue a message for delivery to the local endpoint's handlers.
+     */
     QStatus DispatchMessage(Message& msg);
 
+    /**
+     * Call listener->AlarmTriggered() on a worker thread after delay milliseconds.
+     */
+    QStatus DispatchCallback(qcc::AlarmListener* listener, uint32_t delay);
+
+    /**
+     * Release the reentrancy lock if it is held by the calling thread.
+     */
+    void EnableReentrancy();
+
+    /**
+     * Check if the calling thread is a worker thread running a handler that has not enabled
+     * reentrancy.
+     */
+    bool ThreadHoldsLock();
+
+    /**
+     * Get the number of entries waiting in each run queue.
+     */
+    size_t GetQueueDepths(uint32_t* depths, size_t numLanes) const;
+
+    /**
+     * Get the time entries waited in the run queues.
+     */
+    void GetLatencyStats(BusAttachment::DispatchLatencyStats& stats) const;
+
     void AlarmTriggered(const qcc::Alarm& alarm, QStatus reason);
 
   private:
+
+    /**
+     * A run queue entry. Either a message or a callback listener.
+     */
+    struct Slot {
+        volatile int32_t seq;           /**< Queue position this slot is ready for (see Push and Pop) */
+        Message msg;                    /**< Message to deliver */
+        qcc::AlarmListener* listener;   /**< Callback to run if not NULL */
+        uint64_t queuedUs;              /**< DispatchClockUs() when the slot was filled */
+        Slot(const Message& msg) : seq(0), msg(msg), listener(NULL), queuedUs(0) { }
+    };
+
+    /**
+     * A run queue and the event its consumers wait on.
+     */
+    struct Lane {
+        std::vector<Slot> ring;         /**< The run queue */
+        volatile int32_t tail;          /**< Next position to be claimed by a producer */
+        volatile uint32_t head;         /**< Next position to be consumed (only written by the consumer) */
+        volatile int32_t idleWorkers;   /**< Number of workers waiting for work */
+        volatile int32_t fullWaiters;   /**< Number of producers waiting for room in the run queue */
+        volatile int32_t overflowCount; /**< Number of entries in overflow */
+        volatile bool reentrant;        /**< True while the lane's handler has enabled reentrancy (lane mode only) */
+        qcc::Event workEvent;           /**< Set when work is queued while workers are idle */
+        qcc::Event spaceEvent;          /**< Set when work is taken while producers wait for room */
+        qcc::Mutex overflowLock;        /**< Protects overflow */
+        std::deque<Slot> overflow;      /**< Work a worker queued while its own run queue was full */
+
+        /* Time entries waited in the run queue, only written by the consumer */
+        uint32_t latencyCount;
+        uint32_t latencyMaxUs;
+        uint64_t latencyTotalUs;
+        uint32_t latencyHistogram[BusAttachment::DISPATCH_LATENCY_BUCKETS];
+
+        Lane(const Message& empty) : ring(DISPATCH_QUEUE_SIZE, Slot(empty)), tail(0), head(0), idleWorkers(0), fullWaiters(0), overflowCount(0), reentrant(false) { ResetLatency(); }
+        bool HasWork() const { return (ring[head & (DISPATCH_QUEUE_SIZE - 1)].seq == (int32_t)(head + 1)) || (overflowCount > 0); }
+        uint32_t Depth() const { return ((uint32_t)tail - head) + (uint32_t)overflowCount; }
+        bool IsFull() const { return (((uint32_t)tail - head) >= DISPATCH_QUEUE_SIZE) || (overflowCount > 0); }
+        void ResetLatency()
+        {
+            latencyCount = 0;
+            latencyMaxUs = 0;
+            latencyTotalUs = 0;
+            ::memset(latencyHistogram, 0, sizeof(latencyHistogram));
+        }
+      private:
+        Lane(const Lane& other);
+        Lane& operator=(const Lane& other);
+    };
+
+    class Worker : public qcc::Thread {
+      public:
+        Worker(Dispatcher& dispatcher, Lane& lane) : Thread("lepDisp"), dispatcher(dispatcher), lane(lane), holdsLock(false), signalSender(NULL), tracked(false) { }
+        qcc::ThreadReturn STDCALL Run(void* arg);
+
+        Dispatcher& dispatcher;
+        Lane& lane;                     /**< Run queue this worker takes work from */
+        bool holdsLock;                 /**< True while this worker runs a handler that has not enabled reentrancy */
+        const char* signalSender;       /**< Sender of the signal this worker is running */
+        bool tracked;                   /**< True if signals from signalSender are being held back */
+    };
+
+    QStatus Push(Lane& lane, Message& msg, qcc::AlarmListener* listener);
+    bool Claim(Lane& lane, int32_t& pos);
+    void Fill(Lane& lane, int32_t pos, Message& msg, qcc::AlarmListener* listener);
+    void Overflow(Lane& lane, Message& msg, qcc::AlarmListener* listener);
+    void WaitForSpace(Lane& lane);
+    bool Pop(Lane& lane, Message& msg, qcc::AlarmListener*& listener);
+    void Fence() { qcc::IncrementAndFetch(&fence); }
+    void WaitForWork(Lane& lane);
+    void Deliver(Message& msg);
+    void RunSignal(Worker& worker, Message& msg);
+    Worker* CurrentWorker();
+    void Reset();
+
     _LocalEndpoint* endpoint;
+    Message empty;                      /**< Placeholder for run queue slots that hold no message */
+    bool sessionLanes;                  /**< True if each worker has its own lane */
+    std::vector<Lane*> lanes;           /**< Run queues, a single shared queue unless sessionLanes is true */
+    size_t numSessionLanes;             /**< Number of lanes messages are hashed onto, the reply lane follows them */
+    volatile int32_t fence;             /**< Target of atomic operations used as memory barriers */
+    qcc::Mutex reentrancyLock;          /**< Held while a handler runs unless it enables reentrancy (shared queue only) */
+    std::vector<Worker*> workers;       /**< Worker threads */
+    volatile bool running;              /**< True between Start and Stop */
+    std::map<qcc::String, std::deque<Message> > heldSignals; /**< Signals held back per sender (shared queue only) */
 };
 
 class _LocalEndpoint::DeferredCallbacks : public qcc::AlarmListener {
@@ -150,9 +347,9 @@ class _LocalEndpoint::ReplyContext {
     ReplyContext operator=(const ReplyContext& other);
 };
 
-_LocalEndpoint::_LocalEndpoint(BusAttachment& bus, uint32_t concurrency) :
+_LocalEndpoint::_LocalEndpoint(BusAttachment& bus, uint32_t concurrency, BusAttachment::DispatchMode dispatchMode) :
     _BusEndpoint(ENDPOINT_TYPE_LOCAL),
-    dispatcher(new Dispatcher(this, concurrency)),
+    dispatcher(new Dispatcher(this, bus, concurrency, dispatchMode)),
     deferredCallbacks(new DeferredCallbacks(this)),
     running(false),
     isRegistered(false),
@@ -390,22 +587,446 @@ QStatus _LocalEndpoint::PeerInterface(Message& message)
 }
 
 
-QStatus _LocalEndpoint::Dispatcher::DispatchMessage(Message& msg)
+_LocalEndpoint::Dispatcher::Dispatcher(_LocalEndpoint* endpoint, BusAttachment& bus, uint32_t concurrency, BusAttachment::DispatchMode mode) :
+    AlarmListener(),
+    endpoint(endpoint),
+    empty(bus),
+    sessionLanes(mode == BusAttachment::DISPATCH_SESSION_LANES),
+    fence(0),
+    running(false)
 {
-    uint32_t zero = 0;
-    void* context = new Message(msg);
-    qcc::AlarmListener* localEndpointListener = this;
-    Alarm alarm(zero, localEndpointListener, context, zero);
-    QStatus status = AddAlarm(alarm);
-    if (status != ER_OK) {
-        Message* temp = static_cast<Message*>(context);
-        if (temp) {
-            delete temp;
+    for (uint32_t i = 0; i < (std::max)(concurrency, (uint32_t)1); ++i) {
+        if (sessionLanes || lanes.empty()) {
+            lanes.push_back(new Lane(empty));
+        }
+        workers.push_back(new Worker(*this, *lanes.back()));
+    }
+    numSessionLanes = lanes.size();
+    if (sessionLanes) {
+        lanes.push_back(new Lane(empty));
+        workers.push_back(new Worker(*this, *lanes.back()));
+    }
+    Reset();
+}
+
+_LocalEndpoint::Dispatcher::~Dispatcher()
+{
+    Stop();
+    Join();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        delete workers[i];
+    }
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        delete lanes[i];
+    }
+}
+
+void _LocalEndpoint::Dispatcher::Reset()
+{
+    for (size_t l = 0; l < lanes.size(); ++l) {
+        Lane& lane = *lanes[l];
+        for (uint32_t i = 0; i < DISPATCH_QUEUE_SIZE; ++i) {
+            lane.ring[i].msg = empty;
+            lane.ring[i].listener = NULL;
+            lane.ring[i].seq = i;
         }
+        lane.tail = 0;
+        lane.head = 0;
+        lane.overflow.clear();
+        lane.overflowCount = 0;
+        lane.reentrant = false;
+        lane.ResetLatency();
+    }
+    heldSignals.clear();
+}
+
+QStatus _LocalEndpoint::Dispatcher::Start()
+{
+    QStatus status = ER_OK;
+    running = true;
+    for (size_t i = 0; (status == ER_OK) && (i < workers.size()); ++i) {
+        status = workers[i]->Start();
     }
     return status;
 }
 
+QStatus _LocalEndpoint::Dispatcher::Stop()
+{
+    running = false;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Stop();
+    }
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        lanes[i]->workEvent.SetEvent();
+        lanes[i]->spaceEvent.SetEvent();
+    }
+    return ER_OK;
+}
+
+QStatus _LocalEndpoint::Dispatcher::Join()
+{
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->Join();
+    }
+    /*
+     * Discard work that was not run before the workers stopped
+     */
+    Reset();
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        lanes[i]->workEvent.ResetEvent();
+        lanes[i]->spaceEvent.ResetEvent();
+    }
+    return ER_OK;
+}
+
+/*
+ * Each slot's sequence number tells producers and the consumer who owns it. A slot with sequence
+ * number n is free for the producer that claims position n, a slot with sequence number n + 1
+ * holds the work for position n and is ready to be consumed. The consumer hands the slot to the
+ * producer of the next lap by setting the sequence number to n + DISPATCH_QUEUE_SIZE.
+ *
+ * A producer claims position n by moving the tail from n to n + 1 with a compare-and-swap, which
+ * it only tries when slot n is free. If the slot still holds work from the previous lap the queue
+ * is full.
+ */
+QStatus _LocalEndpoint::Dispatcher::Push(Lane& lane, Message& msg, qcc::AlarmListener* listener)
+{
+    int32_t pos;
+    while (true) {
+        if (!running) {
+            return ER_BUS_STOPPING;
+        }
+        if ((lane.overflowCount == 0) && Claim(lane, pos)) {
+            break;
+        }
+        /*
+         * The queue is full. A worker taking work from this queue would wait for itself so the work
+         * goes to the overflow list, otherwise wait for the workers to catch up. This applies back
+         * pressure to the remote endpoint that is delivering messages the same way the bounded
+         * timer did.
+         */
+        Worker* worker = CurrentWorker();
+        if (worker && (&worker->lane == &lane)) {
+            Overflow(lane, msg, listener);
+            return ER_OK;
+        }
+        WaitForSpace(lane);
+    }
+    Fill(lane, pos, msg, listener);
+    return ER_OK;
+}
+
+bool _LocalEndpoint::Dispatcher::Claim(Lane& lane, int32_t& pos)
+{
+    while (true) {
+        pos = lane.tail;
+        int32_t seq = lane.ring[(uint32_t)pos & (DISPATCH_QUEUE_SIZE - 1)].seq;
+        int32_t lap = (int32_t)((uint32_t)seq - (uint32_t)pos);
+        if (lap < 0) {
+            /* The slot has not been consumed since the previous lap */
+            return false;
+        }
+        if ((lap == 0) && CompareAndSwap(&lane.tail, pos, pos + 1)) {
+            return true;
+        }
+        /* Another producer claimed this position first */
+    }
+}
+
+void _LocalEndpoint::Dispatcher::Fill(Lane& lane, int32_t pos, Message& msg, qcc::AlarmListener* listener)
+{
+    Slot& slot = lane.ring[(uint32_t)pos & (DISPATCH_QUEUE_SIZE - 1)];
+    assert(slot.seq == pos);
+    Fence();
+    slot.msg = msg;
+    slot.listener = listener;
+    slot.queuedUs = DispatchClockUs();
+    Fence();
+    slot.seq = pos + 1;
+    Fence();
+    if (lane.idleWorkers > 0) {
+        lane.workEvent.SetEvent();
+    }
+}
+
+void _LocalEndpoint::Dispatcher::Overflow(Lane& lane, Message& msg, qcc::AlarmListener* listener)
+{
+    Slot slot(msg);
+    slot.listener = listener;
+    slot.queuedUs = DispatchClockUs();
+    lane.overflowLock.Lock(MUTEX_CONTEXT);
+    lane.overflow.push_back(slot);
+    qcc::IncrementAndFetch(&lane.overflowCount);
+    lane.overflowLock.Unlock(MUTEX_CONTEXT);
+    if (lane.idleWorkers > 0) {
+        lane.workEvent.SetEvent();
+    }
+}
+
+void _LocalEndpoint::Dispatcher::WaitForSpace(Lane& lane)
+{
+    qcc::IncrementAndFetch(&lane.fullWaiters);
+    lane.spaceEvent.ResetEvent();
+    if (running && lane.IsFull()) {
+        /* The timeout covers a wakeup lost to another waiter resetting the event */
+        Event::Wait(lane.spaceEvent, DISPATCH_FULL_WAIT_MS);
+    }
+    qcc::DecrementAndFetch(&lane.fullWaiters);
+}
+
+bool _LocalEndpoint::Dispatcher::Pop(Lane& lane, Message& msg, qcc::AlarmListener*& listener)
+{
+    uint32_t head = lane.head;
+    Slot& slot = lane.ring[head & (DISPATCH_QUEUE_SIZE - 1)];
+    uint64_t queuedUs;
+    if (slot.seq == (int32_t)(head + 1)) {
+        Fence();
+        msg = slot.msg;
+        listener = slot.listener;
+        queuedUs = slot.queuedUs;
+        slot.msg = empty;
+        slot.listener = NULL;
+        Fence();
+        slot.seq = (int32_t)(head + DISPATCH_QUEUE_SIZE);
+        lane.head = head + 1;
+        Fence();
+    } else if (lane.overflowCount > 0) {
+        /* Work only goes to the overflow list while the run queue is full so it is taken after the run queue */
+        lane.overflowLock.Lock(MUTEX_CONTEXT);
+        Slot& front = lane.overflow.front();
+        msg = front.msg;
+        listener = front.listener;
+        queuedUs = front.queuedUs;
+        lane.overflow.pop_front();
+        qcc::DecrementAndFetch(&lane.overflowCount);
+        lane.overflowLock.Unlock(MUTEX_CONTEXT);
+    } else {
+        return false;
+    }
+    uint32_t waitUs = (uint32_t)(std::min)(DispatchClockUs() - queuedUs, (uint64_t)0xFFFFFFFF);
+    if (lane.fullWaiters > 0) {
+        lane.spaceEvent.SetEvent();
+    }
+
+    size_t bucket = 0;
+    while ((bucket < (BusAttachment::DISPATCH_LATENCY_BUCKETS - 1)) && (waitUs >= (1U << bucket))) {
+        ++bucket;
+    }
+    ++lane.latencyHistogram[bucket];
+    ++lane.latencyCount;
+    lane.latencyTotalUs += waitUs;
+    lane.latencyMaxUs = (std::max)(lane.latencyMaxUs, waitUs);
+    return true;
+}
+
+void _LocalEndpoint::Dispatcher::WaitForWork(Lane& lane)
+{
+    qcc::IncrementAndFetch(&lane.idleWorkers);
+    lane.workEvent.ResetEvent();
+    if (!lane.HasWork()) {
+        Event::Wait(lane.workEvent);
+    }
+    qcc::DecrementAndFetch(&lane.idleWorkers);
+}
+
+qcc::ThreadReturn STDCALL _LocalEndpoint::Dispatcher::Worker::Run(void* arg)
+{
+    bool shared = !dispatcher.sessionLanes;
+    while (!IsStopping()) {
+        Message msg = dispatcher.empty;
+        qcc::AlarmListener* listener = NULL;
+        if (shared) {
+            dispatcher.reentrancyLock.Lock(MUTEX_CONTEXT);
+        }
+        holdsLock = true;
+        bool found = dispatcher.Pop(lane, msg, listener);
+        if (found) {
+            if (listener) {
+                uint32_t zero = 0;
+                listener->AlarmTriggered(Alarm(zero, listener), ER_OK);
+            } else if (shared && (msg->GetType() == MESSAGE_SIGNAL)) {
+                dispatcher.RunSignal(*this, msg);
+            } else {
+                dispatcher.Deliver(msg);
+            }
+        }
+        if (holdsLock) {
+            holdsLock = false;
+            if (shared) {
+                dispatcher.reentrancyLock.Unlock(MUTEX_CONTEXT);
+            }
+        }
+        lane.reentrant = false;
+        if (!found) {
+            dispatcher.WaitForWork(lane);
+        }
+    }
+    return 0;
+}
+
+void _LocalEndpoint::Dispatcher::Deliver(Message& msg)
+{
+    QStatus status = endpoint->DoPushMessage(msg);
+    // ER_BUS_STOPPING is a common shutdown error
+    if (status != ER_OK && status != ER_BUS_STOPPING) {
+        QCC_LogError(status, ("LocalEndpoint::DoPushMessage failed"));
+    }
+}
+
+void _LocalEndpoint::Dispatcher::RunSignal(Worker& worker, Message& msg)
+{
+    /*
+     * Hold the signal back if an earlier signal from the same sender is still being handled
+     */
+    if (!heldSignals.empty()) {
+        std::map<qcc::String, std::deque<Message> >::iterator it = heldSignals.find(msg->GetSender());
+        if (it != heldSignals.end()) {
+            it->second.push_back(msg);
+            return;
+        }
+    }
+    qcc::String sender;
+    Message next = msg;
+    worker.tracked = false;
+    while (true) {
+        worker.signalSender = next->GetSender();
+        Deliver(next);
+        worker.signalSender = NULL;
+        if (!worker.tracked) {
+            break;
+        }
+        /*
+         * The handler enabled reentrancy so other workers may have held back signals from this
+         * sender. Run them in order on this worker once it holds the reentrancy lock again.
+         */
+        if (!worker.holdsLock) {
+            reentrancyLock.Lock(MUTEX_CONTEXT);
+            worker.holdsLock = true;
+        }
+        if (sender.empty()) {
+            sender = msg->GetSender();
+        }
+        std::map<qcc::String, std::deque<Message> >::iterator it = heldSignals.find(sender);
+        if (it->second.empty()) {
+            heldSignals.erase(it);
+            break;
+        }
+        next = it->second.front();
+        it->second.pop_front();
+    }
+    worker.tracked = false;
+}
+
+_LocalEndpoint::Dispatcher::Worker* _LocalEndpoint::Dispatcher::CurrentWorker()
+{
+    qcc::Thread* thread = qcc::Thread::GetThread();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        if (workers[i] == thread) {
+            return workers[i];
+        }
+    }
+    return NULL;
+}
+
+void _LocalEndpoint::Dispatcher::EnableReentrancy()
+{
+    Worker* worker = CurrentWorker();
+    if (worker && worker->holdsLock) {
+        if (sessionLanes) {
+            /*
+             * There is no lock to release, stop routing replies to this lane instead since the
+             * handler may be about to wait for one. The barrier makes the flag visible before the
+             * handler sends the call whose reply it will wait for.
+             */
+            worker->lane.reentrant = true;
+            Fence();
+            worker->holdsLock = false;
+            return;
+        }
+        /*
+         * Start holding back signals from the sender of the signal being handled before another
+         * worker can take work off the run queue.
+         */
+        if (worker->signalSender && !worker->tracked) {
+            heldSignals[worker->signalSender];
+            worker->tracked = true;
+        }
+        worker->holdsLock = false;
+        reentrancyLock.Unlock(MUTEX_CONTEXT);
+    }
+}
+
+bool _LocalEndpoint::Dispatcher::ThreadHoldsLock()
+{
+    Worker* worker = CurrentWorker();
+    return worker && worker->holdsLock;
+}
+
+size_t _LocalEndpoint::Dispatcher::GetQueueDepths(uint32_t* depths, size_t numLanes) const
+{
+    if (depths) {
+        for (size_t i = 0; i < (std::min)(numLanes, lanes.size()); ++i) {
+            depths[i] = lanes[i]->Depth();
+        }
+    }
+    return lanes.size();
+}
+
+void _LocalEndpoint::Dispatcher::GetLatencyStats(BusAttachment::DispatchLatencyStats& stats) const
+{
+    ::memset(&stats, 0, sizeof(stats));
+    for (size_t l = 0; l < lanes.size(); ++l) {
+        const Lane& lane = *lanes[l];
+        stats.count += lane.latencyCount;
+        stats.totalUs += lane.latencyTotalUs;
+        stats.maxUs = (std::max)(stats.maxUs, lane.latencyMaxUs);
+        for (size_t i = 0; i < BusAttachment::DISPATCH_LATENCY_BUCKETS; ++i) {
+            stats.histogram[i] += lane.latencyHistogram[i];
+        }
+    }
+}
+
+QStatus _LocalEndpoint::Dispatcher::DispatchMessage(Message& msg)
+{
+    if (!sessionLanes) {
+        return Push(*lanes[0], msg, NULL);
+    }
+    AllJoynMessageType type = msg->GetType();
+    if ((type == MESSAGE_METHOD_RET) || (type == MESSAGE_ERROR)) {
+        if (!running) {
+            return ER_BUS_STOPPING;
+        }
+        /*
+         * Full lanes are skipped rather than waited for. A lane that enables reentrancy after it
+         * was picked may still get this reply, but the reply is not for a call made by that
+         * lane's handler since the handler enables reentrancy before making the call.
+         */
+        uint32_t first = msg->GetReplySerial();
+        for (size_t i = 0; i < numSessionLanes; ++i) {
+            Lane& lane = *lanes[(first + i) % numSessionLanes];
+            int32_t pos;
+            if (!lane.reentrant && (lane.overflowCount == 0) && Claim(lane, pos)) {
+                Fill(lane, pos, msg, NULL);
+                return ER_OK;
+            }
+        }
+        /*
+         * Every lane is running a handler that may be waiting for this reply, or is full, so it
+         * goes to the reply lane rather than queue behind them.
+         */
+        return Push(*lanes[numSessionLanes], msg, NULL);
+    }
+    uint32_t hash = (uint32_t)qcc::hash_string(msg->GetSender()) ^ (msg->GetSessionId() * 2654435761U);
+    return Push(*lanes[hash % numSessionLanes], msg, NULL);
+}
+
+QStatus _LocalEndpoint::Dispatcher::DispatchCallback(qcc::AlarmListener* listener, uint32_t delay)
+{
+    uint32_t zero = 0;
+    qcc::AlarmListener* dispatcherListener = this;
+    return endpoint->replyTimer.AddAlarm(Alarm(delay, dispatcherListener, listener, zero));
+}
+
 void _LocalEndpoint::EnableReentrancy()
 {
     if (dispatcher) {
@@ -422,18 +1043,32 @@ bool _LocalEndpoint::IsReentrantCall()
 
 }
 
+size_t _LocalEndpoint::GetDispatchQueueDepths(uint32_t* depths, size_t numLanes) const
+{
+    return dispatcher ? dispatcher->GetQueueDepths(depths, numLanes) : 0;
+}
+
+void _LocalEndpoint::GetDispatchLatencyStats(BusAttachment::DispatchLatencyStats& stats) const
+{
+    if (dispatcher) {
+        dispatcher->GetLatencyStats(stats);
+    } else {
+        ::memset(&stats, 0, sizeof(stats));
+    }
+}
+
 void _LocalEndpoint::Dispatcher::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
-    Message* msg = static_cast<Message*>(alarm->GetContext());
-    if (msg) {
-        if (reason == ER_OK) {
-            QStatus status = endpoint->DoPushMessage(*msg);
-            // ER_BUS_STOPPING is a common shutdown error
-            if (status != ER_OK && status != ER_BUS_STOPPING) {
-                QCC_LogError(status, ("LocalEndpoint::DoPushMessage failed"));
-            }
+    /*
+     * A callback that was waiting on the timer is due, run it on a worker thread. In lane mode
+     * callbacks are not tied to a session and all go to the first lane.
+     */
+    qcc::AlarmListener* listener = static_cast<qcc::AlarmListener*>(alarm->GetContext());
+    if (listener && (reason == ER_OK)) {
+        QStatus status = Push(*lanes[0], empty, listener);
+        if (status != ER_OK && status != ER_BUS_STOPPING) {
+            QCC_LogError(status, ("Failed to dispatch deferred callback"));
         }
-        delete msg;
     }
 }
 
@@ -1101,9 +1736,8 @@ void _LocalEndpoint::OnBusConnected()
     /*
      * Use the local endpoint's dispatcher to call back to report the object registrations.
      */
-    uint32_t zero = 0;
     if (dispatcher) {
-        dispatcher->AddAlarm(Alarm(zero, deferredCallbacks));
+        dispatcher->DispatchCallback(deferredCallbacks, 0);
     }
 }
 
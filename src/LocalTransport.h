@@ -35,6 +35,7 @@
 #include <qcc/Timer.h>
 #include <qcc/Util.h>
 
+#include <alljoyn/BusAttachment.h>
 #include <alljoyn/BusObject.h>
 #include <alljoyn/Message.h>
 #include <alljoyn/MessageReceiver.h>
@@ -82,8 +83,9 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
      *
      * @param bus          Bus associated with endpoint.
      * @param concurrency  The maximum number of concurrent method and signal handlers locally executing.
+     * @param dispatchMode How method and signal handlers are assigned to handler threads.
      */
-    _LocalEndpoint(BusAttachment& bus, uint32_t concurrency);
+    _LocalEndpoint(BusAttachment& bus, uint32_t concurrency, BusAttachment::DispatchMode dispatchMode = BusAttachment::DISPATCH_SERIALIZED);
 
     /**
      * Destructor.
@@ -364,6 +366,23 @@ class _LocalEndpoint : public _BusEndpoint, public qcc::AlarmListener, public Me
      */
     bool IsReentrantCall();
 
+    /**
+     * Get the number of messages and callbacks waiting in each dispatcher run queue.
+     *
+     * @param depths    Array to receive the queue depths (may be NULL).
+     * @param numLanes  Size of the depths array.
+     *
+     * @return The number of run queues, one per handler thread plus the reply lane in lane mode otherwise one.
+     */
+    size_t GetDispatchQueueDepths(uint32_t* depths, size_t numLanes) const;
+
+    /**
+     * Get the time entries waited in the dispatcher run queues.
+     *
+     * @param stats   Returns the statistics summed over all run queues.
+     */
+    void GetDispatchLatencyStats(BusAttachment::DispatchLatencyStats& stats) const;
+
   private:
 
     /**
@@ -514,9 +533,11 @@ class LocalTransport : public Transport {
      *
      * @param bus               The bus
      * @param concurrency       The maximum number of concurrent method and signal handlers locally executing.
+     * @param dispatchMode      How method and signal handlers are assigned to handler threads.
      *
      */
-    LocalTransport(BusAttachment& bus, uint32_t concurrency) : localEndpoint(bus, concurrency), isStoppedEvent() { isStoppedEvent.SetEvent(); }
+    LocalTransport(BusAttachment& bus, uint32_t concurrency, BusAttachment::DispatchMode dispatchMode = BusAttachment::DISPATCH_SERIALIZED) :
+        localEndpoint(bus, concurrency, dispatchMode), isStoppedEvent() { isStoppedEvent.SetEvent(); }
 
     /**
      * Destructor
@@ -0,0 +1,386 @@
+/**
+ * @file
+ *
+ * This file implements the compilation of message signatures into marshal plans.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <map>
+
+#include <qcc/atomic.h>
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
+#include <qcc/String.h>
+#include <qcc/Thread.h>
+
+#include <alljoyn/MsgArg.h>
+
+#include "MarshalPlan.h"
+#include "SignatureUtils.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace std;
+using namespace qcc;
+
+namespace ajn {
+
+/*
+ * Signatures come from interface descriptions so the number of distinct signatures is small. The
+ * limit only guards against an application that generates signatures on the fly.
+ */
+static const size_t MAX_CACHED_PLANS = 1024;
+
+struct PlanCache {
+    qcc::Mutex lock;
+    std::map<qcc::String, MarshalPlan> plans;
+};
+
+/*
+ * The cache is created on first use and never destroyed so that plans can be requested by objects
+ * constructed or destroyed during static initialization or teardown. Only zero initialized
+ * statics are used to create it.
+ */
+static PlanCache* volatile planCache = NULL;
+static volatile int32_t planCacheInit = 0;
+
+static PlanCache* GetPlanCache()
+{
+    PlanCache* cache = planCache;
+    if (!cache) {
+        if (IncrementAndFetch(&planCacheInit) == 1) {
+            cache = new PlanCache();
+            /* The atomic op orders construction of the cache before it is published */
+            IncrementAndFetch(&planCacheInit);
+            planCache = cache;
+        } else {
+            while (!(cache = planCache)) {
+                qcc::Sleep(1);
+            }
+        }
+    }
+    return cache;
+}
+
+#define PadUp(n, i)   (((n) + (i) - 1) & ~((i) - 1))
+
+const MarshalPlan* MarshalPlan::Get(const qcc::String& signature)
+{
+    const MarshalPlan* plan = NULL;
+
+    if (signature.empty()) {
+        return NULL;
+    }
+    PlanCache* cache = GetPlanCache();
+    cache->lock.Lock(MUTEX_CONTEXT);
+    std::map<qcc::String, MarshalPlan>::iterator it = cache->plans.find(signature);
+    if (it != cache->plans.end()) {
+        plan = &it->second;
+    } else if (cache->plans.size() < MAX_CACHED_PLANS) {
+        MarshalPlan& newPlan = cache->plans[signature];
+        QStatus status = newPlan.Compile(signature);
+        if (status == ER_OK) {
+            plan = &newPlan;
+        } else {
+            QCC_DbgPrintf(("No marshal plan for \"%s\": %s", signature.c_str(), QCC_StatusText(status)));
+            cache->plans.erase(signature);
+        }
+    }
+    cache->lock.Unlock(MUTEX_CONTEXT);
+    return plan;
+}
+
+QStatus MarshalPlan::Compile(const qcc::String& sig)
+{
+    QStatus status = ER_OK;
+
+    if (!SignatureUtils::IsValidSignature(sig.c_str())) {
+        return ER_BUS_BAD_SIGNATURE;
+    }
+    signature = sig;
+    numArgs = 0;
+    ops.clear();
+    const char* sigPtr = signature.c_str();
+    while ((status == ER_OK) && *sigPtr) {
+        status = CompileType(sigPtr);
+        ++numArgs;
+    }
+    return status;
+}
+
+QStatus MarshalPlan::CompileType(const char*& sigPtr)
+{
+    QStatus status = ER_OK;
+    const char* start = sigPtr;
+    size_t index = ops.size();
+    Op op;
+
+    op.code = OP_GENERIC;
+    op.typeId = (AllJoynTypeId)(*sigPtr);
+    op.align = (uint8_t)SignatureUtils::AlignmentForType(op.typeId);
+    op.elemAlign = 0;
+    op.numMembers = 0;
+    op.fixedSize = 0;
+    op.stride = 0;
+    op.offset = 0;
+    op.next = 0;
+    /*
+     * Reserve the slot for this op, the ops for any contained types follow it.
+     */
+    ops.push_back(op);
+
+    switch (*sigPtr++) {
+    case ALLJOYN_BYTE:
+    case ALLJOYN_BOOLEAN:
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+    case ALLJOYN_INT64:
+    case ALLJOYN_UINT64:
+    case ALLJOYN_DOUBLE:
+        /* Scalars are the same size as their alignment */
+        op.code = OP_FIXED;
+        op.fixedSize = op.align;
+        break;
+
+    case ALLJOYN_STRING:
+    case ALLJOYN_OBJECT_PATH:
+        op.code = OP_STRING;
+        break;
+
+    case ALLJOYN_SIGNATURE:
+        op.code = OP_SIGNATURE;
+        break;
+
+    case ALLJOYN_HANDLE:
+    case ALLJOYN_VARIANT:
+        op.code = OP_GENERIC;
+        break;
+
+    case ALLJOYN_ARRAY:
+        op.elemAlign = (uint8_t)SignatureUtils::AlignmentForType((AllJoynTypeId)(*sigPtr));
+        switch (*sigPtr) {
+        case ALLJOYN_BYTE:
+        case ALLJOYN_BOOLEAN:
+        case ALLJOYN_INT16:
+        case ALLJOYN_UINT16:
+        case ALLJOYN_INT32:
+        case ALLJOYN_UINT32:
+        case ALLJOYN_INT64:
+        case ALLJOYN_UINT64:
+        case ALLJOYN_DOUBLE:
+            op.code = OP_SCALAR_ARRAY;
+            op.typeId = (AllJoynTypeId)(ALLJOYN_ARRAY | ((*sigPtr++) << 8));
+            break;
+
+        default:
+            op.code = OP_ARRAY;
+            status = CompileType(sigPtr);
+            if ((status == ER_OK) && ops[index + 1].fixedSize) {
+                /* Elements of fixed size are laid out at a fixed distance from each other */
+                op.stride = (uint32_t)PadUp(ops[index + 1].fixedSize, ops[index + 1].align);
+            }
+            break;
+        }
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    case ALLJOYN_DICT_ENTRY_OPEN:
+    {
+        bool isStruct = (op.typeId == ALLJOYN_STRUCT_OPEN);
+        char close = isStruct ? ALLJOYN_STRUCT_CLOSE : ALLJOYN_DICT_ENTRY_CLOSE;
+        /*
+         * A struct made up entirely of fixed size members has a fixed layout. The offsets of the
+         * members are relative to the 8 byte aligned start of the struct.
+         */
+        bool fixed = isStruct;
+        uint32_t offset = 0;
+        op.code = isStruct ? OP_STRUCT : OP_DICT_ENTRY;
+        op.typeId = isStruct ? ALLJOYN_STRUCT : ALLJOYN_DICT_ENTRY;
+        while ((status == ER_OK) && (*sigPtr != close)) {
+            size_t member = ops.size();
+            status = CompileType(sigPtr);
+            if (status == ER_OK) {
+                ++op.numMembers;
+                if (ops[member].fixedSize) {
+                    offset = PadUp(offset, ops[member].align);
+                    ops[member].offset = offset;
+                    offset += ops[member].fixedSize;
+                } else {
+                    fixed = false;
+                }
+            }
+        }
+        ++sigPtr;
+        if (fixed) {
+            op.code = OP_FIXED;
+            op.fixedSize = offset;
+        }
+    }
+    break;
+
+    default:
+        status = ER_BUS_BAD_SIGNATURE;
+        break;
+    }
+    if (status == ER_OK) {
+        op.next = (uint32_t)ops.size();
+        op.sig = qcc::String(start, sigPtr - start);
+        ops[index] = op;
+    }
+    return status;
+}
+
+bool MarshalPlan::MatchesFixed(size_t op, const MsgArg* arg) const
+{
+    const Op& o = ops[op];
+    if (!arg || (arg->typeId != o.typeId)) {
+        return false;
+    }
+    if (o.typeId == ALLJOYN_STRUCT) {
+        if ((arg->v_struct.numMembers != o.numMembers) || !arg->v_struct.members) {
+            return false;
+        }
+        size_t member = op + 1;
+        for (size_t i = 0; i < o.numMembers; ++i) {
+            if (!MatchesFixed(member, &arg->v_struct.members[i])) {
+                return false;
+            }
+            member = ops[member].next;
+        }
+    }
+    return true;
+}
+
+QStatus MarshalPlan::GetSize(size_t op, const MsgArg* arg, size_t& sz) const
+{
+    QStatus status = ER_OK;
+    const Op& o = ops[op];
+
+    if (!arg) {
+        return ER_BUS_BAD_VALUE;
+    }
+    /*
+     * Some signatures can be represented by args with different type ids, for example an array of
+     * bytes can be an ALLJOYN_ARRAY of ALLJOYN_BYTE args. These are checked and sized the slow way
+     * and are marshaled by the generic marshaler.
+     */
+    if (arg->typeId != o.typeId) {
+        if (!arg->HasSignature(o.sig.c_str())) {
+            return ER_BUS_UNEXPECTED_SIGNATURE;
+        }
+        sz = SignatureUtils::GetSize(arg, 1, sz);
+        return ER_OK;
+    }
+    switch (o.code) {
+    case OP_FIXED:
+        if (!MatchesFixed(op, arg)) {
+            return ER_BUS_UNEXPECTED_SIGNATURE;
+        }
+        sz = PadUp(sz, o.align) + o.fixedSize;
+        break;
+
+    case OP_STRING:
+        sz = PadUp(sz, 4) + 4 + arg->v_string.len + 1;
+        break;
+
+    case OP_SIGNATURE:
+        sz += 1 + arg->v_signature.len + 1;
+        break;
+
+    case OP_SCALAR_ARRAY:
+    case OP_GENERIC:
+        sz = SignatureUtils::GetSize(arg, 1, sz);
+        break;
+
+    case OP_ARRAY:
+    {
+        const Op& elem = ops[op + 1];
+        size_t numElements = arg->v_array.numElements;
+        if (!arg->v_array.elemSig || (elem.sig != arg->v_array.elemSig)) {
+            return ER_BUS_UNEXPECTED_SIGNATURE;
+        }
+        if (numElements && !arg->v_array.elements) {
+            return ER_BUS_BAD_VALUE;
+        }
+        sz = PadUp(PadUp(sz, 4) + 4, o.elemAlign);
+        if (o.stride) {
+            for (size_t i = 0; i < numElements; ++i) {
+                if (!MatchesFixed(op + 1, &arg->v_array.elements[i])) {
+                    return ER_BUS_UNEXPECTED_SIGNATURE;
+                }
+            }
+            if (numElements) {
+                sz += (numElements - 1) * o.stride + elem.fixedSize;
+            }
+        } else {
+            for (size_t i = 0; (status == ER_OK) && (i < numElements); ++i) {
+                status = GetSize(op + 1, &arg->v_array.elements[i], sz);
+            }
+        }
+    }
+    break;
+
+    case OP_STRUCT:
+    {
+        if ((arg->v_struct.numMembers != o.numMembers) || !arg->v_struct.members) {
+            return ER_BUS_UNEXPECTED_SIGNATURE;
+        }
+        sz = PadUp(sz, 8);
+        size_t member = op + 1;
+        for (size_t i = 0; (status == ER_OK) && (i < o.numMembers); ++i) {
+            status = GetSize(member, &arg->v_struct.members[i], sz);
+            member = ops[member].next;
+        }
+    }
+    break;
+
+    case OP_DICT_ENTRY:
+        sz = PadUp(sz, 8);
+        status = GetSize(op + 1, arg->v_dictEntry.key, sz);
+        if (status == ER_OK) {
+            status = GetSize(ops[op + 1].next, arg->v_dictEntry.val, sz);
+        }
+        break;
+    }
+    return status;
+}
+
+QStatus MarshalPlan::GetSize(const MsgArg* args, size_t numArgs, size_t& size) const
+{
+    QStatus status = ER_OK;
+    size_t sz = 0;
+
+    if (numArgs != this->numArgs) {
+        return ER_BUS_UNEXPECTED_SIGNATURE;
+    }
+    size_t op = 0;
+    for (size_t i = 0; (status == ER_OK) && (i < numArgs); ++i) {
+        status = GetSize(op, &args[i], sz);
+        op = ops[op].next;
+    }
+    if (status == ER_OK) {
+        size = sz;
+    }
+    return status;
+}
+
+}
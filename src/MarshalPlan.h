@@ -0,0 +1,149 @@
+#ifndef _ALLJOYN_MARSHALPLAN_H
+#define _ALLJOYN_MARSHALPLAN_H
+/**
+ * @file
+ * This file defines a precompiled marshaling plan for a message signature.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include MarshalPlan.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/String.h>
+
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/Status.h>
+
+namespace ajn {
+
+/**
+ * A marshal plan is a signature compiled into a flat list of operations, one for each complete
+ * type in the signature, with the wire alignment and the marshaled size of fixed size types worked
+ * out in advance. Plans are immutable once compiled and are shared through a process wide cache
+ * keyed by signature, so a signature is only compiled once. Callers marshaling for an interface
+ * member look up the plan for the member's signature with Get().
+ *
+ * A plan is used to check a list of MsgArgs against the signature and compute the marshaled size
+ * in a single pass without building a signature string for the args or for each array element.
+ * The marshaling itself is done by _Message::MarshalArgs(const MarshalPlan&, ...).
+ */
+class MarshalPlan {
+    friend class _Message;
+
+  public:
+
+    /**
+     * Constructor for an empty plan
+     */
+    MarshalPlan() : numArgs(0) { }
+
+    /**
+     * Get the plan for a signature, compiling it if this is the first time the signature has been
+     * seen.
+     *
+     * @param signature  The signature.
+     *
+     * @return  The plan or NULL if the signature is empty or invalid or the plan cache is full.
+     *          The plan remains valid until the process exits.
+     */
+    static const MarshalPlan* Get(const qcc::String& signature);
+
+    /**
+     * Compile a signature into a plan. Most callers should use Get().
+     *
+     * @param signature  The signature to compile.
+     *
+     * @return
+     *      - #ER_OK if the signature was compiled.
+     *      - #ER_BUS_BAD_SIGNATURE if the signature is not valid.
+     */
+    QStatus Compile(const qcc::String& signature);
+
+    /**
+     * Check a list of args against the plan and compute their marshaled size.
+     *
+     * @param args     The args to check.
+     * @param numArgs  The number of args.
+     * @param size     Returns the marshaled size of the args starting at an 8 byte boundary.
+     *
+     * @return
+     *      - #ER_OK if the args match the plan signature.
+     *      - #ER_BUS_UNEXPECTED_SIGNATURE if they don't.
+     *      - #ER_BUS_BAD_VALUE if an arg is malformed.
+     */
+    QStatus GetSize(const MsgArg* args, size_t numArgs, size_t& size) const;
+
+    /**
+     * Get the signature the plan was compiled from.
+     */
+    const qcc::String& GetSignature() const { return signature; }
+
+    /**
+     * Get the number of complete types in the signature.
+     */
+    size_t GetNumArgs() const { return numArgs; }
+
+  private:
+
+    /**
+     * How a complete type is marshaled
+     */
+    typedef enum {
+        OP_FIXED,        ///< Scalar or struct of scalars with a precomputed layout
+        OP_STRING,       ///< String or object path
+        OP_SIGNATURE,    ///< Signature
+        OP_SCALAR_ARRAY, ///< Array of scalars, copied as a block
+        OP_ARRAY,        ///< Array of any other type, elements follow using the element op
+        OP_STRUCT,       ///< Struct, members follow
+        OP_DICT_ENTRY,   ///< Dictionary entry, key and value follow
+        OP_GENERIC       ///< Variants and handles are marshaled by the generic marshaler
+    } OpCode;
+
+    /**
+     * One complete type in the signature
+     */
+    struct Op {
+        OpCode code;            ///< How the type is marshaled
+        AllJoynTypeId typeId;   ///< The MsgArg type id the plan expects
+        uint8_t align;          ///< Wire alignment of the type
+        uint8_t elemAlign;      ///< Wire alignment of the element type of an array
+        uint16_t numMembers;    ///< Number of members of a struct
+        uint32_t fixedSize;     ///< Marshaled size of a fixed size type, 0 for variable size types
+        uint32_t stride;        ///< Distance between elements of an array of fixed size elements
+        uint32_t offset;        ///< Offset of a member of a fixed size struct from the start of the struct
+        uint32_t next;          ///< Index of the op following this complete type
+        qcc::String sig;        ///< The complete type signature
+    };
+
+    QStatus CompileType(const char*& sigPtr);
+    QStatus GetSize(size_t op, const MsgArg* arg, size_t& sz) const;
+    bool MatchesFixed(size_t op, const MsgArg* arg) const;
+
+    qcc::String signature;
+    size_t numArgs;
+    std::vector<Op> ops;
+};
+
+}
+
+#endif
@@ -25,11 +25,14 @@
 #include <assert.h>
 #include <ctype.h>
 #include <limits>
+#include <vector>
 
 #include <qcc/String.h>
+#include <qcc/atomic.h>
 #include <qcc/Mutex.h>
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
 #include <qcc/time.h>
 #include <qcc/Util.h>
 #include <qcc/Debug.h>
@@ -39,6 +42,7 @@
 
 #include "BusInternal.h"
 #include "BusUtil.h"
+#include "MsgArgArena.h"
 
 #define QCC_MODULE "ALLJOYN"
 
@@ -300,6 +304,84 @@ QStatus _Message::GetArgs(const char* signature, ...)
     return status;
 }
 
+/*
+ * Buffers for messages that fit in MSG_BUF_POOL_SIZE bytes are recycled through a free list so that
+ * receiving or marshaling a typical message does not allocate. Larger buffers are allocated to size.
+ * Each buffer is preceded by its capacity so FreeMsgBuf() knows which kind it is.
+ */
+static const size_t MSG_BUF_POOL_SIZE = 2048;
+static const size_t MAX_FREE_MSG_BUFS = 128;
+static const size_t MSG_BUF_PREFIX = sizeof(uint64_t);
+
+struct MsgBufPool {
+    qcc::Mutex lock;
+    std::vector<uint8_t*> freeBufs;
+};
+
+/*
+ * The pool is created on first use and never destroyed since messages can outlive static
+ * destructors. Only zero initialized statics are used to create it.
+ */
+static MsgBufPool* volatile msgBufPool = NULL;
+static volatile int32_t msgBufPoolInit = 0;
+
+static MsgBufPool* GetMsgBufPool()
+{
+    MsgBufPool* pool = msgBufPool;
+    if (!pool) {
+        if (IncrementAndFetch(&msgBufPoolInit) == 1) {
+            pool = new MsgBufPool();
+            /* The atomic op orders construction of the pool before it is published */
+            IncrementAndFetch(&msgBufPoolInit);
+            msgBufPool = pool;
+        } else {
+            while (!(pool = msgBufPool)) {
+                qcc::Sleep(1);
+            }
+        }
+    }
+    return pool;
+}
+
+uint8_t* _Message::AllocMsgBuf(size_t size)
+{
+    uint8_t* raw = NULL;
+    size_t capacity = size;
+    if (size <= MSG_BUF_POOL_SIZE) {
+        capacity = MSG_BUF_POOL_SIZE;
+        MsgBufPool* pool = GetMsgBufPool();
+        pool->lock.Lock(MUTEX_CONTEXT);
+        if (!pool->freeBufs.empty()) {
+            raw = pool->freeBufs.back();
+            pool->freeBufs.pop_back();
+        }
+        pool->lock.Unlock(MUTEX_CONTEXT);
+    }
+    if (!raw) {
+        raw = new uint8_t[MSG_BUF_PREFIX + capacity];
+        *reinterpret_cast<size_t*>(raw) = capacity;
+    }
+    return raw + MSG_BUF_PREFIX;
+}
+
+void _Message::FreeMsgBuf(uint8_t* buf)
+{
+    if (!buf) {
+        return;
+    }
+    uint8_t* raw = buf - MSG_BUF_PREFIX;
+    if (*reinterpret_cast<size_t*>(raw) == MSG_BUF_POOL_SIZE) {
+        MsgBufPool* pool = GetMsgBufPool();
+        pool->lock.Lock(MUTEX_CONTEXT);
+        if (pool->freeBufs.size() < MAX_FREE_MSG_BUFS) {
+            pool->freeBufs.push_back(raw);
+            raw = NULL;
+        }
+        pool->lock.Unlock(MUTEX_CONTEXT);
+    }
+    delete [] raw;
+}
+
 _Message::_Message(BusAttachment& bus) :
     bus(&bus),
     endianSwap(false),
@@ -307,14 +389,15 @@ _Message::_Message(BusAttachment& bus) :
     msgBuf(NULL),
     msgArgs(NULL),
     numMsgArgs(0),
+    argArena(NULL),
     ttl(0),
     handles(NULL),
     numHandles(0),
     encrypt(false),
+    encryptPending(false),
+    encryptStatus(ER_OK),
     readState(MESSAGE_NEW),
-    countRead(0),
-    writeState(MESSAGE_NEW),
-    countWrite(0)
+    countRead(0)
 {
     msgHeader.msgType = MESSAGE_INVALID;
     msgHeader.endian = myEndian;
@@ -322,8 +405,9 @@ _Message::_Message(BusAttachment& bus) :
 
 _Message::~_Message(void)
 {
-    delete [] _msgBuf;
+    FreeMsgBuf(_msgBuf);
     delete [] msgArgs;
+    delete argArena;
     while (numHandles) {
         qcc::Close(handles[--numHandles]);
     }
@@ -335,6 +419,7 @@ _Message::_Message(const _Message& other) :
     endianSwap(other.endianSwap),
     msgHeader(other.msgHeader),
     numMsgArgs(other.numMsgArgs),
+    argArena(NULL),
     bufSize(other.bufSize),
     ttl(other.ttl),
     timestamp(other.timestamp),
@@ -343,15 +428,15 @@ _Message::_Message(const _Message& other) :
     rcvEndpointName(other.rcvEndpointName),
     numHandles(other.numHandles),
     encrypt(other.encrypt),
+    encryptPending(false),
+    encryptStatus(ER_OK),
     readState(other.readState),
     countRead(other.countRead),
-    writeState(other.writeState),
-    countWrite(other.countWrite),
     hdrFields(other.hdrFields)
 {
     if (bufSize > 0) {
         assert(other.msgBuf != NULL);
-        _msgBuf = new uint8_t[bufSize + 7];
+        _msgBuf = AllocMsgBuf(bufSize + 7);
         msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7);
         bufEOD = ((uint8_t*)msgBuf) + (other.bufEOD - ((uint8_t*)other.msgBuf));
         bufPos = ((uint8_t*)msgBuf) + (other.bufPos - ((uint8_t*)other.msgBuf));
@@ -400,6 +485,8 @@ QStatus _Message::ReMarshal(const char* senderName)
     delete [] msgArgs;
     msgArgs = NULL;
     numMsgArgs = 0;
+    delete argArena;
+    argArena = NULL;
 
     /*
      * We delete the current buffer after we have copied the body data
@@ -415,7 +502,7 @@ QStatus _Message::ReMarshal(const char* senderName)
      * message reducing the places where we need to check for bufEOD when unmarshaling the body.
      */
     bufSize = sizeof(msgHeader) + ((((msgHeader.headerLen + 7) & ~7) + msgHeader.bodyLen + 7) & ~7) + 8;
-    _msgBuf = new uint8_t[bufSize + 7];
+    _msgBuf = AllocMsgBuf(bufSize + 7);
     msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
     bufPos = (uint8_t*)msgBuf;
     memcpy(bufPos, &msgHeader, sizeof(msgHeader));
@@ -448,7 +535,7 @@ QStatus _Message::ReMarshal(const char* senderName)
      */
     assert((size_t)(bufEOD - (uint8_t*)msgBuf) < bufSize);
     memset(bufEOD, 0, (uint8_t*)msgBuf + bufSize - bufEOD);
-    delete [] _savBuf;
+    FreeMsgBuf(_savBuf);
     return ER_OK;
 }
 
@@ -492,6 +579,8 @@ void _Message::ClearHeader()
         delete [] msgArgs;
         msgArgs = NULL;
         numMsgArgs = 0;
+        delete argArena;
+        argArena = NULL;
         ttl = 0;
         msgHeader.msgType = MESSAGE_INVALID;
         while (numHandles) {
@@ -42,6 +42,7 @@
 #include "AllJoynCrypto.h"
 #include "AllJoynPeerObj.h"
 #include "SignatureUtils.h"
+#include "MarshalPlan.h"
 #include "BusInternal.h"
 
 #define QCC_MODULE "ALLJOYN"
@@ -448,6 +449,150 @@ QStatus _Message::MarshalArgs(const MsgArg* arg, size_t numArgs)
     return status;
 }
 
+void _Message::MarshalFixed(const MarshalPlan& plan, size_t op, const MsgArg* arg, uint8_t* pos)
+{
+    const MarshalPlan::Op& o = plan.ops[op];
+
+    switch (o.typeId) {
+    case ALLJOYN_STRUCT:
+    {
+        size_t member = op + 1;
+        for (size_t i = 0; i < o.numMembers; ++i) {
+            MarshalFixed(plan, member, &arg->v_struct.members[i], pos + plan.ops[member].offset);
+            member = plan.ops[member].next;
+        }
+    }
+    break;
+
+    case ALLJOYN_BYTE:
+        *pos = arg->v_byte;
+        break;
+
+    case ALLJOYN_BOOLEAN:
+        *((uint32_t*)pos) = arg->v_bool ? (endianSwap ? EndianSwap32(1) : 1) : 0;
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        *((uint16_t*)pos) = endianSwap ? EndianSwap16(arg->v_uint16) : arg->v_uint16;
+        break;
+
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+        *((uint32_t*)pos) = endianSwap ? EndianSwap32(arg->v_uint32) : arg->v_uint32;
+        break;
+
+    default:
+        *((uint64_t*)pos) = endianSwap ? EndianSwap64(arg->v_uint64) : arg->v_uint64;
+        break;
+    }
+}
+
+QStatus _Message::MarshalPlanArg(const MarshalPlan& plan, size_t op, const MsgArg* arg)
+{
+    QStatus status = ER_OK;
+    const MarshalPlan::Op& o = plan.ops[op];
+    uint32_t len;
+
+    /*
+     * Args that were checked the slow way by MarshalPlan::GetSize() and types that don't benefit
+     * from the plan go through the generic marshaler.
+     */
+    if ((arg->typeId != o.typeId) || (o.code == MarshalPlan::OP_GENERIC) || (o.code == MarshalPlan::OP_SCALAR_ARRAY) ||
+        (o.code == MarshalPlan::OP_STRING) || (o.code == MarshalPlan::OP_SIGNATURE)) {
+        return MarshalArgs(arg, 1);
+    }
+    switch (o.code) {
+    case MarshalPlan::OP_FIXED:
+        MarshalPad(o.align);
+        /* Zero fill so the padding inside a struct is cleared */
+        memset(bufPos, 0, o.fixedSize);
+        MarshalFixed(plan, op, arg, bufPos);
+        bufPos += o.fixedSize;
+        break;
+
+    case MarshalPlan::OP_ARRAY:
+    {
+        const MarshalPlan::Op& elem = plan.ops[op + 1];
+        size_t numElements = arg->v_array.numElements;
+        MarshalPad(4);
+        uint8_t* lenPos = bufPos;
+        bufPos += 4;
+        /* Length does not include padding for first element */
+        MarshalPad(o.elemAlign);
+        uint8_t* elemPos = bufPos;
+        if (o.stride) {
+            /*
+             * Fixed size elements are written in place at a fixed distance from each other
+             */
+            if (numElements) {
+                size_t sz = (numElements - 1) * o.stride + elem.fixedSize;
+                memset(bufPos, 0, sz);
+                for (size_t i = 0; i < numElements; ++i) {
+                    MarshalFixed(plan, op + 1, &arg->v_array.elements[i], bufPos + i * o.stride);
+                }
+                bufPos += sz;
+            }
+        } else {
+            for (size_t i = 0; (status == ER_OK) && (i < numElements); ++i) {
+                status = MarshalPlanArg(plan, op + 1, &arg->v_array.elements[i]);
+            }
+        }
+        if (status == ER_OK) {
+            status = CheckedArraySize(bufPos - elemPos, len);
+        }
+        if (status == ER_OK) {
+            /* Patch in length */
+            uint8_t* tmpPos = bufPos;
+            bufPos = lenPos;
+            if (endianSwap) {
+                MarshalReversed(&len, 4);
+            } else {
+                Marshal4(len);
+            }
+            bufPos = tmpPos;
+        }
+    }
+    break;
+
+    case MarshalPlan::OP_STRUCT:
+    {
+        MarshalPad(8);
+        size_t member = op + 1;
+        for (size_t i = 0; (status == ER_OK) && (i < o.numMembers); ++i) {
+            status = MarshalPlanArg(plan, member, &arg->v_struct.members[i]);
+            member = plan.ops[member].next;
+        }
+    }
+    break;
+
+    case MarshalPlan::OP_DICT_ENTRY:
+        MarshalPad(8);
+        status = MarshalPlanArg(plan, op + 1, arg->v_dictEntry.key);
+        if (status == ER_OK) {
+            status = MarshalPlanArg(plan, plan.ops[op + 1].next, arg->v_dictEntry.val);
+        }
+        break;
+
+    default:
+        status = MarshalArgs(arg, 1);
+        break;
+    }
+    return status;
+}
+
+QStatus _Message::MarshalArgs(const MarshalPlan& plan, const MsgArg* args, size_t numArgs)
+{
+    QStatus status = ER_OK;
+    size_t op = 0;
+
+    for (size_t i = 0; (status == ER_OK) && (i < numArgs); ++i) {
+        status = MarshalPlanArg(plan, op, &args[i]);
+        op = plan.ops[op].next;
+    }
+    return status;
+}
+
 QStatus _Message::Deliver(RemoteEndpoint& endpoint)
 {
     QStatus status = ER_OK;
@@ -517,76 +662,98 @@ QStatus _Message::Deliver(RemoteEndpoint& endpoint)
     return status;
 }
 
-QStatus _Message::DeliverNonBlocking(RemoteEndpoint& endpoint)
+QStatus _Message::BeginDelivery(RemoteEndpoint& endpoint, WriteContext& context)
 {
-    size_t pushed;
     QStatus status = ER_OK;
-    Sink& sink = endpoint->GetSink();
-
-    switch (writeState) {
-    case MESSAGE_NEW:
-        writePtr = reinterpret_cast<uint8_t*>(msgBuf);
-        countWrite = bufEOD - writePtr;
-        pushed = 0;
 
-        if (countWrite == 0) {
-            status = ER_BUS_EMPTY_MESSAGE;
-            QCC_LogError(status, ("Message is empty"));
-            return status;
-        }
-        /*
-         * Handles can only be passed if that feature was negotiated.
-         */
-        if (handles && !endpoint->GetFeatures().handlePassing) {
-            status = ER_BUS_HANDLES_NOT_ENABLED;
-            QCC_LogError(status, ("Handle passing was not negotiated on this connection"));
-            return status;
-        }
+    if (bufEOD == reinterpret_cast<uint8_t*>(msgBuf)) {
+        status = ER_BUS_EMPTY_MESSAGE;
+        QCC_LogError(status, ("Message is empty"));
+        return status;
+    }
+    /*
+     * Handles can only be passed if that feature was negotiated.
+     */
+    if (handles && !endpoint->GetFeatures().handlePassing) {
+        status = ER_BUS_HANDLES_NOT_ENABLED;
+        QCC_LogError(status, ("Handle passing was not negotiated on this connection"));
+        return status;
+    }
+    /*
+     * If the message has a TTL, check if it has expired
+     */
+    if (ttl && IsExpired()) {
+        QCC_DbgHLPrintf(("TTL has expired - discarding message %s", Description().c_str()));
+        context.writeState = MESSAGE_COMPLETE;
+        return ER_OK;
+    }
+    /*
+     * Check if message needs to be encrypted. A message that was handed to a crypto worker has
+     * already been encrypted or has the status of the attempt.
+     */
+    if (encryptStatus != ER_OK) {
+        status = encryptStatus;
+        encryptStatus = ER_OK;
+    } else if (encrypt) {
+        status = EncryptMessage();
+    }
+    if (status != ER_OK) {
         /*
-         * If the message has a TTL, check if it has expired
+         * Delivery is retried when the authentication completes
          */
-        if (ttl && IsExpired()) {
-            QCC_DbgHLPrintf(("TTL has expired - discarding message %s", Description().c_str()));
+        if (status == ER_BUS_AUTHENTICATION_PENDING) {
+            context.writeState = MESSAGE_COMPLETE;
             return ER_OK;
         }
         /*
-         * Check if message needs to be encrypted
+         * A message that cannot be encrypted is not sent but the endpoint is still usable.
          */
-        if (encrypt) {
-            status = EncryptMessage();
-            /*
-             * Delivery is retried when the authentication completes
-             */
-            if (status == ER_BUS_AUTHENTICATION_PENDING) {
-                return ER_OK;
-            }
+        context.writeState = MESSAGE_COMPLETE;
+        return status;
+    }
+    context.writePtr = reinterpret_cast<const uint8_t*>(msgBuf);
+    context.countWrite = bufEOD - context.writePtr;
+    context.writeState = MESSAGE_HEADERFIELDS;
+    return status;
+}
+
+QStatus _Message::DeliverNonBlocking(RemoteEndpoint& endpoint, WriteContext& context)
+{
+    size_t pushed;
+    QStatus status = ER_OK;
+    Sink& sink = endpoint->GetSink();
+
+    switch (context.writeState) {
+    case MESSAGE_NEW:
+        status = BeginDelivery(endpoint, context);
+        if ((status != ER_OK) || (context.writeState == MESSAGE_COMPLETE)) {
+            return status;
         }
-        writeState = MESSAGE_HEADERFIELDS;
 
     case MESSAGE_HEADERFIELDS:
         if (handles) {
-            status = sink.PushBytesAndFds(writePtr, countWrite, pushed, handles, numHandles, endpoint->GetProcessId());
+            status = sink.PushBytesAndFds(context.writePtr, context.countWrite, pushed, handles, numHandles, endpoint->GetProcessId());
         } else {
-            status = sink.PushBytes(writePtr, countWrite, pushed, (msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) ? (ttl * 1000) : ttl);
+            status = sink.PushBytes(context.writePtr, context.countWrite, pushed, (msgHeader.flags & ALLJOYN_FLAG_SESSIONLESS) ? (ttl * 1000) : ttl);
         }
 
         if (status == ER_OK) {
-            countWrite -= pushed;
-            writePtr += pushed;
-            writeState = MESSAGE_HEADER_BODY;
+            context.countWrite -= pushed;
+            context.writePtr += pushed;
+            context.writeState = MESSAGE_HEADER_BODY;
         } else break;
 
     case MESSAGE_HEADER_BODY:
         status = ER_OK;
-        while (status == ER_OK && countWrite > 0) {
-            status = sink.PushBytes(writePtr, countWrite, pushed);
+        while (status == ER_OK && context.countWrite > 0) {
+            status = sink.PushBytes(context.writePtr, context.countWrite, pushed);
             if (status == ER_OK) {
-                countWrite -= pushed;
-                writePtr += pushed;
+                context.countWrite -= pushed;
+                context.writePtr += pushed;
             }
         }
-        if (countWrite == 0) {
-            writeState = MESSAGE_COMPLETE;
+        if (context.countWrite == 0) {
+            context.writeState = MESSAGE_COMPLETE;
         }
         break;
 
@@ -750,7 +917,7 @@ QStatus _Message::EncryptMessage()
     if (status == ER_OK) {
         size_t argsLen = msgHeader.bodyLen - ajn::Crypto::MACLength;
         size_t hdrLen = ROUNDUP8(sizeof(msgHeader) + msgHeader.headerLen);
-        status = ajn::Crypto::Encrypt(*this, key, (uint8_t*)msgBuf, hdrLen, argsLen);
+        status = ajn::Crypto::Encrypt(*this, key, (uint8_t*)msgBuf, hdrLen, argsLen, &peerState->GetCryptoContext(PEER_SESSION_KEY, true));
         if (status == ER_OK) {
             QCC_DbgHLPrintf(("EncryptMessage: %s", Description().c_str()));
             /*
@@ -783,16 +950,29 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
                                  const MsgArg* args,
                                  uint8_t numArgs,
                                  uint8_t flags,
-                                 uint32_t sessionId)
+                                 uint32_t sessionId,
+                                 const MarshalPlan* plan)
 {
     char signature[256];
     QStatus status = ER_OK;
-    size_t argsLen = (numArgs == 0) ? 0 : SignatureUtils::GetSize(args, numArgs);
+    QStatus planStatus = ER_OK;
+    size_t argsLen = 0;
     size_t hdrLen = 0;
 
     if (!bus->IsStarted()) {
         return ER_BUS_BUS_NOT_STARTED;
     }
+    /*
+     * A plan checks the args and computes their size in one pass without building a signature.
+     */
+    if (plan && (plan->GetSignature() != expectedSignature)) {
+        plan = NULL;
+    }
+    if (plan) {
+        planStatus = plan->GetSize(args, numArgs, argsLen);
+    } else if (numArgs > 0) {
+        argsLen = SignatureUtils::GetSize(args, numArgs);
+    }
     /*
      * Check if endianess needs to be swapped.
      */
@@ -858,7 +1038,16 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      * If there are arguments build the signature
      */
     hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].Clear();
-    if (numArgs > 0) {
+    if (plan) {
+        if (planStatus != ER_OK) {
+            status = planStatus;
+            QCC_LogError(status, ("MarshalMessage args do not match expected signature \"%s\"", expectedSignature.c_str()));
+            goto ExitMarshalMessage;
+        }
+        hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].typeId = ALLJOYN_SIGNATURE;
+        hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].v_signature.sig = plan->GetSignature().c_str();
+        hdrFields.field[ALLJOYN_HDR_FIELD_SIGNATURE].v_signature.len = (uint8_t)plan->GetSignature().size();
+    } else if (numArgs > 0) {
         size_t sigLen = 0;
         status = SignatureUtils::MakeSignature(args, numArgs, signature, sigLen);
         if (status != ER_OK) {
@@ -875,7 +1064,7 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
     /*
      * Check the signature computed from the args matches the expected signature.
      */
-    if (expectedSignature != signature) {
+    if (!plan && (expectedSignature != signature)) {
         status = ER_BUS_UNEXPECTED_SIGNATURE;
         QCC_LogError(status, ("MarshalMessage expected signature \"%s\" got \"%s\"", expectedSignature.c_str(), signature));
         goto ExitMarshalMessage;
@@ -911,7 +1100,7 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      * Allocate buffer for entire message.
      */
     bufSize = (hdrLen + msgHeader.bodyLen + 7);
-    _msgBuf = new uint8_t[bufSize + 7];
+    _msgBuf = AllocMsgBuf(bufSize + 7);
     msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
     /*
      * Initialize the buffer and copy in the message header
@@ -951,7 +1140,11 @@ QStatus _Message::MarshalMessage(const qcc::String& expectedSignature,
      * Marshal the message body
      */
     bodyPtr = bufPos;
-    status = MarshalArgs(args, numArgs);
+    if (plan) {
+        status = MarshalArgs(*plan, args, numArgs);
+    } else {
+        status = MarshalArgs(args, numArgs);
+    }
     if (status != ER_OK) {
         goto ExitMarshalMessage;
     }
@@ -982,14 +1175,14 @@ ExitMarshalMessage:
     /*
      * Don't need the old message buffer any more
      */
-    delete [] _oldMsgBuf;
+    FreeMsgBuf(_oldMsgBuf);
 
     if (status == ER_OK) {
         QCC_DbgHLPrintf(("MarshalMessage: %d+%d %s %s", hdrLen, msgHeader.bodyLen, Description().c_str(), encrypt ? " (encrypted)" : ""));
     } else {
         QCC_LogError(status, ("MarshalMessage: %s", Description().c_str()));
         msgBuf = NULL;
-        delete [] _msgBuf;
+        FreeMsgBuf(_msgBuf);
         _msgBuf = NULL;
         bodyPtr = NULL;
         bufPos = NULL;
@@ -1084,7 +1277,8 @@ QStatus _Message::CallMsg(const qcc::String& signature,
                           const qcc::String& methodName,
                           const MsgArg* args,
                           size_t numArgs,
-                          uint8_t flags)
+                          uint8_t flags,
+                          const MarshalPlan* plan)
 {
     QStatus status;
 
@@ -1136,7 +1330,7 @@ QStatus _Message::CallMsg(const qcc::String& signature,
     /*
      * Build method call message
      */
-    status = MarshalMessage(signature, destination, MESSAGE_METHOD_CALL, args, numArgs, flags, sessionId);
+    status = MarshalMessage(signature, destination, MESSAGE_METHOD_CALL, args, numArgs, flags, sessionId, plan);
 
 ExitCallMsg:
     return status;
@@ -1152,7 +1346,8 @@ QStatus _Message::SignalMsg(const qcc::String& signature,
                             const MsgArg* args,
                             size_t numArgs,
                             uint8_t flags,
-                            uint16_t timeToLive)
+                            uint16_t timeToLive,
+                            const MarshalPlan* plan)
 {
     QStatus status;
 
@@ -1211,7 +1406,7 @@ QStatus _Message::SignalMsg(const qcc::String& signature,
     /*
      * Build signal message
      */
-    status = MarshalMessage(signature, destination, MESSAGE_SIGNAL, args, numArgs, flags, sessionId);
+    status = MarshalMessage(signature, destination, MESSAGE_SIGNAL, args, numArgs, flags, sessionId, plan);
 
 ExitSignalMsg:
     return status;
@@ -1244,7 +1439,7 @@ QStatus _Message::ReplyMsg(const Message& call, const MsgArg* args, size_t numAr
      * Build method return message (encrypted if the method call was encrypted)
      */
     status = MarshalMessage(call->replySignature, destination, MESSAGE_METHOD_RET, args,
-                            numArgs, call->msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED, sessionId);
+                            numArgs, call->msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED, sessionId, MarshalPlan::Get(call->replySignature));
 
     return status;
 }
@@ -31,6 +31,7 @@
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/Message.h>
+#include <alljoyn/MsgCursor.h>
 
 #include "Router.h"
 #include "KeyStore.h"
@@ -38,6 +39,7 @@
 #include "PeerState.h"
 #include "CompressionRules.h"
 #include "BusUtil.h"
+#include "MsgArgArena.h"
 #include "AllJoynCrypto.h"
 #include "AllJoynPeerObj.h"
 #include "SignatureUtils.h"
@@ -118,13 +120,17 @@ QStatus _Message::ParseArray(MsgArg* arg,
             arg->typeId = (AllJoynTypeId)((elemTypeId << 8) | ALLJOYN_ARRAY);
             arg->v_scalarArray.numElements = (size_t)(len / 2);
             if (endianSwap) {
-                arg->v_scalarArray.v_uint16 = new uint16_t[arg->v_scalarArray.numElements];
+                if (argArena) {
+                    arg->v_scalarArray.v_uint16 = (uint16_t*)argArena->Alloc(len);
+                } else {
+                    arg->v_scalarArray.v_uint16 = new uint16_t[arg->v_scalarArray.numElements];
+                    arg->flags = MsgArg::OwnsData;
+                }
                 uint16_t* p = (uint16_t*)arg->v_scalarArray.v_uint16;
                 uint16_t* n = (uint16_t*)bufPos;
                 for (size_t i = 0; i < arg->v_scalarArray.numElements; i++) {
                     *p++ = EndianSwap16(*n++);
                 }
-                arg->flags = MsgArg::OwnsData;
             } else {
                 arg->v_scalarArray.v_uint16 = (uint16_t*)bufPos;
             }
@@ -137,14 +143,16 @@ QStatus _Message::ParseArray(MsgArg* arg,
     case ALLJOYN_BOOLEAN:
         if ((len & 3) == 0) {
             size_t num = (size_t)(len / 4);
-            bool* bools = new bool[num];
+            bool* bools = argArena ? (bool*)argArena->Alloc(num * sizeof(bool)) : new bool[num];
             for (size_t i = 0; i < num; i++) {
                 uint32_t b = *(uint32_t*)bufPos;
                 if (endianSwap) {
                     b = EndianSwap32(b);
                 }
                 if (b > 1) {
-                    delete [] bools;
+                    if (!argArena) {
+                        delete [] bools;
+                    }
                     status = ER_BUS_BAD_VALUE;
                     break;
                 }
@@ -163,7 +171,9 @@ QStatus _Message::ParseArray(MsgArg* arg,
             arg->typeId = ALLJOYN_BOOLEAN_ARRAY;
             arg->v_scalarArray.numElements = num;
             arg->v_scalarArray.v_bool = bools;
-            arg->flags = MsgArg::OwnsData;
+            if (!argArena) {
+                arg->flags = MsgArg::OwnsData;
+            }
         } else {
             status = ER_BUS_BAD_LENGTH;
         }
@@ -175,13 +185,17 @@ QStatus _Message::ParseArray(MsgArg* arg,
             arg->typeId = (AllJoynTypeId)((elemTypeId << 8) | ALLJOYN_ARRAY);
             arg->v_scalarArray.numElements = (size_t)(len / 4);
             if (endianSwap) {
-                arg->v_scalarArray.v_uint32 = new uint32_t[arg->v_scalarArray.numElements];
+                if (argArena) {
+                    arg->v_scalarArray.v_uint32 = (uint32_t*)argArena->Alloc(len);
+                } else {
+                    arg->v_scalarArray.v_uint32 = new uint32_t[arg->v_scalarArray.numElements];
+                    arg->flags = MsgArg::OwnsData;
+                }
                 uint32_t* p = (uint32_t*)arg->v_scalarArray.v_uint32;
                 uint32_t* n = (uint32_t*)bufPos;
                 for (size_t i = 0; i < arg->v_scalarArray.numElements; i++) {
                     *p++ = EndianSwap32(*n++);
                 }
-                arg->flags = MsgArg::OwnsData;
             } else {
                 arg->v_scalarArray.v_uint32 = (uint32_t*)bufPos;
             }
@@ -200,13 +214,17 @@ QStatus _Message::ParseArray(MsgArg* arg,
             bufPos = AlignPtr(bufPos, 8);
             arg->v_scalarArray.v_uint64 = (uint64_t*)bufPos;
             if (endianSwap) {
-                arg->v_scalarArray.v_uint64 = new uint64_t[arg->v_scalarArray.numElements];
+                if (argArena) {
+                    arg->v_scalarArray.v_uint64 = (uint64_t*)argArena->Alloc(len);
+                } else {
+                    arg->v_scalarArray.v_uint64 = new uint64_t[arg->v_scalarArray.numElements];
+                    arg->flags = MsgArg::OwnsData;
+                }
                 uint64_t* p = (uint64_t*)arg->v_scalarArray.v_uint64;
                 uint64_t* n = (uint64_t*)bufPos;
                 for (size_t i = 0; i < arg->v_scalarArray.numElements; i++) {
                     *p++ = EndianSwap64(*n++);
                 }
-                arg->flags = MsgArg::OwnsData;
             } else {
                 arg->v_scalarArray.v_uint64 = (uint64_t*)bufPos;
             }
@@ -227,7 +245,13 @@ QStatus _Message::ParseArray(MsgArg* arg,
     /* Falling through */
     default:
     {
-        qcc::String elemSig(sigStart, sigPtr - sigStart);
+        /*
+         * Signatures are never longer than 255 characters
+         */
+        char elemSig[256];
+        size_t elemSigLen = sigPtr - sigStart;
+        memcpy(elemSig, sigStart, elemSigLen);
+        elemSig[elemSigLen] = 0;
         size_t numElements = 0;
         MsgArg* elements = NULL;
         if (len > 0) {
@@ -238,12 +262,15 @@ QStatus _Message::ParseArray(MsgArg* arg,
             uint8_t* endOfArray = bufPos + len;
             size_t capacity = 8;
             numElements = 0;
-            elements = new MsgArg[capacity];
+            elements = argArena ? argArena->NewArgs(capacity) : new MsgArg[capacity];
             /*
              * Loop until we have consumed all of the data bytes
              */
             while (bufPos < endOfArray) {
-                if (numElements == capacity) {
+                if ((numElements == capacity) && argArena) {
+                    elements = argArena->GrowArgs(elements, capacity, capacity * 2);
+                    capacity *= 2;
+                } else if (numElements == capacity) {
                     capacity *= 2;
                     MsgArg* bigger = new MsgArg[capacity];
                     memcpy(bigger, elements, numElements * sizeof(MsgArg));
@@ -257,7 +284,7 @@ QStatus _Message::ParseArray(MsgArg* arg,
                     delete [] elements;
                     elements = bigger;
                 }
-                const char* esig = elemSig.c_str();
+                const char* esig = elemSig;
                 status = ParseValue(&elements[numElements++], esig, true);
                 if (status != ER_OK) {
                     break;
@@ -265,9 +292,11 @@ QStatus _Message::ParseArray(MsgArg* arg,
             }
         }
         if (status == ER_OK) {
-            arg->v_array.SetElements(elemSig.c_str(), numElements, elements);
-            arg->flags |= MsgArg::OwnsArgs;
-        } else {
+            arg->v_array.SetElements(elemSig, numElements, elements);
+            if (!argArena) {
+                arg->flags |= MsgArg::OwnsArgs;
+            }
+        } else if (!argArena) {
             delete [] elements;
         }
     }
@@ -302,8 +331,12 @@ QStatus _Message::ParseStruct(MsgArg* arg, const char*& sigPtr)
 
     QCC_DbgPrintf(("ParseStruct at pos:%d", bufPos - bodyPtr));
 
-    arg->v_struct.members = new MsgArg[arg->v_struct.numMembers];
-    arg->flags |= MsgArg::OwnsArgs;
+    if (argArena) {
+        arg->v_struct.members = argArena->NewArgs(arg->v_struct.numMembers);
+    } else {
+        arg->v_struct.members = new MsgArg[arg->v_struct.numMembers];
+        arg->flags |= MsgArg::OwnsArgs;
+    }
     for (uint32_t i = 0; i < arg->v_struct.numMembers; ++i) {
         status = ParseValue(&arg->v_struct.members[i], memberSig);
         if (status != ER_OK) {
@@ -337,9 +370,15 @@ QStatus _Message::ParseDictEntry(MsgArg* arg,
 
         QCC_DbgPrintf(("ParseDictEntry at pos:%d", bufPos - bodyPtr));
 
-        arg->v_dictEntry.key = new MsgArg();
-        arg->v_dictEntry.val = new MsgArg();
-        arg->flags |= MsgArg::OwnsArgs;
+        if (argArena) {
+            MsgArg* keyVal = argArena->NewArgs(2);
+            arg->v_dictEntry.key = &keyVal[0];
+            arg->v_dictEntry.val = &keyVal[1];
+        } else {
+            arg->v_dictEntry.key = new MsgArg();
+            arg->v_dictEntry.val = new MsgArg();
+            arg->flags |= MsgArg::OwnsArgs;
+        }
         status = ParseValue(arg->v_dictEntry.key, memberSig);
         if (status == ER_OK) {
             status = ParseValue(arg->v_dictEntry.val, memberSig);
@@ -366,15 +405,21 @@ QStatus _Message::ParseVariant(MsgArg* arg)
     } else if (*bufPos++ != 0) {
         status = ER_BUS_BAD_SIGNATURE;
     } else {
-        arg->v_variant.val = new MsgArg();
-        arg->flags |= MsgArg::OwnsArgs;
+        if (argArena) {
+            arg->v_variant.val = argArena->NewArgs(1);
+        } else {
+            arg->v_variant.val = new MsgArg();
+            arg->flags |= MsgArg::OwnsArgs;
+        }
         status = ParseValue(arg->v_variant.val, sigPtr);
         if ((status == ER_OK) && (*sigPtr != 0)) {
             status = ER_BUS_BAD_SIGNATURE;
         }
     }
     if (status != ER_OK) {
-        delete arg->v_variant.val;
+        if (!argArena) {
+            delete arg->v_variant.val;
+        }
         arg->typeId = ALLJOYN_INVALID;
     }
     return status;
@@ -565,6 +610,13 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
     if (msgArgs != NULL) {
         return ER_OK;
     }
+    /*
+     * Nothing in the arena is in use until msgArgs is set. Release anything left over from an
+     * earlier call that returned before the arena could be reset so it does not accumulate.
+     */
+    if (argArena) {
+        argArena->Reset();
+    }
 
     if (!bus->IsStarted()) {
         return ER_BUS_BUS_NOT_STARTED;
@@ -612,7 +664,8 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
          * algorithm adds appends a MAC block to the end of the encrypted data.
          */
         size_t bodyLen = msgHeader.bodyLen;
-        status = ajn::Crypto::Decrypt(*this, key, (uint8_t*)msgBuf, hdrLen, bodyLen);
+        status = ajn::Crypto::Decrypt(*this, key, (uint8_t*)msgBuf, hdrLen, bodyLen,
+                                      &peerState->GetCryptoContext(broadcast ? PEER_GROUP_KEY : PEER_SESSION_KEY, false));
         if (status != ER_OK) {
             goto ExitUnmarshalArgs;
         }
@@ -624,6 +677,14 @@ QStatus _Message::UnmarshalArgs(const qcc::String& expectedSignature, const char
      */
     _numMsgArgs = SignatureUtils::CountCompleteTypes(sig);
     _msgArgs = new MsgArg[_numMsgArgs];
+    /*
+     * The MsgArgs nested in the arguments are allocated from an arena that is freed in one step
+     * when the arguments are released. Unmarshaled MsgArgs typically take up a few times the space
+     * of the body on the wire.
+     */
+    if (!argArena) {
+        argArena = new MsgArgArena(4 * msgHeader.bodyLen);
+    }
 
     /*
      * Unmarshal the body values
@@ -671,6 +732,9 @@ ExitUnmarshalArgs:
         if (_msgArgs) {
             delete [] _msgArgs;
         }
+        if (argArena) {
+            argArena->Reset();
+        }
         QCC_LogError(status, ("UnmarshalArgs failed"));
     }
     return status;
@@ -890,7 +954,7 @@ QStatus _Message::InterpretHeader()
      * message reducing the places where we need to check for bufEOD when unmarshaling the body.
      */
     bufSize = sizeof(msgHeader) + ((pktSize + 7) & ~7) + sizeof(uint64_t);
-    _msgBuf = new uint8_t[bufSize + 7];
+    _msgBuf = AllocMsgBuf(bufSize + 7);
     msgBuf = (uint64_t*)((uintptr_t)(_msgBuf + 7) & ~7); /* Align to 8 byte boundary */
     /*
      * Copy header into the buffer
@@ -952,7 +1016,7 @@ QStatus _Message::PullBytes(RemoteEndpoint& endpoint, bool checkSender, bool ped
                 memcpy(handles, fdList, numHandles * sizeof(qcc::SocketFd));
             }
         } else {
-            status = source.PullBytes(bufPos, toRead, read, timeout);
+            status = endpoint->PullMessageBytes(bufPos, toRead, read, timeout);
         }
         bufPos += read;
         countRead -= read;
@@ -968,7 +1032,7 @@ QStatus _Message::PullBytes(RemoteEndpoint& endpoint, bool checkSender, bool ped
     case MESSAGE_HEADER_BODY:
         /* Read the rest of the message header and body */
         toRead = (std::min)(countRead, MAX_PULL);
-        status = source.PullBytes(bufPos, toRead, read, timeout);
+        status = endpoint->PullMessageBytes(bufPos, toRead, read, timeout);
         if (status == ER_ALERTED_THREAD) {
             QCC_LogError(status, ("PullBytes ALERTED continuing"));
             status = ER_OK;
@@ -1016,7 +1080,7 @@ QStatus _Message::Read(RemoteEndpoint& endpoint, bool checkSender, bool pedantic
      * Clear out any stale message state
      */
     msgBuf = NULL;
-    delete [] _msgBuf;
+    FreeMsgBuf(_msgBuf);
     _msgBuf = NULL;
     ClearHeader();
     readState = MESSAGE_NEW;
@@ -1270,7 +1334,7 @@ ExitUnmarshal:
          * There was an unrecoverable failure while unmarshaling the message, cleanup before we return.
          */
         msgBuf = NULL;
-        delete [] _msgBuf;
+        FreeMsgBuf(_msgBuf);
         _msgBuf = NULL;
         ClearHeader();
         if ((status != ER_SOCK_OTHER_END_CLOSED) && (status != ER_STOPPING_THREAD)) {
@@ -1356,4 +1420,429 @@ ExitAddExpansion:
     return status;
 }
 
+/*
+ * The cursor type for a signature character, struct and dictionary entry open characters are
+ * reported as the container type.
+ */
+static inline AllJoynTypeId CursorTypeId(char c)
+{
+    switch (c) {
+    case ALLJOYN_STRUCT_OPEN:
+        return ALLJOYN_STRUCT;
+
+    case ALLJOYN_DICT_ENTRY_OPEN:
+        return ALLJOYN_DICT_ENTRY;
+
+    default:
+        return (AllJoynTypeId)c;
+    }
+}
+
+MsgCursor::MsgCursor(Message& msg) :
+    msg(msg),
+    parser(*msg->bus),
+    pos(NULL),
+    eod(NULL),
+    endianSwap(false),
+    status(ER_OK),
+    depth(0)
+{
+    levels[0].typeId = ALLJOYN_INVALID;
+    levels[0].sig = "";
+    levels[0].nextSig = "";
+    levels[0].end = NULL;
+
+    if ((msg->msgHeader.msgType == MESSAGE_INVALID) || !msg->msgBuf) {
+        status = ER_FAIL;
+        return;
+    }
+    /*
+     * Encrypted bodies are decrypted in place when the arguments are unmarshaled.
+     */
+    if ((msg->msgHeader.flags & ALLJOYN_FLAG_ENCRYPTED) && !msg->msgArgs) {
+        status = msg->UnmarshalArgs("*");
+        if (status != ER_OK) {
+            return;
+        }
+    }
+    /*
+     * UnmarshalArgs() marks the message as native endian once the arguments have been converted,
+     * the byte order of the body is the one recorded in the buffered header.
+     */
+    endianSwap = (*((const char*)msg->msgBuf) != _Message::myEndian);
+    pos = msg->bodyPtr;
+    eod = msg->bufEOD;
+    levels[0].sig = msg->GetSignature();
+    levels[0].end = msg->bodyPtr + msg->msgHeader.bodyLen;
+    /*
+     * Values are decoded by a parser of our own that reads the body of msg so the parse state of
+     * msg is never touched. The parser borrows the handles of msg without owning them.
+     */
+    parser->bodyPtr = msg->bodyPtr;
+    parser->bufEOD = eod;
+    parser->endianSwap = endianSwap;
+    parser->hdrFields.field[ALLJOYN_HDR_FIELD_HANDLES] = msg->hdrFields.field[ALLJOYN_HDR_FIELD_HANDLES];
+    parser->handles = msg->handles;
+}
+
+MsgCursor::~MsgCursor()
+{
+    parser->handles = NULL;
+}
+
+AllJoynTypeId MsgCursor::GetTypeId() const
+{
+    const Level& level = levels[depth];
+    if (status != ER_OK) {
+        return ALLJOYN_INVALID;
+    }
+    if (level.typeId == ALLJOYN_ARRAY) {
+        return (pos < level.end) ? CursorTypeId(*level.sig) : ALLJOYN_INVALID;
+    }
+    switch (*level.sig) {
+    case 0:
+    case ALLJOYN_STRUCT_CLOSE:
+    case ALLJOYN_DICT_ENTRY_CLOSE:
+        return ALLJOYN_INVALID;
+
+    default:
+        return CursorTypeId(*level.sig);
+    }
+}
+
+void MsgCursor::Advance(const char* sigPtr)
+{
+    /*
+     * Every element of an array has the same signature
+     */
+    if (levels[depth].typeId != ALLJOYN_ARRAY) {
+        levels[depth].sig = sigPtr;
+    }
+}
+
+QStatus MsgCursor::ReadLength(uint32_t& len)
+{
+    pos = AlignPtr(pos, 4);
+    if ((pos + 4) > eod) {
+        return ER_BUS_BAD_LENGTH;
+    }
+    if (endianSwap) {
+        len = EndianSwap32(*((uint32_t*)pos));
+    } else {
+        len = *((uint32_t*)pos);
+    }
+    pos += 4;
+    if (len > (size_t)(eod - pos)) {
+        return ER_BUS_BAD_LENGTH;
+    }
+    return ER_OK;
+}
+
+QStatus MsgCursor::SkipValue(const char*& sigPtr)
+{
+    QStatus result = ER_OK;
+    uint32_t len;
+
+    switch (AllJoynTypeId typeId = (AllJoynTypeId)(*sigPtr++)) {
+    case ALLJOYN_BYTE:
+        pos += 1;
+        break;
+
+    case ALLJOYN_INT16:
+    case ALLJOYN_UINT16:
+        pos = AlignPtr(pos, 2) + 2;
+        break;
+
+    case ALLJOYN_BOOLEAN:
+    case ALLJOYN_INT32:
+    case ALLJOYN_UINT32:
+    case ALLJOYN_HANDLE:
+        pos = AlignPtr(pos, 4) + 4;
+        break;
+
+    case ALLJOYN_DOUBLE:
+    case ALLJOYN_INT64:
+    case ALLJOYN_UINT64:
+        pos = AlignPtr(pos, 8) + 8;
+        break;
+
+    case ALLJOYN_OBJECT_PATH:
+    case ALLJOYN_STRING:
+        result = ReadLength(len);
+        pos += len + 1;
+        break;
+
+    case ALLJOYN_SIGNATURE:
+        if (pos >= eod) {
+            result = ER_BUS_BAD_LENGTH;
+        } else {
+            pos += *pos + 2;
+        }
+        break;
+
+    case ALLJOYN_ARRAY:
+    {
+        /*
+         * Arrays are skipped using their length, the elements are not looked at
+         */
+        const char* elemSig = sigPtr;
+        result = ReadLength(len);
+        if (result == ER_OK) {
+            result = SignatureUtils::ParseCompleteType(sigPtr);
+        }
+        if (result == ER_OK) {
+            pos = AlignPtr(pos, SignatureUtils::AlignmentForType(CursorTypeId(*elemSig)));
+            pos += len;
+        }
+    }
+    break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    case ALLJOYN_DICT_ENTRY_OPEN:
+    {
+        char close = (typeId == ALLJOYN_STRUCT_OPEN) ? ALLJOYN_STRUCT_CLOSE : ALLJOYN_DICT_ENTRY_CLOSE;
+        pos = AlignPtr(pos, 8);
+        while ((result == ER_OK) && (*sigPtr != close)) {
+            result = SkipValue(sigPtr);
+        }
+        if (result == ER_OK) {
+            ++sigPtr;
+        }
+    }
+    break;
+
+    case ALLJOYN_VARIANT:
+    {
+        if (pos >= eod) {
+            result = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        len = *pos;
+        const char* variantSig = (const char*)(pos + 1);
+        pos += len + 2;
+        if (pos > eod) {
+            result = ER_BUS_BAD_LENGTH;
+        } else if (variantSig[len] != 0) {
+            result = ER_BUS_BAD_SIGNATURE;
+        } else {
+            result = SkipValue(variantSig);
+            if ((result == ER_OK) && (*variantSig != 0)) {
+                result = ER_BUS_BAD_SIGNATURE;
+            }
+        }
+    }
+    break;
+
+    default:
+        result = ER_BUS_BAD_SIGNATURE;
+        break;
+    }
+    if ((result == ER_OK) && (pos > eod)) {
+        result = ER_BUS_BAD_LENGTH;
+    }
+    return result;
+}
+
+QStatus MsgCursor::Next(MsgArg& arg)
+{
+    if (status != ER_OK) {
+        return status;
+    }
+    if (AtEnd()) {
+        return ER_BUS_END_OF_ARGS;
+    }
+    Level& level = levels[depth];
+    const char* sigPtr = level.sig;
+    /*
+     * The parser has no arena so the value is owned by arg
+     */
+    parser->bufPos = pos;
+    QStatus result = parser->ParseValue(&arg, sigPtr, level.typeId == ALLJOYN_ARRAY);
+    pos = parser->bufPos;
+    if (result == ER_OK) {
+        Advance(sigPtr);
+    }
+    return result;
+}
+
+QStatus MsgCursor::Skip()
+{
+    if (status != ER_OK) {
+        return status;
+    }
+    if (AtEnd()) {
+        return ER_BUS_END_OF_ARGS;
+    }
+    const char* sigPtr = levels[depth].sig;
+    QStatus result = SkipValue(sigPtr);
+    if (result == ER_OK) {
+        Advance(sigPtr);
+    }
+    return result;
+}
+
+QStatus MsgCursor::Get(const char* signature, ...)
+{
+    size_t sigLen = (signature ? strlen(signature) : 0);
+    if (sigLen == 0) {
+        return ER_BAD_ARG_1;
+    }
+    QStatus result = Next(value);
+    if (result == ER_OK) {
+        va_list argp;
+        va_start(argp, signature);
+        result = MsgArg::VParseArgs(signature, sigLen, &value, 1, &argp);
+        va_end(argp);
+    }
+    return result;
+}
+
+QStatus MsgCursor::Enter()
+{
+    if (status != ER_OK) {
+        return status;
+    }
+    if (AtEnd()) {
+        return ER_BUS_END_OF_ARGS;
+    }
+    if (depth == MAX_DEPTH) {
+        return ER_BUS_BAD_SIGNATURE;
+    }
+    const char* sigPtr = levels[depth].sig;
+    Level& inner = levels[depth + 1];
+    QStatus result = ER_OK;
+    uint32_t len;
+
+    switch (*sigPtr) {
+    case ALLJOYN_ARRAY:
+        inner.typeId = ALLJOYN_ARRAY;
+        inner.sig = sigPtr + 1;
+        inner.nextSig = inner.sig;
+        result = ReadLength(len);
+        if (result == ER_OK) {
+            result = SignatureUtils::ParseCompleteType(inner.nextSig);
+        }
+        if (result == ER_OK) {
+            /*
+             * The array length does not include the padding before the first element
+             */
+            pos = AlignPtr(pos, SignatureUtils::AlignmentForType(CursorTypeId(*inner.sig)));
+            if (len > (size_t)(eod - pos)) {
+                result = ER_BUS_BAD_LENGTH;
+            } else {
+                inner.end = pos + len;
+            }
+        }
+        break;
+
+    case ALLJOYN_STRUCT_OPEN:
+    case ALLJOYN_DICT_ENTRY_OPEN:
+        pos = AlignPtr(pos, 8);
+        inner.typeId = CursorTypeId(*sigPtr);
+        inner.sig = sigPtr + 1;
+        inner.nextSig = sigPtr;
+        inner.end = levels[depth].end;
+        result = SignatureUtils::ParseCompleteType(inner.nextSig);
+        break;
+
+    case ALLJOYN_VARIANT:
+        if (pos >= eod) {
+            result = ER_BUS_BAD_LENGTH;
+            break;
+        }
+        len = *pos;
+        inner.typeId = ALLJOYN_VARIANT;
+        inner.sig = (const char*)(pos + 1);
+        inner.nextSig = sigPtr + 1;
+        inner.end = levels[depth].end;
+        pos += len + 2;
+        if (pos > eod) {
+            result = ER_BUS_BAD_LENGTH;
+        } else if (inner.sig[len] != 0) {
+            result = ER_BUS_BAD_SIGNATURE;
+        }
+        break;
+
+    default:
+        result = ER_BUS_BAD_VALUE;
+        break;
+    }
+    if (result == ER_OK) {
+        ++depth;
+    }
+    return result;
+}
+
+QStatus MsgCursor::Leave()
+{
+    if (status != ER_OK) {
+        return status;
+    }
+    if (depth == 0) {
+        return ER_FAIL;
+    }
+    QStatus result = ER_OK;
+    if (levels[depth].typeId == ALLJOYN_ARRAY) {
+        pos = levels[depth].end;
+    } else {
+        while ((result == ER_OK) && !AtEnd()) {
+            result = Skip();
+        }
+    }
+    if (result == ER_OK) {
+        const char* nextSig = levels[depth].nextSig;
+        --depth;
+        Advance(nextSig);
+    }
+    return result;
+}
+
+QStatus MsgCursor::Lookup(const char* key, MsgArg& value)
+{
+    if (status != ER_OK) {
+        return status;
+    }
+    if (AtEnd()) {
+        return ER_BUS_END_OF_ARGS;
+    }
+    const char* sigPtr = levels[depth].sig;
+    if ((sigPtr[0] != ALLJOYN_ARRAY) || (sigPtr[1] != ALLJOYN_DICT_ENTRY_OPEN) || (sigPtr[2] != ALLJOYN_STRING)) {
+        return ER_BUS_NOT_A_DICTIONARY;
+    }
+    /*
+     * On an error the cursor is put back on the dictionary
+     */
+    size_t startDepth = depth;
+    uint8_t* startPos = pos;
+    bool found = false;
+    QStatus result = Enter();
+    while ((result == ER_OK) && !found && !AtEnd()) {
+        result = Enter();
+        if (result == ER_OK) {
+            /*
+             * Decoding a string key does not allocate, the key points into the message body
+             */
+            MsgArg entryKey;
+            result = Next(entryKey);
+            if ((result == ER_OK) && (strcmp(entryKey.v_string.str, key) == 0)) {
+                result = Next(value);
+                found = (result == ER_OK);
+            }
+        }
+        if (result == ER_OK) {
+            result = Leave();
+        }
+    }
+    if (result == ER_OK) {
+        result = Leave();
+    }
+    if ((result == ER_OK) && !found) {
+        result = ER_BUS_ELEMENT_NOT_FOUND;
+    } else if (result != ER_OK) {
+        depth = startDepth;
+        pos = startPos;
+    }
+    return result;
+}
+
 }
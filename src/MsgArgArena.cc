@@ -0,0 +1,161 @@
+/**
+ * @file
+ *
+ * This file implements the bump allocator used for unmarshaled MsgArg trees.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <assert.h>
+#include <string.h>
+#include <new>
+#include <algorithm>
+
+#include <alljoyn/MsgArg.h>
+
+#include "MsgArgArena.h"
+
+#define QCC_MODULE "ALLJOYN"
+
+namespace ajn {
+
+/* Smallest and largest block sizes */
+static const size_t MIN_BLOCK_SIZE = 512;
+static const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+#define ROUND8(n) (((n) + 7) & ~((size_t)7))
+
+#define BLOCK_HDR_LEN ROUND8(sizeof(Block))
+#define RUN_HDR_LEN   ROUND8(sizeof(Run))
+
+#define BLOCK_DATA(b) (reinterpret_cast<uint8_t*>(b) + BLOCK_HDR_LEN)
+#define RUN_ARGS(r)   reinterpret_cast<MsgArg*>(reinterpret_cast<uint8_t*>(r) + RUN_HDR_LEN)
+#define RUN_LEN(n)    ROUND8(RUN_HDR_LEN + (n) * sizeof(MsgArg))
+
+MsgArgArena::MsgArgArena(size_t sizeHint) :
+    blocks(NULL),
+    runs(NULL),
+    nextBlockSize((std::min)((std::max)(ROUND8(sizeHint), MIN_BLOCK_SIZE), MAX_BLOCK_SIZE)),
+    numBlocks(0)
+{
+}
+
+MsgArgArena::~MsgArgArena()
+{
+    Reset();
+    FreeBlocks(NULL);
+}
+
+MsgArgArena::Block* MsgArgArena::NewBlock(size_t minLen)
+{
+    size_t size = (std::max)(nextBlockSize, minLen);
+    Block* block = reinterpret_cast<Block*>(new uint64_t[(BLOCK_HDR_LEN + size) / sizeof(uint64_t)]);
+    block->next = blocks;
+    block->size = size;
+    block->used = 0;
+    blocks = block;
+    nextBlockSize = (std::min)(nextBlockSize * 2, MAX_BLOCK_SIZE);
+    ++numBlocks;
+    return block;
+}
+
+void MsgArgArena::FreeBlocks(Block* stop)
+{
+    while (blocks != stop) {
+        Block* next = blocks->next;
+        delete [] reinterpret_cast<uint64_t*>(blocks);
+        blocks = next;
+    }
+}
+
+void* MsgArgArena::Alloc(size_t len)
+{
+    len = ROUND8(len);
+    if (!blocks || ((blocks->size - blocks->used) < len)) {
+        NewBlock(len);
+    }
+    void* ptr = BLOCK_DATA(blocks) + blocks->used;
+    blocks->used += len;
+    return ptr;
+}
+
+MsgArg* MsgArgArena::NewArgs(size_t numArgs)
+{
+    Run* run = reinterpret_cast<Run*>(Alloc(RUN_LEN(numArgs)));
+    run->prev = runs;
+    run->numArgs = numArgs;
+    runs = run;
+    MsgArg* args = RUN_ARGS(run);
+    for (size_t i = 0; i < numArgs; ++i) {
+        new (&args[i])MsgArg();
+    }
+    return args;
+}
+
+MsgArg* MsgArgArena::GrowArgs(MsgArg* args, size_t numArgs, size_t newNumArgs)
+{
+    Run* run = reinterpret_cast<Run*>(reinterpret_cast<uint8_t*>(args) - RUN_HDR_LEN);
+    assert(newNumArgs >= numArgs);
+    /*
+     * Extend in place if this is the most recent allocation and there is room in the block
+     */
+    if ((run == runs) && ((reinterpret_cast<uint8_t*>(run) + RUN_LEN(numArgs)) == (BLOCK_DATA(blocks) + blocks->used))) {
+        size_t extra = RUN_LEN(newNumArgs) - RUN_LEN(numArgs);
+        if ((blocks->size - blocks->used) >= extra) {
+            blocks->used += extra;
+            for (size_t i = numArgs; i < newNumArgs; ++i) {
+                new (&args[i])MsgArg();
+            }
+            run->numArgs = newNumArgs;
+            return args;
+        }
+    }
+    /*
+     * Move the MsgArgs to a new array. The old array is left in the arena but is emptied so the
+     * MsgArgs that moved are not destroyed twice.
+     */
+    MsgArg* newArgs = NewArgs(newNumArgs);
+    for (size_t i = 0; i < numArgs; ++i) {
+        newArgs[i].~MsgArg();
+    }
+    memcpy(reinterpret_cast<void*>(newArgs), args, numArgs * sizeof(MsgArg));
+    run->numArgs = 0;
+    return newArgs;
+}
+
+void MsgArgArena::Reset()
+{
+    while (runs) {
+        MsgArg* args = RUN_ARGS(runs);
+        for (size_t i = 0; i < runs->numArgs; ++i) {
+            args[i].~MsgArg();
+        }
+        runs = runs->prev;
+    }
+    if (blocks) {
+        Block* first = blocks;
+        while (first->next) {
+            first = first->next;
+        }
+        FreeBlocks(first);
+        first->used = 0;
+    }
+}
+
+}
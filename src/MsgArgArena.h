@@ -0,0 +1,124 @@
+#ifndef _ALLJOYN_MSGARGARENA_H
+#define _ALLJOYN_MSGARGARENA_H
+/**
+ * @file
+ *
+ * This file defines a bump allocator for the MsgArg trees built when a message is unmarshaled.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef __cplusplus
+#error Only include MsgArgArena.h in C++ code.
+#endif
+
+#include <qcc/platform.h>
+
+#include <alljoyn/MsgArg.h>
+
+namespace ajn {
+
+/**
+ * Allocates MsgArgs and raw storage from a small number of large blocks that are all freed
+ * together. MsgArgs allocated from the arena must not have the MsgArg::OwnsArgs or
+ * MsgArg::OwnsData flags set for anything that came from the arena, the arena runs the MsgArg
+ * destructors itself when it is reset or destroyed.
+ */
+class MsgArgArena {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param sizeHint  Expected number of bytes that will be allocated, used to size the first block.
+     */
+    MsgArgArena(size_t sizeHint = 0);
+
+    /**
+     * Destructor, destroys all MsgArgs allocated from the arena.
+     */
+    ~MsgArgArena();
+
+    /**
+     * Allocate an array of default constructed MsgArgs.
+     *
+     * @param numArgs  Number of MsgArgs to allocate.
+     *
+     * @return  Pointer to the first MsgArg.
+     */
+    MsgArg* NewArgs(size_t numArgs);
+
+    /**
+     * Grow an array previously returned by NewArgs(). The array is extended in place if nothing
+     * else has been allocated after it, otherwise the MsgArgs are moved to a new array.
+     *
+     * @param args        The array to grow.
+     * @param numArgs     Current number of MsgArgs in the array.
+     * @param newNumArgs  Required number of MsgArgs.
+     *
+     * @return  Pointer to the first MsgArg of the grown array.
+     */
+    MsgArg* GrowArgs(MsgArg* args, size_t numArgs, size_t newNumArgs);
+
+    /**
+     * Allocate raw storage aligned on an 8 byte boundary.
+     *
+     * @param len  Number of bytes to allocate.
+     *
+     * @return  Pointer to the storage.
+     */
+    void* Alloc(size_t len);
+
+    /**
+     * Destroy all MsgArgs and free all blocks but the first one.
+     */
+    void Reset();
+
+    /**
+     * Get the number of blocks allocated from the heap since the arena was created.
+     */
+    size_t GetNumBlocks() const { return numBlocks; }
+
+  private:
+
+    struct Block {
+        Block* next;    /**< Previously allocated block */
+        size_t size;    /**< Number of data bytes in the block */
+        size_t used;    /**< Number of data bytes allocated */
+    };
+
+    struct Run {
+        Run* prev;      /**< Previously allocated MsgArg array */
+        size_t numArgs; /**< Number of MsgArgs in this array */
+    };
+
+    Block* NewBlock(size_t minLen);
+    void FreeBlocks(Block* stop);
+
+    Block* blocks;          /**< Most recently allocated block */
+    Run* runs;              /**< Most recently allocated MsgArg array */
+    size_t nextBlockSize;   /**< Size of the next block to allocate */
+    size_t numBlocks;       /**< Number of blocks allocated */
+
+    /* Copy constructor and assignment operator are not allowed */
+    MsgArgArena(const MsgArgArena& other);
+    MsgArgArena& operator=(const MsgArgArena& other);
+};
+
+}
+
+#endif
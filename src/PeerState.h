@@ -43,6 +43,8 @@
 
 #include <alljoyn/Status.h>
 
+#include "AllJoynCrypto.h"
+
 namespace ajn {
 
 /* Forward declaration */
@@ -142,6 +144,8 @@ class _PeerState {
      */
     void SetKey(const qcc::KeyBlob& key, PeerKeyType keyType) {
         keys[keyType] = key;
+        cryptoContexts[keyType][0].Reset();
+        cryptoContexts[keyType][1].Reset();
         isSecure = key.IsValid();
     }
 
@@ -174,9 +178,26 @@ class _PeerState {
     void ClearKeys() {
         keys[PEER_SESSION_KEY].Erase();
         keys[PEER_GROUP_KEY].Erase();
+        for (size_t i = 0; i < 2; ++i) {
+            cryptoContexts[i][0].Reset();
+            cryptoContexts[i][1].Reset();
+        }
         isSecure = false;
     }
 
+    /**
+     * Get the cached cipher for encrypting or decrypting messages with one of the keys for this
+     * peer. The cipher is discarded when the key is changed or cleared.
+     *
+     * @param keyType  Indicate if this is for the unicast or broadcast key.
+     * @param encrypt  True for the encryption context, false for the decryption context.
+     *
+     * @return  The crypto context.
+     */
+    CryptoContext& GetCryptoContext(PeerKeyType keyType, bool encrypt) {
+        return cryptoContexts[keyType][encrypt ? 1 : 0];
+    }
+
     /**
      * Tests if this peer is secure.
      *
@@ -315,6 +336,11 @@ class _PeerState {
      */
     qcc::KeyBlob keys[2];
 
+    /**
+     * Cached ciphers for the keys, indexed by key type and then decrypt (0) or encrypt (1).
+     */
+    CryptoContext cryptoContexts[2][2];
+
     /**
      * Serial number window. Used by IsValidSerial() to detect replay attacks. The size of the
      * window defines that largest tolerable gap between consecutive serial numbers.
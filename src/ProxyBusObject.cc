@@ -47,6 +47,7 @@
 #include "AllJoynPeerObj.h"
 #include "BusInternal.h"
 #include "XmlHelper.h"
+#include "MarshalPlan.h"
 
 #include <alljoyn/Status.h>
 
@@ -70,6 +71,40 @@ struct ProxyBusObject::Components {
 
     /** List of threads that are waiting in sync method calls */
     vector<Thread*> waitingThreads;
+
+    /** Cached property values of an interface */
+    struct PropertyCache {
+        /** Values of the cached properties, each a variant as returned by Properties.Get */
+        map<qcc::String, MsgArg> values;
+
+        /** Incremented whenever a cached value changes or is dropped, never 0 */
+        uint32_t epoch;
+
+        PropertyCache() : epoch(1) { }
+    };
+
+    /** Interfaces whose properties are being cached */
+    map<qcc::String, PropertyCache> propertyCaches;
+
+    uint32_t cacheHits;     /**< Property reads answered from propertyCaches */
+    uint32_t cacheMisses;   /**< Property reads on cached interfaces that went to the remote object */
+
+    /** Unique name of the owner of the service name, the only sender of accepted PropertiesChanged signals */
+    qcc::String cacheOwner;
+
+    bool cacheHandlersRegistered;   /**< True if the property cache signal handlers and match rule are in place */
+    bool cacheHandlersBusy;         /**< True while a thread registers or unregisters the property cache handlers */
+
+    Components() : cacheHits(0), cacheMisses(0), cacheHandlersRegistered(false), cacheHandlersBusy(false) { }
+
+    /** Forget the property cache state of a copied proxy, its handlers belong to the original */
+    void ClearPropertyCaches()
+    {
+        propertyCaches.clear();
+        cacheOwner.clear();
+        cacheHandlersRegistered = false;
+        cacheHandlersBusy = false;
+    }
 };
 
 template <typename _cbType> struct CBContext {
@@ -92,12 +127,353 @@ static inline bool SecurityApplies(const ProxyBusObject* obj, const InterfaceDes
     }
 }
 
+/*
+ * A property can only be cached if the remote object tells us when it changes or if it never
+ * changes.
+ */
+static bool IsCacheable(const InterfaceDescription* iface, const char* property)
+{
+    qcc::String emitsChanged;
+    if (!iface->GetPropertyAnnotation(property, org::freedesktop::DBus::AnnotateEmitsChanged, emitsChanged)) {
+        return false;
+    }
+    return (emitsChanged == "true") || (emitsChanged == "invalidates") || (emitsChanged == "const");
+}
+
+/*
+ * Match rule for the PropertiesChanged signals of an object. The sender is not part of the rule
+ * because the daemon matches it against unique names only.
+ */
+static qcc::String PropertiesChangedRule(const qcc::String& path)
+{
+    return qcc::String("type='signal',interface='") + org::freedesktop::DBus::InterfaceName +
+           "',member='PropertiesChanged',path='" + path + "'";
+}
+
+QStatus ProxyBusObject::RegisterPropertyCacheHandlers()
+{
+    const InterfaceDescription* dbusIface = bus->GetInterface(org::freedesktop::DBus::InterfaceName);
+    if (!dbusIface) {
+        return ER_BUS_NO_SUCH_INTERFACE;
+    }
+
+    /*
+     * Track the owner of the service name before looking it up so that a change of owner between
+     * the two cannot be missed. NameOwnerChanged is delivered to every client bus attachment by
+     * the match rule it adds for org.freedesktop.DBus signals.
+     */
+    QStatus status = bus->RegisterSignalHandler(this,
+                                                static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheNameOwnerChangedHandler),
+                                                dbusIface->GetMember("NameOwnerChanged"),
+                                                NULL);
+    if (ER_OK == status) {
+        qcc::String owner = serviceName;
+        if (serviceName.empty() || (serviceName[0] != ':')) {
+            Message reply(*bus);
+            MsgArg arg("s", serviceName.c_str());
+            status = bus->GetDBusProxyObj().MethodCall(org::freedesktop::DBus::InterfaceName, "GetNameOwner", &arg, 1, reply);
+            if (ER_OK == status) {
+                owner = reply->GetArg(0)->v_string.str;
+            }
+        }
+        if (ER_OK == status) {
+            lock->Lock(MUTEX_CONTEXT);
+            components->cacheOwner = owner;
+            lock->Unlock(MUTEX_CONTEXT);
+        }
+    }
+    if (ER_OK == status) {
+        status = bus->RegisterSignalHandler(this,
+                                            static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                            dbusIface->GetMember("PropertiesChanged"),
+                                            path.c_str());
+    }
+    if (ER_OK == status) {
+        status = bus->AddMatch(PropertiesChangedRule(path).c_str());
+        if (ER_OK != status) {
+            bus->UnregisterSignalHandler(this,
+                                         static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                         dbusIface->GetMember("PropertiesChanged"),
+                                         path.c_str());
+        }
+    }
+    if (ER_OK != status) {
+        bus->UnregisterSignalHandler(this,
+                                     static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheNameOwnerChangedHandler),
+                                     dbusIface->GetMember("NameOwnerChanged"),
+                                     NULL);
+    }
+    return status;
+}
+
+void ProxyBusObject::UnregisterPropertyCacheHandlers()
+{
+    const InterfaceDescription* dbusIface = bus->GetInterface(org::freedesktop::DBus::InterfaceName);
+    bus->UnregisterSignalHandler(this,
+                                 static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::PropertiesChangedHandler),
+                                 dbusIface->GetMember("PropertiesChanged"),
+                                 path.c_str());
+    bus->UnregisterSignalHandler(this,
+                                 static_cast<MessageReceiver::SignalHandler>(&ProxyBusObject::CacheNameOwnerChangedHandler),
+                                 dbusIface->GetMember("NameOwnerChanged"),
+                                 NULL);
+    bus->RemoveMatch(PropertiesChangedRule(path).c_str());
+}
+
+QStatus ProxyBusObject::EnablePropertyCaching(const char* iface, uint32_t timeout)
+{
+    if (!bus->GetInterface(iface)) {
+        return ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    }
+
+    /*
+     * Only one thread at a time registers or unregisters the signal handlers, others wait for it
+     * so that no interface is populated before the handlers exist.
+     */
+    lock->Lock(MUTEX_CONTEXT);
+    while (components->cacheHandlersBusy) {
+        lock->Unlock(MUTEX_CONTEXT);
+        qcc::Sleep(5);
+        lock->Lock(MUTEX_CONTEXT);
+    }
+    if (components->propertyCaches.find(iface) != components->propertyCaches.end()) {
+        lock->Unlock(MUTEX_CONTEXT);
+        return ER_OK;
+    }
+    bool doRegister = !components->cacheHandlersRegistered;
+    components->cacheHandlersBusy = doRegister;
+    lock->Unlock(MUTEX_CONTEXT);
+
+    QStatus status = ER_OK;
+    if (doRegister) {
+        status = RegisterPropertyCacheHandlers();
+        lock->Lock(MUTEX_CONTEXT);
+        components->cacheHandlersRegistered = (ER_OK == status);
+        components->cacheHandlersBusy = false;
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+
+    if (ER_OK == status) {
+        /* The handlers are in place so the cache can now be populated */
+        lock->Lock(MUTEX_CONTEXT);
+        components->propertyCaches[iface];
+        lock->Unlock(MUTEX_CONTEXT);
+        MsgArg values;
+        status = GetAllProperties(iface, values, timeout);
+        if (ER_OK != status) {
+            DisablePropertyCaching(iface);
+        }
+    }
+    if (ER_OK != status) {
+        QCC_LogError(status, ("Failed to enable property caching for %s on %s", iface, path.c_str()));
+    }
+    return status;
+}
+
+QStatus ProxyBusObject::DisablePropertyCaching(const char* iface)
+{
+    lock->Lock(MUTEX_CONTEXT);
+    while (components->cacheHandlersBusy) {
+        lock->Unlock(MUTEX_CONTEXT);
+        qcc::Sleep(5);
+        lock->Lock(MUTEX_CONTEXT);
+    }
+    bool wasEnabled = components->propertyCaches.erase(iface) != 0;
+    bool doUnregister = wasEnabled && components->propertyCaches.empty() && components->cacheHandlersRegistered;
+    components->cacheHandlersBusy = doUnregister;
+    lock->Unlock(MUTEX_CONTEXT);
+
+    if (doUnregister) {
+        UnregisterPropertyCacheHandlers();
+        lock->Lock(MUTEX_CONTEXT);
+        components->cacheHandlersRegistered = false;
+        components->cacheHandlersBusy = false;
+        components->cacheOwner.clear();
+        lock->Unlock(MUTEX_CONTEXT);
+    }
+    return wasEnabled ? ER_OK : ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+}
+
+void ProxyBusObject::GetPropertyCacheStats(uint32_t& hits, uint32_t& misses) const
+{
+    lock->Lock(MUTEX_CONTEXT);
+    hits = components->cacheHits;
+    misses = components->cacheMisses;
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+bool ProxyBusObject::GetCachedProperty(const InterfaceDescription* iface, const char* property, MsgArg& value, uint32_t& epoch) const
+{
+    bool hit = false;
+    epoch = 0;
+    lock->Lock(MUTEX_CONTEXT);
+    map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.find(iface->GetName());
+    if (it != components->propertyCaches.end()) {
+        map<qcc::String, MsgArg>::const_iterator vit = it->second.values.find(property);
+        if (vit != it->second.values.end()) {
+            value = vit->second;
+            hit = true;
+            ++components->cacheHits;
+        } else {
+            if (IsCacheable(iface, property)) {
+                epoch = it->second.epoch;
+            }
+            ++components->cacheMisses;
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+    return hit;
+}
+
+bool ProxyBusObject::GetCachedProperties(const InterfaceDescription* iface, MsgArg& values, uint32_t& epoch) const
+{
+    bool hit = false;
+    epoch = 0;
+    lock->Lock(MUTEX_CONTEXT);
+    map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.find(iface->GetName());
+    if (it != components->propertyCaches.end()) {
+        /* All readable properties must be in the cache to answer GetAll locally */
+        size_t numProps = iface->GetProperties();
+        const InterfaceDescription::Property** props = new const InterfaceDescription::Property*[numProps];
+        iface->GetProperties(props, numProps);
+        vector<MsgArg> entries;
+        hit = true;
+        for (size_t i = 0; hit && (i < numProps); ++i) {
+            if (props[i]->access & PROP_ACCESS_READ) {
+                map<qcc::String, MsgArg>::const_iterator vit = it->second.values.find(props[i]->name);
+                if (vit != it->second.values.end()) {
+                    entries.push_back(MsgArg());
+                    entries.back().Set("{sv}", props[i]->name.c_str(), vit->second.v_variant.val);
+                } else {
+                    hit = false;
+                }
+            }
+        }
+        delete [] props;
+        if (hit) {
+            values.Set("a{sv}", entries.size(), entries.empty() ? NULL : &entries[0]);
+            values.Stabilize();
+            ++components->cacheHits;
+        } else {
+            epoch = it->second.epoch;
+            ++components->cacheMisses;
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+    return hit;
+}
+
+void ProxyBusObject::CacheProperty(const InterfaceDescription* iface, const char* property, const MsgArg& value, uint32_t epoch) const
+{
+    lock->Lock(MUTEX_CONTEXT);
+    map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.find(iface->GetName());
+    if ((it != components->propertyCaches.end()) && (it->second.epoch == epoch)) {
+        it->second.values[property] = value;
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::CacheProperties(const InterfaceDescription* iface, const MsgArg& values, uint32_t epoch) const
+{
+    MsgArg* entries;
+    size_t numEntries;
+    if (values.Get("a{sv}", &numEntries, &entries) != ER_OK) {
+        return;
+    }
+    lock->Lock(MUTEX_CONTEXT);
+    map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.find(iface->GetName());
+    if ((it != components->propertyCaches.end()) && (it->second.epoch == epoch)) {
+        for (size_t i = 0; i < numEntries; ++i) {
+            const char* property = entries[i].v_dictEntry.key->v_string.str;
+            if (IsCacheable(iface, property)) {
+                it->second.values[property] = *entries[i].v_dictEntry.val;
+            }
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::InvalidateProperty(const char* iface, const char* property) const
+{
+    lock->Lock(MUTEX_CONTEXT);
+    map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.find(iface);
+    if (it != components->propertyCaches.end()) {
+        it->second.values.erase(property);
+        ++it->second.epoch;
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::PropertiesChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+{
+    const char* ifaceName;
+    MsgArg* changed;
+    size_t numChanged;
+    MsgArg* invalidated;
+    size_t numInvalidated;
+    QStatus status = msg->GetArgs("sa{sv}as", &ifaceName, &numChanged, &changed, &numInvalidated, &invalidated);
+    if (ER_OK != status) {
+        QCC_LogError(status, ("Invalid PropertiesChanged signal from %s", msg->GetSender()));
+        return;
+    }
+
+    const InterfaceDescription* iface = bus->GetInterface(ifaceName);
+    if (!iface) {
+        return;
+    }
+    lock->Lock(MUTEX_CONTEXT);
+    /* The match rule cannot name the sender so only accept changes from the current owner of the service name */
+    if (components && !components->cacheOwner.empty() && (components->cacheOwner == msg->GetSender())) {
+        map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.find(ifaceName);
+        if (it != components->propertyCaches.end()) {
+            for (size_t i = 0; i < numChanged; ++i) {
+                const char* property = changed[i].v_dictEntry.key->v_string.str;
+                if (IsCacheable(iface, property)) {
+                    it->second.values[property] = *changed[i].v_dictEntry.val;
+                } else {
+                    it->second.values.erase(property);
+                }
+            }
+            for (size_t i = 0; i < numInvalidated; ++i) {
+                it->second.values.erase(invalidated[i].v_string.str);
+            }
+            ++it->second.epoch;
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
+void ProxyBusObject::CacheNameOwnerChangedHandler(const InterfaceDescription::Member* member, const char* srcPath, Message& msg)
+{
+    const char* name;
+    const char* oldOwner;
+    const char* newOwner;
+    if ((msg->GetArgs("sss", &name, &oldOwner, &newOwner) != ER_OK) || (serviceName != name)) {
+        return;
+    }
+    /* Values read from the previous owner no longer describe the remote object */
+    lock->Lock(MUTEX_CONTEXT);
+    if (components) {
+        components->cacheOwner = newOwner;
+        map<qcc::String, Components::PropertyCache>::iterator it = components->propertyCaches.begin();
+        while (it != components->propertyCaches.end()) {
+            it->second.values.clear();
+            ++it->second.epoch;
+            ++it;
+        }
+    }
+    lock->Unlock(MUTEX_CONTEXT);
+}
+
 QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint32_t timeout) const
 {
     QStatus status;
+    uint32_t epoch;
     const InterfaceDescription* valueIface = bus->GetInterface(iface);
     if (!valueIface) {
         status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    } else if (GetCachedProperties(valueIface, value, epoch)) {
+        status = ER_OK;
     } else {
         uint8_t flags = 0;
         /*
@@ -115,6 +491,9 @@ QStatus ProxyBusObject::GetAllProperties(const char* iface, MsgArg& value, uint3
             status = MethodCall(*(propIface->GetMember("GetAll")), &arg, 1, reply, timeout, flags);
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
+                if (epoch) {
+                    CacheProperties(valueIface, value, epoch);
+                }
             }
         }
     }
@@ -186,9 +565,12 @@ QStatus ProxyBusObject::GetAllPropertiesAsync(const char* iface,
 QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, MsgArg& value, uint32_t timeout) const
 {
     QStatus status;
+    uint32_t epoch;
     const InterfaceDescription* valueIface = bus->GetInterface(iface);
     if (!valueIface) {
         status = ER_BUS_OBJECT_NO_SUCH_INTERFACE;
+    } else if (GetCachedProperty(valueIface, property, value, epoch)) {
+        status = ER_OK;
     } else {
         uint8_t flags = 0;
         /*
@@ -208,6 +590,9 @@ QStatus ProxyBusObject::GetProperty(const char* iface, const char* property, Msg
             status = MethodCall(*(propIface->GetMember("Get")), inArgs, numArgs, reply, timeout, flags);
             if (ER_OK == status) {
                 value = *(reply->GetArg(0));
+                if (epoch) {
+                    CacheProperty(valueIface, property, value, epoch);
+                }
             }
         }
     }
@@ -304,6 +689,10 @@ QStatus ProxyBusObject::SetProperty(const char* iface, const char* property, Msg
                                 reply,
                                 timeout,
                                 flags);
+            if (ER_OK == status) {
+                /* Don't serve the old value while the PropertiesChanged signal is in flight */
+                InvalidateProperty(iface, property);
+            }
         }
     }
     return status;
@@ -682,7 +1071,7 @@ QStatus ProxyBusObject::MethodCallAsync(const InterfaceDescription::Member& meth
     if ((flags & ALLJOYN_FLAG_ENCRYPTED) && !bus->IsPeerSecurityEnabled()) {
         return ER_BUS_SECURITY_NOT_ENABLED;
     }
-    status = msg->CallMsg(method.signature, serviceName, sessionId, path, method.iface->GetName(), method.name, args, numArgs, flags);
+    status = msg->CallMsg(method.signature, serviceName, sessionId, path, method.iface->GetName(), method.name, args, numArgs, flags, MarshalPlan::Get(method.signature));
     if (status == ER_OK) {
         if (!(flags & ALLJOYN_FLAG_NO_REPLY_EXPECTED)) {
             status = localEndpoint->RegisterReplyHandler(receiver, replyHandler, method, msg, context, timeout);
@@ -786,7 +1175,7 @@ QStatus ProxyBusObject::MethodCall(const InterfaceDescription::Member& method,
         status = ER_BUS_SECURITY_NOT_ENABLED;
         goto MethodCallExit;
     }
-    status = msg->CallMsg(method.signature, serviceName, sessionId, path, method.iface->GetName(), method.name, args, numArgs, flags);
+    status = msg->CallMsg(method.signature, serviceName, sessionId, path, method.iface->GetName(), method.name, args, numArgs, flags, MarshalPlan::Get(method.signature));
     if (status != ER_OK) {
         goto MethodCallExit;
     }
@@ -1070,6 +1459,12 @@ void ProxyBusObject::DestructComponents()
 
         if (bus) {
             bus->UnregisterAllHandlers(this);
+            if (components->cacheHandlersRegistered) {
+                /* Fire-and-forget so that this can be called from a callback */
+                qcc::String rule = PropertiesChangedRule(path);
+                MsgArg arg("s", rule.c_str());
+                bus->GetDBusProxyObj().MethodCall(org::freedesktop::DBus::InterfaceName, "RemoveMatch", &arg, 1);
+            }
         }
 
         /* Wait for any waiting threads to exit this object's members */
@@ -1123,6 +1518,7 @@ ProxyBusObject::ProxyBusObject(const ProxyBusObject& other) :
     isSecure(other.isSecure)
 {
     *components = *other.components;
+    components->ClearPropertyCaches();
 }
 
 ProxyBusObject& ProxyBusObject::operator=(const ProxyBusObject& other)
@@ -1132,6 +1528,7 @@ ProxyBusObject& ProxyBusObject::operator=(const ProxyBusObject& other)
         if (other.components) {
             components = new Components();
             *components = *other.components;
+            components->ClearPropertyCaches();
             if (!lock) {
                 lock = new Mutex();
             }
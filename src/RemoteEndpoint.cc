@@ -20,6 +20,7 @@
 #include <qcc/platform.h>
 
 #include <assert.h>
+#include <vector>
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
@@ -39,6 +40,13 @@
 #include "AllJoynPeerObj.h"
 #include "BusInternal.h"
 
+#if defined(QCC_OS_GROUP_POSIX) && !defined(QCC_OS_DARWIN)
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
 #ifndef NDEBUG
 #include <qcc/time.h>
 #endif
@@ -52,6 +60,17 @@ namespace ajn {
 
 #define ENDPOINT_IS_DEAD_ALERTCODE  1
 
+/* Default transmit queue limit, a limit of zero bytes means no byte limit */
+static const size_t DEFAULT_MAX_TX_QUEUE_MSGS = 30;
+static const size_t DEFAULT_MAX_TX_QUEUE_BYTES = 0;
+
+/* Largest number of messages written with a single scatter-gather write */
+static const size_t MAX_TX_BATCH = 16;
+
+/* Limits for the size of the read-ahead buffer */
+static const size_t MIN_RX_BUFFER = 4 * 1024;
+static const size_t MAX_RX_BUFFER = 64 * 1024;
+
 class _RemoteEndpoint::Internal {
     friend class _RemoteEndpoint;
   public:
@@ -80,20 +99,72 @@ class _RemoteEndpoint::Internal {
         currentReadMsg(bus),
         validateSender(incoming),
         hasRxSessionMsg(false),
-        getNextMsg(true),
-        currentWriteMsg(bus),
+        sgWrite(true),
+        txIov(MAX_TX_BATCH),
+        txBytes(0),
+        maxTxMsgs(DEFAULT_MAX_TX_QUEUE_MSGS),
+        maxTxBytes(DEFAULT_MAX_TX_QUEUE_BYTES),
+        txPolicy(TX_QUEUE_BLOCK),
+        txListener(NULL),
+        txWritablePending(false),
+        rxBuf(NULL),
+        rxBufSize(MIN_RX_BUFFER),
+        rxHead(0),
+        rxTail(0),
+        rxMsgCount(0),
+        rxReadCount(0),
         stopping(false),
-        sessionId(0)
+        sessionId(0),
+        auth(NULL)
     {
     }
 
     ~Internal() {
+        delete [] rxBuf;
+        delete auth;
     }
 
+    /**
+     * A queued message with the number of bytes it was charged against the queue byte limit and,
+     * once it has been taken from the txQueue for writing, its write state.
+     */
+    struct TxEntry {
+        Message msg;                         /**< The message being queued or written */
+        _Message::WriteContext context;      /**< Write state for msg */
+        size_t size;                         /**< Number of bytes msg was charged against the queue byte limit */
+        TxEntry(const Message& msg, size_t size) : msg(msg), size(size) { }
+    };
+
+    /**
+     * Number of queued messages including those already taken for writing. Caller must hold lock.
+     */
+    size_t TxQueueSize() const { return txQueue.size() + txBatch.size(); }
+
+    /**
+     * Check if a message of the given size would exceed the queue limits. A message that is larger
+     * than the byte limit is accepted by an empty queue. Caller must hold lock.
+     */
+    bool TxQueueFull(size_t msgSize) const {
+        size_t count = TxQueueSize();
+        return (count >= maxTxMsgs) || (maxTxBytes && count && ((txBytes + msgSize) > maxTxBytes));
+    }
+
+    /**
+     * Check if the queue has drained to half its limits. Caller must hold lock.
+     */
+    bool TxQueueLow() const {
+        return (TxQueueSize() <= (maxTxMsgs / 2)) && (!maxTxBytes || (txBytes <= (maxTxBytes / 2)));
+    }
+
+    /**
+     * Remove bytes charged for a message that has left the queue. Caller must hold lock.
+     */
+    void ReleaseTxBytes(size_t size) { txBytes -= (std::min)(txBytes, size); }
+
     BusAttachment& bus;                      /**< Message bus associated with this endpoint */
     qcc::Stream* stream;                     /**< Stream for this endpoint or NULL if uninitialized */
 
-    std::deque<Message> txQueue;             /**< Transmit message queue */
+    std::deque<TxEntry> txQueue;             /**< Transmit message queue */
     std::deque<qcc::Thread*> txWaitQueue;    /**< Threads waiting for txQueue to become not-full */
     qcc::Mutex lock;                         /**< Mutex that protects the txQueue and timeout values */
     int32_t exitCount;                       /**< Number of sub-threads (rx and tx) that have exited (atomically incremented) */
@@ -124,10 +195,24 @@ class _RemoteEndpoint::Internal {
     Message currentReadMsg;                  /**< The message currently being read for this endpoint */
     bool validateSender;                     /**< If true, the sender field on incomming messages will be overwritten with actual endpoint name */
     bool hasRxSessionMsg;                    /**< true iff this endpoint has previously processed a non-control message */
-    bool getNextMsg;                         /**< If true, read the next message from the txQueue */
-    Message currentWriteMsg;                 /**< The message currently being read for this endpoint */
+    std::deque<TxEntry> txBatch;             /**< Messages currently being written, oldest first */
+    bool sgWrite;                            /**< False if the endpoint does not support scatter-gather writes */
+    std::vector<IOVec> txIov;                /**< Buffers of the messages in txBatch passed to PushBytesSG */
+    size_t txBytes;                          /**< Number of bytes in txQueue and txBatch */
+    size_t maxTxMsgs;                        /**< Maximum number of messages in txQueue and txBatch */
+    size_t maxTxBytes;                       /**< Maximum number of bytes in txQueue and txBatch (0 for no limit) */
+    TxQueuePolicy txPolicy;                  /**< What PushMessage does when the tx queue is full */
+    TxQueueListener* txListener;             /**< Listener notified when a full tx queue drains */
+    bool txWritablePending;                  /**< True if TryPushMessage failed since the last writable notification */
+    uint8_t* rxBuf;                          /**< Read-ahead buffer for incoming messages */
+    size_t rxBufSize;                        /**< Current size of rxBuf */
+    size_t rxHead;                           /**< Offset of the first unread byte in rxBuf */
+    size_t rxTail;                           /**< Offset past the last byte read into rxBuf */
+    uint32_t rxMsgCount;                     /**< Number of messages received (debug stats) */
+    uint32_t rxReadCount;                    /**< Number of reads from the stream (debug stats) */
     bool stopping;                           /**< Is this EP stopping? */
     uint32_t sessionId;                      /**< SessionId for BusToBus endpoint. (not used for non-B2B endpoints) */
+    EndpointAuth* auth;                      /**< Authentication state of a non-blocking establishment */
 };
 
 
@@ -187,6 +272,57 @@ const qcc::String&  _RemoteEndpoint::GetConnectSpec() const
     }
 }
 
+QStatus _RemoteEndpoint::PullMessageBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout)
+{
+    if (!internal) {
+        return ER_BUS_NO_ENDPOINT;
+    }
+    /*
+     * Serve the request from data that has already been read ahead
+     */
+    if (internal->rxHead < internal->rxTail) {
+        actualBytes = (std::min)(reqBytes, internal->rxTail - internal->rxHead);
+        memcpy(buf, internal->rxBuf + internal->rxHead, actualBytes);
+        internal->rxHead += actualBytes;
+        return ER_OK;
+    }
+    ++internal->rxReadCount;
+    internal->bus.GetInternal().CountRxRead();
+    /*
+     * Bytes beyond the current message must not be consumed before the endpoint is started, when
+     * handles are passed with the data, or when the stream is about to be handed over after the
+     * next reply. Large reads go straight into the message buffer.
+     */
+    if (!internal->started || internal->features.handlePassing || internal->armRxPause || (reqBytes >= internal->rxBufSize)) {
+        return GetSource().PullBytes(buf, reqBytes, actualBytes, timeout);
+    }
+    /*
+     * Resize the buffer based on the previous read. Grow if it was filled, shrink if it was mostly
+     * unused so idle endpoints don't hold on to large buffers.
+     */
+    size_t newSize = internal->rxBufSize;
+    if ((internal->rxTail == internal->rxBufSize) && (newSize < MAX_RX_BUFFER)) {
+        newSize *= 2;
+    } else if (internal->rxBuf && (internal->rxTail < (internal->rxBufSize / 8)) && (newSize > MIN_RX_BUFFER)) {
+        newSize /= 2;
+    }
+    if (!internal->rxBuf || (newSize != internal->rxBufSize)) {
+        delete [] internal->rxBuf;
+        internal->rxBufSize = newSize;
+        internal->rxBuf = new uint8_t[newSize];
+    }
+    size_t got = 0;
+    QStatus status = GetSource().PullBytes(internal->rxBuf, internal->rxBufSize, got, timeout);
+    internal->rxHead = 0;
+    internal->rxTail = (status == ER_OK) ? got : 0;
+    if (status == ER_OK) {
+        actualBytes = (std::min)(reqBytes, got);
+        memcpy(buf, internal->rxBuf, actualBytes);
+        internal->rxHead = actualBytes;
+    }
+    return status;
+}
+
 bool _RemoteEndpoint::IsIncomingConnection() const
 {
     if (internal) {
@@ -239,6 +375,53 @@ QStatus _RemoteEndpoint::Establish(const qcc::String& authMechanisms, qcc::Strin
     return status;
 }
 
+QStatus _RemoteEndpoint::EstablishStart(const qcc::String& authMechanisms, AuthListener* listener)
+{
+    if (!internal) {
+        return ER_BUS_NO_ENDPOINT;
+    }
+    assert(internal->incoming && !internal->auth);
+    RemoteEndpoint rep = RemoteEndpoint::wrap(this);
+    internal->auth = new EndpointAuth(internal->bus, rep, internal->incoming);
+    internal->auth->EstablishStart(authMechanisms, listener);
+    return ER_OK;
+}
+
+QStatus _RemoteEndpoint::EstablishContinue(qcc::String& authUsed)
+{
+    if (!internal || !internal->auth) {
+        return ER_BUS_NO_ENDPOINT;
+    }
+    EndpointAuth* auth = internal->auth;
+    QStatus status = auth->EstablishContinue(authUsed);
+    if (status == ER_WOULDBLOCK) {
+        return status;
+    }
+    if (status == ER_OK) {
+        internal->uniqueName = auth->GetUniqueName();
+        internal->remoteName = auth->GetRemoteName();
+        internal->remoteGUID = auth->GetRemoteGUID();
+        internal->features.protocolVersion = auth->GetRemoteProtocolVersion();
+        internal->features.trusted = (authUsed != "ANONYMOUS");
+    }
+    /*
+     * The authentication state holds a reference to this endpoint so it must be released as soon
+     * as the establishment is over.
+     */
+    internal->auth = NULL;
+    delete auth;
+    return status;
+}
+
+void _RemoteEndpoint::EstablishCancel()
+{
+    if (internal && internal->auth) {
+        EndpointAuth* auth = internal->auth;
+        internal->auth = NULL;
+        delete auth;
+    }
+}
+
 QStatus _RemoteEndpoint::SetLinkTimeout(uint32_t& idleTimeout)
 {
     if (internal) {
@@ -388,7 +571,7 @@ QStatus _RemoteEndpoint::StopAfterTxEmpty(uint32_t maxWaitMs)
     /* Wait for txqueue to empty before triggering stop */
     internal->lock.Lock(MUTEX_CONTEXT);
     while (true) {
-        if (internal->txQueue.empty() || (maxWaitMs && (qcc::GetTimestamp() > (startTime + maxWaitMs)))) {
+        if ((internal->TxQueueSize() == 0) || (maxWaitMs && (qcc::GetTimestamp() > (startTime + maxWaitMs)))) {
             status = Stop();
             break;
         } else {
@@ -516,6 +699,8 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
 
             status = internal->currentReadMsg->ReadNonBlocking(rep, (internal->validateSender && !bus2bus));
             if (status == ER_OK) {
+                ++internal->rxMsgCount;
+                internal->bus.GetInternal().CountRxMessage();
                 /* Message read complete.Proceed to unmarshal it. */
                 Message msg = internal->currentReadMsg;
                 status = msg->Unmarshal(rep, (internal->validateSender && !bus2bus));
@@ -625,6 +810,18 @@ QStatus _RemoteEndpoint::ReadCallback(qcc::Source& source, bool isTimedOut)
                 }
             }
         }
+#ifndef NDEBUG
+#undef QCC_MODULE
+#define QCC_MODULE "RXSTATS"
+        static uint32_t lastTime = 0;
+        uint32_t now = GetTimestamp();
+        if (((now - lastTime) > 1000) && internal->rxMsgCount) {
+            QCC_DbgPrintf(("Rx reads per message (%s) = %u/%u", GetUniqueName().c_str(), internal->rxReadCount, internal->rxMsgCount));
+            lastTime = now;
+        }
+#undef QCC_MODULE
+#define QCC_MODULE "ALLJOYN"
+#endif
         if (status == ER_TIMEOUT) {
             internal->lock.Lock(MUTEX_CONTEXT);
             internal->bus.GetInternal().GetIODispatch().EnableReadCallback(internal->stream, internal->idleTimeout);
@@ -686,54 +883,26 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
         return ER_BUS_NO_ENDPOINT;
     }
 
+    RemoteEndpoint rep = RemoteEndpoint::wrap(this);
     QStatus status = ER_OK;
     while (status == ER_OK) {
-        if (internal->getNextMsg) {
+        if (internal->txBatch.empty()) {
             internal->lock.Lock(MUTEX_CONTEXT);
-            if (!internal->txQueue.empty()) {
-                /* Make a deep copy of the message since there is state information inside the message.
-                 * Each copy of the message could be in different write state.
-                 */
-                internal->currentWriteMsg = Message(internal->txQueue.back(), true);
-
-                /* Alert next thread on wait queue */
-                if (0 < internal->txWaitQueue.size()) {
-                    Thread* wakeMe = internal->txWaitQueue.back();
-                    internal->txWaitQueue.pop_back();
-                    status = wakeMe->Alert();
-                    if (ER_OK != status) {
-                        QCC_LogError(status, ("Failed to alert thread blocked on full tx queue"));
-                    }
-                }
-                internal->getNextMsg = false;
+            if (internal->txQueue.empty()) {
+                internal->bus.GetInternal().GetIODispatch().DisableWriteCallback(internal->stream);
                 internal->lock.Unlock(MUTEX_CONTEXT);
-            } else {
-
+                return ER_OK;
+            }
+            FillTxBatch();
+            if (internal->txBatch.empty()) {
+                /* The oldest message is still being encrypted, the crypto worker re-enables writes */
                 internal->bus.GetInternal().GetIODispatch().DisableWriteCallback(internal->stream);
                 internal->lock.Unlock(MUTEX_CONTEXT);
                 return ER_OK;
             }
-        }
-        /* Deliver message */
-        RemoteEndpoint rep = RemoteEndpoint::wrap(this);
-        status = internal->currentWriteMsg->DeliverNonBlocking(rep);
-        /* Report authorization failure as a security violation */
-        if (status == ER_BUS_NOT_AUTHORIZED) {
-            internal->bus.GetInternal().GetLocalEndpoint()->GetPeerObj()->HandleSecurityViolation(internal->currentWriteMsg, status);
-            /*
-             * Clear the error after reporting the security violation otherwise we will exit
-             * this thread which will shut down the endpoint.
-             */
-            status = ER_OK;
-        }
-        if (status == ER_OK) {
-            /* Message has been successfully delivered. i.e. PushBytes is complete
-             */
-            internal->lock.Lock(MUTEX_CONTEXT);
-            internal->txQueue.pop_back();
-            internal->getNextMsg = true;
             internal->lock.Unlock(MUTEX_CONTEXT);
         }
+        status = WriteTxBatch(rep);
     }
 
     if (status == ER_TIMEOUT) {
@@ -757,13 +926,276 @@ QStatus _RemoteEndpoint::WriteCallback(qcc::Sink& sink, bool isTimedOut) {
     return status;
 }
 
+#if defined(QCC_OS_GROUP_POSIX) && !defined(QCC_OS_DARWIN)
+QStatus _RemoteEndpoint::SendBytesSG(SocketFd sockfd, const IOVec* iov, size_t numIov, size_t& pushed)
+{
+    /* A write can stop part way through the buffers so any beyond the first MAX_TX_BATCH are left for the next one */
+    struct iovec vec[MAX_TX_BATCH];
+    size_t numVec = (std::min)(numIov, MAX_TX_BATCH);
+    for (size_t i = 0; i < numVec; ++i) {
+        vec[i].iov_base = iov[i].buf;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec;
+    msg.msg_iovlen = numVec;
+
+    pushed = 0;
+    ssize_t ret = sendmsg(static_cast<int>(sockfd), &msg, MSG_NOSIGNAL);
+    if (ret == -1) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return ER_TIMEOUT;
+        }
+        if ((errno == EPIPE) || (errno == ECONNRESET)) {
+            return ER_SOCK_OTHER_END_CLOSED;
+        }
+        QCC_LogError(ER_OS_ERROR, ("sendmsg (sockfd = %d): %d - %s", sockfd, errno, strerror(errno)));
+        return ER_OS_ERROR;
+    }
+    pushed = static_cast<size_t>(ret);
+    return ER_OK;
+}
+#endif
+
+void _RemoteEndpoint::FillTxBatch()
+{
+    while (!internal->txQueue.empty() && (internal->txBatch.size() < MAX_TX_BATCH)) {
+        Internal::TxEntry& next = internal->txQueue.back();
+        /*
+         * Messages must be written in order so nothing more can be taken until the oldest message
+         * has been encrypted.
+         */
+        if (next.msg->encryptPending) {
+            break;
+        }
+        /*
+         * Messages that pass handles must be written on their own. Endpoints that cannot do
+         * scatter-gather writes get one message at a time.
+         */
+        if (!internal->txBatch.empty() && (next.msg->handles || internal->txBatch.front().msg->handles || !internal->sgWrite)) {
+            break;
+        }
+        /*
+         * The write state is kept by the endpoint so the marshaled buffer can be shared with
+         * any other endpoints this message was queued on. Messages that still need to be
+         * encrypted are the exception since encryption rewrites the buffer in place, these
+         * get a private copy. Messages handed to a crypto worker already have one.
+         */
+        if (next.msg->encrypt && (next.msg->encryptStatus == ER_OK)) {
+            internal->txBatch.push_back(Internal::TxEntry(Message(next.msg, true), next.size));
+        } else {
+            internal->txBatch.push_back(next);
+        }
+        internal->txQueue.pop_back();
+    }
+}
+
+QStatus _RemoteEndpoint::WriteTxBatch(RemoteEndpoint& rep)
+{
+    std::deque<Internal::TxEntry>& batch = internal->txBatch;
+    QStatus status = ER_OK;
+
+    /*
+     * Start delivery of messages that were just added to the batch. A message that cannot be sent
+     * is completed without being written.
+     */
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Internal::TxEntry& entry = batch[i];
+        if (entry.context.writeState == MESSAGE_NEW) {
+            status = entry.msg->BeginDelivery(rep, entry.context);
+            if (status != ER_OK) {
+                if (entry.context.writeState != MESSAGE_COMPLETE) {
+                    return status;
+                }
+                /* Report authorization failure as a security violation */
+                if (status == ER_BUS_NOT_AUTHORIZED) {
+                    internal->bus.GetInternal().GetLocalEndpoint()->GetPeerObj()->HandleSecurityViolation(entry.msg, status);
+                } else {
+                    QCC_LogError(status, ("Discarding message %s", entry.msg->Description().c_str()));
+                }
+                status = ER_OK;
+            }
+        }
+    }
+
+    /*
+     * Count the messages that still have bytes to write. These are always at the end of the
+     * batch since messages are written in order.
+     */
+    size_t first = 0;
+    while ((first < batch.size()) && (batch[first].context.writeState == MESSAGE_COMPLETE)) {
+        ++first;
+    }
+    size_t pending = batch.size() - first;
+
+    if ((pending > 1) && internal->sgWrite) {
+        std::vector<IOVec>& iov = internal->txIov;
+        for (size_t i = 0; i < pending; ++i) {
+            iov[i].buf = const_cast<uint8_t*>(batch[first + i].context.writePtr);
+            iov[i].len = batch[first + i].context.countWrite;
+        }
+        size_t pushed = 0;
+        status = PushBytesSG(&iov[0], pending, pushed);
+        if (status == ER_OK) {
+            if (pushed == 0) {
+                return ER_TIMEOUT;
+            }
+            /*
+             * Advance the write state of each message covered by the write. The last of these may
+             * have been partially written.
+             */
+            for (size_t i = first; (pushed > 0) && (i < batch.size()); ++i) {
+                _Message::WriteContext& context = batch[i].context;
+                size_t n = (std::min)(pushed, context.countWrite);
+                context.writePtr += n;
+                context.countWrite -= n;
+                context.writeState = (context.countWrite == 0) ? MESSAGE_COMPLETE : MESSAGE_HEADER_BODY;
+                pushed -= n;
+            }
+        } else if (status == ER_NOT_IMPLEMENTED) {
+            /* Fall back to writing one message at a time from now on */
+            internal->sgWrite = false;
+            status = ER_OK;
+        } else {
+            return status;
+        }
+    } else if (pending > 0) {
+        status = batch[first].msg->DeliverNonBlocking(rep, batch[first].context);
+        if (status != ER_OK) {
+            return status;
+        }
+    }
+
+    /*
+     * Release messages that have been completely written and wake up a thread waiting for
+     * room in the tx queue for each one.
+     */
+    TxQueueListener* writableListener = NULL;
+    internal->lock.Lock(MUTEX_CONTEXT);
+    while (!batch.empty() && (batch.front().context.writeState == MESSAGE_COMPLETE)) {
+        internal->ReleaseTxBytes(batch.front().size);
+        batch.pop_front();
+        if (0 < internal->txWaitQueue.size()) {
+            Thread* wakeMe = internal->txWaitQueue.back();
+            internal->txWaitQueue.pop_back();
+            QStatus alertStatus = wakeMe->Alert();
+            if (ER_OK != alertStatus) {
+                QCC_LogError(alertStatus, ("Failed to alert thread blocked on full tx queue"));
+            }
+        }
+    }
+    if (internal->txWritablePending && internal->TxQueueLow()) {
+        internal->txWritablePending = false;
+        writableListener = internal->txListener;
+    }
+    internal->lock.Unlock(MUTEX_CONTEXT);
+    if (writableListener) {
+        writableListener->TxQueueWritable(rep);
+    }
+    return status;
+}
+
+QStatus _RemoteEndpoint::EncryptTxMessage(Message& msg, bool encrypt)
+{
+    QStatus status = encrypt ? msg->EncryptMessage() : ER_OK;
+
+    internal->lock.Lock(MUTEX_CONTEXT);
+    msg->encryptStatus = status;
+    msg->encryptPending = false;
+    /*
+     * The writer only stops for the oldest message so that is the only one that needs to
+     * re-enable it.
+     */
+    if (!internal->txQueue.empty() && internal->txQueue.back().msg.iden(msg) && internal->txBatch.empty()) {
+        internal->bus.GetInternal().GetIODispatch().EnableWriteCallbackNow(internal->stream);
+    }
+    internal->lock.Unlock(MUTEX_CONTEXT);
+    return status;
+}
+
 QStatus _RemoteEndpoint::PushMessage(Message& msg)
 {
     QCC_DbgTrace(("RemoteEndpoint::PushMessage %s (serial=%d)", GetUniqueName().c_str(), msg->GetCallSerial()));
-    static const size_t MAX_TX_QUEUE_SIZE = 30;
+    return QueueMessage(msg, false);
+}
+
+QStatus _RemoteEndpoint::TryPushMessage(Message& msg)
+{
+    QCC_DbgTrace(("RemoteEndpoint::TryPushMessage %s (serial=%d)", GetUniqueName().c_str(), msg->GetCallSerial()));
+    return QueueMessage(msg, true);
+}
+
+void _RemoteEndpoint::SetTxQueueLimits(size_t maxMsgs, size_t maxBytes, TxQueuePolicy policy)
+{
+    if (internal) {
+        internal->lock.Lock(MUTEX_CONTEXT);
+        internal->maxTxMsgs = (std::max)(maxMsgs, (size_t)1);
+        internal->maxTxBytes = maxBytes;
+        internal->txPolicy = policy;
+        internal->lock.Unlock(MUTEX_CONTEXT);
+    }
+}
+
+void _RemoteEndpoint::SetTxQueueListener(TxQueueListener* listener)
+{
+    if (internal) {
+        internal->lock.Lock(MUTEX_CONTEXT);
+        internal->txListener = listener;
+        internal->lock.Unlock(MUTEX_CONTEXT);
+    }
+}
 
+bool _RemoteEndpoint::DiscardTxMessage(bool expiredOnly, uint32_t& maxWait)
+{
+    /*
+     * Messages that have already been taken for writing are not in txQueue so only messages
+     * that have not been started are discarded. The oldest messages are at the back.
+     */
+    deque<Internal::TxEntry>::iterator it = internal->txQueue.end();
+    while (it != internal->txQueue.begin()) {
+        --it;
+        uint32_t expMs;
+        if (it->msg->IsExpired(&expMs) || (!expiredOnly && it->msg->ttl)) {
+            QCC_DbgHLPrintf(("Discarding %s from full tx queue (%s)", it->msg->Description().c_str(), GetUniqueName().c_str()));
+            if (it->msg->encryptPending) {
+                internal->bus.GetInternal().GetCryptoWorkerPool().Cancel(it->msg);
+            }
+            bool wasHead = ((it + 1) == internal->txQueue.end());
+            internal->ReleaseTxBytes(it->size);
+            internal->txQueue.erase(it);
+            /*
+             * The writer stops while the oldest message is being encrypted. If that was the message
+             * just discarded nothing else will re-enable it.
+             */
+            if (wasHead && !internal->txQueue.empty() && internal->txBatch.empty()) {
+                internal->bus.GetInternal().GetIODispatch().EnableWriteCallbackNow(internal->stream);
+            }
+            return true;
+        }
+        maxWait = (std::min)(maxWait, expMs);
+    }
+    return false;
+}
+
+QStatus _RemoteEndpoint::QueueMessage(Message& msg, bool tryOnly)
+{
+    size_t numQueued;
+    return QueueMessages(&msg, 1, tryOnly, numQueued);
+}
+
+QStatus _RemoteEndpoint::PushMessages(Message* msgs, size_t numMsgs, size_t& numQueued)
+{
+    QCC_DbgTrace(("RemoteEndpoint::PushMessages %s (count=%d)", GetUniqueName().c_str(), numMsgs));
+    return QueueMessages(msgs, numMsgs, false, numQueued);
+}
+
+QStatus _RemoteEndpoint::QueueMessages(Message* msgs, size_t numMsgs, bool tryOnly, size_t& numQueued)
+{
     QStatus status = ER_OK;
 
+    numQueued = 0;
     /* Remote endpoints can be invalid if they were created with the default
      * constructor or being torn down. Return ER_BUS_NO_ENDPOINT only if the
      * endpoint was created with the default constructor. i.e. internal=NULL
@@ -779,72 +1211,109 @@ QStatus _RemoteEndpoint::PushMessage(Message& msg)
     if (internal->stopping) {
         return ER_BUS_ENDPOINT_CLOSING;
     }
+    bool disconnect = false;
+    CryptoWorkerPool& cryptoPool = internal->bus.GetInternal().GetCryptoWorkerPool();
     internal->lock.Lock(MUTEX_CONTEXT);
-    size_t count = internal->txQueue.size();
-    bool wasEmpty = (count == 0);
-    if (MAX_TX_QUEUE_SIZE > count) {
-        internal->txQueue.push_front(msg);
-    } else {
-        while (true) {
-            /* Remove a queue entry whose TTLs is expired if possible */
-            deque<Message>::iterator it = internal->txQueue.begin();
+    TxQueuePolicy policy = tryOnly ? TX_QUEUE_DROP_NEW : internal->txPolicy;
+#ifndef NDEBUG
+    size_t count = internal->TxQueueSize();
+#endif
+    /*
+     * The lock is held for the whole batch so the writer is only woken for the first message
+     * unless the queue drains while waiting for room.
+     */
+    while ((status == ER_OK) && (numQueued < numMsgs)) {
+        Message& msg = msgs[numQueued];
+        /*
+         * Charge the marshaled size rather than the allocated buffer size. The same amount is
+         * released when the message leaves the queue even if encryption changes its length.
+         */
+        size_t msgSize = static_cast<size_t>(msg->bufEOD - reinterpret_cast<uint8_t*>(msg->msgBuf));
+        while (internal->TxQueueFull(msgSize)) {
+            /* Remove a queue entry whose TTL has expired if possible */
             uint32_t maxWait = 20 * 1000;
-            while (it != internal->txQueue.end()) {
-                uint32_t expMs;
-                if ((*it)->IsExpired(&expMs)) {
-                    internal->txQueue.erase(it);
-                    break;
-                } else {
-                    ++it;
-                }
-                maxWait = (std::min)(maxWait, expMs);
+            if (DiscardTxMessage(true, maxWait)) {
+                continue;
+            }
+            if ((policy == TX_QUEUE_DROP_EXPIRABLE) && DiscardTxMessage(false, maxWait)) {
+                continue;
+            }
+            if (policy == TX_QUEUE_DISCONNECT) {
+                status = ER_BUS_TX_QUEUE_FULL;
+                disconnect = true;
+                break;
             }
-            if (internal->txQueue.size() < MAX_TX_QUEUE_SIZE) {
-                /* Check queue wasn't drained while we were waiting */
-                if (internal->txQueue.size() == 0) {
-                    wasEmpty = true;
+            if (policy != TX_QUEUE_BLOCK) {
+                status = ER_BUS_TX_QUEUE_FULL;
+                if (tryOnly) {
+                    internal->txWritablePending = true;
                 }
-                internal->txQueue.push_front(msg);
-                status = ER_OK;
                 break;
-            } else {
-                /* This thread will have to wait for room in the queue */
-                Thread* thread = Thread::GetThread();
-                assert(thread);
+            }
+            /* This thread will have to wait for room in the queue */
+            Thread* thread = Thread::GetThread();
+            assert(thread);
 
-                thread->AddAuxListener(this);
-                internal->txWaitQueue.push_front(thread);
-                internal->lock.Unlock(MUTEX_CONTEXT);
-                status = Event::Wait(Event::neverSet, maxWait);
-                internal->lock.Lock(MUTEX_CONTEXT);
+            thread->AddAuxListener(this);
+            internal->txWaitQueue.push_front(thread);
+            internal->lock.Unlock(MUTEX_CONTEXT);
+            status = Event::Wait(Event::neverSet, maxWait);
+            internal->lock.Lock(MUTEX_CONTEXT);
 
-                /* Reset alert status */
-                if (ER_ALERTED_THREAD == status) {
-                    if (thread->GetAlertCode() == ENDPOINT_IS_DEAD_ALERTCODE) {
-                        status = ER_BUS_ENDPOINT_CLOSING;
-                    }
-                    thread->GetStopEvent().ResetEvent();
-                }
-                /* Remove thread from wait queue. */
-                thread->RemoveAuxListener(this);
-                deque<Thread*>::iterator eit = find(internal->txWaitQueue.begin(), internal->txWaitQueue.end(), thread);
-                if (eit != internal->txWaitQueue.end()) {
-                    internal->txWaitQueue.erase(eit);
+            /* Reset alert status */
+            if (ER_ALERTED_THREAD == status) {
+                if (thread->GetAlertCode() == ENDPOINT_IS_DEAD_ALERTCODE) {
+                    status = ER_BUS_ENDPOINT_CLOSING;
                 }
+                thread->GetStopEvent().ResetEvent();
+            }
+            /* Remove thread from wait queue. */
+            thread->RemoveAuxListener(this);
+            deque<Thread*>::iterator eit = find(internal->txWaitQueue.begin(), internal->txWaitQueue.end(), thread);
+            if (eit != internal->txWaitQueue.end()) {
+                internal->txWaitQueue.erase(eit);
+            }
 
-                if ((ER_OK != status) && (ER_ALERTED_THREAD != status) && (ER_TIMEOUT != status)) {
-                    break;
-                }
+            if ((ER_OK != status) && (ER_ALERTED_THREAD != status) && (ER_TIMEOUT != status)) {
+                break;
+            }
+            status = ER_OK;
+        }
 
+        if (status == ER_OK) {
+            /*
+             * If the bus has crypto workers, messages that need to be encrypted get a private copy
+             * (the buffer is rewritten in place) that is encrypted by a worker while it waits in
+             * the queue.
+             */
+            Message txMsg = msg;
+            if (msg->encrypt && cryptoPool.IsRunning()) {
+                txMsg = Message(msg, true);
+            }
+            /* Check if the queue was drained while we were waiting */
+            bool wasEmpty = (internal->TxQueueSize() == 0);
+            internal->txQueue.push_front(Internal::TxEntry(txMsg, msgSize));
+            internal->txBytes += msgSize;
+            if (!txMsg.iden(msg)) {
+                RemoteEndpoint rep = RemoteEndpoint::wrap(this);
+                txMsg->encryptPending = (cryptoPool.Submit(rep, txMsg, msgSize) == ER_OK);
+            }
+            if (wasEmpty) {
+                internal->bus.GetInternal().GetIODispatch().EnableWriteCallbackNow(internal->stream);
             }
+            ++numQueued;
         }
     }
+    internal->lock.Unlock(MUTEX_CONTEXT);
 
-
-    if (wasEmpty) {
-        internal->bus.GetInternal().GetIODispatch().EnableWriteCallbackNow(internal->stream);
+    if (disconnect) {
+        QCC_LogError(status, ("Disconnecting endpoint with full tx queue (%s)", GetUniqueName().c_str()));
+        if (disconnectStatus == ER_OK) {
+            disconnectStatus = status;
+        }
+        Stop();
+        status = ER_BUS_ENDPOINT_CLOSING;
     }
-    internal->lock.Unlock(MUTEX_CONTEXT);
 #ifndef NDEBUG
 #undef QCC_MODULE
 #define QCC_MODULE "TXSTATS"
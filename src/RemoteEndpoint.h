@@ -29,6 +29,7 @@
 #include <qcc/String.h>
 #include <qcc/GUID.h>
 #include <qcc/Mutex.h>
+#include <qcc/SocketTypes.h>
 #include <qcc/Stream.h>
 #include <qcc/Thread.h>
 
@@ -116,6 +117,37 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
         virtual void EndpointExit(RemoteEndpoint& ep) = 0;
     };
 
+    /**
+     * What PushMessage() does when the transmit queue is full. Messages whose time-to-live has
+     * expired are always discarded first.
+     */
+    typedef enum {
+        TX_QUEUE_BLOCK,           /**< Block the caller until there is room in the queue */
+        TX_QUEUE_DROP_EXPIRABLE,  /**< Discard the oldest queued message that has a time-to-live */
+        TX_QUEUE_DROP_NEW,        /**< Fail with ER_BUS_TX_QUEUE_FULL */
+        TX_QUEUE_DISCONNECT       /**< Disconnect the endpoint */
+    } TxQueuePolicy;
+
+    /**
+     * Listener called when a full transmit queue can accept messages again.
+     */
+    class TxQueueListener {
+      public:
+        /**
+         * Virtual destructor for derivable class.
+         */
+        virtual ~TxQueueListener() { }
+
+        /**
+         * Called once the transmit queue has drained to half its limits after a call to
+         * TryPushMessage() failed with ER_BUS_TX_QUEUE_FULL. This is called on the endpoint's
+         * write thread so it must not block.
+         *
+         * @param ep   Endpoint whose transmit queue has room.
+         */
+        virtual void TxQueueWritable(RemoteEndpoint& ep) = 0;
+    };
+
     /**
      * Called when a new untrusted client has connected to the daemon.
      * This calls into the transport's UntrustedClientStart function
@@ -163,6 +195,49 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     virtual QStatus PushMessage(Message& msg);
 
+    /**
+     * Send an outgoing message without blocking. If the transmit queue is full the message is not
+     * queued and the listener set with SetTxQueueListener() is called when the queue has room.
+     *
+     * @param msg   Message to be sent.
+     * @return
+     *      - ER_OK if successful.
+     *      - ER_BUS_TX_QUEUE_FULL if the transmit queue is full.
+     *      - An error status otherwise
+     */
+    QStatus TryPushMessage(Message& msg);
+
+    /**
+     * Send a batch of outgoing messages in order. The messages are queued under a single
+     * acquisition of the endpoint lock and the writer is woken once for the batch. The transmit
+     * queue limits apply to each message as they do for PushMessage().
+     *
+     * @param msgs        Messages to be sent.
+     * @param numMsgs     Number of messages.
+     * @param numQueued   [OUT] Number of messages that were queued. Messages are queued in order
+     *                    so the messages that were not queued are at the end of the array.
+     * @return
+     *      - ER_OK if all messages were queued.
+     *      - An error status otherwise
+     */
+    QStatus PushMessages(Message* msgs, size_t numMsgs, size_t& numQueued);
+
+    /**
+     * Set the limits of the transmit queue. The queue is full when either limit is reached.
+     *
+     * @param maxMsgs    Maximum number of queued messages.
+     * @param maxBytes   Maximum number of queued bytes or 0 for no byte limit.
+     * @param policy     What PushMessage() does when the queue is full.
+     */
+    void SetTxQueueLimits(size_t maxMsgs, size_t maxBytes, TxQueuePolicy policy);
+
+    /**
+     * Set the listener that is called when a full transmit queue has room again.
+     *
+     * @param listener   Transmit queue listener or NULL.
+     */
+    void SetTxQueueListener(TxQueueListener* listener);
+
     /**
      * Start the endpoint.
      *
@@ -270,6 +345,40 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     QStatus Establish(const qcc::String& authMechanisms, qcc::String& authUsed, qcc::String& redirection, AuthListener* listener = NULL);
 
+    /**
+     * Start establishing an incoming connection without blocking. EstablishContinue() must be
+     * called each time the stream has data to read until it returns something other than
+     * ER_WOULDBLOCK, or EstablishCancel() must be called to abandon the connection.
+     *
+     * @param authMechanisms  The authentication mechanism(s) to accept.
+     * @param listener        Optional authentication listener
+     *
+     * @return
+     *      - ER_OK if successful.
+     *      - An error status otherwise
+     */
+    QStatus EstablishStart(const qcc::String& authMechanisms, AuthListener* listener = NULL);
+
+    /**
+     * Continue establishing a connection started with EstablishStart() using the data that is
+     * available on the stream. This call does not block.
+     *
+     * @param authUsed        [OUT]    Returns the name of the authentication method
+     *                                 that was used to establish the connection.
+     *
+     * @return
+     *      - ER_OK if the connection is established.
+     *      - ER_WOULDBLOCK if more data is needed.
+     *      - ER_BUS_ENDPOINT_REDIRECTED if the endpoint is being redirected.
+     *      - An error status otherwise
+     */
+    QStatus EstablishContinue(qcc::String& authUsed);
+
+    /**
+     * Abandon a connection started with EstablishStart() that has not completed.
+     */
+    void EstablishCancel();
+
     /**
      * Get the GUID of the remote side of a bus-to-bus endpoint.
      *
@@ -320,6 +429,20 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     qcc::Stream& GetStream();
 
+    /**
+     * Read bytes of an incoming message. Once the endpoint has been started small reads are served
+     * from a read-ahead buffer that is filled with as much data as the stream has available so that
+     * several messages can be received with a single read from the underlying stream.
+     *
+     * @param buf          Buffer to receive the data.
+     * @param reqBytes     Number of bytes requested.
+     * @param actualBytes  [OUT] Number of bytes returned in buf.
+     * @param timeout      Timeout in milliseconds.
+     *
+     * @return ER_OK if successful, otherwise the error returned by the endpoint's source.
+     */
+    QStatus PullMessageBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout);
+
     /**
      * Set link timeout
      *
@@ -399,8 +522,48 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     QStatus SetLinkTimeout(uint32_t idleTimeout, uint32_t probeTimeout, uint32_t maxIdleProbes);
 
+    /**
+     * Write several buffers to the endpoint's underlying media with a single scatter-gather
+     * write. This is used to flush a batch of queued messages with one system call. Endpoints
+     * whose stream is a socket should override this method with SendBytesSG. Endpoints that do
+     * not override it have their messages written one at a time through the endpoint's sink.
+     *
+     * @param iov      Array of buffers to write.
+     * @param numIov   Number of entries in iov.
+     * @param pushed   [OUT] Number of bytes written. This can be less than the total length of
+     *                 the buffers and can end in the middle of any buffer.
+     *
+     * @return
+     *      - ER_OK if some or all of the data was written.
+     *      - ER_TIMEOUT if no data could be written without blocking.
+     *      - ER_NOT_IMPLEMENTED if the endpoint does not support scatter-gather writes.
+     *      - An error status otherwise
+     */
+    virtual QStatus PushBytesSG(const qcc::IOVec* iov, size_t numIov, size_t& pushed) { return ER_NOT_IMPLEMENTED; }
+
+#if defined(QCC_OS_GROUP_POSIX) && !defined(QCC_OS_DARWIN)
+    /**
+     * Implementation of PushBytesSG for endpoints whose stream is a socket. Darwin has no
+     * MSG_NOSIGNAL so endpoints there write their messages one at a time.
+     *
+     * @param sockfd   Socket to write to.
+     * @param iov      Array of buffers to write.
+     * @param numIov   Number of entries in iov.
+     * @param pushed   [OUT] Number of bytes written.
+     *
+     * @return
+     *      - ER_OK if some or all of the data was written.
+     *      - ER_TIMEOUT if no data could be written without blocking.
+     *      - ER_SOCK_OTHER_END_CLOSED if the other end closed the connection.
+     *      - ER_OS_ERROR otherwise
+     */
+    static QStatus SendBytesSG(qcc::SocketFd sockfd, const qcc::IOVec* iov, size_t numIov, size_t& pushed);
+#endif
+
   private:
 
+    friend class CryptoWorkerPool;
+
     class Internal;
     Internal* internal; /* All the internal state for a remote endpoint */
 
@@ -461,6 +624,63 @@ class _RemoteEndpoint : public _BusEndpoint, public qcc::ThreadListener, public
      */
     QStatus WriteCallback(qcc::Sink& sink, bool isTimedOut);
 
+    /**
+     * Add a message to the tx queue applying the queue limits.
+     *
+     * @param msg       Message to queue.
+     * @param tryOnly   If true fail with ER_BUS_TX_QUEUE_FULL rather than apply the overflow policy.
+     */
+    QStatus QueueMessage(Message& msg, bool tryOnly);
+
+    /**
+     * Add messages to the tx queue in order applying the queue limits to each one.
+     *
+     * @param msgs        Messages to queue.
+     * @param numMsgs     Number of messages.
+     * @param tryOnly     If true fail with ER_BUS_TX_QUEUE_FULL rather than apply the overflow policy.
+     * @param numQueued   [OUT] Number of messages that were queued.
+     */
+    QStatus QueueMessages(Message* msgs, size_t numMsgs, bool tryOnly, size_t& numQueued);
+
+    /**
+     * Discard the oldest message in the tx queue that has expired, or if expiredOnly is false,
+     * that has a time-to-live. Caller must hold the endpoint lock.
+     *
+     * @param expiredOnly  Only discard a message that has expired.
+     * @param maxWait      [IN/OUT] Reduced to the time until the first message expires.
+     * @return true if a message was discarded.
+     */
+    bool DiscardTxMessage(bool expiredOnly, uint32_t& maxWait);
+
+    /**
+     * Move the oldest messages from the tx queue into the batch of messages being written. This
+     * stops at the first message that is waiting for a crypto worker.
+     * Caller must hold the endpoint lock.
+     */
+    void FillTxBatch();
+
+    /**
+     * Called by the crypto worker pool to encrypt a message that is waiting in the tx queue and
+     * mark it ready to be written.
+     *
+     * @param msg       A message that was handed to the crypto worker pool by QueueMessage().
+     * @param encrypt   If false the message is marked ready without being encrypted so it is
+     *                  encrypted by the writer instead.
+     * @return  The status of the encryption.
+     */
+    QStatus EncryptTxMessage(Message& msg, bool encrypt);
+
+    /**
+     * Write as much of the current batch of messages as the media will accept.
+     *
+     * @param rep   Managed reference to this endpoint.
+     * @return
+     *      - ER_OK if the write made progress.
+     *      - ER_TIMEOUT if the media cannot accept more data right now.
+     *      - An error status otherwise
+     */
+    QStatus WriteTxBatch(RemoteEndpoint& rep);
+
     /**
      * Internal callback used to indicate that the Stream for this endpoint has been removed
      * from the IODispatch.
@@ -47,8 +47,10 @@ class TransportList : public TransportListener {
      * @param factory           TransportFactoryContainer telling the list how to create its Transports.
      * @param m_ioDispatch      The IODispatch for this bus.
      * @param concurrency       The maximum number of concurrent method and signal handlers locally executing.
+     * @param dispatchMode      How method and signal handlers are assigned to handler threads.
      */
-    TransportList(BusAttachment& bus, TransportFactoryContainer& factories, qcc::IODispatch* m_ioDispatch, uint32_t concurrency);
+    TransportList(BusAttachment& bus, TransportFactoryContainer& factories, qcc::IODispatch* m_ioDispatch, uint32_t concurrency,
+                  BusAttachment::DispatchMode dispatchMode = BusAttachment::DISPATCH_SERIALIZED);
 
     /** Destructor  */
     virtual ~TransportList();
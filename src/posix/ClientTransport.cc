@@ -119,6 +119,16 @@ class _ClientEndpoint : public _RemoteEndpoint {
      */
     bool SupportsUnixIDs() const { return true; }
 
+#if !defined(QCC_OS_DARWIN)
+    /**
+     * Write a batch of queued messages to the socket with a single sendmsg() call.
+     */
+    QStatus PushBytesSG(const qcc::IOVec* iov, size_t numIov, size_t& pushed)
+    {
+        return SendBytesSG(stream.GetSocketFd(), iov, numIov, pushed);
+    }
+#endif
+
 
   private:
     uint32_t userId;
@@ -1,7 +1,8 @@
 /**
  * @file
  *
- * This file tests AES-CCM against the RFC 3610 test vectors and some or our own tests
+ * This file tests AES-CCM against the RFC 3610 test vectors and some or our own tests and
+ * benchmarks message encryption with and without a cached cipher.
  */
 
 /******************************************************************************
@@ -28,11 +29,17 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Util.h>
+#include <qcc/time.h>
 
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
 #include <alljoyn/version.h>
 
 #include <alljoyn/Status.h>
 
+/* Private files included for unit testing */
+#include <AllJoynCrypto.h>
+
 using namespace qcc;
 using namespace std;
 using namespace ajn;
@@ -322,6 +329,84 @@ static TEST_CASE testVector[] = {
 };
 
 
+class _PingMessage : public _Message {
+  public:
+
+    _PingMessage(BusAttachment& bus) : _Message(bus) { }
+
+    QStatus Ping(const char* payload, uint8_t flags)
+    {
+        MsgArg arg("s", payload);
+        return SignalMsg("s", NULL, 0, "/org/alljoyn/ping", "org.alljoyn.ping", "Ping", &arg, 1, flags, 0);
+    }
+};
+
+/*
+ * Encrypt and decrypt a ping sized message body the way an encrypted ping and its reply would be.
+ */
+static QStatus EncryptedPing(_PingMessage& msg, uint32_t iterations, CryptoContext* txContext, CryptoContext* rxContext, uint64_t& elapsed)
+{
+    QStatus status = ER_OK;
+    const size_t hdrLen = 128;
+    const size_t bodyLen = 64;
+    uint8_t buf[hdrLen + bodyLen + 16];
+    uint8_t plaintext[bodyLen];
+
+    KeyBlob txKey;
+    txKey.Rand(Crypto_AES::AES128_SIZE, KeyBlob::AES);
+    txKey.SetTag("ping", KeyBlob::INITIATOR);
+    KeyBlob rxKey(txKey);
+    rxKey.SetTag("ping", KeyBlob::RESPONDER);
+
+    Crypto_GetRandomBytes(buf, hdrLen);
+    Crypto_GetRandomBytes(plaintext, bodyLen);
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t n = 0; (status == ER_OK) && (n < iterations); ++n) {
+        size_t len = bodyLen;
+        memcpy(buf + hdrLen, plaintext, bodyLen);
+        status = ajn::Crypto::Encrypt(msg, txKey, buf, hdrLen, len, txContext);
+        if (status == ER_OK) {
+            status = ajn::Crypto::Decrypt(msg, rxKey, buf, hdrLen, len, rxContext);
+        }
+        if ((status == ER_OK) && ((len != bodyLen) || (memcmp(buf + hdrLen, plaintext, bodyLen) != 0))) {
+            status = ER_FAIL;
+        }
+    }
+    elapsed = GetTimestamp64() - start;
+    return status;
+}
+
+static QStatus EncryptedPingBenchmark(uint32_t iterations)
+{
+    QStatus status = ER_OK;
+    BusAttachment bus("aes_ccm");
+
+    status = bus.Start();
+    for (int compressed = 0; (status == ER_OK) && (compressed < 2); ++compressed) {
+        _PingMessage msg(bus);
+        status = msg.Ping("ping", compressed ? ALLJOYN_FLAG_COMPRESSED : 0);
+        uint64_t uncached = 0;
+        uint64_t cached = 0;
+        if (status == ER_OK) {
+            status = EncryptedPing(msg, iterations, NULL, NULL, uncached);
+        }
+        if (status == ER_OK) {
+            CryptoContext txContext;
+            CryptoContext rxContext;
+            status = EncryptedPing(msg, iterations, &txContext, &rxContext, cached);
+        }
+        if (status == ER_OK) {
+            printf("%s headers %u pings: per message key %8.3f us/ping, cached cipher %8.3f us/ping\n",
+                   compressed ? "compressed  " : "uncompressed", iterations,
+                   (1000.0 * uncached) / iterations, (1000.0 * cached) / iterations);
+        }
+    }
+    bus.Stop();
+    bus.Join();
+    return status;
+}
+
 
 int main(int argc, char** argv)
 {
@@ -387,6 +472,12 @@ int main(int argc, char** argv)
         printf("Crypto_PseudorandomFunctionCCM test PASSED\n");
     }
 
+    status = EncryptedPingBenchmark(10000);
+    if (status != ER_OK) {
+        printf("Encrypted ping benchmark %s\n", QCC_StatusText(status));
+        goto ErrorExit;
+    }
+
     return 0;
 
 ErrorExit:
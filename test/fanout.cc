@@ -0,0 +1,238 @@
+/**
+ * @file
+ *
+ * Broadcast fan-out benchmark. Compares delivering one marshaled message to many remote
+ * endpoints from a shared buffer against making a deep copy of the message per endpoint.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+/* Private files included for unit testing */
+#include <RemoteEndpoint.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+static BusAttachment* gBus;
+
+static const bool falsiness = false;
+
+/*
+ * Number of bytes allocated with operator new. The bus is idle while the benchmark runs so this
+ * is what composing and delivering the messages allocates.
+ */
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    allocatedBytes += size;
+    return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+    free(ptr);
+}
+
+class _FanoutMessage : public _Message {
+  public:
+
+    _FanoutMessage() : _Message(*gBus) { }
+
+    QStatus Signal(const uint8_t* payload, size_t len)
+    {
+        MsgArg arg("ay", len, payload);
+        return SignalMsg("ay", NULL, 0, "/org/alljoyn/fanout", "org.alljoyn.fanout", "Payload", &arg, 1, 0, 0);
+    }
+
+    QStatus Write(RemoteEndpoint& ep)
+    {
+        WriteContext context;
+        return DeliverNonBlocking(ep, context);
+    }
+};
+
+typedef qcc::ManagedObj<_FanoutMessage> FanoutMessage;
+
+static void usage(void)
+{
+    printf("Usage: fanout [-n <endpoints>] [-s <bytes>] [-i <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h               = Print this help message\n");
+    printf("   -n <endpoints>   = Number of endpoints each message is broadcast to (default 100)\n");
+    printf("   -s <bytes>       = Payload size of each message (default 4096)\n");
+    printf("   -i <iterations>  = Number of messages to broadcast (default 1000)\n");
+}
+
+/*
+ * Drain the pipes so the next iteration starts empty and return the number of bytes drained.
+ */
+static size_t Drain(vector<Pipe*>& pipes, uint8_t* scratch, size_t scratchLen)
+{
+    size_t total = 0;
+    for (size_t p = 0; p < pipes.size(); ++p) {
+        size_t avail = pipes[p]->AvailBytes();
+        while (avail) {
+            size_t actual;
+            if (pipes[p]->PullBytes(scratch, (std::min)(avail, scratchLen), actual) != ER_OK) {
+                break;
+            }
+            avail -= actual;
+            total += actual;
+        }
+    }
+    return total;
+}
+
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t numEndpoints = 100;
+    uint32_t payloadSize = 4096;
+    uint32_t iterations = 1000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        uint32_t* opt = NULL;
+        if (0 == strcmp("-n", argv[i])) {
+            opt = &numEndpoints;
+        } else if (0 == strcmp("-s", argv[i])) {
+            opt = &payloadSize;
+        } else if (0 == strcmp("-i", argv[i])) {
+            opt = &iterations;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+        if (++i == argc) {
+            printf("option %s requires a parameter\n", argv[i - 1]);
+            usage();
+            exit(1);
+        }
+        *opt = StringToU32(argv[i], 0, *opt);
+    }
+
+    gBus = new BusAttachment("fanout");
+    gBus->Start();
+
+    vector<Pipe*> pipes;
+    vector<RemoteEndpoint> endpoints;
+    for (uint32_t n = 0; n < numEndpoints; ++n) {
+        Pipe* pipe = new Pipe();
+        pipes.push_back(pipe);
+        RemoteEndpoint ep(*gBus, falsiness, String::Empty, pipe);
+        endpoints.push_back(ep);
+    }
+
+    vector<uint8_t> payload(payloadSize, 0xA5);
+    size_t scratchLen = 64 * 1024;
+    uint8_t* scratch = new uint8_t[scratchLen];
+
+    /*
+     * Per endpoint deep copy. This is how RemoteEndpoint used to track the write state of each
+     * queued message.
+     */
+    uint64_t copyTime = 0;
+    size_t copyAllocated = 0;
+    size_t copyWritten = 0;
+    for (uint32_t it = 0; (status == ER_OK) && (it < iterations); ++it) {
+        FanoutMessage msg;
+        status = msg->Signal(&payload[0], payload.size());
+        size_t allocated = allocatedBytes;
+        uint64_t start = GetTimestamp64();
+        for (uint32_t n = 0; (status == ER_OK) && (n < numEndpoints); ++n) {
+            FanoutMessage copy = FanoutMessage(msg, true);
+            status = copy->Write(endpoints[n]);
+        }
+        copyTime += GetTimestamp64() - start;
+        copyAllocated += allocatedBytes - allocated;
+        copyWritten += Drain(pipes, scratch, scratchLen);
+    }
+
+    /*
+     * Shared buffer with the write state owned by the endpoint.
+     */
+    uint64_t sharedTime = 0;
+    size_t sharedAllocated = 0;
+    size_t sharedWritten = 0;
+    for (uint32_t it = 0; (status == ER_OK) && (it < iterations); ++it) {
+        FanoutMessage msg;
+        status = msg->Signal(&payload[0], payload.size());
+        size_t allocated = allocatedBytes;
+        uint64_t start = GetTimestamp64();
+        for (uint32_t n = 0; (status == ER_OK) && (n < numEndpoints); ++n) {
+            status = msg->Write(endpoints[n]);
+        }
+        sharedTime += GetTimestamp64() - start;
+        sharedAllocated += allocatedBytes - allocated;
+        sharedWritten += Drain(pipes, scratch, scratchLen);
+    }
+
+    if (status == ER_OK) {
+        double deliveries = (double)iterations * numEndpoints;
+        printf("%u endpoints, %u byte payloads, per fan-out:\n", numEndpoints, payloadSize);
+        printf("  deep copy: %10.0f deliveries/s, %10u bytes allocated, %10u bytes written\n",
+               copyTime ? (1000.0 * deliveries / copyTime) : 0.0, (uint32_t)(copyAllocated / iterations), (uint32_t)(copyWritten / iterations));
+        printf("  shared:    %10.0f deliveries/s, %10u bytes allocated, %10u bytes written\n",
+               sharedTime ? (1000.0 * deliveries / sharedTime) : 0.0, (uint32_t)(sharedAllocated / iterations), (uint32_t)(sharedWritten / iterations));
+    } else {
+        QCC_LogError(status, ("Fanout benchmark failed"));
+    }
+
+    endpoints.clear();
+    for (size_t p = 0; p < pipes.size(); ++p) {
+        delete pipes[p];
+    }
+    delete [] scratch;
+    delete gBus;
+
+    printf("\n%s\n", (status == ER_OK) ? "PASSED" : "FAILED");
+    return (status == ER_OK) ? 0 : 1;
+}
@@ -31,6 +31,7 @@
 #include <qcc/String.h>
 #include <qcc/StringUtil.h>
 #include <qcc/ManagedObj.h>
+#include <qcc/time.h>
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/Message.h>
@@ -41,6 +42,7 @@
 /* Private files included for unit testing */
 #include <PeerState.h>
 #include <SignatureUtils.h>
+#include <MarshalPlan.h>
 #include <RemoteEndpoint.h>
 
 #define QCC_MODULE "ALLJOYN"
@@ -147,6 +149,11 @@ class _MyMessage : public _Message {
         return SignalMsg(sig, destination, 0, objPath, interface, signalName, argList, numArgs, 0, 0);
     }
 
+    QStatus Call(const qcc::String& sig, const MsgArg* argList, size_t numArgs, const MarshalPlan* plan)
+    {
+        return CallMsg(sig, "desti.nation", 0, "/foo/bar", "foo.bar", "test", argList, numArgs, 0, plan);
+    }
+
     QStatus UnmarshalBody() { return UnmarshalArgs("*"); }
 
     QStatus Read(RemoteEndpoint& ep, const qcc::String& endpointName, bool pedantic = true)
@@ -1031,6 +1038,111 @@ QStatus TestMsgUnpack()
 }
 
 
+/*
+ * Compare marshaling with and without a precompiled marshal plan
+ */
+static QStatus MarshalPlanBenchmark(const char* sig, const MsgArg& arg, uint32_t iterations)
+{
+    QStatus status = ER_OK;
+    const MarshalPlan* plan = MarshalPlan::Get(sig);
+    MyMessage msg;
+
+    if (!plan) {
+        printf("No marshal plan for %s\n", sig);
+        return ER_FAIL;
+    }
+    /*
+     * Check the planned marshaling round trips
+     */
+    {
+        TestPipe stream;
+        TestPipe* pStream = &stream;
+        RemoteEndpoint ep(*gBus, falsiness, String::Empty, pStream);
+        status = msg->Call(sig, &arg, 1, plan);
+        if (status == ER_OK) {
+            status = msg->Deliver(ep);
+        }
+        if (status == ER_OK) {
+            status = msg->Read(ep, ":88.88");
+        }
+        if (status == ER_OK) {
+            status = msg->Unmarshal(ep, ":88.88");
+        }
+        if (status == ER_OK) {
+            status = msg->UnmarshalBody();
+        }
+        if (status == ER_OK) {
+            size_t numArgs;
+            const MsgArg* args;
+            msg->GetArgs(numArgs, args);
+            if ((numArgs != 1) || (args[0].ToString() != arg.ToString())) {
+                printf("Planned marshaling of %s does not round trip\n", sig);
+                status = ER_FAIL;
+            }
+        }
+        if (status != ER_OK) {
+            return status;
+        }
+    }
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t n = 0; (status == ER_OK) && (n < iterations); ++n) {
+        status = msg->Call(sig, &arg, 1, NULL);
+    }
+    uint64_t genericTime = GetTimestamp64() - start;
+
+    start = GetTimestamp64();
+    for (uint32_t n = 0; (status == ER_OK) && (n < iterations); ++n) {
+        status = msg->Call(sig, &arg, 1, plan);
+    }
+    uint64_t planTime = GetTimestamp64() - start;
+
+    if (status == ER_OK) {
+        printf("%-12s %7u msgs: generic %8.3f us/msg, plan %8.3f us/msg\n", sig, iterations,
+               (1000.0 * genericTime) / iterations, (1000.0 * planTime) / iterations);
+    }
+    return status;
+}
+
+static QStatus MarshalPlanBenchmarks(uint32_t iterations)
+{
+    QStatus status = ER_OK;
+    const size_t numElements = 1000;
+
+    /* a(iiid) - fixed size structs */
+    if (status == ER_OK) {
+        MsgArg* elems = new MsgArg[numElements];
+        for (size_t e = 0; e < numElements; ++e) {
+            elems[e].Set("(iiid)", (int32_t)e, -(int32_t)e, 42, 0.5 * e);
+        }
+        MsgArg arg("a(iiid)", numElements, elems);
+        status = MarshalPlanBenchmark("a(iiid)", arg, iterations);
+        delete [] elems;
+    }
+    /* a(ysu) - structs with strings */
+    if (status == ER_OK) {
+        MsgArg* elems = new MsgArg[numElements];
+        for (size_t e = 0; e < numElements; ++e) {
+            elems[e].Set("(ysu)", (uint8_t)e, s, (uint32_t)e);
+        }
+        MsgArg arg("a(ysu)", numElements, elems);
+        status = MarshalPlanBenchmark("a(ysu)", arg, iterations);
+        delete [] elems;
+    }
+    /* a{is} - dictionary */
+    if (status == ER_OK) {
+        MsgArg* elems = new MsgArg[numElements];
+        for (size_t e = 0; e < numElements; ++e) {
+            elems[e].Set("{is}", (int32_t)e, s);
+        }
+        MsgArg arg("a{is}", numElements, elems);
+        status = MarshalPlanBenchmark("a{is}", arg, iterations);
+        delete [] elems;
+    }
+    return status;
+}
+
+
 static void usage(void)
 {
     printf("Usage: marshal [-f] [-q]\n");
@@ -1038,11 +1150,13 @@ static void usage(void)
     printf("   -f         = fuzzing\n");
     printf("   -q         = Quiet\n");
     printf("   -b         = Suppress big array test (which takes a long time)\n");
+    printf("   -p         = Run the marshal plan benchmarks\n");
 }
 
 int main(int argc, char** argv)
 {
     bool fuzz = false;
+    bool bench = false;
     QStatus status = ER_OK;
 
     printf("AllJoyn Library version: %s\n", ajn::GetVersion());
@@ -1056,6 +1170,8 @@ int main(int argc, char** argv)
             nobig = true;
         } else if (0 == strcmp("-q", argv[i])) {
             quiet = true;
+        } else if (0 == strcmp("-p", argv[i])) {
+            bench = true;
         } else {
             usage();
             exit(1);
@@ -1259,6 +1375,10 @@ int main(int argc, char** argv)
         status = MarshalTests();
     }
 
+    if ((status == ER_OK) && bench) {
+        status = MarshalPlanBenchmarks(1000);
+    }
+
     if (status == ER_OK) {
         printf("\nPASSED\n");
     } else {
@@ -28,6 +28,8 @@
 #include <qcc/StringUtil.h>
 #include <qcc/Mutex.h>
 #include <qcc/Thread.h>
+#include <qcc/time.h>
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 
@@ -563,6 +565,143 @@ static void DoJoinAsync(String name, SessionPort port, const SessionOpts& opts)
 
 }
 
+/*
+ * Get the value of a field (in kB for sizes) from /proc/<pid>/status, or 0 if it cannot be read.
+ */
+static uint32_t GetProcStatus(uint32_t pid, const char* field)
+{
+    String path = "/proc/" + U32ToString(pid) + "/status";
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) {
+        return 0;
+    }
+    char line[256];
+    uint32_t val = 0;
+    size_t len = strlen(field);
+    while (fgets(line, sizeof(line), fp)) {
+        if ((strncmp(line, field, len) == 0) && (line[len] == ':')) {
+            val = (uint32_t) strtoul(line + len + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return val;
+}
+
+class JoinStressCB : public BusAttachment::JoinSessionAsyncCB {
+  public:
+    JoinStressCB() : completed(0), failed(0) { }
+
+    void JoinSessionCB(QStatus status, SessionId id, const SessionOpts& opts, void* context)
+    {
+        uint64_t* start = reinterpret_cast<uint64_t*>(context);
+        uint64_t latency = GetTimestamp64() - *start;
+        delete start;
+        lock.Lock(MUTEX_CONTEXT);
+        latencies.push_back(latency);
+        if (status == ER_OK) {
+            ids.push_back(id);
+        } else {
+            ++failed;
+        }
+        ++completed;
+        lock.Unlock(MUTEX_CONTEXT);
+    }
+
+    Mutex lock;
+    vector<uint64_t> latencies;
+    vector<SessionId> ids;
+    uint32_t completed;
+    uint32_t failed;
+};
+
+/*
+ * Join the same session port count times with up to concurrency joins outstanding at once, then
+ * leave all the sessions joined. Reports joins per second, join latency percentiles and, if the
+ * daemon pid is given, the peak number of daemon threads.
+ */
+static void DoJoinStress(String name, SessionPort port, uint32_t count, uint32_t concurrency, uint32_t daemonPid)
+{
+    JoinStressCB cb;
+    SessionOpts opts;
+    uint32_t issued = 0;
+    uint32_t peakThreads = 0;
+    uint32_t startThreads = daemonPid ? GetProcStatus(daemonPid, "Threads") : 0;
+
+    uint64_t start = GetTimestamp64();
+    uint64_t lastProgress = start;
+    uint32_t lastCompleted = 0;
+    while (true) {
+        cb.lock.Lock(MUTEX_CONTEXT);
+        uint32_t completed = cb.completed;
+        cb.lock.Unlock(MUTEX_CONTEXT);
+        if (completed == count) {
+            break;
+        }
+        if (daemonPid) {
+            peakThreads = max(peakThreads, GetProcStatus(daemonPid, "Threads"));
+        }
+        uint64_t now = GetTimestamp64();
+        if (completed != lastCompleted) {
+            lastCompleted = completed;
+            lastProgress = now;
+        } else if ((now - lastProgress) > 60000) {
+            printf("joinstress: gave up waiting for %u joins\n", issued - completed);
+            break;
+        }
+        if ((issued < count) && ((issued - completed) < concurrency)) {
+            uint64_t* ts = new uint64_t(GetTimestamp64());
+            QStatus status = s_bus->JoinSessionAsync(name.c_str(), port, NULL, opts, &cb, ts);
+            if (status != ER_OK) {
+                printf("JoinSessionAsync(%s, %u) failed with %s\n", name.c_str(), port, QCC_StatusText(status));
+                delete ts;
+                break;
+            }
+            ++issued;
+        } else {
+            qcc::Sleep(1);
+        }
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+
+    cb.lock.Lock(MUTEX_CONTEXT);
+    vector<uint64_t> latencies = cb.latencies;
+    vector<SessionId> ids = cb.ids;
+    uint32_t failed = cb.failed;
+    cb.lock.Unlock(MUTEX_CONTEXT);
+
+    sort(latencies.begin(), latencies.end());
+    uint64_t p50 = latencies.empty() ? 0 : latencies[latencies.size() / 2];
+    uint64_t p99 = latencies.empty() ? 0 : latencies[(latencies.size() * 99) / 100];
+    uint64_t maxLatency = latencies.empty() ? 0 : latencies.back();
+    printf("joinstress: %u joins (%u concurrent), %u ok, %u failed in %u ms: %.1f joins/s\n",
+           (unsigned int) latencies.size(), concurrency, (unsigned int) ids.size(), failed, (unsigned int) elapsed,
+           (latencies.size() * 1000.0) / (elapsed ? elapsed : 1));
+    printf("joinstress: latency p50 %u ms, p99 %u ms, max %u ms\n", (unsigned int) p50, (unsigned int) p99, (unsigned int) maxLatency);
+    if (daemonPid) {
+        printf("joinstress: daemon threads %u before, %u peak\n", startThreads, peakThreads);
+    }
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        s_bus->LeaveSession(ids[i]);
+    }
+
+    /* Wait for any stragglers so the callback can be destroyed safely */
+    while (true) {
+        cb.lock.Lock(MUTEX_CONTEXT);
+        uint32_t completed = cb.completed;
+        uint32_t numIds = cb.ids.size();
+        cb.lock.Unlock(MUTEX_CONTEXT);
+        if (completed == issued) {
+            for (size_t i = ids.size(); i < numIds; ++i) {
+                s_bus->LeaveSession(cb.ids[i]);
+            }
+            break;
+        }
+        qcc::Sleep(10);
+    }
+}
+
 static void DoJoin(String name, SessionPort port, const SessionOpts& opts)
 {
     SessionId id;
@@ -831,6 +970,17 @@ int main(int argc, char** argv)
             opts.proximity = static_cast<SessionOpts::Proximity>(StringToU32(NextTok(line), 0, 0xFF));
             opts.transports = static_cast<TransportMask>(StringToU32(NextTok(line), 0, 0xFFFF));
             DoJoinAsync(name, port, opts);
+        } else if (cmd == "joinstress") {
+            String name = NextTok(line);
+            SessionPort port = static_cast<SessionPort>(StringToU32(NextTok(line), 0, 0));
+            uint32_t count = StringToU32(NextTok(line), 0, 1000);
+            uint32_t concurrency = StringToU32(NextTok(line), 0, 100);
+            uint32_t daemonPid = StringToU32(NextTok(line), 0, 0);
+            if (name.empty() || (port == 0) || (concurrency == 0)) {
+                printf("Usage: joinstress <name> <port> [count] [concurrency] [daemonPid]\n");
+                continue;
+            }
+            DoJoinStress(name, port, count, concurrency, daemonPid);
         } else if (cmd == "leave") {
             SessionId id = NextTokAsSessionId(line);
             if (id == 0) {
@@ -951,6 +1101,7 @@ int main(int argc, char** argv)
             printf("cancelfind <name_prefix>                                      - Cancel discovering names that begins with prefix\n");
             printf("list                                                          - List port bindings, discovered names and active sessions\n");
             printf("join <name> <port> [isMultipoint] [traffic] [proximity] [transports] - Join a session\n");
+            printf("joinstress <name> <port> [count] [concurrency] [daemonPid]   - Measure join rate, latency and daemon threads\n");
             printf("leave <sessionId>                                             - Leave a session\n");
             printf("chat <sessionId> <msg>                                        - Send a message over a given session\n");
             printf("cchat <sessionId> <msg>                                       - Send a message over a given session with compression\n");
@@ -0,0 +1,289 @@
+/**
+ * @file
+ *
+ * Unmarshal benchmark. Reports the heap allocations and time taken to unmarshal and release the
+ * arguments of messages with nested signatures.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/atomic.h>
+#include <qcc/time.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+#include <alljoyn/MsgArg.h>
+#include <alljoyn/version.h>
+
+#include <alljoyn/Status.h>
+
+/* Private files included for unit testing */
+#include <RemoteEndpoint.h>
+
+#define QCC_MODULE "ALLJOYN"
+
+using namespace qcc;
+using namespace std;
+using namespace ajn;
+
+/*
+ * Count heap allocations while a message is being unmarshaled and released
+ */
+static bool counting = false;
+static volatile int32_t numAllocs = 0;
+
+void* operator new(size_t size)
+{
+    if (counting) {
+        IncrementAndFetch(&numAllocs);
+    }
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr)
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr)
+{
+    free(ptr);
+}
+
+static BusAttachment* gBus;
+
+static const bool falsiness = false;
+
+class _UnmarshalMessage : public _Message {
+  public:
+
+    _UnmarshalMessage() : _Message(*gBus) { }
+
+    QStatus Signal(const char* signature, const MsgArg* args, size_t numArgs)
+    {
+        return SignalMsg(signature, NULL, 0, "/org/alljoyn/unmarshal", "org.alljoyn.unmarshal", "Args", args, numArgs, 0, 0);
+    }
+
+    QStatus Write(RemoteEndpoint& ep)
+    {
+        WriteContext context;
+        return DeliverNonBlocking(ep, context);
+    }
+
+    QStatus ReadHeader(RemoteEndpoint& ep)
+    {
+        return Read(ep, false);
+    }
+
+    QStatus ReadArgs()
+    {
+        return UnmarshalArgs("*");
+    }
+
+    size_t BodyLength() const
+    {
+        return msgHeader.bodyLen;
+    }
+};
+
+typedef qcc::ManagedObj<_UnmarshalMessage> UnmarshalMessage;
+
+static const char* names[] = { "Name", "Version", "Description", "Manufacturer", "ModelNumber", "SerialNumber" };
+
+/* a{sv} */
+static void BuildDict(MsgArg& arg, size_t num)
+{
+    MsgArg* entries = new MsgArg[num];
+    for (size_t i = 0; i < num; ++i) {
+        entries[i].Set("{sv}", names[i % ArraySize(names)], new MsgArg("u", (uint32_t)i));
+    }
+    arg.Set("a{sv}", num, entries);
+    arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+}
+
+/* a{sv} where every value is an a{sv} */
+static void BuildNestedDict(MsgArg& arg, size_t num)
+{
+    MsgArg* entries = new MsgArg[num];
+    for (size_t i = 0; i < num; ++i) {
+        MsgArg* inner = new MsgArg();
+        BuildDict(*inner, num);
+        entries[i].Set("{sv}", names[i % ArraySize(names)], inner);
+    }
+    arg.Set("a{sv}", num, entries);
+    arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+}
+
+/* a(ssu) */
+static void BuildStructs(MsgArg& arg, size_t num)
+{
+    MsgArg* entries = new MsgArg[num];
+    for (size_t i = 0; i < num; ++i) {
+        entries[i].Set("(ssu)", names[i % ArraySize(names)], names[(i + 1) % ArraySize(names)], (uint32_t)i);
+    }
+    arg.Set("a(ssu)", num, entries);
+    arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+}
+
+/* aas */
+static void BuildArrays(MsgArg& arg, size_t num)
+{
+    MsgArg* entries = new MsgArg[num];
+    for (size_t i = 0; i < num; ++i) {
+        entries[i].Set("as", ArraySize(names), names);
+    }
+    arg.Set("aas", num, entries);
+    arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+}
+
+static QStatus RunBenchmark(const char* label, MsgArg& arg, RemoteEndpoint& ep, uint32_t iterations)
+{
+    QStatus status;
+    UnmarshalMessage msg;
+    status = msg->Signal(arg.Signature().c_str(), &arg, 1);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("Failed to marshal %s", label));
+        return status;
+    }
+    size_t allocs = 0;
+    uint64_t elapsed = 0;
+    for (uint32_t it = 0; (status == ER_OK) && (it < iterations); ++it) {
+        status = msg->Write(ep);
+        if (status != ER_OK) {
+            break;
+        }
+        UnmarshalMessage* rx = new UnmarshalMessage();
+        status = (*rx)->ReadHeader(ep);
+        if (status == ER_OK) {
+            numAllocs = 0;
+            counting = true;
+            uint64_t start = GetTimestamp64();
+            status = (*rx)->ReadArgs();
+            delete rx;
+            elapsed += GetTimestamp64() - start;
+            counting = false;
+            allocs += numAllocs;
+        } else {
+            delete rx;
+        }
+    }
+    if (status == ER_OK) {
+        printf("%-24s %8u bytes: %8.1f allocs/msg %10.0f ns/msg\n", label, (uint32_t)msg->BodyLength(),
+               (double)allocs / iterations, (1000000.0 * elapsed) / iterations);
+    } else {
+        QCC_LogError(status, ("Unmarshal benchmark %s failed", label));
+    }
+    return status;
+}
+
+static void usage(void)
+{
+    printf("Usage: unmarshal [-n <entries>] [-i <iterations>]\n\n");
+    printf("Options:\n");
+    printf("   -h               = Print this help message\n");
+    printf("   -n <entries>     = Number of entries in each container (default 20)\n");
+    printf("   -i <iterations>  = Number of messages to unmarshal (default 10000)\n");
+}
+
+int main(int argc, char** argv)
+{
+    QStatus status = ER_OK;
+    uint32_t numEntries = 20;
+    uint32_t iterations = 10000;
+
+    printf("AllJoyn Library version: %s\n", ajn::GetVersion());
+    printf("AllJoyn Library build info: %s\n", ajn::GetBuildInfo());
+
+    for (int i = 1; i < argc; ++i) {
+        uint32_t* opt = NULL;
+        if (0 == strcmp("-n", argv[i])) {
+            opt = &numEntries;
+        } else if (0 == strcmp("-i", argv[i])) {
+            opt = &iterations;
+        } else if (0 == strcmp("-h", argv[i])) {
+            usage();
+            exit(0);
+        } else {
+            printf("Unknown option %s\n", argv[i]);
+            usage();
+            exit(1);
+        }
+        if (++i == argc) {
+            printf("option %s requires a parameter\n", argv[i - 1]);
+            usage();
+            exit(1);
+        }
+        *opt = StringToU32(argv[i], 0, *opt);
+    }
+
+    gBus = new BusAttachment("unmarshal");
+    gBus->Start();
+
+    Pipe* pipe = new Pipe();
+    RemoteEndpoint* ep = new RemoteEndpoint(*gBus, falsiness, String::Empty, pipe);
+
+    MsgArg dict;
+    BuildDict(dict, numEntries);
+    MsgArg nested;
+    BuildNestedDict(nested, numEntries);
+    MsgArg structs;
+    BuildStructs(structs, numEntries);
+    MsgArg arrays;
+    BuildArrays(arrays, numEntries);
+
+    if (status == ER_OK) {
+        status = RunBenchmark("a{sv}", dict, *ep, iterations);
+    }
+    if (status == ER_OK) {
+        status = RunBenchmark("a{sv} of a{sv}", nested, *ep, (std::max)(iterations / 10, (uint32_t)1));
+    }
+    if (status == ER_OK) {
+        status = RunBenchmark("a(ssu)", structs, *ep, iterations);
+    }
+    if (status == ER_OK) {
+        status = RunBenchmark("aas", arrays, *ep, iterations);
+    }
+
+    delete ep;
+    delete pipe;
+    delete gBus;
+
+    printf("\n%s\n", (status == ER_OK) ? "PASSED" : "FAILED");
+    return (status == ER_OK) ? 0 : 1;
+}
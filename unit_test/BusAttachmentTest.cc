@@ -554,3 +554,65 @@ TEST_F(BusAttachmentTest, GetDBusProxyObj) {
     replyMsg->GetArg(0)->Get("u", &requestNameResponce);
     EXPECT_EQ(DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER, requestNameResponce);
 }
+
+TEST_F(BusAttachmentTest, DispatchQueueDepths) {
+    EXPECT_EQ(static_cast<size_t>(1), bus.GetDispatchQueueDepths());
+
+    BusAttachment laneBus("BusAttachmentLanes", false, 3, BusAttachment::DISPATCH_SESSION_LANES);
+    QStatus status = laneBus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = laneBus.Connect(getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* One lane per handler thread and the reply lane */
+    uint32_t depths[5] = { 99, 99, 99, 99, 99 };
+    EXPECT_EQ(static_cast<size_t>(4), laneBus.GetDispatchQueueDepths(depths, 5));
+    EXPECT_EQ(static_cast<uint32_t>(99), depths[4]);
+
+    /* Replies are dispatched through the lanes, the queues must be drained once the call returns */
+    ProxyBusObject dBusProxyObj(laneBus.GetDBusProxyObj());
+    MsgArg arg("s", "org.alljoyn.test.BusAttachmentLanes");
+    Message replyMsg(laneBus);
+    status = dBusProxyObj.MethodCall(ajn::org::freedesktop::DBus::WellKnownName, "NameHasOwner", &arg, 1, replyMsg);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    laneBus.GetDispatchQueueDepths(depths, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(static_cast<uint32_t>(0), depths[i]);
+    }
+
+    laneBus.Stop();
+    laneBus.Join();
+}
+
+TEST_F(BusAttachmentTest, CryptoWorkers) {
+    BusAttachment::CryptoWorkerStats stats;
+    bus.GetCryptoWorkerStats(stats);
+    EXPECT_EQ(static_cast<uint32_t>(0), stats.numWorkers);
+    EXPECT_EQ(ER_BUS_BUS_ALREADY_STARTED, bus.SetCryptoWorkers(2));
+
+    BusAttachment cryptoBus("BusAttachmentCryptoWorkers", false);
+    QStatus status = cryptoBus.SetCryptoWorkers(2);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = cryptoBus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = cryptoBus.Connect(getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    /* Messages that are not encrypted never go to the workers */
+    ProxyBusObject dBusProxyObj(cryptoBus.GetDBusProxyObj());
+    MsgArg arg("s", "org.alljoyn.test.BusAttachmentCryptoWorkers");
+    Message replyMsg(cryptoBus);
+    status = dBusProxyObj.MethodCall(ajn::org::freedesktop::DBus::WellKnownName, "NameHasOwner", &arg, 1, replyMsg);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    cryptoBus.GetCryptoWorkerStats(stats);
+    EXPECT_EQ(static_cast<uint32_t>(2), stats.numWorkers);
+    EXPECT_EQ(static_cast<uint32_t>(0), stats.queueDepth);
+    EXPECT_EQ(static_cast<uint64_t>(0), stats.messagesEncrypted);
+
+    cryptoBus.Stop();
+    cryptoBus.Join();
+    cryptoBus.GetCryptoWorkerStats(stats);
+    EXPECT_EQ(static_cast<uint32_t>(0), stats.numWorkers);
+}
@@ -25,6 +25,7 @@
 
 #include <alljoyn/BusAttachment.h>
 #include <alljoyn/Message.h>
+#include <alljoyn/MsgCursor.h>
 #include <alljoyn/version.h>
 
 #include <alljoyn/Status.h>
@@ -32,6 +33,7 @@
 /* Private files included for unit testing */
 #include <PeerState.h>
 #include <SignatureUtils.h>
+#include <MarshalPlan.h>
 #include <RemoteEndpoint.h>
 
 /* Header files included for Google Test Framework */
@@ -116,6 +118,11 @@ class MyMessage : public _Message {
         return SignalMsg(sig, destination, 0, objPath, iface, signalName, argList, numArgs, 0, 0);
     }
 
+    QStatus PlannedMethodCall(const MarshalPlan* plan, const MsgArg* argList, size_t numArgs)
+    {
+        return CallMsg(plan->GetSignature(), "a.b.c", 0, "/foo/bar", "foo.bar", "test", argList, numArgs, 0, plan);
+    }
+
     QStatus UnmarshalBody() { return UnmarshalArgs("*"); }
 
     QStatus Read(RemoteEndpoint& ep, const qcc::String& endpointName, bool pedantic = true)
@@ -297,6 +304,173 @@ TEST(MarshalTest, TestMsgUnpack) {
     delete bus;
 }
 
+TEST(MarshalTest, MarshalPlan) {
+    QStatus status = ER_OK;
+
+    BusAttachment*bus = new BusAttachment("TestMarshalPlan", false);
+    bus->Start();
+
+    TestPipe stream;
+    TestPipe* pStream = &stream;
+    static const bool falsiness = false;
+    RemoteEndpoint ep(*bus, falsiness, String::Empty, pStream);
+
+    MsgArg fixed[3];
+    fixed[0].Set("(iiid)", 1, 2, 3, 0.25);
+    fixed[1].Set("(iiid)", -1, -2, -3, 1.5);
+    fixed[2].Set("(iiid)", 7, 8, 9, 100.0);
+    MsgArg entries[2];
+    entries[0].Set("{sv}", "one", new MsgArg("u", 1));
+    entries[0].SetOwnershipFlags(MsgArg::OwnsArgs);
+    entries[1].Set("{sv}", "two", new MsgArg("(yn)", 2, -2));
+    entries[1].SetOwnershipFlags(MsgArg::OwnsArgs);
+    const char* strs[] = { "a", "bc" };
+    MsgArg args[5];
+    args[0].Set("a(iiid)", ArraySize(fixed), fixed);
+    args[1].Set("(yqb(xt))", 1, 2, true, -3LL, 4ULL);
+    args[2].Set("a{sv}", ArraySize(entries), entries);
+    args[3].Set("as", ArraySize(strs), strs);
+    args[4].Set("a(iiid)", (size_t)0, (const MsgArg*)NULL);
+
+    const MarshalPlan* plan = MarshalPlan::Get("a(iiid)(yqb(xt))a{sv}asa(iiid)");
+    ASSERT_TRUE(plan != NULL);
+    EXPECT_EQ(5U, plan->GetNumArgs());
+    EXPECT_EQ(plan, MarshalPlan::Get("a(iiid)(yqb(xt))a{sv}asa(iiid)"));
+
+    size_t size;
+    status = plan->GetSize(args, ArraySize(args), size);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(SignatureUtils::GetSize(args, ArraySize(args)), size);
+
+    MyMessage msg(*bus);
+    status = msg.PlannedMethodCall(plan, args, ArraySize(args));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.Deliver(ep);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.Read(ep, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.Unmarshal(ep, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg.UnmarshalBody();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    size_t numArgs;
+    const MsgArg* outArgs;
+    msg.GetArgs(numArgs, outArgs);
+    EXPECT_STREQ(MsgArg::ToString(args, ArraySize(args)).c_str(), MsgArg::ToString(outArgs, numArgs).c_str());
+
+    /* Args that don't match the plan are rejected */
+    status = msg.PlannedMethodCall(plan, args, 3);
+    EXPECT_EQ(ER_BUS_UNEXPECTED_SIGNATURE, status) << "  Actual Status: " << QCC_StatusText(status);
+    MsgArg wrong[5];
+    for (size_t i = 0; i < ArraySize(wrong); ++i) {
+        wrong[i] = args[i];
+    }
+    wrong[1].Set("(yqb(xx))", 1, 2, true, -3LL, 4LL);
+    status = msg.PlannedMethodCall(plan, wrong, ArraySize(wrong));
+    EXPECT_EQ(ER_BUS_UNEXPECTED_SIGNATURE, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    delete bus;
+}
+
+TEST(MarshalTest, MsgCursor) {
+    QStatus status = ER_OK;
+
+    BusAttachment*bus = new BusAttachment("TestMsgCursor", false);
+    bus->Start();
+
+    TestPipe stream;
+    ManagedObj<MyMessage> msg(*bus);
+
+    TestPipe* pStream = &stream;
+    static const bool falsiness = false;
+    RemoteEndpoint ep(*bus, falsiness, String::Empty, pStream);
+
+    /*
+     * A property dictionary followed by a struct and a trailing scalar
+     */
+    MsgArg props[32];
+    qcc::String keys[ArraySize(props)];
+    for (size_t k = 0; k < ArraySize(props); ++k) {
+        keys[k] = "Prop" + U32ToString(k);
+        props[k].Set("{sv}", keys[k].c_str(), new MsgArg("u", (uint32_t)(k * 10)));
+        props[k].SetOwnershipFlags(MsgArg::OwnsArgs);
+    }
+    MsgArg args[4];
+    args[0].Set("s", "first");
+    args[1].Set("a{sv}", ArraySize(props), props);
+    args[2].Set("(ias)", -7, 2, "one", "two");
+    args[3].Set("u", 1234);
+
+    status = msg->Signal(NULL, "/foo/bar", "foo.bar", "test", args, ArraySize(args));
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg->Deliver(ep);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg->Read(ep, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = msg->Unmarshal(ep, ":88.88");
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    Message m = Message::cast(msg);
+
+    /* Skip the string, look up a property and read the trailing scalar */
+    {
+        MsgCursor cursor(m);
+        EXPECT_EQ(ALLJOYN_STRING, cursor.GetTypeId());
+        EXPECT_EQ(ER_OK, cursor.Skip());
+        EXPECT_EQ(ALLJOYN_ARRAY, cursor.GetTypeId());
+        MsgArg value;
+        status = cursor.Lookup("Prop23", value);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        uint32_t u = 0;
+        const MsgArg* inner;
+        ASSERT_EQ(ER_OK, value.Get("v", &inner));
+        ASSERT_EQ(ER_OK, inner->Get("u", &u));
+        EXPECT_EQ(230U, u);
+        EXPECT_EQ(ALLJOYN_STRUCT, cursor.GetTypeId());
+        EXPECT_EQ(ER_OK, cursor.Skip());
+        EXPECT_EQ(ER_OK, cursor.Get("u", &u));
+        EXPECT_EQ(1234U, u);
+        EXPECT_TRUE(cursor.AtEnd());
+        EXPECT_EQ(ER_BUS_END_OF_ARGS, cursor.Skip());
+    }
+
+    /* Read values inside containers */
+    {
+        MsgCursor cursor(m);
+        const char* str;
+        ASSERT_EQ(ER_OK, cursor.Get("s", &str));
+        EXPECT_STREQ("first", str);
+        MsgArg value;
+        EXPECT_EQ(ER_BUS_ELEMENT_NOT_FOUND, cursor.Lookup("NoSuchProp", value));
+        EXPECT_EQ(ER_OK, cursor.Enter());
+        EXPECT_EQ(1U, cursor.GetDepth());
+        int32_t i = 0;
+        EXPECT_EQ(ER_OK, cursor.Get("i", &i));
+        EXPECT_EQ(-7, i);
+        EXPECT_EQ(ER_OK, cursor.Enter());
+        EXPECT_EQ(ER_OK, cursor.Get("s", &str));
+        EXPECT_STREQ("one", str);
+        EXPECT_EQ(ER_OK, cursor.Leave());
+        EXPECT_TRUE(cursor.AtEnd());
+        EXPECT_EQ(ER_OK, cursor.Leave());
+        EXPECT_EQ(0U, cursor.GetDepth());
+        uint32_t u = 0;
+        EXPECT_EQ(ER_BUS_BAD_VALUE, cursor.Enter());
+        EXPECT_EQ(ER_OK, cursor.Get("u", &u));
+        EXPECT_EQ(1234U, u);
+        EXPECT_EQ(ER_FAIL, cursor.Leave());
+    }
+
+    /* The cursor does not build the message arguments */
+    size_t numArgs;
+    const MsgArg* msgArgs;
+    m->GetArgs(numArgs, msgArgs);
+    EXPECT_EQ(0U, numArgs);
+
+    delete bus;
+}
+
 /*--------------------------FUZZING TEST CODE---------------------------------*/
 static bool fuzzing = false;
 static bool nobig = false;
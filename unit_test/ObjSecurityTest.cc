@@ -22,6 +22,7 @@
 #include <alljoyn/ProxyBusObject.h>
 #include <alljoyn/InterfaceDescription.h>
 #include <alljoyn/DBusStd.h>
+#include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
 #include <qcc/Util.h>
 
@@ -3002,3 +3003,84 @@ TEST_F(ObjectSecurityTest, Test33) {
     EXPECT_EQ(Intf2->GetSecurityPolicy(), AJ_IFC_SECURITY_INHERIT);
     EXPECT_FALSE(clientProxyObject.IsSecure());
 }
+
+/*
+ *  Client bus has crypto workers.
+ *  service creates interface with AJ_IFC_SECURITY_REQUIRED.
+ *  client makes method calls.
+ *  expected that the calls are encrypted by the crypto workers and all of them are answered.
+ */
+TEST_F(ObjectSecurityTest, CryptoWorkers) {
+
+    QStatus status = ER_OK;
+
+    BusAttachment cryptoBus("ObjectSecurityTestCryptoClient", false);
+    status = cryptoBus.SetCryptoWorkers(2);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = cryptoBus.Start();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = cryptoBus.Connect(ajn::getConnectArg().c_str());
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    cryptoBus.EnablePeerSecurity("ALLJOYN_SRP_KEYX", this, NULL, false);
+    cryptoBus.ClearKeyStore();
+
+    InterfaceDescription* Intf1 = NULL;
+    status = servicebus.CreateInterface(interface1, Intf1, AJ_IFC_SECURITY_REQUIRED);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = Intf1->AddMethod("my_ping", "s", "s", "inStr,outStr", 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    Intf1->Activate();
+    InterfaceDescription* Intf2 = NULL;
+    status = servicebus.CreateInterface(interface2, Intf2, AJ_IFC_SECURITY_REQUIRED);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = Intf2->AddProperty("integer_property", "i", PROP_ACCESS_RW);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    Intf2->Activate();
+
+    SvcTestObject serviceObject(object_path, servicebus);
+    status = servicebus.RegisterBusObject(serviceObject, false);
+    //Wait for a maximum of 3 sec for object to be registered
+    for (int i = 0; i < 300; ++i) {
+        qcc::Sleep(10);
+        if (serviceObject.objectRegistered) {
+            break;
+        }
+    }
+    ASSERT_TRUE(serviceObject.objectRegistered);
+
+    InterfaceDescription* clienttestIntf = NULL;
+    status = cryptoBus.CreateInterface(interface1, clienttestIntf, AJ_IFC_SECURITY_REQUIRED);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = clienttestIntf->AddMethod("my_ping", "s", "s", "inStr,outStr", 0);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    clienttestIntf->Activate();
+
+    ProxyBusObject clientProxyObject(cryptoBus, servicebus.GetUniqueName().c_str(), object_path, 0, false);
+    status = clientProxyObject.AddInterface(interface1);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    const InterfaceDescription::Member* pingMethod = clientProxyObject.GetInterface(interface1)->GetMember("my_ping");
+
+    for (int i = 0; i < 10; ++i) {
+        qcc::String pingStr = "Ping String " + qcc::I32ToString(i);
+        MsgArg pingArgs;
+        status = pingArgs.Set("s", pingStr.c_str());
+        EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        Message reply(cryptoBus);
+        serviceObject.msgEncrypted = false;
+        status = clientProxyObject.MethodCall(*pingMethod, &pingArgs, 1, reply, 5000);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+        EXPECT_STREQ(pingStr.c_str(), reply->GetArg(0)->v_string.str);
+        EXPECT_TRUE(serviceObject.msgEncrypted);
+    }
+
+    BusAttachment::CryptoWorkerStats stats;
+    cryptoBus.GetCryptoWorkerStats(stats);
+    EXPECT_EQ(static_cast<uint32_t>(2), stats.numWorkers);
+    EXPECT_LE(static_cast<uint64_t>(10), stats.messagesEncrypted);
+    EXPECT_EQ(static_cast<uint32_t>(0), stats.encryptFailures);
+    EXPECT_EQ(static_cast<uint32_t>(0), stats.queueDepth);
+
+    cryptoBus.ClearKeyStore();
+    cryptoBus.Stop();
+    cryptoBus.Join();
+}
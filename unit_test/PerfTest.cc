@@ -418,6 +418,66 @@ TEST_F(PerfTest, Signals_With_Huge_String_Param) {
 
 
 
+/*
+ * Upper bound in microseconds of the wait below which a fraction of the dispatched entries fall,
+ * from the difference of two dispatch latency snapshots.
+ */
+static uint32_t DispatchLatencyPercentile(const BusAttachment::DispatchLatencyStats& before, const BusAttachment::DispatchLatencyStats& after, uint32_t percent)
+{
+    uint32_t count = after.count - before.count;
+    uint32_t target = (count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < BusAttachment::DISPATCH_LATENCY_BUCKETS; ++i) {
+        seen += after.histogram[i] - before.histogram[i];
+        if (seen >= target) {
+            return (i < (BusAttachment::DISPATCH_LATENCY_BUCKETS - 1)) ? (1U << i) : after.maxUs;
+        }
+    }
+    return after.maxUs;
+}
+
+/* Report method call throughput and how long the calls wait to be dispatched to the handler */
+TEST_F(PerfTest, MethodCallTest_DispatchRate) {
+    const size_t numCalls = 2000;
+    ClientSetup testclient(ajn::getConnectArg().c_str());
+
+    BusAttachment* test_msgBus = testclient.getClientMsgBus();
+
+    ProxyBusObject remoteObj(*test_msgBus, testclient.getClientWellknownName(), testclient.getClientObjectPath(), 0);
+    QStatus status = remoteObj.IntrospectRemoteObject();
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    Message reply(*test_msgBus);
+    MsgArg pingStr("s", "Test Ping");
+    BusAttachment::DispatchLatencyStats before;
+    BusAttachment::DispatchLatencyStats after;
+    BusAttachment::RxStats rxBefore;
+    BusAttachment::RxStats rxAfter;
+    serviceBus->GetDispatchLatencyStats(before);
+    serviceBus->GetRxStats(rxBefore);
+    uint64_t start = GetTimestamp64();
+    for (size_t i = 0; i < numCalls; ++i) {
+        status = remoteObj.MethodCall(testclient.getClientInterfaceName(), "my_ping", &pingStr, 1, reply, 5000);
+        ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    serviceBus->GetDispatchLatencyStats(after);
+    serviceBus->GetRxStats(rxAfter);
+
+    uint32_t dispatched = after.count - before.count;
+    uint32_t rxMsgs = rxAfter.numMsgs - rxBefore.numMsgs;
+    uint32_t rxReads = rxAfter.numReads - rxBefore.numReads;
+    EXPECT_LE(static_cast<uint32_t>(numCalls), dispatched);
+    EXPECT_LE(static_cast<uint32_t>(numCalls), rxMsgs);
+    QCC_SyncPrintf("Method calls: %u calls/sec, queue to handler: mean %u us, median < %u us, p99 < %u us\n",
+                   (uint32_t)(elapsed ? (1000 * numCalls) / elapsed : 0),
+                   (uint32_t)(dispatched ? (after.totalUs - before.totalUs) / dispatched : 0),
+                   DispatchLatencyPercentile(before, after, 50),
+                   DispatchLatencyPercentile(before, after, 99));
+    QCC_SyncPrintf("Received %u messages with %u reads: %.2f reads per message\n",
+                   rxMsgs, rxReads, rxMsgs ? (double)rxReads / rxMsgs : 0.0);
+}
+
 /* Test Asynchronous method calls */
 TEST_F(PerfTest, AsyncMethodCallTest_SimpleCall) {
     ClientSetup testclient(ajn::getConnectArg().c_str());
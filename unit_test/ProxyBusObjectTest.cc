@@ -464,3 +464,129 @@ TEST_F(ProxyBusObjectTest, AddPropertyInterfaceError) {
     status = proxyObj.AddInterface(*testIntf);
     EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
 }
+
+class ProxyBusObjectTestPropertyObject : public BusObject {
+  public:
+    ProxyBusObjectTestPropertyObject(const InterfaceDescription& intf) :
+        BusObject(OBJECT_PATH), intf(intf), cached(1), invalidated(2), uncached(3), getCount(0)
+    {
+        AddInterface(intf);
+    }
+
+    QStatus Get(const char* ifcName, const char* propName, MsgArg& val)
+    {
+        ++getCount;
+        if (strcmp(propName, "cached") == 0) {
+            val.Set("i", cached);
+        } else if (strcmp(propName, "invalidated") == 0) {
+            val.Set("i", invalidated);
+        } else if (strcmp(propName, "uncached") == 0) {
+            val.Set("i", uncached);
+        } else {
+            return ER_BUS_NO_SUCH_PROPERTY;
+        }
+        return ER_OK;
+    }
+
+    void Change(const char* propName, int32_t& prop, int32_t value)
+    {
+        prop = value;
+        MsgArg val("i", value);
+        EmitPropChanged(intf.GetName(), propName, val, 0);
+    }
+
+    const InterfaceDescription& intf;
+    int32_t cached;
+    int32_t invalidated;
+    int32_t uncached;
+    uint32_t getCount;
+};
+
+static void AddPropertyCacheInterface(BusAttachment& bus)
+{
+    InterfaceDescription* testIntf = NULL;
+    QStatus status = bus.CreateInterface(INTERFACE_NAME, testIntf, false);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    testIntf->AddProperty("cached", "i", PROP_ACCESS_READ);
+    testIntf->AddPropertyAnnotation("cached", org::freedesktop::DBus::AnnotateEmitsChanged, "true");
+    testIntf->AddProperty("invalidated", "i", PROP_ACCESS_READ);
+    testIntf->AddPropertyAnnotation("invalidated", org::freedesktop::DBus::AnnotateEmitsChanged, "invalidates");
+    testIntf->AddProperty("uncached", "i", PROP_ACCESS_READ);
+    testIntf->Activate();
+}
+
+TEST_F(ProxyBusObjectTest, PropertyCache) {
+    AddPropertyCacheInterface(servicebus);
+    AddPropertyCacheInterface(bus);
+
+    status = servicebus.Start();
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.Connect(ajn::getConnectArg().c_str());
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObjectTestPropertyObject testObj(*servicebus.GetInterface(INTERFACE_NAME));
+    status = servicebus.RegisterBusObject(testObj);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = servicebus.RequestName(OBJECT_NAME, DBUS_NAME_FLAG_REPLACE_EXISTING | DBUS_NAME_FLAG_DO_NOT_QUEUE);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+
+    ProxyBusObject proxy(bus, OBJECT_NAME, OBJECT_PATH, 0);
+    status = proxy.AddInterface(INTERFACE_NAME);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.EnablePropertyCaching(INTERFACE_NAME);
+    ASSERT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    uint32_t getCount = testObj.getCount;
+
+    /* Annotated properties are served from the cache */
+    MsgArg val;
+    int32_t i;
+    status = proxy.GetProperty(INTERFACE_NAME, "cached", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(ER_OK, val.Get("i", &i));
+    EXPECT_EQ(1, i);
+    status = proxy.GetProperty(INTERFACE_NAME, "invalidated", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(ER_OK, val.Get("i", &i));
+    EXPECT_EQ(2, i);
+    EXPECT_EQ(getCount, testObj.getCount);
+
+    /* Properties without the annotation are always read remotely */
+    status = proxy.GetProperty(INTERFACE_NAME, "uncached", val);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    EXPECT_EQ(getCount + 1, testObj.getCount);
+
+    uint32_t hits;
+    uint32_t misses;
+    proxy.GetPropertyCacheStats(hits, misses);
+    EXPECT_EQ((uint32_t)2, hits);
+    EXPECT_EQ((uint32_t)2, misses);
+
+    /* A changed value replaces the cached value */
+    testObj.Change("cached", testObj.cached, 10);
+    for (size_t n = 0; n < 200; ++n) {
+        proxy.GetProperty(INTERFACE_NAME, "cached", val);
+        val.Get("i", &i);
+        if (i == 10) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    EXPECT_EQ(10, i);
+
+    /* An invalidated value is read again from the remote object */
+    testObj.Change("invalidated", testObj.invalidated, 20);
+    for (size_t n = 0; n < 200; ++n) {
+        proxy.GetProperty(INTERFACE_NAME, "invalidated", val);
+        val.Get("i", &i);
+        if (i == 20) {
+            break;
+        }
+        qcc::Sleep(5);
+    }
+    EXPECT_EQ(20, i);
+
+    status = proxy.DisablePropertyCaching(INTERFACE_NAME);
+    EXPECT_EQ(ER_OK, status) << "  Actual Status: " << QCC_StatusText(status);
+    status = proxy.DisablePropertyCaching(INTERFACE_NAME);
+    EXPECT_EQ(ER_BUS_OBJECT_NO_SUCH_INTERFACE, status) << "  Actual Status: " << QCC_StatusText(status);
+}
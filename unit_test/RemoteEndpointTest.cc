@@ -0,0 +1,103 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <qcc/Pipe.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+
+#include <alljoyn/Status.h>
+
+/* Private files included for unit testing */
+#include <RemoteEndpoint.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace ajn;
+using namespace qcc;
+using namespace std;
+
+class BatchMessage : public _Message {
+  public:
+    BatchMessage(BusAttachment& bus) : _Message(bus) { }
+
+    QStatus Signal(const qcc::String& objPath)
+    {
+        return SignalMsg("", NULL, 0, objPath, "org.alljoyn.test.Batch", "Signal", NULL, 0, 0, 0);
+    }
+};
+
+typedef ManagedObj<BatchMessage> TestMessage;
+
+static const size_t NUM_MSGS = 4;
+
+static const bool incoming = false;
+
+class RemoteEndpointTest : public testing::Test {
+  public:
+    RemoteEndpointTest() : bus("RemoteEndpointTest", false), pStream(&stream), ep(bus, incoming, String::Empty, pStream) { }
+
+    virtual void SetUp()
+    {
+        ASSERT_EQ(ER_OK, bus.Start());
+        for (size_t i = 0; i < NUM_MSGS; ++i) {
+            TestMessage tmsg(bus);
+            ASSERT_EQ(ER_OK, tmsg->Signal("/org/alljoyn/test/m" + U32ToString(i)));
+            msgs[i] = Message::cast(tmsg);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        bus.Stop();
+        bus.Join();
+    }
+
+    BusAttachment bus;
+    Pipe stream;
+    Stream* pStream;
+    RemoteEndpoint ep;
+    Message msgs[NUM_MSGS];
+};
+
+TEST_F(RemoteEndpointTest, PushMessagesQueuesWholeBatch) {
+    ep->SetTxQueueLimits(NUM_MSGS, 0, _RemoteEndpoint::TX_QUEUE_DROP_NEW);
+
+    size_t numQueued = 0;
+    EXPECT_EQ(ER_OK, ep->PushMessages(msgs, NUM_MSGS, numQueued));
+    EXPECT_EQ(NUM_MSGS, numQueued);
+}
+
+/*
+ * A batch stops at the first message the queue refuses. The caller can then skip that message
+ * and push the rest of the batch, as SessionlessObj does for a catch-up range.
+ */
+TEST_F(RemoteEndpointTest, PushMessagesStopsAtFirstRefusedMessage) {
+    ep->SetTxQueueLimits(NUM_MSGS - 2, 0, _RemoteEndpoint::TX_QUEUE_DROP_NEW);
+
+    size_t numQueued = 0;
+    EXPECT_EQ(ER_BUS_TX_QUEUE_FULL, ep->PushMessages(msgs, NUM_MSGS, numQueued));
+    EXPECT_EQ(NUM_MSGS - 2, numQueued);
+
+    ep->SetTxQueueLimits(NUM_MSGS, 0, _RemoteEndpoint::TX_QUEUE_DROP_NEW);
+    size_t next = numQueued + 1;
+    EXPECT_EQ(ER_OK, ep->PushMessages(&msgs[next], NUM_MSGS - next, numQueued));
+    EXPECT_EQ(NUM_MSGS - next, numQueued);
+}